@@ -1,4 +1,658 @@
 import * as m from 'zigbee-herdsman-converters/lib/modernExtend';
+import * as exposes from 'zigbee-herdsman-converters/lib/exposes';
+
+// Operation names for the latency summary (order matches perf_id_t in main/perf_stats.h)
+const PERF_NAMES = [
+    "read_temp_hum", "read_pressure", "read_voc", "read_nox", "read_co2",
+    "i2c_sht45", "i2c_lps22hb", "i2c_sgp41", "i2c_scd40",
+    "led_refresh", "zb_attr_batch", "nvs_commit", "ota_write",
+];
+
+// Latency percentiles (0xF013, octet string): {id, p50, p90, p99} log2 bucket per operation.
+// Bucket b means the percentile lies in [2^b, 2^(b+1)) us, so publish the upper edge.
+const perfSummary = {
+    isModernExtend: true,
+    fromZigbee: [{
+        cluster: "msTemperatureMeasurement",
+        type: ["attributeReport", "readResponse"],
+        convert: (model, msg, publish, options, meta) => {
+            const raw = msg.data["61459"];
+            if (raw === undefined) return;
+            const parts = [];
+            for (let i = 0; i + 3 < raw.length; i += 4) {
+                const name = PERF_NAMES[raw[i]] ?? `op${raw[i]}`;
+                const edges = [raw[i + 1], raw[i + 2], raw[i + 3]].map((b) => 2 ** (b + 1));
+                parts.push(`${name}: p50<${edges[0]} p90<${edges[1]} p99<${edges[2]} us`);
+            }
+            return {perf_summary: parts.join("; ")};
+        },
+    }],
+    toZigbee: [{
+        key: ["perf_summary"],
+        convertGet: async (entity, key, meta) => {
+            await entity.read("msTemperatureMeasurement", [0xF013]);
+        },
+    }],
+    exposes: [
+        exposes.text("perf_summary", exposes.access.STATE_GET)
+            .withDescription("Latency percentiles per operation (p50/p90/p99 upper bounds in microseconds)"),
+    ],
+};
+
+// Task/heap telemetry record (0xF107 on haDiagnostic, octet string, see main/telemetry.h):
+// uptime, heap free, heap min free, largest free block (uint32 LE), CPU load (uint8),
+// then per task {name[4], stack free bytes (uint16 LE), cpu % (uint8)}
+const telemetry = {
+    isModernExtend: true,
+    fromZigbee: [{
+        cluster: "haDiagnostic",
+        type: ["attributeReport", "readResponse"],
+        convert: (model, msg, publish, options, meta) => {
+            const raw = msg.data["61703"];
+            if (raw === undefined || raw.length < 17) return;
+            const buf = Buffer.from(raw);
+            const tasks = [];
+            for (let i = 17; i + 6 < buf.length; i += 7) {
+                const name = buf.subarray(i, i + 4).toString("latin1").replace(/\0+$/, "");
+                tasks.push(`${name}: ${buf.readUInt16LE(i + 4)}B ${buf[i + 6]}%`);
+            }
+            return {
+                uptime: buf.readUInt32LE(0),
+                heap_free: buf.readUInt32LE(4),
+                heap_largest_block: buf.readUInt32LE(12),
+                cpu_load: buf[16],
+                task_stats: tasks.join("; "),
+            };
+        },
+    }],
+    toZigbee: [{
+        key: ["cpu_load", "heap_free", "heap_largest_block", "task_stats", "uptime"],
+        convertGet: async (entity, key, meta) => {
+            await entity.read("haDiagnostic", [0xF107]);
+        },
+    }],
+    exposes: [
+        exposes.numeric("uptime", exposes.access.STATE_GET).withUnit("s").withDescription("Time since boot"),
+        exposes.numeric("cpu_load", exposes.access.STATE_GET).withUnit("%").withDescription("CPU load since the previous sample"),
+        exposes.numeric("heap_free", exposes.access.STATE_GET).withUnit("B").withDescription("Free heap"),
+        exposes.numeric("heap_largest_block", exposes.access.STATE_GET).withUnit("B").withDescription("Largest free heap block (fragmentation)"),
+        exposes.text("task_stats", exposes.access.STATE_GET).withDescription("Per-task free stack and CPU share, lowest stack first"),
+    ],
+};
+
+// Boot milestones (0xF10A on haDiagnostic, octet string, see main/boot_profile.h): version,
+// reset reason (esp_reset_reason_t), boots since power-on (uint16 LE), milestones reached by
+// the previous boot (uint16 LE mask), then ms since reset per milestone (uint32 LE, 0xFFFFFFFF = not yet)
+const BOOT_MILESTONES = [
+    "app_main", "settings_init", "platform_config", "esp_zb_start", "stack_ready",
+    "led_init", "fan_init", "i2c_bus0_init", "sgp41_init", "scd40_init",
+    "i2c_bus1_init", "sht45_init", "lps22hb_init", "sensors_ready", "network", "first_report",
+];
+const RESET_REASONS = [
+    "unknown", "power_on", "external", "software", "panic", "int_wdt", "task_wdt", "wdt",
+    "deep_sleep", "brownout", "sdio", "usb", "jtag", "efuse", "power_glitch", "cpu_lockup",
+];
+
+const bootProfile = {
+    isModernExtend: true,
+    fromZigbee: [{
+        cluster: "haDiagnostic",
+        type: ["attributeReport", "readResponse"],
+        convert: (model, msg, publish, options, meta) => {
+            const raw = msg.data["61706"];
+            if (raw === undefined || raw.length < 6) return;
+            const buf = Buffer.from(raw);
+            const times = {};
+            for (let i = 0; i < BOOT_MILESTONES.length && 6 + 4 * i + 3 < buf.length; i++) {
+                const ms = buf.readUInt32LE(6 + 4 * i);
+                if (ms !== 0xFFFFFFFF) times[BOOT_MILESTONES[i]] = ms;
+            }
+            const prevMask = buf.readUInt16LE(4);
+            const prevLast = BOOT_MILESTONES.filter((name, i) => prevMask & (1 << i)).pop();
+            return {
+                reset_reason: RESET_REASONS[buf[1]] ?? `reason${buf[1]}`,
+                boot_count: buf.readUInt16LE(2),
+                boot_network_time: times.network ?? null,
+                boot_first_report_time: times.first_report ?? null,
+                boot_milestones: Object.entries(times).map(([name, ms]) => `${name}: ${ms}`).join("; "),
+                previous_boot_reached: prevLast ?? "none",
+            };
+        },
+    }],
+    toZigbee: [{
+        key: ["reset_reason", "boot_count", "boot_network_time", "boot_first_report_time",
+              "boot_milestones", "previous_boot_reached"],
+        convertGet: async (entity, key, meta) => {
+            await entity.read("haDiagnostic", [0xF10A]);
+        },
+    }],
+    exposes: [
+        exposes.text("reset_reason", exposes.access.STATE_GET).withDescription("Cause of the last reset"),
+        exposes.numeric("boot_count", exposes.access.STATE_GET).withDescription("Boots since the last power-on"),
+        exposes.numeric("boot_network_time", exposes.access.STATE_GET).withUnit("ms").withDescription("Time from reset to network joined or restored"),
+        exposes.numeric("boot_first_report_time", exposes.access.STATE_GET).withUnit("ms").withDescription("Time from reset to the first published sample"),
+        exposes.text("boot_milestones", exposes.access.STATE_GET).withDescription("Boot milestones reached, ms since reset"),
+        exposes.text("previous_boot_reached", exposes.access.STATE_GET).withDescription("Last milestone the previous boot reached (none after power-on)"),
+    ],
+};
+
+// Bulk configuration (0xF020 on msTemperatureMeasurement, octet string, see main/config_tlv.h):
+// version byte, then {tag, length, value LE} per setting. A write only changes the keys it
+// contains and is applied as a whole (or rejected as a whole), so a device is provisioned in
+// one frame. Fan mode uses the firmware values (off 0, low 30, medium 60, high 100, auto 255).
+const CONFIG_TLV_VERSION = 1;
+
+// Settings (main/attr_table.h): bulk configuration fields, and a config expose per custom attribute
+// BEGIN GENERATED by tools/gen_converter.py from main/attr_table.h, do not edit
+const CONFIG_FIELDS = [
+    // [key, tag, size, signed]
+    ["temperature_offset", 0x10, 2, true],
+    ["humidity_offset", 0x11, 2, true],
+    ["sensor_refresh_interval", 0x12, 2],
+    ["pm_poll_interval", 0x13, 2],
+    ["sensor_leds", 0x01, 1],
+    ["led_brightness", 0x03, 1],
+    ["led_mask", 0x04, 1],
+    ["led_gradient", 0x05, 1],
+    ["voc_orange_threshold", 0x20, 2],
+    ["voc_red_threshold", 0x21, 2],
+    ["nox_orange_threshold", 0x22, 2],
+    ["nox_red_threshold", 0x23, 2],
+    ["co2_orange_threshold", 0x24, 2],
+    ["co2_red_threshold", 0x25, 2],
+    ["humidity_orange_low_threshold", 0x26, 2],
+    ["humidity_orange_high_threshold", 0x27, 2],
+    ["humidity_red_low_threshold", 0x28, 2],
+    ["humidity_red_high_threshold", 0x29, 2],
+    ["status_led", 0x02, 1],
+    ["fan_mode", 0x30, 1],
+    ["fan_idle", 0x31, 1],
+    ["fan_hysteresis", 0x32, 1],
+    ["fan_ramp_down", 0x33, 1],
+    ["fan_temp_start", 0x34, 2],
+    ["fan_temp_full", 0x35, 2],
+    ["fan_voc_start", 0x36, 2],
+    ["fan_voc_full", 0x37, 2],
+    ["fan_co2_start", 0x38, 2],
+    ["fan_co2_full", 0x39, 2],
+    ["fan_humidity_start", 0x3A, 2],
+    ["fan_humidity_full", 0x3B, 2],
+    ["fan_purge_time", 0x3C, 2],
+    ["fan_purge_speed", 0x3D, 1],
+    ["fan_measure_speed", 0x3E, 1],
+    ["fan_full_rpm", 0x3F, 2],
+];
+
+const configAttributes = [
+    m.numeric({
+        name: "temperature_offset",
+        valueMin: -100,
+        valueMax: 100,
+        valueStep: 1,
+        unit: "0.1°C",
+        cluster: "msTemperatureMeasurement",
+        attribute: {ID: 0xF00F, type: 0x29},
+        description: "Temperature calibration offset (in 0.1°C, e.g., 30 = subtract 3.0°C)",
+        access: "ALL",
+        entityCategory: "config",
+        endpointNames: ["1"],
+    }),
+    m.numeric({
+        name: "humidity_offset",
+        valueMin: -100,
+        valueMax: 100,
+        valueStep: 1,
+        unit: "0.1%",
+        cluster: "msTemperatureMeasurement",
+        attribute: {ID: 0xF010, type: 0x29},
+        description: "Humidity calibration offset (in 0.1%, e.g., 10 = subtract 1.0%)",
+        access: "ALL",
+        entityCategory: "config",
+        endpointNames: ["1"],
+    }),
+    m.numeric({
+        name: "sensor_refresh_interval",
+        valueMin: 10,
+        valueMax: 3600,
+        valueStep: 1,
+        unit: "s",
+        cluster: "msTemperatureMeasurement",
+        attribute: {ID: 0xF011, type: 0x21},
+        description: "Sensor refresh interval in seconds (10-3600, default 30)",
+        access: "ALL",
+        entityCategory: "config",
+        endpointNames: ["1"],
+    }),
+    m.numeric({
+        name: "voc_orange_threshold",
+        valueMin: 0,
+        valueMax: 500,
+        valueStep: 1,
+        cluster: "genAnalogOutput",
+        attribute: {ID: 0xF000, type: 0x21},
+        description: "VOC Index orange (warning) threshold",
+        access: "ALL",
+        entityCategory: "config",
+        endpointNames: ["6"],
+    }),
+    m.numeric({
+        name: "voc_red_threshold",
+        valueMin: 0,
+        valueMax: 500,
+        valueStep: 1,
+        cluster: "genAnalogOutput",
+        attribute: {ID: 0xF001, type: 0x21},
+        description: "VOC Index red (danger) threshold",
+        access: "ALL",
+        entityCategory: "config",
+        endpointNames: ["6"],
+    }),
+    m.numeric({
+        name: "nox_orange_threshold",
+        valueMin: 0,
+        valueMax: 500,
+        valueStep: 1,
+        cluster: "genAnalogOutput",
+        attribute: {ID: 0xF002, type: 0x21},
+        description: "NOx Index orange (warning) threshold",
+        access: "ALL",
+        entityCategory: "config",
+        endpointNames: ["6"],
+    }),
+    m.numeric({
+        name: "nox_red_threshold",
+        valueMin: 0,
+        valueMax: 500,
+        valueStep: 1,
+        cluster: "genAnalogOutput",
+        attribute: {ID: 0xF003, type: 0x21},
+        description: "NOx Index red (danger) threshold",
+        access: "ALL",
+        entityCategory: "config",
+        endpointNames: ["6"],
+    }),
+    m.numeric({
+        name: "co2_orange_threshold",
+        valueMin: 400,
+        valueMax: 5000,
+        valueStep: 1,
+        unit: "ppm",
+        cluster: "genAnalogOutput",
+        attribute: {ID: 0xF004, type: 0x21},
+        description: "CO2 orange (warning) threshold",
+        access: "ALL",
+        entityCategory: "config",
+        endpointNames: ["6"],
+    }),
+    m.numeric({
+        name: "co2_red_threshold",
+        valueMin: 400,
+        valueMax: 5000,
+        valueStep: 1,
+        unit: "ppm",
+        cluster: "genAnalogOutput",
+        attribute: {ID: 0xF005, type: 0x21},
+        description: "CO2 red (danger) threshold",
+        access: "ALL",
+        entityCategory: "config",
+        endpointNames: ["6"],
+    }),
+    m.numeric({
+        name: "humidity_orange_low_threshold",
+        valueMin: 0,
+        valueMax: 100,
+        valueStep: 1,
+        unit: "%",
+        cluster: "genAnalogOutput",
+        attribute: {ID: 0xF006, type: 0x21},
+        description: "Humidity too dry - orange threshold",
+        access: "ALL",
+        entityCategory: "config",
+        endpointNames: ["6"],
+    }),
+    m.numeric({
+        name: "humidity_orange_high_threshold",
+        valueMin: 0,
+        valueMax: 100,
+        valueStep: 1,
+        unit: "%",
+        cluster: "genAnalogOutput",
+        attribute: {ID: 0xF007, type: 0x21},
+        description: "Humidity too humid - orange threshold",
+        access: "ALL",
+        entityCategory: "config",
+        endpointNames: ["6"],
+    }),
+    m.numeric({
+        name: "humidity_red_low_threshold",
+        valueMin: 0,
+        valueMax: 100,
+        valueStep: 1,
+        unit: "%",
+        cluster: "genAnalogOutput",
+        attribute: {ID: 0xF008, type: 0x21},
+        description: "Humidity too dry - red threshold",
+        access: "ALL",
+        entityCategory: "config",
+        endpointNames: ["6"],
+    }),
+    m.numeric({
+        name: "humidity_red_high_threshold",
+        valueMin: 0,
+        valueMax: 100,
+        valueStep: 1,
+        unit: "%",
+        cluster: "genAnalogOutput",
+        attribute: {ID: 0xF009, type: 0x21},
+        description: "Humidity too humid - red threshold",
+        access: "ALL",
+        entityCategory: "config",
+        endpointNames: ["6"],
+    }),
+    m.numeric({
+        name: "fan_idle",
+        valueMin: 0,
+        valueMax: 100,
+        valueStep: 1,
+        unit: "%",
+        cluster: "hvacFanCtrl",
+        attribute: {ID: 0xF000, type: 0x20},
+        description: "Auto mode speed in clean air (0 = off)",
+        access: "ALL",
+        entityCategory: "config",
+        endpointNames: ["8"],
+    }),
+    m.numeric({
+        name: "fan_hysteresis",
+        valueMin: 0,
+        valueMax: 50,
+        valueStep: 1,
+        unit: "%",
+        cluster: "hvacFanCtrl",
+        attribute: {ID: 0xF001, type: 0x20},
+        description: "Demand drop before the fan slows down",
+        access: "ALL",
+        entityCategory: "config",
+        endpointNames: ["8"],
+    }),
+    m.numeric({
+        name: "fan_ramp_down",
+        valueMin: 0,
+        valueMax: 100,
+        valueStep: 1,
+        unit: "%/min",
+        cluster: "hvacFanCtrl",
+        attribute: {ID: 0xF002, type: 0x20},
+        description: "Auto mode slow-down rate (0 = immediate)",
+        access: "ALL",
+        entityCategory: "config",
+        endpointNames: ["8"],
+    }),
+    m.numeric({
+        name: "fan_temp_start",
+        valueMin: 0,
+        valueMax: 60,
+        valueStep: 1,
+        unit: "°C",
+        cluster: "hvacFanCtrl",
+        attribute: {ID: 0xF003, type: 0x21},
+        description: "Temperature where the fan starts ramping up",
+        access: "ALL",
+        entityCategory: "config",
+        endpointNames: ["8"],
+    }),
+    m.numeric({
+        name: "fan_temp_full",
+        valueMin: 0,
+        valueMax: 60,
+        valueStep: 1,
+        unit: "°C",
+        cluster: "hvacFanCtrl",
+        attribute: {ID: 0xF004, type: 0x21},
+        description: "Temperature for full speed",
+        access: "ALL",
+        entityCategory: "config",
+        endpointNames: ["8"],
+    }),
+    m.numeric({
+        name: "fan_voc_start",
+        valueMin: 0,
+        valueMax: 500,
+        valueStep: 1,
+        cluster: "hvacFanCtrl",
+        attribute: {ID: 0xF005, type: 0x21},
+        description: "VOC index where the fan starts ramping up",
+        access: "ALL",
+        entityCategory: "config",
+        endpointNames: ["8"],
+    }),
+    m.numeric({
+        name: "fan_voc_full",
+        valueMin: 0,
+        valueMax: 500,
+        valueStep: 1,
+        cluster: "hvacFanCtrl",
+        attribute: {ID: 0xF006, type: 0x21},
+        description: "VOC index for full speed",
+        access: "ALL",
+        entityCategory: "config",
+        endpointNames: ["8"],
+    }),
+    m.numeric({
+        name: "fan_co2_start",
+        valueMin: 0,
+        valueMax: 5000,
+        valueStep: 1,
+        unit: "ppm",
+        cluster: "hvacFanCtrl",
+        attribute: {ID: 0xF007, type: 0x21},
+        description: "CO2 where the fan starts ramping up",
+        access: "ALL",
+        entityCategory: "config",
+        endpointNames: ["8"],
+    }),
+    m.numeric({
+        name: "fan_co2_full",
+        valueMin: 0,
+        valueMax: 5000,
+        valueStep: 1,
+        unit: "ppm",
+        cluster: "hvacFanCtrl",
+        attribute: {ID: 0xF008, type: 0x21},
+        description: "CO2 for full speed",
+        access: "ALL",
+        entityCategory: "config",
+        endpointNames: ["8"],
+    }),
+    m.numeric({
+        name: "fan_humidity_start",
+        valueMin: 0,
+        valueMax: 100,
+        valueStep: 1,
+        unit: "%",
+        cluster: "hvacFanCtrl",
+        attribute: {ID: 0xF009, type: 0x21},
+        description: "Humidity where the fan starts ramping up",
+        access: "ALL",
+        entityCategory: "config",
+        endpointNames: ["8"],
+    }),
+    m.numeric({
+        name: "fan_humidity_full",
+        valueMin: 0,
+        valueMax: 100,
+        valueStep: 1,
+        unit: "%",
+        cluster: "hvacFanCtrl",
+        attribute: {ID: 0xF00A, type: 0x21},
+        description: "Humidity for full speed",
+        access: "ALL",
+        entityCategory: "config",
+        endpointNames: ["8"],
+    }),
+    m.numeric({
+        name: "fan_purge_time",
+        valueMin: 0,
+        valueMax: 600,
+        valueStep: 1,
+        unit: "s",
+        cluster: "hvacFanCtrl",
+        attribute: {ID: 0xF00C, type: 0x21},
+        description: "Fan boost before each sample so the sensors read room air (0 = off)",
+        access: "ALL",
+        entityCategory: "config",
+        endpointNames: ["8"],
+    }),
+    m.numeric({
+        name: "fan_purge_speed",
+        valueMin: 0,
+        valueMax: 100,
+        valueStep: 1,
+        unit: "%",
+        cluster: "hvacFanCtrl",
+        attribute: {ID: 0xF00D, type: 0x20},
+        description: "Fan speed during the purge",
+        access: "ALL",
+        entityCategory: "config",
+        endpointNames: ["8"],
+    }),
+    m.numeric({
+        name: "fan_measure_speed",
+        valueMin: 0,
+        valueMax: 100,
+        valueStep: 1,
+        unit: "%",
+        cluster: "hvacFanCtrl",
+        attribute: {ID: 0xF00E, type: 0x20},
+        description: "Fan speed during the 5 s before and while the sensors are read",
+        access: "ALL",
+        entityCategory: "config",
+        endpointNames: ["8"],
+    }),
+    m.numeric({
+        name: "fan_full_rpm",
+        valueMin: 0,
+        valueMax: 10000,
+        valueStep: 1,
+        unit: "RPM",
+        cluster: "hvacFanCtrl",
+        attribute: {ID: 0xF010, type: 0x21},
+        description: "Fan RPM at 100%: speeds become RPM targets held from the tachometer (0 = open-loop duty)",
+        access: "ALL",
+        entityCategory: "config",
+        endpointNames: ["8"],
+    }),
+];
+// END GENERATED
+
+const bulkConfig = {
+    isModernExtend: true,
+    fromZigbee: [{
+        cluster: "msTemperatureMeasurement",
+        type: ["attributeReport", "readResponse"],
+        convert: (model, msg, publish, options, meta) => {
+            const raw = msg.data["61472"];
+            if (raw === undefined || raw.length < 1 || raw[0] !== CONFIG_TLV_VERSION) return;
+            const buf = Buffer.from(raw);
+            const config = {};
+            for (let i = 1; i + 1 < buf.length && i + 2 + buf[i + 1] <= buf.length; i += 2 + buf[i + 1]) {
+                const field = CONFIG_FIELDS.find((f) => f[1] === buf[i]);
+                if (!field || field[2] !== buf[i + 1]) continue;
+                config[field[0]] = field[2] === 1 ? buf[i + 2] :
+                    field[3] ? buf.readInt16LE(i + 2) : buf.readUInt16LE(i + 2);
+            }
+            return {config: JSON.stringify(config)};
+        },
+    }],
+    toZigbee: [{
+        key: ["config"],
+        convertSet: async (entity, key, value, meta) => {
+            const config = typeof value === "string" ? JSON.parse(value) : value;
+            const parts = [Buffer.from([CONFIG_TLV_VERSION])];
+            for (const [name, val] of Object.entries(config)) {
+                const field = CONFIG_FIELDS.find((f) => f[0] === name);
+                if (!field) throw new Error(`Unknown configuration key '${name}'`);
+                const entry = Buffer.alloc(2 + field[2]);
+                entry[0] = field[1];
+                entry[1] = field[2];
+                const v = typeof val === "boolean" ? Number(val) : val;
+                if (field[2] === 1) entry.writeUInt8(v, 2);
+                else if (field[3]) entry.writeInt16LE(v, 2);
+                else entry.writeUInt16LE(v, 2);
+                parts.push(entry);
+            }
+            await entity.write("msTemperatureMeasurement", {0xF020: {value: Buffer.concat(parts), type: 0x41}});
+            await entity.read("msTemperatureMeasurement", [0xF020]);
+        },
+        convertGet: async (entity, key, meta) => {
+            await entity.read("msTemperatureMeasurement", [0xF020]);
+        },
+    }],
+    exposes: [
+        exposes.text("config", exposes.access.ALL)
+            .withDescription("Whole configuration as JSON (read), or any subset of its keys to apply and save in one write"),
+    ],
+};
+
+// Diagnostics cluster (endpoint 1): stack counters and firmware counters (0xF1xx)
+const diagnostic = (name, attribute, description, unit) => m.numeric({
+    name,
+    cluster: "haDiagnostic",
+    attribute,
+    description,
+    unit,
+    access: "STATE_GET",
+    entityCategory: "diagnostic",
+    endpointNames: ["1"],
+});
+
+const diagnostics = [
+    diagnostic("mac_tx_ucast_retry", "macTxUcastRetry", "MAC unicast retries"),
+    diagnostic("mac_tx_ucast_fail", "macTxUcastFail", "MAC unicast failures"),
+    diagnostic("aps_tx_ucast_fail", "apsTxUcastFail", "APS unicast failures"),
+    diagnostic("route_disc_initiated", "routeDiscInitiated", "Route discoveries initiated"),
+    diagnostic("packet_buffer_alloc_failures", "packetBufferAllocateFailures", "Packet buffer allocation failures"),
+    diagnostic("acquisition_cycle_time", {ID: 0xF100, type: 0x23}, "Duration of the last sensor acquisition cycle", "ms"),
+    diagnostic("i2c_errors_sht45", {ID: 0xF101, type: 0x23}, "Failed I2C transactions (SHT45)"),
+    diagnostic("i2c_errors_lps22hb", {ID: 0xF102, type: 0x23}, "Failed I2C transactions (pressure sensor)"),
+    diagnostic("i2c_errors_sgp41", {ID: 0xF103, type: 0x23}, "Failed I2C transactions (SGP41)"),
+    diagnostic("i2c_errors_scd40", {ID: 0xF104, type: 0x23}, "Failed I2C transactions (SCD40)"),
+    diagnostic("dropped_samples", {ID: 0xF105, type: 0x23}, "Sensor reads that reported a cached value"),
+    diagnostic("heap_min_free", {ID: 0xF106, type: 0x23}, "Heap low-water mark since boot", "B"),
+];
+
+const fan = [
+    m.enumLookup({
+        name: "fan_mode",
+        lookup: {off: 0, low: 1, medium: 2, high: 3, auto: 5},
+        cluster: "hvacFanCtrl",
+        attribute: "fanMode",
+        description: "Fan speed: fixed 0/30/60/100 % or auto (control curve on every sample)",
+        access: "ALL",
+        endpointName: "8",
+    }),
+    m.numeric({
+        name: "fan_rpm",
+        cluster: "hvacFanCtrl",
+        attribute: {ID: 0xF00B, type: 0x21},
+        description: "Measured fan speed",
+        unit: "RPM",
+        access: "STATE_GET",
+        endpointNames: ["8"],
+    }),
+    m.binary({
+        name: "fan_fault",
+        cluster: "hvacFanCtrl",
+        attribute: {ID: 0xF00F, type: 0x10},
+        valueOn: [true, 1],
+        valueOff: [false, 0],
+        description: "Fan commanded on but not turning (stalled or failed to start)",
+        access: "STATE_GET",
+        endpointName: "8",
+        reporting: {min: 0, max: 3600, change: 1},
+        entityCategory: "diagnostic",
+    }),
+];
 
 export default {
     zigbeeModel: ['aeris-z'],
@@ -8,7 +662,7 @@ export default {
     extend: [m.deviceEndpoints
         (
             {
-                endpoints:{"1":1,"2":2,"3":3,"4":4,"5":5,"6":6,"7":7}}), 
+                endpoints:{"1":1,"2":2,"3":3,"4":4,"5":5,"6":6,"7":7,"8":8}}), 
                 m.temperature(
                     {
                         endpointNames: ["1"],
@@ -27,46 +681,39 @@ export default {
                         reporting: {min: 10, max: 3600, change: 1},
                     }
                 ),
-                m.numeric(
+                m.enumLookup(
                     {
-                        name: "temperature_offset",
-                        valueMin: -100,
-                        valueMax: 100,
-                        valueStep: 1,
-                        unit: "0.1°C",
+                        name: "log_level",
+                        lookup: {none: 0, error: 1, warn: 2, info: 3, debug: 4, verbose: 5},
                         cluster: "msTemperatureMeasurement",
-                        attribute: {ID: 0xF00F, type: 0x29},  // INT16S
-                        description: "Temperature calibration offset (in 0.1°C, e.g., 30 = subtract 3.0°C)",
+                        attribute: {ID: 0xF012, type: 0x20},  // UINT8
+                        description: "Firmware log verbosity (runtime only, resets to info on reboot)",
                         access: "ALL",
-                        endpointNames: ["1"]
+                        endpointName: "1"
                     }
                 ),
-                m.numeric(
+                m.enumLookup(
                     {
-                        name: "humidity_offset",
-                        valueMin: -100,
-                        valueMax: 100,
-                        valueStep: 1,
-                        unit: "0.1%",
-                        cluster: "msTemperatureMeasurement",
-                        attribute: {ID: 0xF010, type: 0x29},  // INT16S
-                        description: "Humidity calibration offset (in 0.1%, e.g., 10 = subtract 1.0%)",
+                        name: "event_trace",
+                        lookup: {stop: 0, start: 1, dump: 2},
+                        cluster: "haDiagnostic",
+                        attribute: {ID: 0xF108, type: 0x20},  // UINT8
+                        description: "Event tracer (trace builds only): dump prints the ring on the serial console for tools/trace_to_perfetto.py",
                         access: "ALL",
-                        endpointNames: ["1"]
+                        entityCategory: "diagnostic",
+                        endpointName: "1"
                     }
                 ),
-                m.numeric(
+                m.enumLookup(
                     {
-                        name: "sensor_refresh_interval",
-                        valueMin: 10,
-                        valueMax: 3600,
-                        valueStep: 1,
-                        unit: "s",
-                        cluster: "msTemperatureMeasurement",
-                        attribute: {ID: 0xF011, type: 0x21},  // UINT16
-                        description: "Sensor refresh interval in seconds (10-3600, default 30)",
+                        name: "i2c_capture",
+                        lookup: {off: 0, ring: 1, stream: 2, dump: 3},
+                        cluster: "haDiagnostic",
+                        attribute: {ID: 0xF109, type: 0x20},  // UINT8
+                        description: "I2C transaction recorder: stream/dump print #I2C lines on the serial console for tools/i2c_replay.py",
                         access: "ALL",
-                        endpointNames: ["1"]
+                        entityCategory: "diagnostic",
+                        endpointName: "1"
                     }
                 ),
                 m.pressure(
@@ -136,6 +783,17 @@ export default {
                         endpointNames:["6"]
                     }
                 ),
+                m.enumLookup(
+                    {
+                        name:"led_mode",
+                        lookup:{thresholds:0, gradient:1},
+                        cluster:"genAnalogOutput",
+                        attribute:{ID:0xF014, type:0x20},  // UINT8
+                        description:"Sensor LED colors: thresholds = green/orange/red, gradient = continuous blend between the thresholds",
+                        access:"ALL",
+                        endpointName:"6"
+                    }
+                ),
                 m.numeric(
                     {
                         name:"led_brightness",
@@ -149,6 +807,13 @@ export default {
                         access:"ALL",
                         endpointNames:["6"]
                     }
-                )
+                ),
+                ...fan,
+                ...configAttributes,
+                bulkConfig,
+                perfSummary,
+                telemetry,
+                bootProfile,
+                ...diagnostics
             ],
 };
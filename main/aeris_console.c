@@ -0,0 +1,448 @@
+/*
+ * Diagnostics and benchmark console implementation for Aeris_Lite
+ *
+ * Benchmarks that touch the sensors, the LED strip or Zigbee attributes run
+ * with the Zigbee lock held, so they never interleave with the periodic
+ * acquisition cycle (a scheduler alarm in the Zigbee task).
+ */
+
+#include "aeris_console.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+
+#if AERIS_CONSOLE_ENABLE
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_console.h"
+#include "esp_timer.h"
+#include "esp_system.h"
+#include "esp_partition.h"
+#include "nvs.h"
+#include "esp_zigbee_core.h"
+#include "esp_zb_aeris.h"
+#include "esp_zb_ota.h"
+#include "aeris_driver.h"
+#include "led_indicator.h"
+#include "settings.h"
+#include "perf_stats.h"
+#include "telemetry.h"
+#include "boot_profile.h"
+#include "zb_diagnostics.h"
+#include "binlog.h"
+#include "event_trace.h"
+#include "i2c_capture.h"
+
+static const char *TAG = "CONSOLE";
+
+/* Latency statistics of one benchmark */
+typedef struct {
+    uint32_t count;
+    uint32_t errors;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t total_us;
+} bench_stats_t;
+
+static const char *SENSOR_NAMES[AERIS_SENSOR_MAX] = {
+    [AERIS_SENSOR_SHT45] = "sht45",
+    [AERIS_SENSOR_LPS22HB] = "lps22hb",
+    [AERIS_SENSOR_SGP41] = "sgp41",
+    [AERIS_SENSOR_SCD40] = "scd40",
+};
+
+static void bench_add(bench_stats_t *stats, uint32_t elapsed_us, esp_err_t ret)
+{
+    if (ret != ESP_OK) {
+        stats->errors++;
+        return;
+    }
+    if (stats->count == 0 || elapsed_us < stats->min_us) {
+        stats->min_us = elapsed_us;
+    }
+    if (elapsed_us > stats->max_us) {
+        stats->max_us = elapsed_us;
+    }
+    stats->total_us += elapsed_us;
+    stats->count++;
+}
+
+static void bench_print(const char *name, const bench_stats_t *stats)
+{
+    if (stats->count == 0) {
+        printf("%-10s no successful runs (%lu errors)\n", name, (unsigned long)stats->errors);
+        return;
+    }
+    printf("%-10s n=%-4lu min=%-8lu avg=%-8lu max=%-8lu us  errors=%lu\n", name,
+           (unsigned long)stats->count, (unsigned long)stats->min_us,
+           (unsigned long)(stats->total_us / stats->count), (unsigned long)stats->max_us,
+           (unsigned long)stats->errors);
+}
+
+/**
+ * @brief Parse an optional positive count argument
+ */
+static int parse_count(int argc, char **argv, int index, int def, int max)
+{
+    if (argc <= index) {
+        return def;
+    }
+    int value = atoi(argv[index]);
+    if (value < 1) {
+        return def;
+    }
+    return (value > max) ? max : value;
+}
+
+static void bench_i2c(int iterations)
+{
+    for (int s = 0; s < AERIS_SENSOR_MAX; s++) {
+        bench_stats_t stats = {0};
+        for (int i = 0; i < iterations; i++) {
+            esp_zb_lock_acquire(portMAX_DELAY);
+            int64_t t0 = esp_timer_get_time();
+            esp_err_t ret = aeris_ping_sensor((aeris_sensor_id_t)s);
+            uint32_t elapsed = (uint32_t)(esp_timer_get_time() - t0);
+            esp_zb_lock_release();
+            if (ret == ESP_ERR_INVALID_STATE) {
+                break;                      /* Sensor not initialized */
+            }
+            bench_add(&stats, elapsed, ret);
+        }
+        bench_print(SENSOR_NAMES[s], &stats);
+    }
+    printf("Round trips include the sensor command delays; per-transaction latency: \"perf\"\n");
+}
+
+static void bench_cycle(int iterations)
+{
+    bench_stats_t stats = {0};
+    for (int i = 0; i < iterations; i++) {
+        esp_zb_lock_acquire(portMAX_DELAY);
+        int64_t t0 = esp_timer_get_time();
+        aeris_zb_update_now();
+        uint32_t elapsed = (uint32_t)(esp_timer_get_time() - t0);
+        esp_zb_lock_release();
+        bench_add(&stats, elapsed, ESP_OK);
+    }
+    bench_print("cycle", &stats);
+}
+
+static void bench_led(int iterations)
+{
+    bench_stats_t stats = {0};
+    for (int i = 0; i < iterations; i++) {
+        /* The render task owns the strip: time from request to transfer done */
+        uint32_t sent = led_indicator_frames_sent();
+        int64_t t0 = esp_timer_get_time();
+        esp_err_t ret = led_indicator_refresh();
+        while (ret == ESP_OK && led_indicator_frames_sent() == sent) {
+            if (esp_timer_get_time() - t0 > BENCH_LED_TIMEOUT_US) {
+                ret = ESP_ERR_TIMEOUT;
+                break;
+            }
+            taskYIELD();
+        }
+        uint32_t elapsed = (uint32_t)(esp_timer_get_time() - t0);
+        bench_add(&stats, elapsed, ret);
+    }
+    bench_print("led", &stats);
+}
+
+static void bench_nvs(int iterations)
+{
+    nvs_handle_t handle;
+    esp_err_t ret = nvs_open(BENCH_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK) {
+        printf("nvs_open failed: %s\n", esp_err_to_name(ret));
+        return;
+    }
+
+    bench_stats_t stats = {0};
+    for (int i = 0; i < iterations; i++) {
+        int64_t t0 = esp_timer_get_time();
+        ret = nvs_set_u32(handle, "seq", (uint32_t)i);
+        if (ret == ESP_OK) {
+            ret = nvs_commit(handle);
+        }
+        bench_add(&stats, (uint32_t)(esp_timer_get_time() - t0), ret);
+    }
+    bench_print("nvs", &stats);
+
+    nvs_erase_all(handle);
+    nvs_commit(handle);
+    nvs_close(handle);
+}
+
+static void bench_print_rate(const char *name, size_t bytes, int64_t elapsed_us, esp_err_t ret)
+{
+    if (ret != ESP_OK) {
+        printf("%-10s failed: %s\n", name, esp_err_to_name(ret));
+    } else {
+        printf("%-10s %6u KB in %8lld us  %7.1f KB/s\n", name, (unsigned)(bytes / 1024), (long long)elapsed_us,
+               elapsed_us > 0 ? (bytes / 1024.0) * 1e6 / (double)elapsed_us : 0.0);
+    }
+}
+
+static void bench_flash(int size_kb)
+{
+    /* Also keeps OTA downloads out until the partition is returned */
+    const esp_partition_t *part = esp_zb_ota_slot_borrow();
+    if (!part) {
+        printf("Inactive OTA partition unavailable (download running, image pending verification, or none)\n");
+        return;
+    }
+    size_t len = (size_t)size_kb * 1024;
+    if (len > part->size) {
+        len = part->size;
+    }
+    len = (len + BENCH_FLASH_CHUNK - 1) / BENCH_FLASH_CHUNK * BENCH_FLASH_CHUNK;  /* Whole sectors */
+
+    uint8_t *buf = malloc(BENCH_FLASH_CHUNK);
+    uint8_t *check = malloc(BENCH_FLASH_CHUNK);
+    if (!buf || !check) {
+        free(buf);
+        free(check);
+        esp_zb_ota_slot_return();
+        printf("Out of memory\n");
+        return;
+    }
+    for (size_t i = 0; i < BENCH_FLASH_CHUNK; i++) {
+        buf[i] = (uint8_t)(i * 7 + 1);
+    }
+
+    printf("Partition %s at 0x%lx (previous firmware image is overwritten)\n", part->label,
+           (unsigned long)part->address);
+
+    int64_t t0 = esp_timer_get_time();
+    esp_err_t ret = esp_partition_erase_range(part, 0, len);
+    bench_print_rate("erase", len, esp_timer_get_time() - t0, ret);
+
+    if (ret == ESP_OK) {
+        t0 = esp_timer_get_time();
+        for (size_t off = 0; off < len && ret == ESP_OK; off += BENCH_FLASH_CHUNK) {
+            ret = esp_partition_write(part, off, buf, BENCH_FLASH_CHUNK);
+        }
+        bench_print_rate("write", len, esp_timer_get_time() - t0, ret);
+    }
+
+    if (ret == ESP_OK) {
+        t0 = esp_timer_get_time();
+        for (size_t off = 0; off < len && ret == ESP_OK; off += BENCH_FLASH_CHUNK) {
+            ret = esp_partition_read(part, off, check, BENCH_FLASH_CHUNK);
+            if (ret == ESP_OK && memcmp(buf, check, BENCH_FLASH_CHUNK) != 0) {
+                ret = ESP_ERR_INVALID_CRC;
+            }
+        }
+        bench_print_rate("read", len, esp_timer_get_time() - t0, ret);
+    }
+
+    free(buf);
+    free(check);
+    esp_zb_ota_slot_return();
+}
+
+static int cmd_bench(int argc, char **argv)
+{
+    if (argc < 2) {
+        printf("usage: bench <i2c|cycle|led|nvs|flash> [count|kb]\n");
+        return 1;
+    }
+
+    if (strcmp(argv[1], "i2c") == 0) {
+        bench_i2c(parse_count(argc, argv, 2, BENCH_DEFAULT_ITERATIONS, BENCH_MAX_ITERATIONS));
+    } else if (strcmp(argv[1], "cycle") == 0) {
+        bench_cycle(parse_count(argc, argv, 2, 1, BENCH_MAX_CYCLES));
+    } else if (strcmp(argv[1], "led") == 0) {
+        bench_led(parse_count(argc, argv, 2, BENCH_DEFAULT_ITERATIONS, BENCH_MAX_ITERATIONS));
+    } else if (strcmp(argv[1], "nvs") == 0) {
+        bench_nvs(parse_count(argc, argv, 2, 10, 100));
+    } else if (strcmp(argv[1], "flash") == 0) {
+        bench_flash(parse_count(argc, argv, 2, BENCH_FLASH_DEFAULT_KB, 4096));
+    } else {
+        printf("Unknown benchmark: %s\n", argv[1]);
+        return 1;
+    }
+    return 0;
+}
+
+static int cmd_perf(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+        perf_reset();
+        printf("Histograms cleared\n");
+    } else {
+        perf_dump();
+    }
+    return 0;
+}
+
+static int cmd_tasks(int argc, char **argv)
+{
+    /* Last sample of the acquisition cycle: sampling here would race it and reset its interval */
+    telemetry_dump();
+    return 0;
+}
+
+static int cmd_counters(int argc, char **argv)
+{
+    zb_diag_dump();
+    ESP_LOGI(TAG, "Binary log dropped: %lu, uptime: %lld s", binlog_get_dropped(),
+             (long long)(esp_timer_get_time() / 1000000));
+
+    settings_stats_t st;
+    settings_get_stats(&st);
+    ESP_LOGI(TAG, "Settings: %lu changes, %lu commits (%lu bytes, %lu failed)%s",
+             (unsigned long)st.changes, (unsigned long)st.commits,
+             (unsigned long)st.bytes_written, (unsigned long)st.commit_errors,
+             st.pending ? ", commit pending" : "");
+    return 0;
+}
+
+static int cmd_boot(int argc, char **argv)
+{
+    boot_profile_dump();
+    return 0;
+}
+
+static int cmd_inventory(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "clear") == 0) {
+        aeris_sensor_inventory_clear();
+    } else {
+        aeris_sensor_inventory_dump();
+    }
+    return 0;
+}
+
+static int cmd_trace(int argc, char **argv)
+{
+    if (argc < 2) {
+        printf("Event tracer %s\n", event_trace_is_running() ? "running" : "stopped");
+    } else if (strcmp(argv[1], "start") == 0) {
+        event_trace_start();
+    } else if (strcmp(argv[1], "stop") == 0) {
+        event_trace_stop();
+    } else if (strcmp(argv[1], "dump") == 0) {
+        event_trace_dump();
+    } else {
+        printf("usage: trace [start|stop|dump]\n");
+        return 1;
+    }
+    return 0;
+}
+
+static int cmd_i2c_capture(int argc, char **argv)
+{
+    static const char *MODES[] = {"off", "ring", "stream"};
+
+    if (argc < 2) {
+        printf("I2C capture mode: %s\n", MODES[i2c_capture_get_mode()]);
+        return 0;
+    }
+    if (strcmp(argv[1], "dump") == 0) {
+        return i2c_capture_dump() == ESP_OK ? 0 : 1;
+    }
+    for (int i = 0; i < (int)(sizeof(MODES) / sizeof(MODES[0])); i++) {
+        if (strcmp(argv[1], MODES[i]) == 0) {
+            return i2c_capture_set_mode((i2c_capture_mode_t)i) == ESP_OK ? 0 : 1;
+        }
+    }
+    printf("usage: i2c_capture [off|ring|stream|dump]\n");
+    return 1;
+}
+
+static const esp_console_cmd_t CONSOLE_COMMANDS[] = {
+    {
+        .command = "bench",
+        .help = "Run a benchmark: i2c [n] sensor round trips, cycle [n] forced acquisition, "
+                "led [n] strip refresh, nvs [n] NVS commit, flash [kb] erase/write/read of the "
+                "inactive OTA slot (overwrites the previous firmware image)",
+        .hint = "<i2c|cycle|led|nvs|flash> [count|kb]",
+        .func = cmd_bench,
+    },
+    {
+        .command = "perf",
+        .help = "Print the latency histograms, or clear them with \"reset\"",
+        .hint = "[reset]",
+        .func = cmd_perf,
+    },
+    {
+        .command = "tasks",
+        .help = "Print task CPU load, stack and heap watermarks from the last acquisition cycle",
+        .func = cmd_tasks,
+    },
+    {
+        .command = "counters",
+        .help = "Print firmware counters (cycle time, I2C errors, dropped samples, heap)",
+        .func = cmd_counters,
+    },
+    {
+        .command = "boot",
+        .help = "Print the boot milestones (ms since reset) and the previous boot's reached mask",
+        .func = cmd_boot,
+    },
+    {
+        .command = "inventory",
+        .help = "Print the cached sensor inventory, or \"clear\" it so the next boot re-probes the sensors",
+        .hint = "[clear]",
+        .func = cmd_inventory,
+    },
+    {
+        .command = "trace",
+        .help = "Event tracer control (trace builds only), dump for tools/trace_to_perfetto.py",
+        .hint = "[start|stop|dump]",
+        .func = cmd_trace,
+    },
+    {
+        .command = "i2c_capture",
+        .help = "I2C recorder mode, dump for tools/i2c_replay.py",
+        .hint = "[off|ring|stream|dump]",
+        .func = cmd_i2c_capture,
+    },
+};
+
+esp_err_t aeris_console_start(void)
+{
+    esp_console_repl_t *repl = NULL;
+    esp_console_repl_config_t repl_config = ESP_CONSOLE_REPL_CONFIG_DEFAULT();
+    repl_config.prompt = AERIS_CONSOLE_PROMPT;
+    repl_config.task_stack_size = AERIS_CONSOLE_STACK;
+    repl_config.task_priority = AERIS_CONSOLE_PRIORITY;
+
+#if CONFIG_ESP_CONSOLE_UART_DEFAULT || CONFIG_ESP_CONSOLE_UART_CUSTOM
+    esp_console_dev_uart_config_t hw_config = ESP_CONSOLE_DEV_UART_CONFIG_DEFAULT();
+    esp_err_t ret = esp_console_new_repl_uart(&hw_config, &repl_config, &repl);
+#elif CONFIG_ESP_CONSOLE_USB_SERIAL_JTAG
+    esp_console_dev_usb_serial_jtag_config_t hw_config = ESP_CONSOLE_DEV_USB_SERIAL_JTAG_CONFIG_DEFAULT();
+    esp_err_t ret = esp_console_new_repl_usb_serial_jtag(&hw_config, &repl_config, &repl);
+#else
+    esp_err_t ret = ESP_ERR_NOT_SUPPORTED;
+#endif
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Console not started: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    esp_console_register_help_command();
+    for (size_t i = 0; i < sizeof(CONSOLE_COMMANDS) / sizeof(CONSOLE_COMMANDS[0]); i++) {
+        ESP_ERROR_CHECK(esp_console_cmd_register(&CONSOLE_COMMANDS[i]));
+    }
+
+    ret = esp_console_start_repl(repl);
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "Console ready, type \"help\"");
+    }
+    return ret;
+}
+
+#else /* !AERIS_CONSOLE_ENABLE */
+
+esp_err_t aeris_console_start(void)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif /* AERIS_CONSOLE_ENABLE */
@@ -0,0 +1,45 @@
+/*
+ * Diagnostics and benchmark console for Aeris_Lite
+ *
+ * esp_console REPL on the serial console with live microbenchmarks (sensor
+ * I2C round trips, acquisition cycle, LED refresh, NVS commit, flash write
+ * throughput on the inactive OTA slot) and dumps of the latency histograms,
+ * firmware counters and task statistics. Type "help" at the prompt.
+ */
+
+#pragma once
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Set to 0 to leave the serial console output-only */
+#ifndef AERIS_CONSOLE_ENABLE
+#define AERIS_CONSOLE_ENABLE        1
+#endif
+
+#define AERIS_CONSOLE_PROMPT        "aeris> "
+#define AERIS_CONSOLE_STACK         4096
+#define AERIS_CONSOLE_PRIORITY      2       /* Below the Zigbee task (5) */
+
+/* Benchmark limits */
+#define BENCH_DEFAULT_ITERATIONS    20
+#define BENCH_MAX_ITERATIONS        1000
+#define BENCH_MAX_CYCLES            10      /* Each cycle holds the Zigbee lock for ~1 s */
+#define BENCH_FLASH_DEFAULT_KB      64
+#define BENCH_FLASH_CHUNK           4096    /* One flash sector per write */
+#define BENCH_NVS_NAMESPACE         "aeris_bench"
+#define BENCH_LED_TIMEOUT_US        200000  /* Request to transfer-done, per refresh */
+
+/**
+ * @brief Register the console commands and start the REPL task
+ *
+ * @return ESP_ERR_NOT_SUPPORTED when built with AERIS_CONSOLE_ENABLE=0
+ */
+esp_err_t aeris_console_start(void);
+
+#ifdef __cplusplus
+}
+#endif
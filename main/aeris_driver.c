@@ -8,7 +8,14 @@
 #include "aeris_driver.h"
 #include "board.h"
 #include "fan_control.h"
+#include "perf_stats.h"
+#include "event_trace.h"
+#include "i2c_capture.h"
+#include "boot_profile.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
+#include "esp_system.h"
 #include "string.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -43,6 +50,7 @@ static const char *TAG = "AERIS_DRIVER";
 
 /* LPS22HB Constants */
 #define LPS22HB_DEVICE_ID       0xB1  // WHO_AM_I expected value
+#define LPS22HB_CTRL_REG1_CONFIG 0x12 // ODR=1Hz, BDU=1 (set by lps22hb_init)
 
 /* SGP41 Commands */
 #define SGP41_CMD_EXECUTE_CONDITIONING  0x2612  // Execute conditioning (10s)
@@ -57,6 +65,7 @@ static const char *TAG = "AERIS_DRIVER";
 #define SGP41_SELFTEST_TIME_MS          320
 #define SGP41_STARTUP_TIME_MS           170  // Time after power-on
 #define SGP41_MIN_SAMPLING_INTERVAL_MS  1000 // Minimum 1Hz sampling rate (datasheet requirement)
+#define SGP41_SELF_TEST_PASSED          0xD400  // Self-test result word, all tests passed
 
 /* SCD40 Commands */
 #define SCD40_CMD_START_PERIODIC_MEASUREMENT    0x21B1  // Start periodic measurement
@@ -82,6 +91,7 @@ static const char *TAG = "AERIS_DRIVER";
 #define SCD40_INITIAL_STARTUP_MS        1000   // Initial startup time
 #define SCD40_STOP_PERIODIC_MS          500    // Time to stop periodic measurement
 #define SCD40_READ_MEASUREMENT_MS       1      // Time to read measurement
+#define SCD40_DATA_READY_RETRY_MS       250    // Single data-ready retry while verifying a warm boot
 
 /* Current sensor state */
 static aeris_sensor_state_t current_state = {
@@ -113,16 +123,47 @@ static float humidity_offset_percent = 0.0f;  // Default no offset
 
 /* LPS22HB sensor state */
 static bool lps22hb_initialized = false;
+static uint8_t lps22hb_device_id = 0;
 
 /* SGP41 sensor state */
 static bool sgp41_initialized = false;
 static uint64_t sgp41_serial_number = 0;
+static uint16_t sgp41_self_test_result = 0;
 static TickType_t sgp41_last_measure_time = 0;
 
 /* SCD40 sensor state */
 static bool scd40_initialized = false;
 static uint64_t scd40_serial_number = 0;
 
+/* Background initialization (one task per I2C bus) */
+static portMUX_TYPE sensor_init_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint8_t sensor_buses_pending = 0;
+static volatile bool sensors_ready = false;
+static int64_t sensor_init_start_us = 0;
+
+/* Warm-boot sensor inventory: what the last full discovery found. Kept in RTC
+ * memory, so it survives software resets (OTA reboot, panic, watchdog) while
+ * the sensors stay powered and configured; a power cycle starts over. */
+#define SENSOR_INVENTORY_MAGIC  0x5E1507A3u
+
+typedef struct {
+    uint64_t serial;            // SHT45/SGP41/SCD40 serial number
+    uint16_t self_test;         // SGP41 self-test result word
+    uint16_t found_at;          // warm_boots when the entry was recorded
+    uint8_t addr;               // 7-bit I2C address
+    uint8_t variant;            // LPS22HB WHO_AM_I
+    bool valid;                 // Sensor found and initialized
+} sensor_inventory_entry_t;
+
+typedef struct {
+    uint32_t magic;             // Set once a discovery completed
+    uint16_t warm_boots;        // Boots that verified the cache since the full discovery
+    sensor_inventory_entry_t sensor[AERIS_SENSOR_MAX];
+} sensor_inventory_t;
+
+static RTC_NOINIT_ATTR sensor_inventory_t sensor_inventory;
+static bool sensor_inventory_fast = false;  // This boot verifies the cache instead of discovering
+
 /* I2C master bus and device handles (new driver) */
 static i2c_master_bus_handle_t i2c_bus0_handle = NULL;  // Bus 0: SCD4x + SGP41
 static i2c_master_bus_handle_t i2c_bus1_handle = NULL;  // Bus 1: SHT4x + DPS368
@@ -131,6 +172,92 @@ static i2c_master_dev_handle_t lps22hb_dev_handle = NULL;
 static i2c_master_dev_handle_t sgp41_dev_handle = NULL;
 static i2c_master_dev_handle_t scd40_dev_handle = NULL;
 
+/* Failed I2C transactions per sensor (diagnostics) */
+static uint32_t i2c_error_count[AERIS_SENSOR_MAX] = {0};
+
+/* Device handle lookup for the per-sensor I2C wrappers */
+static i2c_master_dev_handle_t *const sensor_dev_handles[AERIS_SENSOR_MAX] = {
+    [AERIS_SENSOR_SHT45] = &sht45_dev_handle,
+    [AERIS_SENSOR_LPS22HB] = &lps22hb_dev_handle,
+    [AERIS_SENSOR_SGP41] = &sgp41_dev_handle,
+    [AERIS_SENSOR_SCD40] = &scd40_dev_handle,
+};
+
+/* Bus number and 7-bit address per sensor (I2C capture records, inventory) */
+static const struct {
+    uint8_t bus;
+    uint8_t addr;
+} sensor_bus_addr[AERIS_SENSOR_MAX] = {
+    [AERIS_SENSOR_SHT45] = { 1, SHT4X_I2C_ADDR },
+    [AERIS_SENSOR_LPS22HB] = { 1, DPS368_I2C_ADDR },
+    [AERIS_SENSOR_SGP41] = { 0, SGP41_I2C_ADDR },
+    [AERIS_SENSOR_SCD40] = { 0, SCD40_I2C_ADDR },
+};
+
+static const char *const sensor_names[AERIS_SENSOR_MAX] = {
+    [AERIS_SENSOR_SHT45] = "SHT45",
+    [AERIS_SENSOR_LPS22HB] = "LPS22HB",
+    [AERIS_SENSOR_SGP41] = "SGP41",
+    [AERIS_SENSOR_SCD40] = "SCD40",
+};
+
+/**
+ * @brief Bookkeeping after every sensor I2C transaction (latency, capture, error count)
+ */
+static void sensor_i2c_done(aeris_sensor_id_t sensor, i2c_capture_op_t op, const uint8_t *tx, size_t tx_len,
+                            const uint8_t *rx, size_t rx_len, esp_err_t ret, uint32_t t0)
+{
+    PERF_END(PERF_I2C_SHT45 + sensor, t0);
+    I2C_CAPTURE_RECORD(sensor_bus_addr[sensor].bus, sensor_bus_addr[sensor].addr, op,
+                       tx, tx_len, rx, rx_len, ret, t0);
+    if (ret != ESP_OK) {
+        i2c_error_count[sensor]++;
+    }
+}
+
+/**
+ * @brief I2C write to a sensor (timed per device)
+ */
+static esp_err_t sensor_i2c_transmit(aeris_sensor_id_t sensor, const uint8_t *data, size_t len,
+                                     int xfer_timeout_ms)
+{
+    uint32_t t0 = perf_now();
+    TRACE_BEGIN(TRACE_I2C_SHT45 + sensor, len);
+    esp_err_t ret = i2c_master_transmit(*sensor_dev_handles[sensor], data, len, xfer_timeout_ms);
+    TRACE_END(TRACE_I2C_SHT45 + sensor, ret);
+    sensor_i2c_done(sensor, I2C_CAPTURE_OP_WRITE, data, len, NULL, 0, ret, t0);
+    return ret;
+}
+
+/**
+ * @brief I2C read from a sensor (timed per device)
+ */
+static esp_err_t sensor_i2c_receive(aeris_sensor_id_t sensor, uint8_t *data, size_t len,
+                                    int xfer_timeout_ms)
+{
+    uint32_t t0 = perf_now();
+    TRACE_BEGIN(TRACE_I2C_SHT45 + sensor, len);
+    esp_err_t ret = i2c_master_receive(*sensor_dev_handles[sensor], data, len, xfer_timeout_ms);
+    TRACE_END(TRACE_I2C_SHT45 + sensor, ret);
+    sensor_i2c_done(sensor, I2C_CAPTURE_OP_READ, NULL, 0, data, len, ret, t0);
+    return ret;
+}
+
+/**
+ * @brief I2C write-then-read (repeated start) to a sensor (timed per device)
+ */
+static esp_err_t sensor_i2c_transmit_receive(aeris_sensor_id_t sensor, const uint8_t *tx, size_t tx_len,
+                                             uint8_t *rx, size_t rx_len, int xfer_timeout_ms)
+{
+    uint32_t t0 = perf_now();
+    TRACE_BEGIN(TRACE_I2C_SHT45 + sensor, tx_len + rx_len);
+    esp_err_t ret = i2c_master_transmit_receive(*sensor_dev_handles[sensor], tx, tx_len, rx, rx_len,
+                                                xfer_timeout_ms);
+    TRACE_END(TRACE_I2C_SHT45 + sensor, ret);
+    sensor_i2c_done(sensor, I2C_CAPTURE_OP_WRITE_READ, tx, tx_len, rx, rx_len, ret, t0);
+    return ret;
+}
+
 /**
  * @brief Calculate CRC8 for SHT45 and SGP41 (polynomial 0x31, init 0xFF)
  */
@@ -151,31 +278,25 @@ static uint8_t sensirion_crc8(const uint8_t *data, size_t len)
 }
 
 /**
- * @brief Initialize SHT45 temperature and humidity sensor
+ * @brief 48-bit serial number from a 3-word response (CRC bytes skipped)
  */
-static esp_err_t sht45_init(void)
+static uint64_t sensirion_serial48(const uint8_t *data)
+{
+    return ((uint64_t)data[0] << 40) |
+           ((uint64_t)data[1] << 32) |
+           ((uint64_t)data[3] << 24) |
+           ((uint64_t)data[4] << 16) |
+           ((uint64_t)data[6] << 8) |
+           ((uint64_t)data[7]);
+}
+
+/**
+ * @brief Read the SHT45 serial number
+ */
+static esp_err_t sht45_read_serial(uint32_t *serial)
 {
-    ESP_LOGI(TAG, "Initializing SHT45 temperature/humidity sensor...");
-    
-    if (!sht45_dev_handle) {
-        ESP_LOGE(TAG, "SHT45 device handle not initialized");
-        return ESP_ERR_INVALID_STATE;
-    }
-    
-    // Send soft reset command
-    uint8_t reset_cmd = SHT45_CMD_SOFT_RESET;
-    esp_err_t ret = i2c_master_transmit(sht45_dev_handle, &reset_cmd, 1, pdMS_TO_TICKS(1000));
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "SHT45 soft reset failed: %s", esp_err_to_name(ret));
-        return ret;
-    }
-    
-    // Wait for reset to complete
-    vTaskDelay(pdMS_TO_TICKS(SHT45_RESET_TIME_MS));
-    
-    // Read serial number to verify communication
     uint8_t serial_cmd = SHT45_CMD_READ_SERIAL;
-    ret = i2c_master_transmit(sht45_dev_handle, &serial_cmd, 1, pdMS_TO_TICKS(1000));
+    esp_err_t ret = sensor_i2c_transmit(AERIS_SENSOR_SHT45, &serial_cmd, 1, pdMS_TO_TICKS(1000));
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "SHT45 read serial command failed: %s", esp_err_to_name(ret));
         return ret;
@@ -185,7 +306,7 @@ static esp_err_t sht45_init(void)
     
     // Read 6 bytes (2 bytes serial + CRC, 2 bytes serial + CRC)
     uint8_t serial_data[6];
-    ret = i2c_master_receive(sht45_dev_handle, serial_data, 6, pdMS_TO_TICKS(1000));
+    ret = sensor_i2c_receive(AERIS_SENSOR_SHT45, serial_data, 6, pdMS_TO_TICKS(1000));
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "SHT45 read serial data failed: %s", esp_err_to_name(ret));
         return ret;
@@ -199,11 +320,41 @@ static esp_err_t sht45_init(void)
         return ESP_ERR_INVALID_CRC;
     }
     
-    // Store serial number
-    sht45_serial_number = ((uint32_t)serial_data[0] << 24) | 
-                          ((uint32_t)serial_data[1] << 16) |
-                          ((uint32_t)serial_data[3] << 8) | 
-                          serial_data[4];
+    *serial = ((uint32_t)serial_data[0] << 24) | 
+              ((uint32_t)serial_data[1] << 16) |
+              ((uint32_t)serial_data[3] << 8) | 
+              serial_data[4];
+    return ESP_OK;
+}
+
+/**
+ * @brief Initialize SHT45 temperature and humidity sensor
+ */
+static esp_err_t sht45_init(void)
+{
+    ESP_LOGI(TAG, "Initializing SHT45 temperature/humidity sensor...");
+    
+    if (!sht45_dev_handle) {
+        ESP_LOGE(TAG, "SHT45 device handle not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    // Send soft reset command
+    uint8_t reset_cmd = SHT45_CMD_SOFT_RESET;
+    esp_err_t ret = sensor_i2c_transmit(AERIS_SENSOR_SHT45, &reset_cmd, 1, pdMS_TO_TICKS(1000));
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "SHT45 soft reset failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    
+    // Wait for reset to complete
+    vTaskDelay(pdMS_TO_TICKS(SHT45_RESET_TIME_MS));
+    
+    // Read serial number to verify communication
+    ret = sht45_read_serial(&sht45_serial_number);
+    if (ret != ESP_OK) {
+        return ret;
+    }
     
     ESP_LOGI(TAG, "SHT45 initialized successfully. Serial: 0x%08lX", sht45_serial_number);
     sht45_initialized = true;
@@ -223,7 +374,7 @@ static esp_err_t sht45_read_temp_humidity(float *temp_c, float *humidity_percent
     
     // Send measurement command (medium repeatability - reduces self-heating)
     uint8_t measure_cmd = SHT45_CMD_MEASURE_MED;
-    esp_err_t ret = i2c_master_transmit(sht45_dev_handle, &measure_cmd, 1, pdMS_TO_TICKS(1000));
+    esp_err_t ret = sensor_i2c_transmit(AERIS_SENSOR_SHT45, &measure_cmd, 1, pdMS_TO_TICKS(1000));
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "SHT45 measure command failed: %s", esp_err_to_name(ret));
         return ret;
@@ -234,7 +385,7 @@ static esp_err_t sht45_read_temp_humidity(float *temp_c, float *humidity_percent
     
     // Read 6 bytes (2 temp + CRC, 2 RH + CRC)
     uint8_t data[6];
-    ret = i2c_master_receive(sht45_dev_handle, data, 6, pdMS_TO_TICKS(1000));
+    ret = sensor_i2c_receive(AERIS_SENSOR_SHT45, data, 6, pdMS_TO_TICKS(1000));
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "SHT45 read measurement failed: %s", esp_err_to_name(ret));
         return ret;
@@ -285,7 +436,7 @@ static esp_err_t scd40_send_command(uint16_t cmd, uint8_t *response, size_t resp
     cmd_buf[1] = cmd & 0xFF;
     
     // Send command
-    esp_err_t ret = i2c_master_transmit(scd40_dev_handle, cmd_buf, 2, pdMS_TO_TICKS(1000));
+    esp_err_t ret = sensor_i2c_transmit(AERIS_SENSOR_SCD40, cmd_buf, 2, pdMS_TO_TICKS(1000));
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "SCD40 send command 0x%04X failed: %s", cmd, esp_err_to_name(ret));
         return ret;
@@ -298,7 +449,7 @@ static esp_err_t scd40_send_command(uint16_t cmd, uint8_t *response, size_t resp
     
     // Read response if expected
     if (response && response_len > 0) {
-        ret = i2c_master_receive(scd40_dev_handle, response, response_len, pdMS_TO_TICKS(1000));
+        ret = sensor_i2c_receive(AERIS_SENSOR_SCD40, response, response_len, pdMS_TO_TICKS(1000));
         if (ret != ESP_OK) {
             ESP_LOGE(TAG, "SCD40 read response failed: %s", esp_err_to_name(ret));
             return ret;
@@ -344,12 +495,7 @@ static esp_err_t scd40_init(void)
     }
     
     // Extract serial number (48 bits from 3 words)
-    scd40_serial_number = ((uint64_t)serial_data[0] << 40) | 
-                          ((uint64_t)serial_data[1] << 32) |
-                          ((uint64_t)serial_data[3] << 24) | 
-                          ((uint64_t)serial_data[4] << 16) |
-                          ((uint64_t)serial_data[6] << 8) | 
-                          serial_data[7];
+    scd40_serial_number = sensirion_serial48(serial_data);
     
     ESP_LOGI(TAG, "SCD40 serial number: 0x%012llX", scd40_serial_number);
     
@@ -367,7 +513,7 @@ static esp_err_t scd40_init(void)
     asc_cmd_buf[3] = asc_params[1];
     asc_cmd_buf[4] = asc_params[2];
     
-    ret = i2c_master_transmit(scd40_dev_handle, asc_cmd_buf, 5, pdMS_TO_TICKS(1000));
+    ret = sensor_i2c_transmit(AERIS_SENSOR_SCD40, asc_cmd_buf, 5, pdMS_TO_TICKS(1000));
     if (ret != ESP_OK) {
         ESP_LOGW(TAG, "SCD40 disable ASC failed (continuing anyway): %s", esp_err_to_name(ret));
     } else {
@@ -464,7 +610,7 @@ static esp_err_t scd40_set_ambient_pressure(uint16_t pressure_hpa)
         return ESP_ERR_INVALID_STATE;
     }
     
-    esp_err_t ret = i2c_master_transmit(scd40_dev_handle, cmd_buf, 5, pdMS_TO_TICKS(1000));
+    esp_err_t ret = sensor_i2c_transmit(AERIS_SENSOR_SCD40, cmd_buf, 5, pdMS_TO_TICKS(1000));
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "SCD40 set ambient pressure failed: %s", esp_err_to_name(ret));
         return ret;
@@ -511,7 +657,7 @@ static esp_err_t sgp41_send_command(uint16_t cmd, const uint8_t *params, size_t
     }
     
     // Send complete command with all parameters
-    esp_err_t ret = i2c_master_transmit(sgp41_dev_handle, full_cmd, full_cmd_len, pdMS_TO_TICKS(1000));
+    esp_err_t ret = sensor_i2c_transmit(AERIS_SENSOR_SGP41, full_cmd, full_cmd_len, pdMS_TO_TICKS(1000));
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "SGP41 send command 0x%04X failed: %s", cmd, esp_err_to_name(ret));
         return ret;
@@ -524,7 +670,7 @@ static esp_err_t sgp41_send_command(uint16_t cmd, const uint8_t *params, size_t
     
     // Read response if expected
     if (response && response_len > 0) {
-        ret = i2c_master_receive(sgp41_dev_handle, response, response_len, pdMS_TO_TICKS(1000));
+        ret = sensor_i2c_receive(AERIS_SENSOR_SGP41, response, response_len, pdMS_TO_TICKS(1000));
         if (ret != ESP_OK) {
             ESP_LOGE(TAG, "SGP41 read response failed: %s", esp_err_to_name(ret));
             return ret;
@@ -564,12 +710,7 @@ static esp_err_t sgp41_init(void)
     }
     
     // Extract serial number (remove CRC bytes)
-    sgp41_serial_number = ((uint64_t)serial_data[0] << 40) |
-                          ((uint64_t)serial_data[1] << 32) |
-                          ((uint64_t)serial_data[3] << 24) |
-                          ((uint64_t)serial_data[4] << 16) |
-                          ((uint64_t)serial_data[6] << 8) |
-                          ((uint64_t)serial_data[7]);
+    sgp41_serial_number = sensirion_serial48(serial_data);
     
     ESP_LOGI(TAG, "SGP41 detected, serial: 0x%012llX", sgp41_serial_number);
     
@@ -583,8 +724,9 @@ static esp_err_t sgp41_init(void)
     }
     
     uint16_t test_value = (test_result[0] << 8) | test_result[1];
-    if (test_value != 0xD400) {  // 0xD400 = all tests passed
-        ESP_LOGW(TAG, "SGP41 self-test result: 0x%04X (expected 0xD400)", test_value);
+    sgp41_self_test_result = test_value;
+    if (test_value != SGP41_SELF_TEST_PASSED) {
+        ESP_LOGW(TAG, "SGP41 self-test result: 0x%04X (expected 0x%04X)", test_value, SGP41_SELF_TEST_PASSED);
     } else {
         ESP_LOGI(TAG, "SGP41 self-test passed");
     }
@@ -652,7 +794,7 @@ static esp_err_t lps22hb_write_reg(uint8_t reg, uint8_t value)
     }
     
     uint8_t write_buf[2] = {reg, value};
-    esp_err_t ret = i2c_master_transmit(lps22hb_dev_handle, write_buf, sizeof(write_buf),
+    esp_err_t ret = sensor_i2c_transmit(AERIS_SENSOR_LPS22HB, write_buf, sizeof(write_buf),
                                         pdMS_TO_TICKS(1000));
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "LPS22HB write reg 0x%02X failed: %s", reg, esp_err_to_name(ret));
@@ -669,8 +811,8 @@ static esp_err_t lps22hb_read_reg(uint8_t reg, uint8_t *data, size_t len)
         return ESP_ERR_INVALID_STATE;
     }
     
-    esp_err_t ret = i2c_master_transmit_receive(lps22hb_dev_handle, &reg, 1, data, len,
-                                                 pdMS_TO_TICKS(1000));
+    esp_err_t ret = sensor_i2c_transmit_receive(AERIS_SENSOR_LPS22HB, &reg, 1, data, len,
+                                                pdMS_TO_TICKS(1000));
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "LPS22HB read reg 0x%02X failed: %s", reg, esp_err_to_name(ret));
     }
@@ -699,6 +841,7 @@ static esp_err_t lps22hb_init(void)
     }
     
     ESP_LOGI(TAG, "LPS22HB detected, device ID: 0x%02X", device_id);
+    lps22hb_device_id = device_id;
     
     // Software reset
     ret = lps22hb_write_reg(LPS22HB_CTRL_REG2, 0x04);
@@ -708,7 +851,7 @@ static esp_err_t lps22hb_init(void)
     // Configure sensor for continuous 1Hz mode
     // CTRL_REG1: ODR=1Hz (0b001), BDU=1 (bit 1), no low-pass filter
     // ODR bits [6:4]: 000=one-shot, 001=1Hz, 010=10Hz, 011=25Hz, 100=50Hz, 101=75Hz
-    ret = lps22hb_write_reg(LPS22HB_CTRL_REG1, 0x12);  // 0b00010010 = 1Hz, BDU=1
+    ret = lps22hb_write_reg(LPS22HB_CTRL_REG1, LPS22HB_CTRL_REG1_CONFIG);  // 0b00010010 = 1Hz, BDU=1
     if (ret != ESP_OK) return ret;
     
     lps22hb_initialized = true;
@@ -757,9 +900,186 @@ static esp_err_t lps22hb_read_data(float *pressure_hpa, float *temperature_c)
 }
 
 /**
- * @brief Initialize dual I2C buses for sensors (new i2c_master driver)
+ * @brief Choose between full discovery and verifying the cached inventory
+ *
+ * The cache is only trusted after a reset that kept the sensors powered, and
+ * for at most AERIS_INVENTORY_MAX_WARM_BOOTS boots in a row.
+ */
+static void sensor_inventory_load(void)
+{
+    esp_reset_reason_t reason = esp_reset_reason();
+    bool warm = (reason != ESP_RST_POWERON && reason != ESP_RST_BROWNOUT && reason != ESP_RST_UNKNOWN);
+    
+    if (warm && sensor_inventory.magic == SENSOR_INVENTORY_MAGIC &&
+        sensor_inventory.warm_boots < AERIS_INVENTORY_MAX_WARM_BOOTS) {
+        sensor_inventory.warm_boots++;
+        sensor_inventory_fast = true;
+        ESP_LOGI(TAG, "Verifying cached sensor inventory (warm boot %u of %d)",
+                 sensor_inventory.warm_boots, AERIS_INVENTORY_MAX_WARM_BOOTS);
+        return;
+    }
+    
+    // Magic stays clear until this discovery completes
+    memset(&sensor_inventory, 0, sizeof(sensor_inventory));
+    sensor_inventory_fast = false;
+    ESP_LOGI(TAG, "Full sensor discovery (reset reason %d)", (int)reason);
+}
+
+/**
+ * @brief Record a sensor after its full initialization succeeded
+ */
+static void sensor_inventory_store(aeris_sensor_id_t sensor)
+{
+    sensor_inventory_entry_t *entry = &sensor_inventory.sensor[sensor];
+    
+    memset(entry, 0, sizeof(*entry));
+    entry->addr = sensor_bus_addr[sensor].addr;
+    entry->found_at = sensor_inventory.warm_boots;
+    switch (sensor) {
+    case AERIS_SENSOR_SHT45:
+        entry->serial = sht45_serial_number;
+        break;
+    case AERIS_SENSOR_LPS22HB:
+        entry->variant = lps22hb_device_id;
+        break;
+    case AERIS_SENSOR_SGP41:
+        entry->serial = sgp41_serial_number;
+        entry->self_test = sgp41_self_test_result;
+        break;
+    case AERIS_SENSOR_SCD40:
+        entry->serial = scd40_serial_number;
+        break;
+    default:
+        return;
+    }
+    entry->valid = true;
+}
+
+/**
+ * @brief Check that the SCD40 has a measurement ready, without reading it
+ *
+ * Only a sensor in periodic measurement sets the data-ready bits, so this
+ * proves the previous boot's measurement is still running. The status word
+ * is CRC-checked by scd40_send_command(). One retry after
+ * SCD40_DATA_READY_RETRY_MS, not a full interval: a sensor caught between
+ * measurements gets the full init, which costs less than waiting for one.
+ *
+ * @return ESP_OK when data is ready, ESP_ERR_NOT_FOUND if not, or the I2C/CRC error
+ */
+static esp_err_t scd40_check_data_ready(void)
+{
+    uint8_t status_data[3];
+    
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (attempt > 0) {
+            vTaskDelay(pdMS_TO_TICKS(SCD40_DATA_READY_RETRY_MS));
+        }
+        esp_err_t ret = scd40_send_command(SCD40_CMD_GET_DATA_READY_STATUS, status_data, 3,
+                                           SCD40_READ_MEASUREMENT_MS);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        uint16_t data_ready = (status_data[0] << 8) | status_data[1];
+        if ((data_ready & 0x07FF) != 0) {
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+/**
+ * @brief Check a cached sensor with one cheap transaction and restore its state
+ *
+ * SHT45 and SGP41: serial number. LPS22HB: WHO_AM_I and CTRL_REG1 in one read
+ * (still configured by the previous boot). SCD40: the serial number cannot be
+ * read while the previous boot's periodic measurement is running, so the
+ * data-ready status must show a pending measurement (which is kept). An SGP41 whose last self-test did not pass is never
+ * taken from the cache.
+ *
+ * @return true if the sensor matches the cache and is ready to be read
+ */
+static bool sensor_inventory_verify(aeris_sensor_id_t sensor)
+{
+    const sensor_inventory_entry_t *entry = &sensor_inventory.sensor[sensor];
+    if (!sensor_inventory_fast || !entry->valid) {
+        return false;
+    }
+    
+    uint8_t rx[9];
+    bool match = false;
+    switch (sensor) {
+    case AERIS_SENSOR_SHT45: {
+        uint32_t serial;
+        match = (sht45_read_serial(&serial) == ESP_OK && serial == entry->serial);
+        if (match) {
+            sht45_serial_number = serial;
+            sht45_initialized = true;
+        }
+        break;
+    }
+    case AERIS_SENSOR_LPS22HB:
+        match = (lps22hb_read_reg(LPS22HB_WHO_AM_I, rx, 2) == ESP_OK &&
+                 rx[0] == entry->variant && rx[1] == LPS22HB_CTRL_REG1_CONFIG);
+        if (match) {
+            lps22hb_device_id = rx[0];
+            lps22hb_initialized = true;
+        }
+        break;
+    case AERIS_SENSOR_SGP41:
+        match = (entry->self_test == SGP41_SELF_TEST_PASSED &&
+                 sgp41_send_command(SGP41_CMD_GET_SERIAL_NUMBER, NULL, 0, rx, 9, 1) == ESP_OK &&
+                 sensirion_serial48(rx) == entry->serial);
+        if (match) {
+            sgp41_serial_number = entry->serial;
+            sgp41_self_test_result = entry->self_test;
+            sgp41_initialized = true;
+            sgp41_last_measure_time = xTaskGetTickCount();
+        }
+        break;
+    case AERIS_SENSOR_SCD40:
+        match = (scd40_check_data_ready() == ESP_OK);
+        if (match) {
+            scd40_serial_number = entry->serial;
+            scd40_initialized = true;
+        }
+        break;
+    default:
+        break;
+    }
+    
+    if (match) {
+        ESP_LOGI(TAG, "%s verified against the cached inventory", sensor_names[sensor]);
+    } else {
+        ESP_LOGW(TAG, "%s does not match the cached inventory, running full init", sensor_names[sensor]);
+    }
+    return match;
+}
+
+/**
+ * @brief Verify a sensor from the cache, or run its full init and cache the result
  */
-static esp_err_t i2c_master_init(void)
+static esp_err_t sensor_init_one(aeris_sensor_id_t sensor, esp_err_t (*full_init)(void))
+{
+    if (sensor_inventory_verify(sensor)) {
+        return ESP_OK;
+    }
+    
+    // Not trusted again until the full init succeeds
+    sensor_inventory.sensor[sensor].valid = false;
+    esp_err_t ret = full_init();
+    if (ret == ESP_OK) {
+        sensor_inventory_store(sensor);
+    }
+    return ret;
+}
+
+/**
+ * @brief Initialize I2C bus 0 (SCD4x + SGP41, new i2c_master driver)
+ *
+ * With CONFIG_PM_ENABLE the i2c_master driver acquires its PM lock around each
+ * transaction only, so no lock is held across the sensor measurement delays.
+ */
+static esp_err_t i2c_bus0_init(void)
 {
     /* Configure I2C Bus 0 (GPIO14/15): SCD4x + SGP41 */
     i2c_master_bus_config_t bus0_config = {
@@ -779,24 +1099,6 @@ static esp_err_t i2c_master_init(void)
     ESP_LOGI(TAG, "I2C Bus 0 initialized on SDA=GPIO%d, SCL=GPIO%d", 
              AERIS_I2C_BUS0_SDA_PIN, AERIS_I2C_BUS0_SCL_PIN);
     
-    /* Configure I2C Bus 1 (GPIO3/4): SHT4x + DPS368 */
-    i2c_master_bus_config_t bus1_config = {
-        .clk_source = I2C_CLK_SRC_DEFAULT,
-        .i2c_port = I2C_NUM_1,
-        .scl_io_num = AERIS_I2C_BUS1_SCL_PIN,
-        .sda_io_num = AERIS_I2C_BUS1_SDA_PIN,
-        .glitch_ignore_cnt = 7,
-        .flags.enable_internal_pullup = true,
-    };
-    
-    err = i2c_new_master_bus(&bus1_config, &i2c_bus1_handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "I2C Bus 1 creation failed: %s", esp_err_to_name(err));
-        return err;
-    }
-    ESP_LOGI(TAG, "I2C Bus 1 initialized on SDA=GPIO%d, SCL=GPIO%d", 
-             AERIS_I2C_BUS1_SDA_PIN, AERIS_I2C_BUS1_SCL_PIN);
-    
     /* Add SCD40 device to Bus 0 */
     i2c_device_config_t scd40_cfg = {
         .dev_addr_length = I2C_ADDR_BIT_LEN_7,
@@ -819,6 +1121,54 @@ static esp_err_t i2c_master_init(void)
         ESP_LOGW(TAG, "Failed to add SGP41 device: %s", esp_err_to_name(err));
     }
     
+    /* Probe known I2C addresses (not needed when the cached inventory is verified) */
+    if (sensor_inventory_fast) {
+        return ESP_OK;
+    }
+    ESP_LOGI(TAG, "Probing I2C Bus 0 devices (SCD4x + SGP41)...");
+    const struct {
+        uint8_t addr;
+        const char *name;
+    } bus0_devices[] = {
+        {SCD40_I2C_ADDR, "SCD40/SCD41"},
+        {SGP41_I2C_ADDR, "SGP41"},
+    };
+    
+    for (size_t i = 0; i < sizeof(bus0_devices)/sizeof(bus0_devices[0]); i++) {
+        esp_err_t probe_ret = i2c_master_probe(i2c_bus0_handle, bus0_devices[i].addr, pdMS_TO_TICKS(100));
+        if (probe_ret == ESP_OK) {
+            ESP_LOGI(TAG, "  [OK] %s found at 0x%02X", bus0_devices[i].name, bus0_devices[i].addr);
+        } else {
+            ESP_LOGD(TAG, "  [--] %s not found at 0x%02X", bus0_devices[i].name, bus0_devices[i].addr);
+        }
+    }
+    
+    return ESP_OK;
+}
+
+/**
+ * @brief Initialize I2C bus 1 (SHT4x + DPS368)
+ */
+static esp_err_t i2c_bus1_init(void)
+{
+    /* Configure I2C Bus 1 (GPIO3/4): SHT4x + DPS368 */
+    i2c_master_bus_config_t bus1_config = {
+        .clk_source = I2C_CLK_SRC_DEFAULT,
+        .i2c_port = I2C_NUM_1,
+        .scl_io_num = AERIS_I2C_BUS1_SCL_PIN,
+        .sda_io_num = AERIS_I2C_BUS1_SDA_PIN,
+        .glitch_ignore_cnt = 7,
+        .flags.enable_internal_pullup = true,
+    };
+    
+    esp_err_t err = i2c_new_master_bus(&bus1_config, &i2c_bus1_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "I2C Bus 1 creation failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    ESP_LOGI(TAG, "I2C Bus 1 initialized on SDA=GPIO%d, SCL=GPIO%d", 
+             AERIS_I2C_BUS1_SDA_PIN, AERIS_I2C_BUS1_SCL_PIN);
+    
     /* Add SHT4x device to Bus 1 */
     i2c_device_config_t sht45_cfg = {
         .dev_addr_length = I2C_ADDR_BIT_LEN_7,
@@ -841,25 +1191,10 @@ static esp_err_t i2c_master_init(void)
         ESP_LOGW(TAG, "Failed to add DPS368 device: %s", esp_err_to_name(err));
     }
     
-    /* Probe known I2C addresses on both buses */
-    ESP_LOGI(TAG, "Probing I2C Bus 0 devices (SCD4x + SGP41)...");
-    const struct {
-        uint8_t addr;
-        const char *name;
-    } bus0_devices[] = {
-        {SCD40_I2C_ADDR, "SCD40/SCD41"},
-        {SGP41_I2C_ADDR, "SGP41"},
-    };
-    
-    for (size_t i = 0; i < sizeof(bus0_devices)/sizeof(bus0_devices[0]); i++) {
-        esp_err_t probe_ret = i2c_master_probe(i2c_bus0_handle, bus0_devices[i].addr, pdMS_TO_TICKS(100));
-        if (probe_ret == ESP_OK) {
-            ESP_LOGI(TAG, "  [OK] %s found at 0x%02X", bus0_devices[i].name, bus0_devices[i].addr);
-        } else {
-            ESP_LOGD(TAG, "  [--] %s not found at 0x%02X", bus0_devices[i].name, bus0_devices[i].addr);
-        }
+    /* Probe known I2C addresses (not needed when the cached inventory is verified) */
+    if (sensor_inventory_fast) {
+        return ESP_OK;
     }
-    
     ESP_LOGI(TAG, "Probing I2C Bus 1 devices (SHT4x + DPS368)...");
     const struct {
         uint8_t addr;
@@ -885,63 +1220,195 @@ static esp_err_t i2c_master_init(void)
 }
 
 /**
- * @brief Initialize air quality sensor driver
+ * @brief Bring up bus 0 and its sensors (SGP41 self-test, SCD40 start-up: ~2 s)
  */
-esp_err_t aeris_driver_init(void)
+static void sensor_bus0_init(void)
 {
-    ESP_LOGI(TAG, "Initializing Aeris Air Quality Sensor Driver");
+    esp_err_t ret = i2c_bus0_init();
+    boot_profile_mark(BOOT_MS_I2C_BUS0_INIT);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize I2C bus 0: %s", esp_err_to_name(ret));
+        return;
+    }
     
-    // Initialize I2C bus
-    esp_err_t ret = i2c_master_init();
+    // Initialize SGP41 VOC/NOx sensor
+    ret = sensor_init_one(AERIS_SENSOR_SGP41, sgp41_init);
+    boot_profile_mark(BOOT_MS_SGP41_INIT);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to initialize I2C: %s", esp_err_to_name(ret));
-        // Continue anyway - PM sensor uses UART
-    } else {
-        // Initialize SHT45 temperature/humidity sensor
-        ret = sht45_init();
-        if (ret != ESP_OK) {
-            ESP_LOGW(TAG, "Failed to initialize SHT45: %s", esp_err_to_name(ret));
-            ESP_LOGW(TAG, "Continuing without temperature/humidity sensor");
-        }
-        
-        // Initialize LPS22HB pressure sensor
-        ret = lps22hb_init();
-        if (ret != ESP_OK) {
-            ESP_LOGW(TAG, "Failed to initialize LPS22HB: %s", esp_err_to_name(ret));
-            ESP_LOGW(TAG, "Continuing without pressure sensor");
-        }
-        
-        // Initialize SGP41 VOC/NOx sensor
-        ret = sgp41_init();
-        if (ret != ESP_OK) {
-            ESP_LOGW(TAG, "Failed to initialize SGP41: %s", esp_err_to_name(ret));
-            ESP_LOGW(TAG, "Continuing without VOC/NOx sensor");
-        }
-        
-        // Initialize SCD40 CO2 sensor
-        ret = scd40_init();
-        if (ret != ESP_OK) {
-            ESP_LOGW(TAG, "Failed to initialize SCD40: %s", esp_err_to_name(ret));
-            ESP_LOGW(TAG, "Continuing without CO2 sensor");
-        }
+        ESP_LOGW(TAG, "Failed to initialize SGP41: %s", esp_err_to_name(ret));
+        ESP_LOGW(TAG, "Continuing without VOC/NOx sensor");
+    }
+    
+    // Initialize SCD40 CO2 sensor
+    ret = sensor_init_one(AERIS_SENSOR_SCD40, scd40_init);
+    boot_profile_mark(BOOT_MS_SCD40_INIT);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to initialize SCD40: %s", esp_err_to_name(ret));
+        ESP_LOGW(TAG, "Continuing without CO2 sensor");
+    }
+}
+
+/**
+ * @brief Bring up bus 1 and its sensors
+ */
+static void sensor_bus1_init(void)
+{
+    esp_err_t ret = i2c_bus1_init();
+    boot_profile_mark(BOOT_MS_I2C_BUS1_INIT);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize I2C bus 1: %s", esp_err_to_name(ret));
+        return;
     }
     
-    // Initialize fan control for airflow management
-    ret = fan_init();
+    // Initialize SHT45 temperature/humidity sensor
+    ret = sensor_init_one(AERIS_SENSOR_SHT45, sht45_init);
+    boot_profile_mark(BOOT_MS_SHT45_INIT);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to initialize SHT45: %s", esp_err_to_name(ret));
+        ESP_LOGW(TAG, "Continuing without temperature/humidity sensor");
+    }
+    
+    // Initialize LPS22HB pressure sensor
+    ret = sensor_init_one(AERIS_SENSOR_LPS22HB, lps22hb_init);
+    boot_profile_mark(BOOT_MS_LPS22HB_INIT);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to initialize LPS22HB: %s", esp_err_to_name(ret));
+        ESP_LOGW(TAG, "Continuing without pressure sensor");
+    }
+}
+
+/**
+ * @brief Initialize fan control for airflow management
+ */
+static void driver_fan_init(void)
+{
+    esp_err_t ret = fan_init();
+    boot_profile_mark(BOOT_MS_FAN_INIT);
     if (ret != ESP_OK) {
         ESP_LOGW(TAG, "Failed to initialize fan control: %s", esp_err_to_name(ret));
         ESP_LOGW(TAG, "Continuing without fan control - may affect sensor accuracy");
     } else {
-        // Start fan at low speed for continuous airflow
+        // Start fan at low speed for continuous airflow (the saved mode and full-scale RPM follow)
         fan_set_speed(FAN_MODE_LOW);
         ESP_LOGI(TAG, "Fan control enabled - running at low speed");
     }
+}
+
+/**
+ * @brief Both buses done: close the capture boot section, sensors may be read
+ */
+static void sensor_init_done(void)
+{
+    /* Everything recorded so far is pinned so every capture dump is replayable */
+    i2c_capture_end_boot();
+    
+    sensor_inventory.magic = SENSOR_INVENTORY_MAGIC;
+    ESP_LOGI(TAG, "Sensors initialized in %lld ms", (esp_timer_get_time() - sensor_init_start_us) / 1000);
+    sensors_ready = true;
+    boot_profile_mark(BOOT_MS_SENSORS_READY);
+}
+
+/* Initialize one bus; the last bus to finish completes the initialization */
+static void sensor_bus_init_run(intptr_t bus)
+{
+    if (bus == 0) {
+        sensor_bus0_init();
+    } else {
+        sensor_bus1_init();
+    }
+    
+    portENTER_CRITICAL(&sensor_init_lock);
+    bool last = (--sensor_buses_pending == 0);
+    portEXIT_CRITICAL(&sensor_init_lock);
+    if (last) {
+        sensor_init_done();
+    }
+}
+
+static void sensor_bus_init_task(void *arg)
+{
+    sensor_bus_init_run((intptr_t)arg);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Initialize air quality sensor driver
+ */
+esp_err_t aeris_driver_init(void)
+{
+    ESP_LOGI(TAG, "Initializing Aeris Air Quality Sensor Driver");
+    sensor_init_start_us = esp_timer_get_time();
+    sensor_inventory_load();
+    
+    sensor_bus1_init();
+    sensor_bus0_init();
+    driver_fan_init();
+    sensor_init_done();
     
     ESP_LOGI(TAG, "Aeris driver initialized successfully");
     
     return ESP_OK;
 }
 
+/**
+ * @brief Initialize the fan, then the two I2C buses in the background
+ */
+esp_err_t aeris_driver_init_async(void)
+{
+    if (sensors_ready || sensor_buses_pending != 0) {
+        return ESP_ERR_INVALID_STATE;   // Already initialized or in progress
+    }
+    
+    ESP_LOGI(TAG, "Initializing Aeris Air Quality Sensor Driver (background)");
+    sensor_init_start_us = esp_timer_get_time();
+    sensor_inventory_load();
+    sensor_buses_pending = 2;
+    
+    driver_fan_init();
+    
+    for (intptr_t bus = 0; bus < 2; bus++) {
+        if (xTaskCreate(sensor_bus_init_task, bus ? "i2c1_init" : "i2c0_init", AERIS_INIT_TASK_STACK,
+                        (void *)bus, AERIS_INIT_TASK_PRIORITY, NULL) != pdPASS) {
+            ESP_LOGW(TAG, "Failed to create bus %d init task, initializing inline", (int)bus);
+            sensor_bus_init_run(bus);
+        }
+    }
+    return ESP_OK;
+}
+
+bool aeris_driver_is_ready(void)
+{
+    return sensors_ready;
+}
+
+void aeris_sensor_inventory_dump(void)
+{
+    bool valid = (sensor_inventory.magic == SENSOR_INVENTORY_MAGIC);
+    ESP_LOGI(TAG, "Sensor inventory: %s, %u warm boots since full discovery (max %d)",
+             !valid ? "not recorded" : sensor_inventory_fast ? "verified this boot" : "discovered this boot",
+             sensor_inventory.warm_boots, AERIS_INVENTORY_MAX_WARM_BOOTS);
+    if (!valid) {
+        return;
+    }
+    
+    for (int i = 0; i < AERIS_SENSOR_MAX; i++) {
+        const sensor_inventory_entry_t *entry = &sensor_inventory.sensor[i];
+        if (!entry->valid) {
+            ESP_LOGI(TAG, "  %-8s not detected", sensor_names[i]);
+            continue;
+        }
+        ESP_LOGI(TAG, "  %-8s bus %u addr 0x%02X serial 0x%012llX variant 0x%02X self-test 0x%04X, recorded %u boots ago",
+                 sensor_names[i], sensor_bus_addr[i].bus, entry->addr, entry->serial, entry->variant,
+                 entry->self_test, sensor_inventory.warm_boots - entry->found_at);
+    }
+}
+
+void aeris_sensor_inventory_clear(void)
+{
+    sensor_inventory.magic = 0;
+    ESP_LOGI(TAG, "Sensor inventory cleared, next boot runs full discovery");
+}
+
 /**
  * @brief Get current sensor readings
  */
@@ -972,7 +1439,9 @@ esp_err_t aeris_read_temp_humidity(float *temp_c, float *humidity)
         return ESP_ERR_INVALID_STATE;
     }
     
+    PERF_BEGIN(t0);
     esp_err_t ret = sht45_read_temp_humidity(temp_c, humidity);
+    PERF_END(PERF_READ_TEMP_HUM, t0);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to read SHT45: %s", esp_err_to_name(ret));
         *temp_c = current_state.temperature_c;
@@ -1005,7 +1474,9 @@ esp_err_t aeris_read_pressure(float *pressure_hpa)
     }
     
     float temp_c;
+    PERF_BEGIN(t0);
     esp_err_t ret = lps22hb_read_data(pressure_hpa, &temp_c);
+    PERF_END(PERF_READ_PRESSURE, t0);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to read LPS22HB: %s", esp_err_to_name(ret));
         *pressure_hpa = current_state.pressure_hpa;
@@ -1030,9 +1501,11 @@ esp_err_t aeris_read_voc(uint16_t *voc_index)
     
     // Read raw VOC signal from SGP41
     uint16_t voc_raw, nox_raw;
+    PERF_BEGIN(t0);
     esp_err_t ret = sgp41_measure_raw_signals(&voc_raw, &nox_raw,
                                                current_state.humidity_percent,
                                                current_state.temperature_c);
+    PERF_END(PERF_READ_VOC, t0);
     if (ret != ESP_OK) {
         ESP_LOGW(TAG, "Failed to read SGP41");
         *voc_index = current_state.voc_index;
@@ -1068,6 +1541,8 @@ esp_err_t aeris_read_nox(uint16_t *nox_index)
         return ESP_ERR_INVALID_ARG;
     }
     
+    PERF_BEGIN(t0);
+    
     // NOx data is already read with VOC, use stored value
     uint16_t nox_raw = current_state.nox_raw;
     
@@ -1082,6 +1557,7 @@ esp_err_t aeris_read_nox(uint16_t *nox_index)
     }
     
     current_state.nox_index = *nox_index;
+    PERF_END(PERF_READ_NOX, t0);
     
     ESP_LOGD(TAG, "NOx raw: %d, index: %d", nox_raw, *nox_index);
     return ESP_OK;
@@ -1123,6 +1599,8 @@ esp_err_t aeris_read_co2(uint16_t *co2_ppm)
         return ESP_ERR_INVALID_STATE;
     }
     
+    PERF_BEGIN(t0);
+    
     // Update pressure compensation if LPS22HB is available
     if (lps22hb_initialized && current_state.pressure_hpa > 0) {
         // Convert pressure to hPa (it's already in hPa from our state)
@@ -1132,6 +1610,7 @@ esp_err_t aeris_read_co2(uint16_t *co2_ppm)
     
     float temp_c, humidity_percent;
     esp_err_t ret = scd40_read_measurement(co2_ppm, &temp_c, &humidity_percent);
+    PERF_END(PERF_READ_CO2, t0);
     if (ret == ESP_ERR_NOT_FOUND) {
         // Data not ready yet, return cached value
         *co2_ppm = current_state.co2_ppm;
@@ -1192,3 +1671,54 @@ float aeris_get_humidity_offset(void)
 {
     return humidity_offset_percent;
 }
+
+/**
+ * @brief Get number of failed I2C transactions for a sensor since boot
+ */
+uint32_t aeris_get_i2c_error_count(aeris_sensor_id_t sensor)
+{
+    if (sensor >= AERIS_SENSOR_MAX) {
+        return 0;
+    }
+    return i2c_error_count[sensor];
+}
+
+/**
+ * @brief One identification round trip to a sensor (console benchmark)
+ */
+esp_err_t aeris_ping_sensor(aeris_sensor_id_t sensor)
+{
+    uint8_t rx[9];
+    
+    switch (sensor) {
+    case AERIS_SENSOR_SHT45: {
+        if (!sht45_initialized) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        uint8_t cmd = SHT45_CMD_READ_SERIAL;
+        esp_err_t ret = sensor_i2c_transmit(AERIS_SENSOR_SHT45, &cmd, 1, pdMS_TO_TICKS(1000));
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+        return sensor_i2c_receive(AERIS_SENSOR_SHT45, rx, 6, pdMS_TO_TICKS(1000));
+    }
+    case AERIS_SENSOR_LPS22HB:
+        if (!lps22hb_initialized) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        return lps22hb_read_reg(LPS22HB_WHO_AM_I, rx, 1);
+    case AERIS_SENSOR_SGP41:
+        if (!sgp41_initialized) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        return sgp41_send_command(SGP41_CMD_GET_SERIAL_NUMBER, NULL, 0, rx, 9, 1);
+    case AERIS_SENSOR_SCD40:
+        if (!scd40_initialized) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        return scd40_send_command(SCD40_CMD_GET_DATA_READY_STATUS, rx, 3, SCD40_READ_MEASUREMENT_MS);
+    default:
+        return ESP_ERR_INVALID_ARG;
+    }
+}
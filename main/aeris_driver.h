@@ -30,6 +30,15 @@ typedef struct {
     char error_text[64];       // Error description
 } aeris_sensor_state_t;
 
+/* Sensor identifiers (order matches the per-device I2C instrumentation) */
+typedef enum {
+    AERIS_SENSOR_SHT45 = 0,     // Bus 1: Temperature/Humidity
+    AERIS_SENSOR_LPS22HB,       // Bus 1: Pressure (LPS22HB/DPS368)
+    AERIS_SENSOR_SGP41,         // Bus 0: VOC/NOx
+    AERIS_SENSOR_SCD40,         // Bus 0: CO2
+    AERIS_SENSOR_MAX
+} aeris_sensor_id_t;
+
 /* I2C Bus Configuration - Dual Bus Setup
  * Bus 0 (GPIO14/15): Self-heating sensors - SCD4x + SGP41
  * Bus 1 (GPIO3/4): Environmental sensors - SHT4x + DPS368
@@ -40,6 +49,20 @@ typedef struct {
 #define AERIS_I2C_BUS1_SCL_PIN  4     // GPIO4 - I2C Bus 1 SCL
 #define AERIS_I2C_FREQ_HZ       100000  // 100kHz I2C clock
 
+/* Background sensor init tasks (one per I2C bus) */
+#ifndef AERIS_INIT_TASK_STACK
+#define AERIS_INIT_TASK_STACK       3072
+#endif
+#ifndef AERIS_INIT_TASK_PRIORITY
+#define AERIS_INIT_TASK_PRIORITY    4       // Below the Zigbee task (5)
+#endif
+
+/* Boots after a software reset that verify the cached sensor inventory
+ * instead of re-probing, before a full discovery is forced (0 = always discover) */
+#ifndef AERIS_INVENTORY_MAX_WARM_BOOTS
+#define AERIS_INVENTORY_MAX_WARM_BOOTS  16
+#endif
+
 /* I2C Bus 0 Sensors (GPIO6/7) */
 #define SCD40_I2C_ADDR          0x62  // SCD4x CO2 Sensor - Fixed I2C address
 #define SGP41_I2C_ADDR          0x59  // SGP41 VOC/NOx Sensor - Fixed I2C address
@@ -51,10 +74,39 @@ typedef struct {
 /**
  * @brief Initialize air quality sensor driver
  * 
+ * Blocks for the whole sensor bring-up (~2 s), see aeris_driver_init_async().
+ * 
  * @return ESP_OK on success
  */
 esp_err_t aeris_driver_init(void);
 
+/**
+ * @brief Initialize the fan, then bring up the two I2C buses in parallel background tasks
+ * 
+ * Returns after the fan init. Reads fail with ESP_ERR_INVALID_STATE until
+ * aeris_driver_is_ready().
+ * 
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if already initialized or in progress
+ */
+esp_err_t aeris_driver_init_async(void);
+
+/**
+ * @brief Check whether the background sensor initialization has finished
+ * 
+ * @return true once both buses and their sensors are initialized (or failed)
+ */
+bool aeris_driver_is_ready(void);
+
+/**
+ * @brief Print the cached sensor inventory (addresses, serials, variants, SGP41 self-test)
+ */
+void aeris_sensor_inventory_dump(void);
+
+/**
+ * @brief Drop the cached sensor inventory so the next boot runs full discovery
+ */
+void aeris_sensor_inventory_clear(void);
+
 /**
  * @brief Get current sensor readings
  * 
@@ -147,6 +199,26 @@ void aeris_set_humidity_offset(float offset_percent);
  */
 float aeris_get_humidity_offset(void);
 
+/**
+ * @brief Get number of failed I2C transactions for a sensor since boot
+ * 
+ * @param sensor Sensor identifier
+ * @return Error count (0 for an invalid identifier)
+ */
+uint32_t aeris_get_i2c_error_count(aeris_sensor_id_t sensor);
+
+/**
+ * @brief One identification round trip to a sensor (console benchmark)
+ *
+ * SHT45: serial number, LPS22HB: WHO_AM_I, SGP41: serial number,
+ * SCD40: data-ready status (allowed during periodic measurement).
+ * Must not run concurrently with the acquisition cycle.
+ *
+ * @param sensor Sensor identifier
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if the sensor was not initialized
+ */
+esp_err_t aeris_ping_sensor(aeris_sensor_id_t sensor);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,175 @@
+/*
+ * Configurable attribute table for Aeris Air Quality Sensor
+ *
+ * Single definition of every user setting: where it is stored, its valid
+ * range, the Zigbee attribute that exposes it, its bulk configuration tag
+ * and the Zigbee2MQTT expose. Expanded by zb_attr_registry.c (ZCL setup and
+ * write dispatch) and config_tlv.c (bulk record), and parsed by
+ * tools/gen_converter.py to generate the aeris_lite.js settings exposes.
+ *
+ * X(key, field, type, min, max, check, endpoint, cluster, attr_id, tag, apply, unit, description)
+ *   key          Zigbee2MQTT / bulk configuration name
+ *   field        aeris_settings_t member holding the value
+ *   type         ZCL type of the attribute (ATTR_TYPE_*), the field is 1 or 2 bytes to match
+ *   min, max     Accepted range, anything else is rejected
+ *   check        Extra validation a range can't express (attr_check_*)
+ *   endpoint, cluster, attr_id
+ *                Zigbee attribute (all 0: stored and in the bulk record only). IDs below
+ *                0xF000 are standard attributes created with their cluster.
+ *   tag          Bulk configuration tag (0: not in the record)
+ *   apply        Pushes the value to the drivers (zb_apply_*), a write is refused if it fails
+ *   unit, description
+ *                Zigbee2MQTT numeric expose, "" when aeris_lite.js exposes it by hand
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "fan_control.h"
+
+/* ZCL types used by the table (values as in esp_zb_zcl_attr_type_t) */
+#define ATTR_TYPE_BOOL      0x10
+#define ATTR_TYPE_U8        0x20
+#define ATTR_TYPE_U16       0x21
+#define ATTR_TYPE_S16       0x29
+
+/* Manufacturer-specific attribute IDs, created by zb_attr_registry_add() */
+#define ATTR_ID_CUSTOM_MIN  0xF000
+
+static inline bool attr_check_none(int32_t value)
+{
+    (void)value;
+    return true;
+}
+
+/* PM polling: 0 = continuous, otherwise at least a minute */
+static inline bool attr_check_pm_poll(int32_t value)
+{
+    return value == 0 || value >= 60;
+}
+
+/* Full-scale RPM: 0 = open-loop duty */
+static inline bool attr_check_fan_full_rpm(int32_t value)
+{
+    return value == 0 || value >= FAN_FULL_RPM_MIN;
+}
+
+static inline bool attr_check_fan_mode(int32_t value)
+{
+    return value == FAN_MODE_OFF || value == FAN_MODE_LOW || value == FAN_MODE_MEDIUM ||
+           value == FAN_MODE_HIGH || value == FAN_MODE_AUTO;
+}
+
+#define AERIS_ATTR_TABLE(X) \
+    /* Endpoint 1: calibration and sampling */ \
+    X(temperature_offset, temperature_offset, ATTR_TYPE_S16, -100, 100, attr_check_none, \
+      HA_ESP_TEMP_HUM_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT, ZCL_ATTR_TEMP_OFFSET, 0x10, \
+      zb_apply_offsets, "0.1°C", "Temperature calibration offset (in 0.1°C, e.g., 30 = subtract 3.0°C)") \
+    X(humidity_offset, humidity_offset, ATTR_TYPE_S16, -100, 100, attr_check_none, \
+      HA_ESP_TEMP_HUM_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT, ZCL_ATTR_HUMIDITY_OFFSET, 0x11, \
+      zb_apply_offsets, "0.1%", "Humidity calibration offset (in 0.1%, e.g., 10 = subtract 1.0%)") \
+    X(sensor_refresh_interval, sensor_refresh_interval, ATTR_TYPE_U16, 10, 3600, attr_check_none, \
+      HA_ESP_TEMP_HUM_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT, ZCL_ATTR_REFRESH_INTERVAL, 0x12, \
+      zb_apply_none, "s", "Sensor refresh interval in seconds (10-3600, default 30)") \
+    X(pm_poll_interval, pm_poll_interval, ATTR_TYPE_U16, 0, 3600, attr_check_pm_poll, \
+      0, 0, 0, 0x13, \
+      zb_apply_none, "", "") \
+    /* Endpoint 6: sensor LEDs */ \
+    X(sensor_leds, sensor_leds_enabled, ATTR_TYPE_BOOL, 0, 1, attr_check_none, \
+      HA_ESP_LED_CONFIG_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_ON_OFF, ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID, 0x01, \
+      zb_apply_leds, "", "") \
+    X(led_brightness, led_brightness, ATTR_TYPE_U8, 1, 255, attr_check_none, \
+      HA_ESP_LED_CONFIG_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_LEVEL_CONTROL, ESP_ZB_ZCL_ATTR_LEVEL_CONTROL_CURRENT_LEVEL_ID, 0x03, \
+      zb_apply_brightness, "", "") \
+    X(led_brightness_level, led_brightness, ATTR_TYPE_U8, 1, 255, attr_check_none, \
+      HA_ESP_LED_CONFIG_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_OUTPUT, ZCL_LED_ATTR_BRIGHTNESS, 0, \
+      zb_apply_brightness, "", "") \
+    X(led_mask, led_mask, ATTR_TYPE_U8, 0, 0x1F, attr_check_none, \
+      HA_ESP_LED_CONFIG_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_OUTPUT, ZCL_LED_ATTR_ENABLE_MASK, 0x04, \
+      zb_apply_leds, "", "") \
+    X(led_gradient, led_gradient, ATTR_TYPE_U8, 0, 1, attr_check_none, \
+      HA_ESP_LED_CONFIG_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_OUTPUT, ZCL_LED_ATTR_DISPLAY_MODE, 0x05, \
+      zb_apply_leds, "", "") \
+    X(voc_orange_threshold, led_thresholds.voc_orange, ATTR_TYPE_U16, 0, 500, attr_check_none, \
+      HA_ESP_LED_CONFIG_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_OUTPUT, ZCL_LED_ATTR_VOC_ORANGE, 0x20, \
+      zb_apply_leds, "", "VOC Index orange (warning) threshold") \
+    X(voc_red_threshold, led_thresholds.voc_red, ATTR_TYPE_U16, 0, 500, attr_check_none, \
+      HA_ESP_LED_CONFIG_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_OUTPUT, ZCL_LED_ATTR_VOC_RED, 0x21, \
+      zb_apply_leds, "", "VOC Index red (danger) threshold") \
+    X(nox_orange_threshold, led_thresholds.nox_orange, ATTR_TYPE_U16, 0, 500, attr_check_none, \
+      HA_ESP_LED_CONFIG_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_OUTPUT, ZCL_LED_ATTR_NOX_ORANGE, 0x22, \
+      zb_apply_leds, "", "NOx Index orange (warning) threshold") \
+    X(nox_red_threshold, led_thresholds.nox_red, ATTR_TYPE_U16, 0, 500, attr_check_none, \
+      HA_ESP_LED_CONFIG_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_OUTPUT, ZCL_LED_ATTR_NOX_RED, 0x23, \
+      zb_apply_leds, "", "NOx Index red (danger) threshold") \
+    X(co2_orange_threshold, led_thresholds.co2_orange, ATTR_TYPE_U16, 400, 5000, attr_check_none, \
+      HA_ESP_LED_CONFIG_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_OUTPUT, ZCL_LED_ATTR_CO2_ORANGE, 0x24, \
+      zb_apply_leds, "ppm", "CO2 orange (warning) threshold") \
+    X(co2_red_threshold, led_thresholds.co2_red, ATTR_TYPE_U16, 400, 5000, attr_check_none, \
+      HA_ESP_LED_CONFIG_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_OUTPUT, ZCL_LED_ATTR_CO2_RED, 0x25, \
+      zb_apply_leds, "ppm", "CO2 red (danger) threshold") \
+    X(humidity_orange_low_threshold, led_thresholds.humidity_orange_low, ATTR_TYPE_U16, 0, 100, attr_check_none, \
+      HA_ESP_LED_CONFIG_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_OUTPUT, ZCL_LED_ATTR_HUM_ORANGE_LOW, 0x26, \
+      zb_apply_leds, "%", "Humidity too dry - orange threshold") \
+    X(humidity_orange_high_threshold, led_thresholds.humidity_orange_high, ATTR_TYPE_U16, 0, 100, attr_check_none, \
+      HA_ESP_LED_CONFIG_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_OUTPUT, ZCL_LED_ATTR_HUM_ORANGE_HIGH, 0x27, \
+      zb_apply_leds, "%", "Humidity too humid - orange threshold") \
+    X(humidity_red_low_threshold, led_thresholds.humidity_red_low, ATTR_TYPE_U16, 0, 100, attr_check_none, \
+      HA_ESP_LED_CONFIG_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_OUTPUT, ZCL_LED_ATTR_HUM_RED_LOW, 0x28, \
+      zb_apply_leds, "%", "Humidity too dry - red threshold") \
+    X(humidity_red_high_threshold, led_thresholds.humidity_red_high, ATTR_TYPE_U16, 0, 100, attr_check_none, \
+      HA_ESP_LED_CONFIG_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_OUTPUT, ZCL_LED_ATTR_HUM_RED_HIGH, 0x29, \
+      zb_apply_leds, "%", "Humidity too humid - red threshold") \
+    /* Endpoint 7: status LED */ \
+    X(status_led, status_led_enabled, ATTR_TYPE_BOOL, 0, 1, attr_check_none, \
+      HA_ESP_STATUS_LED_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_ON_OFF, ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID, 0x02, \
+      zb_apply_status_led, "", "") \
+    /* Endpoint 8: fan (the ZCL fan mode enum is translated by hand, see fan_mode_from_zcl) */ \
+    X(fan_mode, fan_mode, ATTR_TYPE_U8, 0, 255, attr_check_fan_mode, \
+      0, 0, 0, 0x30, \
+      zb_apply_fan_mode, "", "") \
+    X(fan_idle, fan_curve.idle_percent, ATTR_TYPE_U8, 0, 100, attr_check_none, \
+      HA_ESP_FAN_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_FAN_CONTROL, ZCL_FAN_ATTR_IDLE_PERCENT, 0x31, \
+      zb_apply_fan_curve, "%", "Auto mode speed in clean air (0 = off)") \
+    X(fan_hysteresis, fan_curve.hysteresis_percent, ATTR_TYPE_U8, 0, 50, attr_check_none, \
+      HA_ESP_FAN_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_FAN_CONTROL, ZCL_FAN_ATTR_HYSTERESIS, 0x32, \
+      zb_apply_fan_curve, "%", "Demand drop before the fan slows down") \
+    X(fan_ramp_down, fan_curve.ramp_down_percent_min, ATTR_TYPE_U8, 0, 100, attr_check_none, \
+      HA_ESP_FAN_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_FAN_CONTROL, ZCL_FAN_ATTR_RAMP_DOWN, 0x33, \
+      zb_apply_fan_curve, "%/min", "Auto mode slow-down rate (0 = immediate)") \
+    X(fan_temp_start, fan_curve.temp_start_c, ATTR_TYPE_U16, 0, 60, attr_check_none, \
+      HA_ESP_FAN_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_FAN_CONTROL, ZCL_FAN_ATTR_TEMP_START, 0x34, \
+      zb_apply_fan_curve, "°C", "Temperature where the fan starts ramping up") \
+    X(fan_temp_full, fan_curve.temp_full_c, ATTR_TYPE_U16, 0, 60, attr_check_none, \
+      HA_ESP_FAN_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_FAN_CONTROL, ZCL_FAN_ATTR_TEMP_FULL, 0x35, \
+      zb_apply_fan_curve, "°C", "Temperature for full speed") \
+    X(fan_voc_start, fan_curve.voc_start, ATTR_TYPE_U16, 0, 500, attr_check_none, \
+      HA_ESP_FAN_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_FAN_CONTROL, ZCL_FAN_ATTR_VOC_START, 0x36, \
+      zb_apply_fan_curve, "", "VOC index where the fan starts ramping up") \
+    X(fan_voc_full, fan_curve.voc_full, ATTR_TYPE_U16, 0, 500, attr_check_none, \
+      HA_ESP_FAN_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_FAN_CONTROL, ZCL_FAN_ATTR_VOC_FULL, 0x37, \
+      zb_apply_fan_curve, "", "VOC index for full speed") \
+    X(fan_co2_start, fan_curve.co2_start_ppm, ATTR_TYPE_U16, 0, 5000, attr_check_none, \
+      HA_ESP_FAN_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_FAN_CONTROL, ZCL_FAN_ATTR_CO2_START, 0x38, \
+      zb_apply_fan_curve, "ppm", "CO2 where the fan starts ramping up") \
+    X(fan_co2_full, fan_curve.co2_full_ppm, ATTR_TYPE_U16, 0, 5000, attr_check_none, \
+      HA_ESP_FAN_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_FAN_CONTROL, ZCL_FAN_ATTR_CO2_FULL, 0x39, \
+      zb_apply_fan_curve, "ppm", "CO2 for full speed") \
+    X(fan_humidity_start, fan_curve.humidity_start, ATTR_TYPE_U16, 0, 100, attr_check_none, \
+      HA_ESP_FAN_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_FAN_CONTROL, ZCL_FAN_ATTR_HUM_START, 0x3A, \
+      zb_apply_fan_curve, "%", "Humidity where the fan starts ramping up") \
+    X(fan_humidity_full, fan_curve.humidity_full, ATTR_TYPE_U16, 0, 100, attr_check_none, \
+      HA_ESP_FAN_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_FAN_CONTROL, ZCL_FAN_ATTR_HUM_FULL, 0x3B, \
+      zb_apply_fan_curve, "%", "Humidity for full speed") \
+    X(fan_purge_time, fan_purge.purge_s, ATTR_TYPE_U16, 0, 600, attr_check_none, \
+      HA_ESP_FAN_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_FAN_CONTROL, ZCL_FAN_ATTR_PURGE_TIME, 0x3C, \
+      zb_apply_none, "s", "Fan boost before each sample so the sensors read room air (0 = off)") \
+    X(fan_purge_speed, fan_purge.purge_percent, ATTR_TYPE_U8, 0, 100, attr_check_none, \
+      HA_ESP_FAN_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_FAN_CONTROL, ZCL_FAN_ATTR_PURGE_SPEED, 0x3D, \
+      zb_apply_none, "%", "Fan speed during the purge") \
+    X(fan_measure_speed, fan_purge.measure_percent, ATTR_TYPE_U8, 0, 100, attr_check_none, \
+      HA_ESP_FAN_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_FAN_CONTROL, ZCL_FAN_ATTR_MEASURE_SPEED, 0x3E, \
+      zb_apply_none, "%", "Fan speed during the 5 s before and while the sensors are read") \
+    X(fan_full_rpm, fan_full_rpm, ATTR_TYPE_U16, 0, 10000, attr_check_fan_full_rpm, \
+      HA_ESP_FAN_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_FAN_CONTROL, ZCL_FAN_ATTR_FULL_RPM, 0x3F, \
+      zb_apply_fan_full_rpm, "RPM", "Fan RPM at 100%: speeds become RPM targets held from the tachometer (0 = open-loop duty)")
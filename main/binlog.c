@@ -0,0 +1,164 @@
+/*
+ * Binary deferred logging implementation for Aeris_Lite
+ *
+ * Multi-producer / single-consumer ring protected by a spinlock so
+ * records can be written from tasks and ISRs. The drain task is the only
+ * consumer and prints each record as a hex line on the console.
+ */
+
+#include "binlog.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+
+static const char *TAG = "BINLOG";
+
+/* Module state */
+static binlog_record_t s_ring[BINLOG_RING_RECORDS];
+static uint32_t s_head = 0;                 /* Next slot to write */
+static uint32_t s_tail = 0;                 /* Next slot to drain */
+static uint16_t s_seq = 0;
+static uint32_t s_dropped = 0;
+static volatile esp_log_level_t s_level = BINLOG_DEFAULT_LEVEL;
+static portMUX_TYPE s_ring_lock = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t s_drain_task = NULL;
+
+void binlog_write(esp_log_level_t level, const char *tag, const char *fmt, uint32_t nargs, ...)
+{
+    if (level > s_level || level == ESP_LOG_NONE) {
+        return;
+    }
+    if (nargs > BINLOG_MAX_ARGS) {
+        nargs = BINLOG_MAX_ARGS;
+    }
+
+    binlog_record_t rec = {
+        .fmt = fmt,
+        .tag = tag,
+        .timestamp_ms = (uint32_t)(esp_timer_get_time() / 1000),
+        .level = (uint8_t)level,
+        .nargs = (uint8_t)nargs,
+    };
+
+    va_list ap;
+    va_start(ap, nargs);
+    for (uint32_t i = 0; i < nargs; i++) {
+        rec.args[i] = va_arg(ap, uint32_t);
+    }
+    va_end(ap);
+
+    portENTER_CRITICAL_SAFE(&s_ring_lock);
+    rec.seq = s_seq++;
+    if (s_head - s_tail >= BINLOG_RING_RECORDS) {
+        s_dropped++;
+    } else {
+        s_ring[s_head % BINLOG_RING_RECORDS] = rec;
+        s_head++;
+    }
+    portEXIT_CRITICAL_SAFE(&s_ring_lock);
+}
+
+/**
+ * @brief Pop one record from the ring
+ * @return true if a record was copied to @p out
+ */
+static bool binlog_pop(binlog_record_t *out, uint32_t *dropped)
+{
+    bool have = false;
+
+    portENTER_CRITICAL(&s_ring_lock);
+    if (s_tail != s_head) {
+        *out = s_ring[s_tail % BINLOG_RING_RECORDS];
+        s_tail++;
+        have = true;
+    }
+    *dropped = s_dropped;
+    portEXIT_CRITICAL(&s_ring_lock);
+
+    return have;
+}
+
+/**
+ * @brief Drain task - prints records as "#BL <hex>" lines
+ */
+static void binlog_drain_task(void *arg)
+{
+    static const char hex[] = "0123456789abcdef";
+    char line[4 + 2 * sizeof(binlog_record_t) + 1];
+    uint32_t reported_dropped = 0;
+
+    memcpy(line, "#BL ", 4);
+
+    while (1) {
+        binlog_record_t rec;
+        uint32_t dropped = 0;
+        int count = 0;
+
+        while (count < BINLOG_DRAIN_BATCH && binlog_pop(&rec, &dropped)) {
+            const uint8_t *bytes = (const uint8_t *)&rec;
+            char *p = &line[4];
+            for (size_t i = 0; i < sizeof(rec); i++) {
+                *p++ = hex[bytes[i] >> 4];
+                *p++ = hex[bytes[i] & 0x0F];
+            }
+            *p = '\0';
+            puts(line);
+            count++;
+        }
+
+        if (dropped != reported_dropped) {
+            printf("#BL-DROP %lu\n", (unsigned long)(dropped - reported_dropped));
+            reported_dropped = dropped;
+        }
+
+        if (count == BINLOG_DRAIN_BATCH) {
+            taskYIELD();    /* More pending - let equal-priority work run, then continue */
+        } else {
+            fflush(stdout);
+            vTaskDelay(pdMS_TO_TICKS(BINLOG_DRAIN_PERIOD_MS));
+        }
+    }
+}
+
+esp_err_t binlog_init(void)
+{
+    if (s_drain_task) {
+        return ESP_OK;
+    }
+
+    BaseType_t ok = xTaskCreate(binlog_drain_task, "binlog", BINLOG_TASK_STACK, NULL,
+                                BINLOG_TASK_PRIORITY, &s_drain_task);
+    if (ok != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create drain task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Binary log initialized (%d records, level %d) - decode with tools/binlog_decode.py",
+             BINLOG_RING_RECORDS, s_level);
+    return ESP_OK;
+}
+
+esp_err_t binlog_set_level(esp_log_level_t level)
+{
+    if (level > ESP_LOG_VERBOSE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    s_level = level;
+    esp_log_level_set("*", level);
+    ESP_LOGW(TAG, "Log level set to %d", level);
+    return ESP_OK;
+}
+
+esp_log_level_t binlog_get_level(void)
+{
+    return s_level;
+}
+
+uint32_t binlog_get_dropped(void)
+{
+    return s_dropped;
+}
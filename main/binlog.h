@@ -0,0 +1,114 @@
+/*
+ * Binary deferred logging for Aeris_Lite
+ *
+ * Hot-path call sites push a fixed-size record (format string address, tag
+ * address, timestamp, up to 4 raw 32-bit arguments) into a RAM ring buffer
+ * instead of formatting text. A low-priority task drains the ring to the
+ * console as "#BL <hex>" lines which tools/binlog_decode.py turns back into
+ * text using the firmware ELF (format strings never leave flash).
+ *
+ * Arguments must be 32-bit integers or pointers to string literals
+ * (resolved from the ELF by the decoder). Pass floats as scaled integers.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_log.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Set to 0 to route BINLOGx() to the regular ESP_LOGx() text backend */
+#ifndef AERIS_BINLOG_ENABLE
+#define AERIS_BINLOG_ENABLE         1
+#endif
+
+#define BINLOG_RING_RECORDS         128     /* Ring capacity (32 bytes per record) */
+#define BINLOG_DRAIN_PERIOD_MS      200     /* Drain task wake-up period */
+#define BINLOG_DRAIN_BATCH          16      /* Records printed per wake-up before yielding */
+#define BINLOG_TASK_STACK           2560
+#define BINLOG_TASK_PRIORITY        1       /* Just above idle */
+#define BINLOG_MAX_ARGS             4
+
+/* Default runtime verbosity (esp_log_level_t) */
+#ifndef BINLOG_DEFAULT_LEVEL
+#define BINLOG_DEFAULT_LEVEL        ESP_LOG_INFO
+#endif
+
+/* Record layout - must match RECORD_FORMAT in tools/binlog_decode.py */
+typedef struct {
+    const char *fmt;                /* Log ID: address of the format string in flash */
+    const char *tag;                /* Address of the module TAG string */
+    uint32_t timestamp_ms;          /* esp_log_timestamp() at the call site */
+    uint8_t level;                  /* esp_log_level_t */
+    uint8_t nargs;                  /* Number of valid entries in args[] */
+    uint16_t seq;                   /* Sequence number (gaps = dropped records) */
+    uint32_t args[BINLOG_MAX_ARGS];
+} binlog_record_t;
+
+/**
+ * @brief Initialize ring buffer and start the drain task
+ * @return ESP_OK on success
+ */
+esp_err_t binlog_init(void);
+
+/**
+ * @brief Append a record to the ring buffer (task or ISR context)
+ *
+ * Never blocks; when the ring is full the record is dropped and counted.
+ *
+ * @param level Log level of the record
+ * @param tag   Module tag (string literal)
+ * @param fmt   printf-style format string (string literal)
+ * @param nargs Number of 32-bit variadic arguments (0-4)
+ */
+void binlog_write(esp_log_level_t level, const char *tag, const char *fmt, uint32_t nargs, ...);
+
+/**
+ * @brief Set runtime verbosity for binary and text logging
+ *
+ * Also applies the level to all ESP_LOG tags via esp_log_level_set("*").
+ * Levels above CONFIG_LOG_MAXIMUM_LEVEL are still filtered at compile time
+ * for text logs.
+ *
+ * @param level esp_log_level_t value (0=none .. 5=verbose)
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if level is out of range
+ */
+esp_err_t binlog_set_level(esp_log_level_t level);
+
+/**
+ * @brief Get current runtime verbosity
+ */
+esp_log_level_t binlog_get_level(void);
+
+/**
+ * @brief Get number of records dropped because the ring was full
+ */
+uint32_t binlog_get_dropped(void);
+
+/* Argument counting (0-4) for the BINLOGx() macros */
+#define BINLOG_NARGS_(_0, _1, _2, _3, _4, N, ...) N
+#define BINLOG_NARGS(...) BINLOG_NARGS_(0, ##__VA_ARGS__, 4, 3, 2, 1, 0)
+
+#if AERIS_BINLOG_ENABLE
+#define BINLOG_LEVEL(level, tag, fmt, ...) \
+    binlog_write(level, tag, fmt, BINLOG_NARGS(__VA_ARGS__), ##__VA_ARGS__)
+#define BINLOGE(tag, fmt, ...) BINLOG_LEVEL(ESP_LOG_ERROR,   tag, fmt, ##__VA_ARGS__)
+#define BINLOGW(tag, fmt, ...) BINLOG_LEVEL(ESP_LOG_WARN,    tag, fmt, ##__VA_ARGS__)
+#define BINLOGI(tag, fmt, ...) BINLOG_LEVEL(ESP_LOG_INFO,    tag, fmt, ##__VA_ARGS__)
+#define BINLOGD(tag, fmt, ...) BINLOG_LEVEL(ESP_LOG_DEBUG,   tag, fmt, ##__VA_ARGS__)
+#define BINLOGV(tag, fmt, ...) BINLOG_LEVEL(ESP_LOG_VERBOSE, tag, fmt, ##__VA_ARGS__)
+#else
+#define BINLOGE(tag, fmt, ...) ESP_LOGE(tag, fmt, ##__VA_ARGS__)
+#define BINLOGW(tag, fmt, ...) ESP_LOGW(tag, fmt, ##__VA_ARGS__)
+#define BINLOGI(tag, fmt, ...) ESP_LOGI(tag, fmt, ##__VA_ARGS__)
+#define BINLOGD(tag, fmt, ...) ESP_LOGD(tag, fmt, ##__VA_ARGS__)
+#define BINLOGV(tag, fmt, ...) ESP_LOGV(tag, fmt, ##__VA_ARGS__)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,144 @@
+/*
+ * Boot milestone profiler implementation for Aeris_Lite
+ */
+
+#include "boot_profile.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_attr.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+static const char *TAG = "BOOT_PROF";
+
+#define BOOT_PROFILE_MAGIC          0xB0071E5Au
+
+_Static_assert(BOOT_MS_MAX <= 16, "Reached masks are 16 bits");
+
+static const char *const MILESTONE_NAMES[BOOT_MS_MAX] = {
+    [BOOT_MS_APP_MAIN] = "app_main",
+    [BOOT_MS_SETTINGS_INIT] = "settings_init",
+    [BOOT_MS_PLATFORM_CONFIG] = "platform_config",
+    [BOOT_MS_ZB_START] = "esp_zb_start",
+    [BOOT_MS_STACK_READY] = "stack_ready",
+    [BOOT_MS_LED_INIT] = "led_init",
+    [BOOT_MS_FAN_INIT] = "fan_init",
+    [BOOT_MS_I2C_BUS0_INIT] = "i2c_bus0_init",
+    [BOOT_MS_SGP41_INIT] = "sgp41_init",
+    [BOOT_MS_SCD40_INIT] = "scd40_init",
+    [BOOT_MS_I2C_BUS1_INIT] = "i2c_bus1_init",
+    [BOOT_MS_SHT45_INIT] = "sht45_init",
+    [BOOT_MS_LPS22HB_INIT] = "lps22hb_init",
+    [BOOT_MS_SENSORS_READY] = "sensors_ready",
+    [BOOT_MS_NETWORK] = "network",
+    [BOOT_MS_FIRST_REPORT] = "first_report",
+};
+
+/* Survives software resets; random after power-on, rejected by the magic */
+typedef struct {
+    uint32_t magic;
+    uint16_t boot_count;            /* Boots since power-on */
+    uint16_t reached;               /* Milestones reached by this boot so far */
+    uint32_t ms[BOOT_MS_MAX];
+} boot_profile_rtc_t;
+
+static RTC_NOINIT_ATTR boot_profile_rtc_t s_rtc;
+static uint16_t s_prev_reached = 0;
+static uint8_t s_reset_reason = 0;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+void boot_profile_init(void)
+{
+    if (s_rtc.magic == BOOT_PROFILE_MAGIC) {
+        s_prev_reached = s_rtc.reached;
+        s_rtc.boot_count++;
+    } else {
+        s_prev_reached = 0;
+        s_rtc.magic = BOOT_PROFILE_MAGIC;
+        s_rtc.boot_count = 1;
+    }
+    s_rtc.reached = 0;
+    for (int i = 0; i < BOOT_MS_MAX; i++) {
+        s_rtc.ms[i] = BOOT_PROFILE_NOT_REACHED;
+    }
+    s_reset_reason = (uint8_t)esp_reset_reason();
+
+    boot_profile_mark(BOOT_MS_APP_MAIN);
+}
+
+void boot_profile_mark(boot_milestone_t milestone)
+{
+    if (milestone >= BOOT_MS_MAX) {
+        return;
+    }
+    uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    bool first = false;
+
+    portENTER_CRITICAL(&s_lock);
+    if (!(s_rtc.reached & (1u << milestone))) {
+        s_rtc.ms[milestone] = now_ms;
+        s_rtc.reached |= (uint16_t)(1u << milestone);
+        first = true;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (first) {
+        ESP_LOGD(TAG, "%s at %lu ms", MILESTONE_NAMES[milestone], now_ms);
+        if (milestone == BOOT_MS_FIRST_REPORT) {
+            boot_profile_dump();
+        }
+    }
+}
+
+uint32_t boot_profile_get(boot_milestone_t milestone)
+{
+    return (milestone < BOOT_MS_MAX) ? s_rtc.ms[milestone] : BOOT_PROFILE_NOT_REACHED;
+}
+
+void boot_profile_dump(void)
+{
+    ESP_LOGI(TAG, "Boot %u since power-on, reset reason %u, previous boot reached 0x%04x",
+             s_rtc.boot_count, s_reset_reason, s_prev_reached);
+    for (int i = 0; i < BOOT_MS_MAX; i++) {
+        if (s_rtc.ms[i] == BOOT_PROFILE_NOT_REACHED) {
+            ESP_LOGI(TAG, "  %-16s      -", MILESTONE_NAMES[i]);
+        } else {
+            ESP_LOGI(TAG, "  %-16s %6lu ms", MILESTONE_NAMES[i], s_rtc.ms[i]);
+        }
+    }
+}
+
+static size_t put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+    return 2;
+}
+
+static size_t put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = v >> 24;
+    return 4;
+}
+
+size_t boot_profile_encode(uint8_t *buf, size_t buf_size)
+{
+    if (!buf || buf_size < BOOT_PROFILE_ENCODED_LEN) {
+        return 0;
+    }
+
+    size_t len = 1;
+    buf[len++] = BOOT_PROFILE_VERSION;
+    buf[len++] = s_reset_reason;
+    len += put_u16(&buf[len], s_rtc.boot_count);
+    len += put_u16(&buf[len], s_prev_reached);
+    for (int i = 0; i < BOOT_MS_MAX; i++) {
+        len += put_u32(&buf[len], s_rtc.ms[i]);
+    }
+
+    buf[0] = (uint8_t)(len - 1);
+    return len;
+}
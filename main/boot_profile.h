@@ -0,0 +1,89 @@
+/*
+ * Boot milestone profiler for Aeris_Lite
+ *
+ * Timestamps the boot path (app_main to the first published sample) in RTC
+ * memory that survives software resets, so a boot that never completes is
+ * still visible from the next one. The record is exposed over Zigbee
+ * (Diagnostics cluster 0xF10A), logged once the first sample is published
+ * and printed by the "boot" console command.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Boot milestones, in boot path order (bit n of the reached masks) */
+typedef enum {
+    BOOT_MS_APP_MAIN = 0,           /* app_main() entered */
+    BOOT_MS_SETTINGS_INIT,          /* settings_init() done */
+    BOOT_MS_PLATFORM_CONFIG,        /* esp_zb_platform_config() done */
+    BOOT_MS_ZB_START,               /* Endpoints registered, esp_zb_start() called */
+    BOOT_MS_STACK_READY,            /* Device first start / reboot signal */
+    BOOT_MS_LED_INIT,               /* led_indicator_init() done */
+    BOOT_MS_FAN_INIT,               /* Fan control started */
+    BOOT_MS_I2C_BUS0_INIT,          /* Bus 0 created and probed */
+    BOOT_MS_SGP41_INIT,
+    BOOT_MS_SCD40_INIT,
+    BOOT_MS_I2C_BUS1_INIT,          /* Bus 1 created and probed */
+    BOOT_MS_SHT45_INIT,
+    BOOT_MS_LPS22HB_INIT,
+    BOOT_MS_SENSORS_READY,          /* Both buses done */
+    BOOT_MS_NETWORK,                /* Steering succeeded, or rebooted into the saved network */
+    BOOT_MS_FIRST_REPORT,           /* First sample set on the reportable attributes */
+    BOOT_MS_MAX
+} boot_milestone_t;
+
+#define BOOT_PROFILE_VERSION        1
+#define BOOT_PROFILE_NOT_REACHED    UINT32_MAX
+
+/* [len] version(1) reset_reason(1) boot_count(2) prev_mask(2) then ms(4) per milestone */
+#define BOOT_PROFILE_ENCODED_LEN    (1 + 6 + BOOT_MS_MAX * 4)
+
+/**
+ * @brief Start the record of this boot, first call in app_main()
+ *
+ * Keeps the reached mask of the previous boot when RTC memory survived the
+ * reset (software reset, panic, watchdog, OTA reboot), then marks
+ * BOOT_MS_APP_MAIN.
+ */
+void boot_profile_init(void);
+
+/**
+ * @brief Timestamp a milestone (first call only, any task)
+ */
+void boot_profile_mark(boot_milestone_t milestone);
+
+/**
+ * @brief Milliseconds since boot at a milestone
+ * @return BOOT_PROFILE_NOT_REACHED if the milestone was not reached yet
+ */
+uint32_t boot_profile_get(boot_milestone_t milestone);
+
+/**
+ * @brief Print the milestones of this boot to the log
+ */
+void boot_profile_dump(void);
+
+/**
+ * @brief Encode the record as a ZCL octet string
+ *
+ * Layout (little-endian): [len] version reset_reason (esp_reset_reason_t)
+ * boot_count (boots since power-on) prev_mask (milestones reached by the
+ * previous boot, 0 after power-on) then per milestone the milliseconds since
+ * boot, 0xFFFFFFFF if not reached.
+ *
+ * @param buf Output buffer (first byte receives the length)
+ * @param buf_size Size of @p buf
+ * @return Total bytes written including the length byte, 0 if @p buf is too small
+ */
+size_t boot_profile_encode(uint8_t *buf, size_t buf_size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,151 @@
+/*
+ * Bulk configuration encoding for Aeris Air Quality Sensor
+ */
+#include "config_tlv.h"
+#include "attr_table.h"
+#include "esp_log.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+static const char *TAG = "CONFIG_TLV";
+
+/* One setting: where it lives in aeris_settings_t and its valid range */
+typedef struct {
+    uint8_t tag;
+    uint8_t size;               // 1 or 2 bytes
+    uint16_t offset;            // offsetof(aeris_settings_t, ...)
+    int32_t min;                // min < 0: signed field
+    int32_t max;
+    bool (*check)(int32_t value);
+} config_field_t;
+
+/* Table rows with a tag (the record order is the table order) */
+#define CONFIG_FIELD(key, field, type, min, max, check, endpoint, cluster, attr_id, tag, apply, unit, desc) \
+    { tag, sizeof(((aeris_settings_t *)0)->field), offsetof(aeris_settings_t, field), min, max, check },
+
+static const config_field_t FIELDS[] = {
+    AERIS_ATTR_TABLE(CONFIG_FIELD)
+};
+
+#define FIELD_COUNT     (sizeof(FIELDS) / sizeof(FIELDS[0]))
+
+static const config_field_t *config_field_find(uint8_t tag)
+{
+    if (tag == 0) {
+        return NULL;
+    }
+    for (size_t i = 0; i < FIELD_COUNT; i++) {
+        if (FIELDS[i].tag == tag) {
+            return &FIELDS[i];
+        }
+    }
+    return NULL;
+}
+
+static int32_t config_field_get(const config_field_t *f, const aeris_settings_t *settings)
+{
+    const uint8_t *p = (const uint8_t *)settings + f->offset;
+    if (f->size == 1) {
+        return *p;
+    }
+    uint16_t v;
+    memcpy(&v, p, sizeof(v));
+    return (f->min < 0) ? (int32_t)(int16_t)v : (int32_t)v;
+}
+
+static void config_field_set(const config_field_t *f, aeris_settings_t *settings, int32_t value)
+{
+    uint8_t *p = (uint8_t *)settings + f->offset;
+    if (f->size == 1) {
+        *p = (uint8_t)value;
+    } else {
+        uint16_t v = (uint16_t)value;
+        memcpy(p, &v, sizeof(v));
+    }
+}
+
+size_t config_tlv_encode(const aeris_settings_t *settings, uint8_t *buf, size_t buf_size)
+{
+    size_t len = 1;
+
+    if (!settings || !buf || buf_size < 2) {
+        return 0;
+    }
+
+    buf[len++] = CONFIG_TLV_VERSION;
+    for (size_t i = 0; i < FIELD_COUNT; i++) {
+        const config_field_t *f = &FIELDS[i];
+        if (f->tag == 0) {
+            continue;
+        }
+        if (len + 2 + f->size > buf_size || len - 1 + 2 + f->size > CONFIG_TLV_MAX_SIZE) {
+            return 0;
+        }
+        uint16_t v = (uint16_t)config_field_get(f, settings);
+        buf[len++] = f->tag;
+        buf[len++] = f->size;
+        buf[len++] = (uint8_t)v;
+        if (f->size == 2) {
+            buf[len++] = (uint8_t)(v >> 8);
+        }
+    }
+
+    buf[0] = (uint8_t)(len - 1);
+    return len;
+}
+
+esp_err_t config_tlv_decode(const uint8_t *data, size_t len, aeris_settings_t *settings)
+{
+    if (!data || !settings) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (len < 1) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (data[0] != CONFIG_TLV_VERSION) {
+        ESP_LOGW(TAG, "Unsupported config version %d", data[0]);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    aeris_settings_t result = *settings;
+    size_t pos = 1;
+    int applied = 0;
+
+    while (pos < len) {
+        if (len - pos < 2 || len - pos - 2 < data[pos + 1]) {
+            ESP_LOGW(TAG, "Truncated config record at offset %u", (unsigned)pos);
+            return ESP_ERR_INVALID_SIZE;
+        }
+        uint8_t tag = data[pos];
+        uint8_t size = data[pos + 1];
+        const uint8_t *value = &data[pos + 2];
+        pos += 2 + size;
+
+        const config_field_t *f = config_field_find(tag);
+        if (f == NULL) {
+            ESP_LOGD(TAG, "Skipping unknown tag 0x%02X", tag);
+            continue;
+        }
+        if (size != f->size) {
+            ESP_LOGW(TAG, "Tag 0x%02X: length %d, expected %d", tag, size, f->size);
+            return ESP_ERR_INVALID_SIZE;
+        }
+
+        int32_t v = value[0];
+        if (size == 2) {
+            uint16_t u = (uint16_t)(value[0] | (value[1] << 8));
+            v = (f->min < 0) ? (int32_t)(int16_t)u : (int32_t)u;
+        }
+        if (v < f->min || v > f->max || !f->check(v)) {
+            ESP_LOGW(TAG, "Tag 0x%02X: value %ld out of range", tag, (long)v);
+            return ESP_ERR_INVALID_ARG;
+        }
+        config_field_set(f, &result, v);
+        applied++;
+    }
+
+    *settings = result;
+    ESP_LOGI(TAG, "Config record decoded: %d settings", applied);
+    return ESP_OK;
+}
@@ -0,0 +1,52 @@
+/*
+ * Bulk configuration encoding for Aeris Air Quality Sensor
+ *
+ * The whole user configuration (aeris_settings_t) as one TLV record, carried
+ * by a single octet string attribute so a device can be provisioned in one
+ * write and read back in one read.
+ *
+ * Record: version (uint8, CONFIG_TLV_VERSION), then any number of
+ *   tag (uint8) | length (uint8) | value (little endian, length bytes)
+ * A write only changes the settings whose tags it contains. Unknown tags are
+ * skipped so older firmware accepts records from newer tools.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "settings.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CONFIG_TLV_VERSION      1
+#define CONFIG_TLV_MAX_SIZE     254     /* ZCL octet string payload limit */
+
+/* Tags, sizes and ranges: the tag column of AERIS_ATTR_TABLE (attr_table.h) */
+
+/**
+ * @brief Encode all settings as a ZCL octet string (length byte + record)
+ * @param settings Settings to encode
+ * @param buf Output buffer (1 + CONFIG_TLV_MAX_SIZE bytes is always enough)
+ * @param buf_size Size of buf
+ * @return Bytes written including the length byte, 0 if buf is too small
+ */
+size_t config_tlv_encode(const aeris_settings_t *settings, uint8_t *buf, size_t buf_size);
+
+/**
+ * @brief Decode a record on top of existing settings
+ *
+ * All-or-nothing: settings is only modified when the whole record is valid.
+ * @param data Record (without the octet string length byte)
+ * @param len Record length
+ * @param settings In: current settings, out: settings with the record applied
+ * @return ESP_OK, ESP_ERR_NOT_SUPPORTED (version), ESP_ERR_INVALID_SIZE
+ *         (truncated record or wrong value length), ESP_ERR_INVALID_ARG (value out of range)
+ */
+esp_err_t config_tlv_decode(const uint8_t *data, size_t len, aeris_settings_t *settings);
+
+#ifdef __cplusplus
+}
+#endif
@@ -21,9 +21,22 @@
 #include "esp_ota_ops.h"
 #include "esp_system.h"
 #include "esp_event.h"
-#include "freertos/timers.h"
+#include "esp_pm.h"
 #include "led_indicator.h"
+#include "fan_control.h"
 #include "settings.h"
+#include "config_tlv.h"
+#include "zb_attr_registry.h"
+#include "binlog.h"
+#include "perf_stats.h"
+#include "zb_diagnostics.h"
+#include "zb_endpoints.h"
+#include "boot_profile.h"
+#include "telemetry.h"
+#include "event_trace.h"
+#include "i2c_capture.h"
+#include "aeris_console.h"
+#include "esp_timer.h"
 
 #if !defined ZB_ROUTER_ROLE
 #error Define ZB_ROUTER_ROLE in idf.py menuconfig to compile Router source code.
@@ -33,23 +46,32 @@ static const char *TAG = "AERIS_ZIGBEE";
 
 /* Sensor update interval */
 #define SENSOR_UPDATE_INTERVAL_MS   30000  // 30 seconds
+#define SENSOR_READY_POLL_MS        1000   // First sample retry while the sensors start
 
 /* Boot button configuration for factory reset */
 #define BOOT_BUTTON_GPIO            GPIO_NUM_9
 #define BUTTON_LONG_PRESS_TIME_MS   5000
 
-/* Status LED blink state */
-static TimerHandle_t status_led_blink_timer = NULL;
-static bool status_led_blink_state = false;
+/* Status LED animations (played by the LED render task) */
+#define STATUS_LED_JOIN_BLINK_MS    1000    /* Orange/green, 500 ms each */
+#define STATUS_LED_IDENTIFY_MS      2000    /* Breathe period while identifying */
+
+/* Boot time reference for the startup log */
+static int64_t s_app_main_us;
 
 /********************* Function Declarations **************************/
 static esp_err_t deferred_driver_init(void);
 static void sensor_update_zigbee_attributes(uint8_t param);
 static void sensor_periodic_update(uint8_t param);
+static void sensor_schedule_next(uint32_t interval_ms);
+static void sensor_purge_start(uint8_t param);
+static void sensor_purge_end(uint8_t param);
 static esp_err_t button_init(void);
 static void button_task(void *arg);
 static void factory_reset_device(uint8_t param);
-static void status_led_blink_callback(TimerHandle_t xTimer);
+static void status_led_identify_cb(uint8_t identify_on);
+static void config_attr_refresh(uint8_t param);
+static void fan_fault_event(bool fault, uint32_t rpm, void *user_ctx);
 
 /* OTA validation functions */
 void ota_validation_start(void);
@@ -61,65 +83,106 @@ void ota_validation_mark_invalid(void);
 /* Factory reset function */
 static void factory_reset_device(uint8_t param)
 {
+    TRACE_INSTANT(TRACE_ALARM_FACTORY_RESET, param);
     ESP_LOGW(TAG, "[RESET] Performing factory reset...");
     esp_zb_factory_reset();
     ESP_LOGI(TAG, "[RESET] Factory reset successful - device will restart");
+    settings_flush();
     vTaskDelay(pdMS_TO_TICKS(1000));
     esp_restart();
 }
 
-/* Status LED blink timer callback for join animation */
-static void status_led_blink_callback(TimerHandle_t xTimer)
-{
-    // Toggle between green and orange during joining
-    status_led_blink_state = !status_led_blink_state;
-    led_set_status(status_led_blink_state ? LED_COLOR_GREEN : LED_COLOR_ORANGE);
-}
-
-/* Start status LED blinking (green/orange during join) */
+/* Start status LED blinking (orange/green during join) */
 static void status_led_start_blink(void)
 {
-    if (status_led_blink_timer == NULL) {
-        status_led_blink_timer = xTimerCreate(
-            "status_blink",
-            pdMS_TO_TICKS(500),  // 500ms interval
-            pdTRUE,              // Auto-reload
-            NULL,
-            status_led_blink_callback
-        );
-        
-        if (status_led_blink_timer == NULL) {
-            ESP_LOGE(TAG, "[ERROR] Failed to create status LED blink timer");
-            return;
-        }
-    }
-    
-    status_led_blink_state = false;
-    led_set_status(LED_COLOR_ORANGE);
-    if (xTimerStart(status_led_blink_timer, 0) == pdPASS) {
+    if (led_set_status_animation(LED_ANIM_BLINK, LED_COLOR_ORANGE, LED_COLOR_GREEN,
+                                 STATUS_LED_JOIN_BLINK_MS) == ESP_OK) {
         ESP_LOGI(TAG, "[STATUS_LED] Started join blink animation");
     } else {
-        ESP_LOGE(TAG, "[ERROR] Failed to start status LED timer");
+        ESP_LOGE(TAG, "[ERROR] Failed to start status LED animation");
     }
 }
 
 /* Stop status LED blinking */
 static void status_led_stop_blink(void)
 {
-    if (status_led_blink_timer != NULL) {
-        if (xTimerStop(status_led_blink_timer, 0) == pdPASS) {
-            ESP_LOGI(TAG, "[STATUS_LED] Stopped blink animation");
-        }
+    led_set_status_animation(LED_ANIM_NONE, LED_COLOR_OFF, LED_COLOR_OFF, 0);
+    ESP_LOGI(TAG, "[STATUS_LED] Stopped blink animation");
+}
+
+/* Identify cluster: breathe the status LED while identifying */
+static void status_led_identify_cb(uint8_t identify_on)
+{
+    ESP_LOGI(TAG, "[STATUS_LED] Identify %s", identify_on ? "start" : "stop");
+    if (identify_on) {
+        led_set_status_animation(LED_ANIM_BREATHE, LED_COLOR_GREEN, LED_COLOR_GREEN,
+                                 STATUS_LED_IDENTIFY_MS);
+    } else {
+        led_set_status(LED_COLOR_GREEN);    // Identify is only sent while joined
+    }
+}
+
+static void zb_attr_set(uint8_t endpoint, uint16_t cluster, uint16_t attr_id, void *value)
+{
+    esp_zb_zcl_set_attribute_val(endpoint, cluster, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, attr_id, value, false);
+}
+
+/* Refresh the bulk configuration attribute from the settings (read-back) */
+static void config_attr_refresh(uint8_t param)
+{
+    aeris_settings_t cfg;
+    uint8_t record[1 + CONFIG_TLV_MAX_SIZE];
+    
+    settings_get(&cfg);
+    if (config_tlv_encode(&cfg, record, sizeof(record)) > 0) {
+        zb_attr_set(HA_ESP_TEMP_HUM_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT,
+                    ZCL_ATTR_CONFIG, record);
     }
 }
 
+/*
+ * Apply a bulk configuration record: decoded as a whole (nothing changes
+ * if any entry is invalid), pushed to the LED, sensor and fan drivers,
+ * saved with a single NVS commit once every driver accepted it, and
+ * mirrored into the individual attributes.
+ */
+static esp_err_t config_apply_record(const uint8_t *data, size_t len)
+{
+    aeris_settings_t cfg;
+    settings_get(&cfg);
+    
+    esp_err_t ret = config_tlv_decode(data, len, &cfg);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Config record rejected: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    ret = zb_attr_registry_apply_all(&cfg);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Config record not applied: %s", esp_err_to_name(ret));
+        settings_get(&cfg);
+        zb_attr_registry_apply_all(&cfg);   // Back to the saved configuration
+        return ret;
+    }
+    ret = settings_save(&cfg);
+    
+    /* Mirror into the individual attributes */
+    zb_attr_registry_sync(&cfg);
+    uint8_t zcl_fan_mode = zb_fan_mode_to_zcl((fan_mode_t)cfg.fan_mode);
+    zb_attr_set(HA_ESP_FAN_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_FAN_CONTROL, ESP_ZB_ZCL_ATTR_FAN_CONTROL_FAN_MODE_ID, &zcl_fan_mode);
+    
+    ESP_LOGI(TAG, "Config record applied");
+    return ret;
+}
+
 /* Boot button queue and ISR handler */
 static QueueHandle_t button_evt_queue = NULL;
 
 static void IRAM_ATTR button_isr_handler(void *arg)
 {
     uint32_t gpio_num = BOOT_BUTTON_GPIO;
+    TRACE_BEGIN(TRACE_ISR_BUTTON, gpio_num);
     xQueueSendFromISR(button_evt_queue, &gpio_num, NULL);
+    TRACE_END(TRACE_ISR_BUTTON, 0);
 }
 
 /* Button monitoring task */
@@ -236,6 +299,7 @@ static esp_err_t deferred_driver_init(void)
     /* Initialize RGB LED indicator */
     ESP_LOGI(TAG, "[INIT] Initializing RGB LED indicator...");
     esp_err_t led_ret = led_indicator_init();
+    boot_profile_mark(BOOT_MS_LED_INIT);
     if (led_ret != ESP_OK) {
         ESP_LOGE(TAG, "[ERROR] LED initialization failed: %s", esp_err_to_name(led_ret));
         ESP_LOGW(TAG, "[WARN] Continuing without LED indicator");
@@ -247,37 +311,65 @@ static esp_err_t deferred_driver_init(void)
         led_set_enable(settings_get_sensor_leds_enabled());
         led_set_status_enable(settings_get_status_led_enabled());
         
-        /* Apply saved LED mask */
+        /* Apply saved LED mask, display mode and thresholds */
         led_thresholds_t thresholds;
-        led_get_thresholds(&thresholds);
-        thresholds.led_mask = settings_get_led_mask();
-        thresholds.enabled = settings_get_sensor_leds_enabled();
+        settings_get_led_thresholds(&thresholds);
         led_set_thresholds(&thresholds);
     }
     
-    /* Initialize air quality sensor driver */
-    ESP_LOGI(TAG, "[INIT] Initializing air quality sensors...");
-    esp_err_t ret = aeris_driver_init();
+    /* Fan stall / recovery events go to the fault attribute (endpoint 8) */
+    fan_register_fault_cb(fan_fault_event, NULL);
     
+    /* Start the air quality sensors in the background: steering and rejoin don't wait for them */
+    ESP_LOGI(TAG, "[INIT] Starting air quality sensors...");
+    esp_err_t ret = aeris_driver_init_async();
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "[ERROR] Failed to initialize sensors: %s", esp_err_to_name(ret));
-        ESP_LOGW(TAG, "[WARN] Continuing without sensors - endpoints will still be created");
-    } else {
-        ESP_LOGI(TAG, "[OK] Air quality sensors initialized successfully");
-        
-        /* Apply saved calibration offsets */
-        aeris_set_temperature_offset(settings_get_temperature_offset() / 10.0f);
-        aeris_set_humidity_offset(settings_get_humidity_offset() / 10.0f);
+        ESP_LOGE(TAG, "[ERROR] Failed to start sensor initialization: %s", esp_err_to_name(ret));
+        ESP_LOGW(TAG, "[WARN] Continuing without sensors - endpoints will report unknown values");
     }
     
+    /* Apply saved calibration offsets */
+    aeris_set_temperature_offset(settings_get_temperature_offset() / 10.0f);
+    aeris_set_humidity_offset(settings_get_humidity_offset() / 10.0f);
+    
+    /* Apply saved fan curve, full-scale RPM and mode (auto mode then follows every sample) */
+    fan_curve_t fan_curve;
+    settings_get_fan_curve(&fan_curve);
+    fan_set_curve(&fan_curve);
+    fan_set_full_rpm(settings_get_fan_full_rpm());
+    fan_set_mode(settings_get_fan_mode());
+    
     ESP_LOGI(TAG, "[INIT] Deferred initialization complete");
     return ESP_OK;
 }
 
+/* Publish a fan fault transition (Zigbee task), reported to the coordinator */
+static void fan_fault_publish(uint8_t fault)
+{
+    bool value = (fault != 0);
+    esp_zb_zcl_set_attribute_val(HA_ESP_FAN_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_FAN_CONTROL,
+                                  ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, ZCL_FAN_ATTR_FAULT, &value, false);
+    ESP_LOGI(TAG, "Fan fault %s", value ? "raised" : "cleared");
+}
+
+/*
+ * Fan fault callback (esp_timer task, or the caller switching the fan off).
+ * Stack API calls from outside the Zigbee task need the Zigbee lock; it is
+ * recursive, so a fan switched off from the Zigbee task takes it again.
+ */
+static void fan_fault_event(bool fault, uint32_t rpm, void *user_ctx)
+{
+    esp_zb_lock_acquire(portMAX_DELAY);
+    esp_zb_scheduler_alarm((esp_zb_callback_t)fan_fault_publish, fault ? 1 : 0, 0);
+    esp_zb_lock_release();
+}
+
 static void bdb_start_top_level_commissioning_cb(uint8_t mode_mask)
 {
-    ESP_RETURN_ON_FALSE(esp_zb_bdb_start_top_level_commissioning(mode_mask) == ESP_OK, , 
-                       TAG, "Failed to start Zigbee commissioning");
+    TRACE_BEGIN(TRACE_ALARM_COMMISSIONING, mode_mask);
+    esp_err_t ret = esp_zb_bdb_start_top_level_commissioning(mode_mask);
+    TRACE_END(TRACE_ALARM_COMMISSIONING, ret);
+    ESP_RETURN_ON_FALSE(ret == ESP_OK, , TAG, "Failed to start Zigbee commissioning");
 }
 
 void esp_zb_app_signal_handler(esp_zb_app_signal_t *signal_struct)
@@ -286,6 +378,8 @@ void esp_zb_app_signal_handler(esp_zb_app_signal_t *signal_struct)
     esp_err_t err_status = signal_struct->esp_err_status;
     esp_zb_app_signal_type_t sig_type = *p_sg_p;
     
+    TRACE_BEGIN(TRACE_ZB_SIGNAL, sig_type);
+    
     switch (sig_type) {
     case ESP_ZB_ZDO_SIGNAL_SKIP_STARTUP:
         ESP_LOGI(TAG, "[JOIN] Initialize Zigbee stack");
@@ -296,6 +390,7 @@ void esp_zb_app_signal_handler(esp_zb_app_signal_t *signal_struct)
     case ESP_ZB_BDB_SIGNAL_DEVICE_FIRST_START:
         ESP_LOGI(TAG, "[JOIN] Device first start - factory new device");
         if (err_status == ESP_OK) {
+            boot_profile_mark(BOOT_MS_STACK_READY);
             deferred_driver_init();
             /* On first start, LED is enabled by default (from cluster config) */
             led_set_enable(true);
@@ -310,6 +405,7 @@ void esp_zb_app_signal_handler(esp_zb_app_signal_t *signal_struct)
     case ESP_ZB_BDB_SIGNAL_DEVICE_REBOOT:
         ESP_LOGI(TAG, "[JOIN] Device reboot - previously joined network");
         if (err_status == ESP_OK) {
+            boot_profile_mark(BOOT_MS_STACK_READY);
             deferred_driver_init();
             
             /* Sync LED settings from Zigbee attributes (persisted in NVS) */
@@ -349,6 +445,7 @@ void esp_zb_app_signal_handler(esp_zb_app_signal_t *signal_struct)
                 esp_zb_bdb_start_top_level_commissioning(ESP_ZB_BDB_MODE_NETWORK_STEERING);
             } else {
                 led_set_status(LED_COLOR_GREEN);  // Previously joined, should reconnect
+                boot_profile_mark(BOOT_MS_NETWORK);
                 /* Start periodic sensor updates for rejoined device */
                 esp_zb_scheduler_alarm((esp_zb_callback_t)sensor_periodic_update, 0, 5000);
                 ESP_LOGI(TAG, "[JOIN] Sensor updates started for rejoined device");
@@ -363,6 +460,7 @@ void esp_zb_app_signal_handler(esp_zb_app_signal_t *signal_struct)
             esp_zb_ieee_addr_t extended_pan_id;
             esp_zb_get_extended_pan_id(extended_pan_id);
             ESP_LOGI(TAG, "[JOIN] *** SUCCESSFULLY JOINED NETWORK ***");
+            boot_profile_mark(BOOT_MS_NETWORK);
             ESP_LOGI(TAG, "[JOIN] PAN ID: 0x%04hx, Channel: %d", 
                      esp_zb_get_pan_id(), esp_zb_get_current_channel());
             
@@ -405,193 +503,96 @@ void esp_zb_app_signal_handler(esp_zb_app_signal_t *signal_struct)
         }
         break;
     }
+    
+    TRACE_END(TRACE_ZB_SIGNAL, err_status);
 }
 
 static esp_err_t zb_attribute_handler(const esp_zb_zcl_set_attr_value_message_t *message)
 {
+    esp_err_t ret = ESP_OK;
+
     ESP_RETURN_ON_FALSE(message, ESP_FAIL, TAG, "Empty message");
     ESP_RETURN_ON_FALSE(message->info.status == ESP_ZB_ZCL_STATUS_SUCCESS, ESP_ERR_INVALID_ARG, 
                        TAG, "Received message: error status(%d)", message->info.status);
     
-    ESP_LOGI(TAG, "RX: endpoint(%d), cluster(0x%x), attr(0x%x)", 
-             message->info.dst_endpoint, message->info.cluster, message->attribute.id);
+    BINLOGI(TAG, "RX: endpoint(%d), cluster(0x%x), attr(0x%x)", 
+            message->info.dst_endpoint, message->info.cluster, message->attribute.id);
     
-    /* Handle LED configuration endpoint */
-    if (message->info.dst_endpoint == HA_ESP_LED_CONFIG_ENDPOINT) {
-        led_thresholds_t thresholds;
-        led_get_thresholds(&thresholds);
-        
-        /* Handle On/Off cluster for LED enable/disable */
-        if (message->info.cluster == ESP_ZB_ZCL_CLUSTER_ID_ON_OFF &&
-            message->attribute.id == ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID) {
-            bool on_off = *(bool *)message->attribute.data.value;
-            ESP_LOGI(TAG, "LED %s", on_off ? "enabled" : "disabled");
-            led_set_enable(on_off);
-            thresholds.enabled = on_off;
-            led_set_thresholds(&thresholds);
-            settings_set_sensor_leds_enabled(on_off);  // Persist to NVS
-        }
-        /* Handle Level Control cluster for brightness */
-        else if (message->info.cluster == ESP_ZB_ZCL_CLUSTER_ID_LEVEL_CONTROL &&
-                 message->attribute.id == ESP_ZB_ZCL_ATTR_LEVEL_CONTROL_CURRENT_LEVEL_ID) {
-            uint8_t brightness = *(uint8_t *)message->attribute.data.value;
-            // Ignore brightness=0 writes (Z2M sometimes sends 0 when enabling on/off)
-            // If user really wants to turn off LEDs, they should use the on/off switch
-            if (brightness == 0) {
-                ESP_LOGW(TAG, "Ignoring brightness=0 (use on/off switch to disable LEDs)");
-            } else {
-                ESP_LOGI(TAG, "LED brightness: %d", brightness);
-                led_set_brightness(brightness);
-                settings_set_led_brightness(brightness);  // Persist to NVS
+    /* Settings (attr_table.h): range checked, applied and saved by the registry */
+    const zb_attr_desc_t *desc = zb_attr_registry_find(message->info.dst_endpoint, message->info.cluster,
+                                                       message->attribute.id);
+    if (desc) {
+        ret = zb_attr_registry_write(desc, message->attribute.data.value);
+    }
+    /* LED mask written as presentValue (0x55, float) */
+    else if (message->info.dst_endpoint == HA_ESP_LED_CONFIG_ENDPOINT &&
+             message->info.cluster == ESP_ZB_ZCL_CLUSTER_ID_ANALOG_OUTPUT &&
+             message->attribute.id == ESP_ZB_ZCL_ATTR_ANALOG_OUTPUT_PRESENT_VALUE_ID) {
+        uint8_t mask = (uint8_t)*(float *)message->attribute.data.value;
+        ret = zb_attr_registry_write(zb_attr_registry_find(HA_ESP_LED_CONFIG_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_OUTPUT,
+                                                           ZCL_LED_ATTR_ENABLE_MASK), &mask);
+    }
+    /* Temperature endpoint: bulk configuration and diagnostics */
+    else if (message->info.dst_endpoint == HA_ESP_TEMP_HUM_ENDPOINT) {
+        if (message->info.cluster == ESP_ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT &&
+            message->attribute.id == ZCL_ATTR_CONFIG) {
+            const uint8_t *record = (const uint8_t *)message->attribute.data.value;
+            if (record) {
+                ret = config_apply_record(record + 1, record[0]);  // Octet string: length byte first
             }
         }
-        /* Handle threshold attributes */
-        else if (message->info.cluster == ESP_ZB_ZCL_CLUSTER_ID_ANALOG_OUTPUT) {
-            bool updated = true;
-            
-            switch (message->attribute.id) {
-                case ESP_ZB_ZCL_ATTR_ANALOG_OUTPUT_PRESENT_VALUE_ID: {
-                    // presentValue (0x55) is used as LED mask (float -> uint8)
-                    float float_val = *(float *)message->attribute.data.value;
-                    thresholds.led_mask = (uint8_t)float_val;
-                    ESP_LOGI(TAG, "LED mask set via presentValue: 0x%02X (CO2:%d VOC:%d NOx:%d Hum:%d)", 
-                             thresholds.led_mask,
-                             !!(thresholds.led_mask & (1<<0)), !!(thresholds.led_mask & (1<<1)), 
-                             !!(thresholds.led_mask & (1<<2)), !!(thresholds.led_mask & (1<<3)));
-                    settings_set_led_mask(thresholds.led_mask);  // Persist to NVS
-                    break;
-                }
-                case ZCL_LED_ATTR_VOC_ORANGE: {
-                    uint16_t value = *(uint16_t *)message->attribute.data.value;
-                    thresholds.voc_orange = value;
-                    ESP_LOGI(TAG, "VOC orange threshold: %d", value);
-                    break;
-                }
-                case ZCL_LED_ATTR_VOC_RED: {
-                    uint16_t value = *(uint16_t *)message->attribute.data.value;
-                    thresholds.voc_red = value;
-                    ESP_LOGI(TAG, "VOC red threshold: %d", value);
-                    break;
-                }
-                case ZCL_LED_ATTR_NOX_ORANGE: {
-                    uint16_t value = *(uint16_t *)message->attribute.data.value;
-                    thresholds.nox_orange = value;
-                    ESP_LOGI(TAG, "NOx orange threshold: %d", value);
-                    break;
-                }
-                case ZCL_LED_ATTR_NOX_RED: {
-                    uint16_t value = *(uint16_t *)message->attribute.data.value;
-                    thresholds.nox_red = value;
-                    ESP_LOGI(TAG, "NOx red threshold: %d", value);
-                    break;
-                }
-                case ZCL_LED_ATTR_CO2_ORANGE: {
-                    uint16_t value = *(uint16_t *)message->attribute.data.value;
-                    thresholds.co2_orange = value;
-                    ESP_LOGI(TAG, "CO2 orange threshold: %d ppm", value);
-                    break;
-                }
-                case ZCL_LED_ATTR_CO2_RED: {
-                    uint16_t value = *(uint16_t *)message->attribute.data.value;
-                    thresholds.co2_red = value;
-                    ESP_LOGI(TAG, "CO2 red threshold: %d ppm", value);
-                    break;
-                }
-                case ZCL_LED_ATTR_HUM_ORANGE_LOW: {
-                    uint16_t value = *(uint16_t *)message->attribute.data.value;
-                    thresholds.humidity_orange_low = value;
-                    ESP_LOGI(TAG, "Humidity orange low threshold: %d%%", value);
-                    break;
-                }
-                case ZCL_LED_ATTR_HUM_ORANGE_HIGH: {
-                    uint16_t value = *(uint16_t *)message->attribute.data.value;
-                    thresholds.humidity_orange_high = value;
-                    ESP_LOGI(TAG, "Humidity orange high threshold: %d%%", value);
-                    break;
-                }
-                case ZCL_LED_ATTR_HUM_RED_LOW: {
-                    uint16_t value = *(uint16_t *)message->attribute.data.value;
-                    thresholds.humidity_red_low = value;
-                    ESP_LOGI(TAG, "Humidity red low threshold: %d%%", value);
-                    break;
-                }
-                case ZCL_LED_ATTR_HUM_RED_HIGH: {
-                    uint16_t value = *(uint16_t *)message->attribute.data.value;
-                    thresholds.humidity_red_high = value;
-                    ESP_LOGI(TAG, "Humidity red high threshold: %d%%", value);
-                    break;
-                }
-                case ZCL_LED_ATTR_ENABLE_MASK: {
-                    uint8_t value = *(uint8_t *)message->attribute.data.value;
-                    thresholds.led_mask = value;
-                    ESP_LOGI(TAG, "LED enable mask: 0x%02X (CO2:%d VOC:%d NOx:%d Hum:%d)", 
-                             value,
-                             !!(value & (1<<0)), !!(value & (1<<1)), !!(value & (1<<2)),
-                             !!(value & (1<<4)));
-                    break;
-                }
-                case ZCL_LED_ATTR_BRIGHTNESS: {
-                    uint8_t brightness = *(uint8_t *)message->attribute.data.value;
-                    ESP_LOGI(TAG, "LED brightness: %d", brightness);
-                    led_set_brightness(brightness);
-                    updated = false;  // Don't update thresholds
-                    break;
-                }
-                default:
-                    updated = false;
-                    break;
-            }
-            
-            if (updated) {
-                led_set_thresholds(&thresholds);
+        else if (message->info.cluster == ESP_ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT &&
+                 message->attribute.id == ZCL_ATTR_LOG_LEVEL) {
+            uint8_t level = *(uint8_t *)message->attribute.data.value;
+            if (binlog_set_level((esp_log_level_t)level) != ESP_OK) {
+                ESP_LOGW(TAG, "Invalid log level: %d", level);
             }
         }
-    }
-    
-    /* Handle Temperature/Humidity endpoint calibration */
-    if (message->info.dst_endpoint == HA_ESP_TEMP_HUM_ENDPOINT) {
-        if (message->info.cluster == ESP_ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT) {
-            if (message->attribute.id == ZCL_ATTR_TEMP_OFFSET) {
-                int16_t offset_raw = *(int16_t *)message->attribute.data.value;
-                float offset_c = offset_raw / 10.0f;  // Convert from 0.1°C to °C
-                ESP_LOGI(TAG, "Temperature offset: %.1f°C", offset_c);
-                aeris_set_temperature_offset(offset_c);
-                settings_set_temperature_offset(offset_raw);  // Persist to NVS
+        else if (message->info.cluster == ESP_ZB_ZCL_CLUSTER_ID_DIAGNOSTICS &&
+                 message->attribute.id == ZCL_DIAG_ATTR_TRACE_CONTROL) {
+            uint8_t cmd = *(uint8_t *)message->attribute.data.value;
+            ESP_LOGI(TAG, "Event trace command: %d", cmd);
+            if (cmd == ZCL_DIAG_TRACE_STOP) {
+                event_trace_stop();
+            } else if (cmd == ZCL_DIAG_TRACE_START) {
+                event_trace_start();
+            } else if (cmd == ZCL_DIAG_TRACE_DUMP) {
+                event_trace_request_dump();  // Prints from its own task, never blocks the stack
             }
-            else if (message->attribute.id == ZCL_ATTR_HUMIDITY_OFFSET) {
-                int16_t offset_raw = *(int16_t *)message->attribute.data.value;
-                float offset_percent = offset_raw / 10.0f;  // Convert from 0.1% to %
-                ESP_LOGI(TAG, "Humidity offset: %.1f%%", offset_percent);
-                aeris_set_humidity_offset(offset_percent);
-                settings_set_humidity_offset(offset_raw);  // Persist to NVS
-            }
-            else if (message->attribute.id == ZCL_ATTR_REFRESH_INTERVAL) {
-                uint16_t interval_sec = *(uint16_t *)message->attribute.data.value;
-                ESP_LOGI(TAG, "Sensor refresh interval: %d seconds", interval_sec);
-                settings_set_sensor_refresh_interval(interval_sec);  // Persist to NVS (also clamps to 10-3600)
+        }
+        else if (message->info.cluster == ESP_ZB_ZCL_CLUSTER_ID_DIAGNOSTICS &&
+                 message->attribute.id == ZCL_DIAG_ATTR_I2C_CAPTURE) {
+            uint8_t cmd = *(uint8_t *)message->attribute.data.value;
+            ESP_LOGI(TAG, "I2C capture command: %d", cmd);
+            if (cmd == ZCL_DIAG_I2C_CAPTURE_DUMP) {
+                i2c_capture_request_dump();  // Recording continues in the current mode
+            } else if (i2c_capture_set_mode((i2c_capture_mode_t)cmd) != ESP_OK) {
+                ESP_LOGW(TAG, "Invalid I2C capture command: %d", cmd);
             }
         }
     }
-    
-    /* Handle Status LED endpoint */
-    if (message->info.dst_endpoint == HA_ESP_STATUS_LED_ENDPOINT) {
-        /* Handle On/Off cluster for status LED enable/disable */
-        if (message->info.cluster == ESP_ZB_ZCL_CLUSTER_ID_ON_OFF &&
-            message->attribute.id == ESP_ZB_ZCL_ATTR_ON_OFF_ON_OFF_ID) {
-            bool on_off = *(bool *)message->attribute.data.value;
-            ESP_LOGI(TAG, "Status LED %s", on_off ? "enabled" : "disabled");
-            led_set_status_enable(on_off);
-            settings_set_status_led_enabled(on_off);  // Persist to NVS
+    /* ZCL fan mode enum (the table stores fan_mode_t) */
+    else if (message->info.dst_endpoint == HA_ESP_FAN_ENDPOINT &&
+             message->info.cluster == ESP_ZB_ZCL_CLUSTER_ID_FAN_CONTROL &&
+             message->attribute.id == ESP_ZB_ZCL_ATTR_FAN_CONTROL_FAN_MODE_ID) {
+        fan_mode_t mode = zb_fan_mode_from_zcl(*(uint8_t *)message->attribute.data.value);
+        ESP_LOGI(TAG, "Fan mode: %d", mode);
+        if (fan_set_mode(mode) == ESP_OK) {
+            settings_set_fan_mode(mode);  // Persist to NVS
         }
     }
     
-    return ESP_OK;
+    /* Keep the bulk configuration read-back current (also reverts a rejected record);
+     * deferred because the stack stores the written value after this callback */
+    esp_zb_scheduler_alarm((esp_zb_callback_t)config_attr_refresh, 0, 0);
+    
+    return ret;     // Non-OK answers the write with a failure status
 }
 
 static esp_err_t zb_action_handler(esp_zb_core_action_callback_id_t callback_id, const void *message)
 {
     esp_err_t ret = ESP_OK;
-    ESP_LOGI(TAG, "Zigbee action callback: 0x%x", callback_id);
+    BINLOGD(TAG, "Zigbee action callback: 0x%x", callback_id);
     switch (callback_id) {
     case ESP_ZB_CORE_SET_ATTR_VALUE_CB_ID:
         ret = zb_attribute_handler((esp_zb_zcl_set_attr_value_message_t *)message);
@@ -610,30 +611,46 @@ static void sensor_update_zigbee_attributes(uint8_t param)
     float pressure_hpa;
     uint16_t voc_index, nox_index;
     uint16_t co2_ppm;
+    int64_t cycle_start = esp_timer_get_time();
+    
+    if (!aeris_driver_is_ready()) {
+        ESP_LOGD(TAG, "Sensors not initialized yet");
+        return;
+    }
     
     /* Read temperature and humidity from SHT45 */
-    if (aeris_read_temp_humidity(&temp_c, &humidity) != ESP_OK) {
+    bool temp_ok = (aeris_read_temp_humidity(&temp_c, &humidity) == ESP_OK);
+    if (!temp_ok) {
         ESP_LOGW(TAG, "Failed to read temp/humidity");
+        zb_diag_sample_dropped();
     }
     
     /* Read pressure from LPS22HB */
-    if (aeris_read_pressure(&pressure_hpa) != ESP_OK) {
+    bool pressure_ok = (aeris_read_pressure(&pressure_hpa) == ESP_OK);
+    if (!pressure_ok) {
         ESP_LOGW(TAG, "Failed to read pressure");
+        zb_diag_sample_dropped();
     }
     
     /* Read VOC from SGP41 */
-    if (aeris_read_voc(&voc_index) != ESP_OK) {
+    bool voc_ok = (aeris_read_voc(&voc_index) == ESP_OK);
+    if (!voc_ok) {
         ESP_LOGW(TAG, "Failed to read VOC");
+        zb_diag_sample_dropped();
     }
     
     /* Read NOx from SGP41 */
-    if (aeris_read_nox(&nox_index) != ESP_OK) {
+    bool nox_ok = (aeris_read_nox(&nox_index) == ESP_OK);
+    if (!nox_ok) {
         ESP_LOGW(TAG, "Failed to read NOx");
+        zb_diag_sample_dropped();
     }
     
     /* Read CO2 from SCD40 */
-    if (aeris_read_co2(&co2_ppm) != ESP_OK) {
+    bool co2_ok = (aeris_read_co2(&co2_ppm) == ESP_OK);
+    if (!co2_ok) {
         ESP_LOGW(TAG, "Failed to read CO2");
+        zb_diag_sample_dropped();
     }
     
     /* Now get the updated state */
@@ -654,39 +671,62 @@ static void sensor_update_zigbee_attributes(uint8_t param)
     int16_t temp_zigbee = (int16_t)(state.temperature_c * 100);  // °C to 0.01°C
     uint16_t hum_zigbee = (uint16_t)(state.humidity_percent * 100);  // % to 0.01%
     
-    esp_zb_zcl_set_attribute_val(HA_ESP_TEMP_HUM_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT,
-                                  ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, ESP_ZB_ZCL_ATTR_TEMP_MEASUREMENT_VALUE_ID,
-                                  &temp_zigbee, false);
-    esp_zb_zcl_set_attribute_val(HA_ESP_TEMP_HUM_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_REL_HUMIDITY_MEASUREMENT,
-                                  ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, ESP_ZB_ZCL_ATTR_REL_HUMIDITY_MEASUREMENT_VALUE_ID,
-                                  &hum_zigbee, false);
+    /* Only sensors read successfully: the others keep their last value, "unknown" until the first sample */
+    PERF_BEGIN(t_attr);
+    if (temp_ok) {
+        esp_zb_zcl_set_attribute_val(HA_ESP_TEMP_HUM_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT,
+                                      ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, ESP_ZB_ZCL_ATTR_TEMP_MEASUREMENT_VALUE_ID,
+                                      &temp_zigbee, false);
+        esp_zb_zcl_set_attribute_val(HA_ESP_TEMP_HUM_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_REL_HUMIDITY_MEASUREMENT,
+                                      ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, ESP_ZB_ZCL_ATTR_REL_HUMIDITY_MEASUREMENT_VALUE_ID,
+                                      &hum_zigbee, false);
+    }
     
     /* Update Endpoint 2: Pressure */
     /* Zigbee Pressure Measurement cluster uses 0.1 hPa units (int16)
      * Convert hPa to 0.1 hPa by multiplying by 10
      * Example: 997.33 hPa = 9973 in 0.1 hPa units */
     int16_t pressure_zigbee = (int16_t)(state.pressure_hpa * 10.0f);  // hPa to 0.1 hPa units
-    esp_zb_zcl_set_attribute_val(HA_ESP_PRESSURE_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_PRESSURE_MEASUREMENT,
-                                  ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, ESP_ZB_ZCL_ATTR_PRESSURE_MEASUREMENT_VALUE_ID,
-                                  &pressure_zigbee, false);
+    if (pressure_ok) {
+        esp_zb_zcl_set_attribute_val(HA_ESP_PRESSURE_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_PRESSURE_MEASUREMENT,
+                                      ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, ESP_ZB_ZCL_ATTR_PRESSURE_MEASUREMENT_VALUE_ID,
+                                      &pressure_zigbee, false);
+    }
     
     /* Update Endpoint 3: VOC Index */
     float voc_value = (float)state.voc_index;
-    esp_zb_zcl_set_attribute_val(HA_ESP_VOC_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_INPUT,
-                                  ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, ESP_ZB_ZCL_ATTR_ANALOG_INPUT_PRESENT_VALUE_ID,
-                                  &voc_value, false);
+    if (voc_ok) {
+        esp_zb_zcl_set_attribute_val(HA_ESP_VOC_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_INPUT,
+                                      ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, ESP_ZB_ZCL_ATTR_ANALOG_INPUT_PRESENT_VALUE_ID,
+                                      &voc_value, false);
+    }
     
     /* Update Endpoint 4: NOx Index */
     float nox_value = (float)state.nox_index;
-    esp_zb_zcl_set_attribute_val(HA_ESP_NOX_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_INPUT,
-                                  ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, ESP_ZB_ZCL_ATTR_ANALOG_INPUT_PRESENT_VALUE_ID,
-                                  &nox_value, false);
+    if (nox_ok) {
+        esp_zb_zcl_set_attribute_val(HA_ESP_NOX_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_INPUT,
+                                      ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, ESP_ZB_ZCL_ATTR_ANALOG_INPUT_PRESENT_VALUE_ID,
+                                      &nox_value, false);
+    }
     
     /* Update Endpoint 5: CO2 */
     float co2_value = (float)state.co2_ppm;
-    esp_zb_zcl_set_attribute_val(HA_ESP_CO2_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_CARBON_DIOXIDE_MEASUREMENT,
-                                  ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, ESP_ZB_ZCL_ATTR_CARBON_DIOXIDE_MEASUREMENT_MEASURED_VALUE_ID,
-                                  &co2_value, false);
+    if (co2_ok) {
+        esp_zb_zcl_set_attribute_val(HA_ESP_CO2_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_CARBON_DIOXIDE_MEASUREMENT,
+                                      ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, ESP_ZB_ZCL_ATTR_CARBON_DIOXIDE_MEASUREMENT_MEASURED_VALUE_ID,
+                                      &co2_value, false);
+    }
+    PERF_END(PERF_ZB_ATTR_BATCH, t_attr);
+    if (temp_ok || pressure_ok || voc_ok || nox_ok || co2_ok) {
+        boot_profile_mark(BOOT_MS_FIRST_REPORT);
+    }
+    
+    /* Publish latency percentiles (read-only, polled by the coordinator) */
+    uint8_t perf_attr[1 + PERF_ID_MAX * PERF_ENCODED_ENTRY_SIZE];
+    perf_encode_summary(perf_attr, sizeof(perf_attr));
+    esp_zb_zcl_set_attribute_val(HA_ESP_TEMP_HUM_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT,
+                                  ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, ZCL_ATTR_PERF_SUMMARY,
+                                  perf_attr, false);
     
     /* Update LED based on sensor readings */
     led_sensor_data_t led_data = {
@@ -696,15 +736,126 @@ static void sensor_update_zigbee_attributes(uint8_t param)
         .humidity_percent = state.humidity_percent,
     };
     led_update_from_sensors(&led_data);
+    
+    /* Fan auto mode follows the same sample */
+    fan_curve_input_t fan_input = {
+        .temperature_c = state.temperature_c,
+        .humidity_percent = state.humidity_percent,
+        .voc_index = state.voc_index,
+        .co2_ppm = state.co2_ppm,
+    };
+    fan_adaptive_control(&fan_input);
+    
+    uint32_t rpm = fan_get_rpm();
+    uint16_t fan_rpm = (rpm > UINT16_MAX) ? UINT16_MAX : (uint16_t)rpm;
+    esp_zb_zcl_set_attribute_val(HA_ESP_FAN_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_FAN_CONTROL,
+                                  ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, ZCL_FAN_ATTR_RPM,
+                                  &fan_rpm, false);
+    
+    /* Firmware diagnostics (Diagnostics cluster 0xF1xx attributes) */
+    zb_diag_record_cycle((uint32_t)((esp_timer_get_time() - cycle_start) / 1000));
+    zb_diag_update_attributes();
 }
 
 static void sensor_periodic_update(uint8_t param)
 {
+    static uint32_t update_count = 0;
+    
+    /* Sensors still starting: take the first sample as soon as they are up */
+    if (!aeris_driver_is_ready()) {
+        esp_zb_scheduler_alarm((esp_zb_callback_t)sensor_periodic_update, 0, SENSOR_READY_POLL_MS);
+        return;
+    }
+    update_count++;
+    
+    TRACE_BEGIN(TRACE_ALARM_SENSOR_UPDATE, update_count);
+    
+    /* Task/heap telemetry covers the interval since the previous update */
+    telemetry_sample();
+    
+    TRACE_BEGIN(TRACE_ACQUISITION, 0);
     sensor_update_zigbee_attributes(0);
+    TRACE_END(TRACE_ACQUISITION, 0);
+    
+    /* Sample taken: back to the fan mode, auto curve already has the new readings */
+    fan_override_release();
+    
+#if PERF_DUMP_EVERY_N_UPDATES > 0
+    if (update_count % PERF_DUMP_EVERY_N_UPDATES == 0) {
+        perf_dump();
+    }
+#endif
+#if TELEMETRY_LOG_EVERY_N_UPDATES > 0
+    if (update_count % TELEMETRY_LOG_EVERY_N_UPDATES == 0) {
+        telemetry_dump();
+    }
+#endif
     
     /* Schedule next update using dynamic interval from settings */
     uint32_t interval_ms = settings_get_sensor_refresh_interval() * 1000;
-    esp_zb_scheduler_alarm((esp_zb_callback_t)sensor_periodic_update, 0, interval_ms);
+    sensor_schedule_next(interval_ms);
+    
+    TRACE_END(TRACE_ALARM_SENSOR_UPDATE, interval_ms);
+}
+
+/*
+ * Purge-then-measure: the next sample is preceded by a fan purge of
+ * purge_s seconds and a FAN_PURGE_SETTLE_MS window at the measure speed.
+ * Skipped while the fan is stopped (OFF, or AUTO with the curve at 0%) so a
+ * silent fan is never spun up just for a sample, or when the purge and
+ * settle window would take more than 1/FAN_PURGE_MIN_INTERVAL_RATIO of the
+ * refresh interval (the fan would then run boosted most of the time).
+ */
+static bool sensor_purge_allowed(void)
+{
+    fan_status_t status;
+    return fan_get_status(&status) == ESP_OK && status.enabled && status.speed_percent > 0;
+}
+
+static void sensor_schedule_next(uint32_t interval_ms)
+{
+    fan_purge_t purge;
+    settings_get_fan_purge(&purge);
+    uint32_t purge_ms = purge.purge_s * 1000;
+    
+    if (purge_ms > 0 && sensor_purge_allowed() &&
+        interval_ms >= (purge_ms + FAN_PURGE_SETTLE_MS) * FAN_PURGE_MIN_INTERVAL_RATIO) {
+        esp_zb_scheduler_alarm((esp_zb_callback_t)sensor_purge_start, 0,
+                               interval_ms - purge_ms - FAN_PURGE_SETTLE_MS);
+    } else {
+        esp_zb_scheduler_alarm((esp_zb_callback_t)sensor_periodic_update, 0, interval_ms);
+    }
+}
+
+static void sensor_purge_start(uint8_t param)
+{
+    fan_purge_t purge;
+    settings_get_fan_purge(&purge);
+    
+    /* Fan may have been stopped since the purge was scheduled */
+    if (sensor_purge_allowed()) {
+        ESP_LOGD(TAG, "Fan purge: %d%% for %ds", purge.purge_percent, purge.purge_s);
+        fan_override(purge.purge_percent);
+    }
+    esp_zb_scheduler_alarm((esp_zb_callback_t)sensor_purge_end, 0, purge.purge_s * 1000);
+}
+
+static void sensor_purge_end(uint8_t param)
+{
+    fan_purge_t purge;
+    settings_get_fan_purge(&purge);
+    
+    if (fan_is_overridden()) {
+        fan_override(purge.measure_percent);
+    }
+    esp_zb_scheduler_alarm((esp_zb_callback_t)sensor_periodic_update, 0, FAN_PURGE_SETTLE_MS);
+}
+
+void aeris_zb_update_now(void)
+{
+    TRACE_BEGIN(TRACE_ACQUISITION, 1);
+    sensor_update_zigbee_attributes(0);
+    TRACE_END(TRACE_ACQUISITION, 1);
 }
 
 static void esp_zb_task(void *pvParameters)
@@ -712,318 +863,12 @@ static void esp_zb_task(void *pvParameters)
     /* Initialize Zigbee stack as Router (matching working example) */
     esp_zb_cfg_t zb_nwk_cfg = ESP_ZB_ROUTER_CONFIG();
     esp_zb_init(&zb_nwk_cfg);
+    zb_attr_registry_init();
     
-    /* Create endpoint list */
-    esp_zb_ep_list_t *ep_list = esp_zb_ep_list_create();
-    
-    /* Endpoint 1: Temperature and Humidity with REPORTING flag */
-    esp_zb_cluster_list_t *temp_hum_clusters = esp_zb_zcl_cluster_list_create();
-    
-    /* Add Basic cluster */
-    esp_zb_basic_cluster_cfg_t basic_cfg = {
-        .zcl_version = ESP_ZB_ZCL_BASIC_ZCL_VERSION_DEFAULT_VALUE,
-        .power_source = ESP_ZB_ZCL_BASIC_POWER_SOURCE_DEFAULT_VALUE,
-    };
-    esp_zb_attribute_list_t *basic_cluster = esp_zb_basic_cluster_create(&basic_cfg);
-    
-    /* Add optional Basic cluster attributes for Zigbee2MQTT */
-    static uint8_t app_version = 1;       // Application version
-    static uint8_t stack_version = 0x30;  // Zigbee 3.0
-    static uint8_t hw_version = 1;        // Hardware version
-    static char date_code[17] = "\x0A""2025-11-15";  // Build date
-    static char sw_build_id[17] = "\x05""v1.0.0";    // Software version
-    
-    esp_zb_basic_cluster_add_attr(basic_cluster, ESP_ZB_ZCL_ATTR_BASIC_APPLICATION_VERSION_ID, &app_version);
-    esp_zb_basic_cluster_add_attr(basic_cluster, ESP_ZB_ZCL_ATTR_BASIC_STACK_VERSION_ID, &stack_version);
-    esp_zb_basic_cluster_add_attr(basic_cluster, ESP_ZB_ZCL_ATTR_BASIC_HW_VERSION_ID, &hw_version);
-    esp_zb_basic_cluster_add_attr(basic_cluster, ESP_ZB_ZCL_ATTR_BASIC_DATE_CODE_ID, (void*)date_code);
-    esp_zb_basic_cluster_add_attr(basic_cluster, ESP_ZB_ZCL_ATTR_BASIC_SW_BUILD_ID, (void*)sw_build_id);
-    
-    ESP_ERROR_CHECK(esp_zb_cluster_list_add_basic_cluster(temp_hum_clusters, basic_cluster, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
-    
-    /* Add Temperature measurement cluster with REPORTING flag */
-    static int16_t temp_value = 0x8000;  // Invalid value (0x8000)
-    static int16_t temp_min = 0x954D;    // -40°C in 0.01°C units
-    static int16_t temp_max = 0x7FFF;    // Max valid value
-    esp_zb_attribute_list_t *temp_cluster = esp_zb_zcl_attr_list_create(ESP_ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT);
-    ESP_ERROR_CHECK(esp_zb_cluster_add_attr(temp_cluster, ESP_ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT,
-                                            ESP_ZB_ZCL_ATTR_TEMP_MEASUREMENT_VALUE_ID, ESP_ZB_ZCL_ATTR_TYPE_S16,
-                                            ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING, &temp_value));
-    ESP_ERROR_CHECK(esp_zb_temperature_meas_cluster_add_attr(temp_cluster, ESP_ZB_ZCL_ATTR_TEMP_MEASUREMENT_MIN_VALUE_ID, &temp_min));
-    ESP_ERROR_CHECK(esp_zb_temperature_meas_cluster_add_attr(temp_cluster, ESP_ZB_ZCL_ATTR_TEMP_MEASUREMENT_MAX_VALUE_ID, &temp_max));
-    
-    /* Add custom calibration offset attributes to temperature cluster - use saved values */
-    int16_t temp_offset_default = settings_get_temperature_offset();
-    int16_t hum_offset_default = settings_get_humidity_offset();
-    uint16_t refresh_interval_default = settings_get_sensor_refresh_interval();
-    ESP_ERROR_CHECK(esp_zb_cluster_add_attr(temp_cluster, ESP_ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT,
-                                            ZCL_ATTR_TEMP_OFFSET, ESP_ZB_ZCL_ATTR_TYPE_S16,
-                                            ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE, &temp_offset_default));
-    ESP_ERROR_CHECK(esp_zb_cluster_add_attr(temp_cluster, ESP_ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT,
-                                            ZCL_ATTR_HUMIDITY_OFFSET, ESP_ZB_ZCL_ATTR_TYPE_S16,
-                                            ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE, &hum_offset_default));
-    ESP_ERROR_CHECK(esp_zb_cluster_add_attr(temp_cluster, ESP_ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT,
-                                            ZCL_ATTR_REFRESH_INTERVAL, ESP_ZB_ZCL_ATTR_TYPE_U16,
-                                            ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE, &refresh_interval_default));
-    
-    ESP_ERROR_CHECK(esp_zb_cluster_list_add_temperature_meas_cluster(temp_hum_clusters, temp_cluster, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
-    
-    /* Add Humidity measurement cluster with REPORTING flag */
-    static uint16_t hum_value = 0xFFFF;  // Invalid value
-    static uint16_t hum_min = 0;         // 0% RH
-    static uint16_t hum_max = 10000;     // 100% RH (in 0.01% units)
-    esp_zb_attribute_list_t *humidity_cluster = esp_zb_zcl_attr_list_create(ESP_ZB_ZCL_CLUSTER_ID_REL_HUMIDITY_MEASUREMENT);
-    ESP_ERROR_CHECK(esp_zb_cluster_add_attr(humidity_cluster, ESP_ZB_ZCL_CLUSTER_ID_REL_HUMIDITY_MEASUREMENT,
-                                            ESP_ZB_ZCL_ATTR_REL_HUMIDITY_MEASUREMENT_VALUE_ID, ESP_ZB_ZCL_ATTR_TYPE_U16,
-                                            ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING, &hum_value));
-    ESP_ERROR_CHECK(esp_zb_humidity_meas_cluster_add_attr(humidity_cluster, ESP_ZB_ZCL_ATTR_REL_HUMIDITY_MEASUREMENT_MIN_VALUE_ID, &hum_min));
-    ESP_ERROR_CHECK(esp_zb_humidity_meas_cluster_add_attr(humidity_cluster, ESP_ZB_ZCL_ATTR_REL_HUMIDITY_MEASUREMENT_MAX_VALUE_ID, &hum_max));
-    ESP_ERROR_CHECK(esp_zb_cluster_list_add_humidity_meas_cluster(temp_hum_clusters, humidity_cluster, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
-    
-    /* Add Identify cluster */
-    ESP_ERROR_CHECK(esp_zb_cluster_list_add_identify_cluster(temp_hum_clusters, esp_zb_identify_cluster_create(NULL), ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
-    
-    esp_zb_endpoint_config_t endpoint1_config = {
-        .endpoint = HA_ESP_TEMP_HUM_ENDPOINT,
-        .app_profile_id = ESP_ZB_AF_HA_PROFILE_ID,
-        .app_device_id = ESP_ZB_HA_TEMPERATURE_SENSOR_DEVICE_ID,
-        .app_device_version = 0
-    };
-    esp_zb_ep_list_add_ep(ep_list, temp_hum_clusters, endpoint1_config);
-    
-    /* Endpoint 2: Pressure with REPORTING flag */
-    esp_zb_cluster_list_t *pressure_clusters = esp_zb_zcl_cluster_list_create();
-    
-    /* Create Pressure measurement cluster with REPORTING flag */
-    static int16_t pressure_value = ESP_ZB_ZCL_ATTR_PRESSURE_MEASUREMENT_VALUE_UNKNOWN;
-    /* Zigbee Pressure Measurement cluster uses 0.1 hPa units (int16)
-     * Min: 300 hPa = 3000 in 0.1 hPa units
-     * Max: 1100 hPa = 11000 in 0.1 hPa units */
-    static int16_t pressure_min = 3000;   // 300 hPa in 0.1 hPa units
-    static int16_t pressure_max = 11000;  // 1100 hPa in 0.1 hPa units
-    esp_zb_attribute_list_t *pressure_cluster = esp_zb_zcl_attr_list_create(ESP_ZB_ZCL_CLUSTER_ID_PRESSURE_MEASUREMENT);
-    ESP_ERROR_CHECK(esp_zb_cluster_add_attr(pressure_cluster, ESP_ZB_ZCL_CLUSTER_ID_PRESSURE_MEASUREMENT,
-                                            ESP_ZB_ZCL_ATTR_PRESSURE_MEASUREMENT_VALUE_ID, ESP_ZB_ZCL_ATTR_TYPE_S16,
-                                            ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING, &pressure_value));
-    ESP_ERROR_CHECK(esp_zb_pressure_meas_cluster_add_attr(pressure_cluster, ESP_ZB_ZCL_ATTR_PRESSURE_MEASUREMENT_MIN_VALUE_ID, &pressure_min));
-    ESP_ERROR_CHECK(esp_zb_pressure_meas_cluster_add_attr(pressure_cluster, ESP_ZB_ZCL_ATTR_PRESSURE_MEASUREMENT_MAX_VALUE_ID, &pressure_max));
-    ESP_ERROR_CHECK(esp_zb_cluster_list_add_pressure_meas_cluster(pressure_clusters, pressure_cluster, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
-    ESP_ERROR_CHECK(esp_zb_cluster_list_add_identify_cluster(pressure_clusters, esp_zb_identify_cluster_create(NULL), ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
-    
-    esp_zb_endpoint_config_t endpoint2_config = {
-        .endpoint = HA_ESP_PRESSURE_ENDPOINT,
-        .app_profile_id = ESP_ZB_AF_HA_PROFILE_ID,
-        .app_device_id = ESP_ZB_HA_SIMPLE_SENSOR_DEVICE_ID,
-        .app_device_version = 0
-    };
-    esp_zb_ep_list_add_ep(ep_list, pressure_clusters, endpoint2_config);
-    
-    /* Endpoint 3: VOC Index - using Analog Input cluster with REPORTING flag */
-    esp_zb_cluster_list_t *voc_clusters = esp_zb_zcl_cluster_list_create();
-    
-    /* Create Analog Input cluster manually to set REPORTING flag on present_value from the start */
-    esp_zb_attribute_list_t *voc_cluster = esp_zb_zcl_attr_list_create(ESP_ZB_ZCL_CLUSTER_ID_ANALOG_INPUT);
-    /* Mandatory attributes for Analog Input cluster */
-    static bool voc_out_of_service = false;
-    static float voc_present_value = 0.0f;
-    static uint8_t voc_status_flags = 0;
-    esp_zb_cluster_add_attr(voc_cluster, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_INPUT,
-                            ESP_ZB_ZCL_ATTR_ANALOG_INPUT_OUT_OF_SERVICE_ID, ESP_ZB_ZCL_ATTR_TYPE_BOOL,
-                            ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY, &voc_out_of_service);
-    esp_zb_cluster_add_attr(voc_cluster, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_INPUT,
-                            ESP_ZB_ZCL_ATTR_ANALOG_INPUT_PRESENT_VALUE_ID, ESP_ZB_ZCL_ATTR_TYPE_SINGLE,
-                            ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING, &voc_present_value);
-    esp_zb_cluster_add_attr(voc_cluster, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_INPUT,
-                            ESP_ZB_ZCL_ATTR_ANALOG_INPUT_STATUS_FLAGS_ID, ESP_ZB_ZCL_ATTR_TYPE_8BITMAP,
-                            ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY, &voc_status_flags);
-    char voc_desc[] = "\x09""VOC Index";
-    esp_zb_cluster_add_attr(voc_cluster, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_INPUT,
-                            ESP_ZB_ZCL_ATTR_ANALOG_INPUT_DESCRIPTION_ID, ESP_ZB_ZCL_ATTR_TYPE_CHAR_STRING,
-                            ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY, voc_desc);
-    ESP_ERROR_CHECK(esp_zb_cluster_list_add_analog_input_cluster(voc_clusters, voc_cluster, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
-    ESP_ERROR_CHECK(esp_zb_cluster_list_add_identify_cluster(voc_clusters, esp_zb_identify_cluster_create(NULL), ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
-    
-    esp_zb_endpoint_config_t endpoint3_config = {
-        .endpoint = HA_ESP_VOC_ENDPOINT,
-        .app_profile_id = ESP_ZB_AF_HA_PROFILE_ID,
-        .app_device_id = ESP_ZB_HA_SIMPLE_SENSOR_DEVICE_ID,
-        .app_device_version = 0
-    };
-    esp_zb_ep_list_add_ep(ep_list, voc_clusters, endpoint3_config);
-    
-    /* Endpoint 4: NOx Index - using Analog Input cluster with REPORTING flag */
-    esp_zb_cluster_list_t *nox_clusters = esp_zb_zcl_cluster_list_create();
-    
-    /* Create Analog Input cluster manually to set REPORTING flag on present_value from the start */
-    esp_zb_attribute_list_t *nox_cluster = esp_zb_zcl_attr_list_create(ESP_ZB_ZCL_CLUSTER_ID_ANALOG_INPUT);
-    /* Mandatory attributes for Analog Input cluster */
-    static bool nox_out_of_service = false;
-    static float nox_present_value = 0.0f;
-    static uint8_t nox_status_flags = 0;
-    esp_zb_cluster_add_attr(nox_cluster, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_INPUT,
-                            ESP_ZB_ZCL_ATTR_ANALOG_INPUT_OUT_OF_SERVICE_ID, ESP_ZB_ZCL_ATTR_TYPE_BOOL,
-                            ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY, &nox_out_of_service);
-    esp_zb_cluster_add_attr(nox_cluster, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_INPUT,
-                            ESP_ZB_ZCL_ATTR_ANALOG_INPUT_PRESENT_VALUE_ID, ESP_ZB_ZCL_ATTR_TYPE_SINGLE,
-                            ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING, &nox_present_value);
-    esp_zb_cluster_add_attr(nox_cluster, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_INPUT,
-                            ESP_ZB_ZCL_ATTR_ANALOG_INPUT_STATUS_FLAGS_ID, ESP_ZB_ZCL_ATTR_TYPE_8BITMAP,
-                            ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY, &nox_status_flags);
-    char nox_desc[] = "\x09""NOx Index";
-    esp_zb_cluster_add_attr(nox_cluster, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_INPUT,
-                            ESP_ZB_ZCL_ATTR_ANALOG_INPUT_DESCRIPTION_ID, ESP_ZB_ZCL_ATTR_TYPE_CHAR_STRING,
-                            ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY, nox_desc);
-    ESP_ERROR_CHECK(esp_zb_cluster_list_add_analog_input_cluster(nox_clusters, nox_cluster, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
-    ESP_ERROR_CHECK(esp_zb_cluster_list_add_identify_cluster(nox_clusters, esp_zb_identify_cluster_create(NULL), ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
-    
-    esp_zb_endpoint_config_t endpoint4_config = {
-        .endpoint = HA_ESP_NOX_ENDPOINT,
-        .app_profile_id = ESP_ZB_AF_HA_PROFILE_ID,
-        .app_device_id = ESP_ZB_HA_SIMPLE_SENSOR_DEVICE_ID,
-        .app_device_version = 0
-    };
-    esp_zb_ep_list_add_ep(ep_list, nox_clusters, endpoint4_config);
-    
-    /* Endpoint 5: CO2 - using Carbon Dioxide Measurement cluster with REPORTING flag */
-    esp_zb_cluster_list_t *co2_clusters = esp_zb_zcl_cluster_list_create();
-    
-    /* CO2 measurement cluster with REPORTING flag */
-    static float co2_measured_value = 0;
-    static float co2_min_measured_value = 400;   // 400 ppm
-    static float co2_max_measured_value = 5000;  // 5000 ppm
-    esp_zb_attribute_list_t *co2_cluster = esp_zb_zcl_attr_list_create(ESP_ZB_ZCL_CLUSTER_ID_CARBON_DIOXIDE_MEASUREMENT);
-    ESP_ERROR_CHECK(esp_zb_cluster_add_attr(co2_cluster, ESP_ZB_ZCL_CLUSTER_ID_CARBON_DIOXIDE_MEASUREMENT,
-                                            ESP_ZB_ZCL_ATTR_CARBON_DIOXIDE_MEASUREMENT_MEASURED_VALUE_ID, ESP_ZB_ZCL_ATTR_TYPE_SINGLE,
-                                            ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING, &co2_measured_value));
-    ESP_ERROR_CHECK(esp_zb_carbon_dioxide_measurement_cluster_add_attr(co2_cluster, ESP_ZB_ZCL_ATTR_CARBON_DIOXIDE_MEASUREMENT_MIN_MEASURED_VALUE_ID, &co2_min_measured_value));
-    ESP_ERROR_CHECK(esp_zb_carbon_dioxide_measurement_cluster_add_attr(co2_cluster, ESP_ZB_ZCL_ATTR_CARBON_DIOXIDE_MEASUREMENT_MAX_MEASURED_VALUE_ID, &co2_max_measured_value));
-    ESP_ERROR_CHECK(esp_zb_cluster_list_add_carbon_dioxide_measurement_cluster(co2_clusters, co2_cluster, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
-    ESP_ERROR_CHECK(esp_zb_cluster_list_add_identify_cluster(co2_clusters, esp_zb_identify_cluster_create(NULL), ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
-    
-    esp_zb_endpoint_config_t endpoint5_config = {
-        .endpoint = HA_ESP_CO2_ENDPOINT,
-        .app_profile_id = ESP_ZB_AF_HA_PROFILE_ID,
-        .app_device_id = ESP_ZB_HA_SIMPLE_SENSOR_DEVICE_ID,
-        .app_device_version = 0
-    };
-    esp_zb_ep_list_add_ep(ep_list, co2_clusters, endpoint5_config);
-    
-    /* Endpoint 6: LED Configuration */
-    esp_zb_cluster_list_t *led_clusters = esp_zb_zcl_cluster_list_create();
-    
-    /* On/Off cluster for LED enable/disable - use saved value */
-    bool saved_leds_enabled = settings_get_sensor_leds_enabled();
-    esp_zb_on_off_cluster_cfg_t led_on_off_cfg = {
-        .on_off = saved_leds_enabled,
-    };
-    esp_zb_attribute_list_t *led_on_off_cluster = esp_zb_on_off_cluster_create(&led_on_off_cfg);
-    ESP_ERROR_CHECK(esp_zb_cluster_list_add_on_off_cluster(led_clusters, led_on_off_cluster, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
-    
-    /* Add custom attributes for thresholds using Analog Output cluster as a container */
-    esp_zb_analog_output_cluster_cfg_t led_config_cfg = {
-        .present_value = 0.0f,  // Unused, just a placeholder
-    };
-    esp_zb_attribute_list_t *led_config_cluster = esp_zb_analog_output_cluster_create(&led_config_cfg);
-    
-    /* Add description attribute to avoid UNSUPPORTED_ATTRIBUTE errors */
-    static char led_config_desc[17] = "\x0D""LED Thresholds";
-    esp_zb_analog_output_cluster_add_attr(led_config_cluster, ESP_ZB_ZCL_ATTR_ANALOG_OUTPUT_DESCRIPTION_ID, led_config_desc);
-    
-    /* NOTE: esp_zb_analog_output_cluster_create() already adds these standard attributes:
-     * - present_value, out_of_service, status_flags (mandatory)
-     * - min_present_value, max_present_value, resolution (optional but included)
-     * Do NOT add them again to avoid duplicate attribute errors */
-    
-    /* Add threshold attributes (all uint16_t) - use generic esp_zb_cluster_add_attr for custom attributes */
-    uint16_t voc_orange_default = 150;
-    uint16_t voc_red_default = 250;
-    uint16_t nox_orange_default = 150;
-    uint16_t nox_red_default = 250;
-    uint16_t co2_orange_default = 1000;
-    uint16_t co2_red_default = 1500;
-    uint16_t hum_orange_low_default = 30;
-    uint16_t hum_orange_high_default = 70;
-    uint16_t hum_red_low_default = 20;
-    uint16_t hum_red_high_default = 80;
-    uint8_t led_mask_default = settings_get_led_mask();  // Use saved value
-    uint8_t led_brightness_default = settings_get_led_brightness();  // Use saved value
-    
-    /* Custom manufacturer-specific attributes (0xF000-0xFFFF range) must use generic add_attr */
-    esp_zb_cluster_add_attr(led_config_cluster, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_OUTPUT,
-                            ZCL_LED_ATTR_VOC_ORANGE, ESP_ZB_ZCL_ATTR_TYPE_U16,
-                            ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE, &voc_orange_default);
-    esp_zb_cluster_add_attr(led_config_cluster, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_OUTPUT,
-                            ZCL_LED_ATTR_VOC_RED, ESP_ZB_ZCL_ATTR_TYPE_U16,
-                            ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE, &voc_red_default);
-    esp_zb_cluster_add_attr(led_config_cluster, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_OUTPUT,
-                            ZCL_LED_ATTR_NOX_ORANGE, ESP_ZB_ZCL_ATTR_TYPE_U16,
-                            ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE, &nox_orange_default);
-    esp_zb_cluster_add_attr(led_config_cluster, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_OUTPUT,
-                            ZCL_LED_ATTR_NOX_RED, ESP_ZB_ZCL_ATTR_TYPE_U16,
-                            ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE, &nox_red_default);
-    esp_zb_cluster_add_attr(led_config_cluster, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_OUTPUT,
-                            ZCL_LED_ATTR_CO2_ORANGE, ESP_ZB_ZCL_ATTR_TYPE_U16,
-                            ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE, &co2_orange_default);
-    esp_zb_cluster_add_attr(led_config_cluster, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_OUTPUT,
-                            ZCL_LED_ATTR_CO2_RED, ESP_ZB_ZCL_ATTR_TYPE_U16,
-                            ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE, &co2_red_default);
-    esp_zb_cluster_add_attr(led_config_cluster, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_OUTPUT,
-                            ZCL_LED_ATTR_HUM_ORANGE_LOW, ESP_ZB_ZCL_ATTR_TYPE_U16,
-                            ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE, &hum_orange_low_default);
-    esp_zb_cluster_add_attr(led_config_cluster, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_OUTPUT,
-                            ZCL_LED_ATTR_HUM_ORANGE_HIGH, ESP_ZB_ZCL_ATTR_TYPE_U16,
-                            ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE, &hum_orange_high_default);
-    esp_zb_cluster_add_attr(led_config_cluster, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_OUTPUT,
-                            ZCL_LED_ATTR_HUM_RED_LOW, ESP_ZB_ZCL_ATTR_TYPE_U16,
-                            ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE, &hum_red_low_default);
-    esp_zb_cluster_add_attr(led_config_cluster, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_OUTPUT,
-                            ZCL_LED_ATTR_HUM_RED_HIGH, ESP_ZB_ZCL_ATTR_TYPE_U16,
-                            ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE, &hum_red_high_default);
-    esp_zb_cluster_add_attr(led_config_cluster, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_OUTPUT,
-                            ZCL_LED_ATTR_ENABLE_MASK, ESP_ZB_ZCL_ATTR_TYPE_U8,
-                            ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE, &led_mask_default);
-    esp_zb_cluster_add_attr(led_config_cluster, ESP_ZB_ZCL_CLUSTER_ID_ANALOG_OUTPUT,
-                            ZCL_LED_ATTR_BRIGHTNESS, ESP_ZB_ZCL_ATTR_TYPE_U8,
-                            ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE, &led_brightness_default);
-    
-    ESP_ERROR_CHECK(esp_zb_cluster_list_add_analog_output_cluster(led_clusters, led_config_cluster, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
-    ESP_ERROR_CHECK(esp_zb_cluster_list_add_identify_cluster(led_clusters, esp_zb_identify_cluster_create(NULL), ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
-    
-    /* Add Level Control cluster for LED brightness (manually create with write access) */
-    esp_zb_attribute_list_t *level_cluster = esp_zb_zcl_attr_list_create(ESP_ZB_ZCL_CLUSTER_ID_LEVEL_CONTROL);
-    uint8_t current_level = settings_get_led_brightness();  // Use saved value
-    ESP_ERROR_CHECK(esp_zb_cluster_add_attr(level_cluster, ESP_ZB_ZCL_CLUSTER_ID_LEVEL_CONTROL,
-                                            ESP_ZB_ZCL_ATTR_LEVEL_CONTROL_CURRENT_LEVEL_ID, ESP_ZB_ZCL_ATTR_TYPE_U8,
-                                            ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING, &current_level));
-    ESP_ERROR_CHECK(esp_zb_cluster_list_add_level_cluster(led_clusters, level_cluster, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
-    
-    esp_zb_endpoint_config_t endpoint6_config = {
-        .endpoint = HA_ESP_LED_CONFIG_ENDPOINT,
-        .app_profile_id = ESP_ZB_AF_HA_PROFILE_ID,
-        .app_device_id = ESP_ZB_HA_ON_OFF_OUTPUT_DEVICE_ID,
-        .app_device_version = 0
-    };
-    esp_zb_ep_list_add_ep(ep_list, led_clusters, endpoint6_config);
-    
-    /* Endpoint 10: Zigbee Status LED */
-    esp_zb_cluster_list_t *status_led_clusters = esp_zb_zcl_cluster_list_create();
-    
-    /* On/Off cluster for status LED enable/disable - use saved value */
-    bool saved_status_led_enabled = settings_get_status_led_enabled();
-    esp_zb_on_off_cluster_cfg_t status_led_on_off_cfg = {
-        .on_off = saved_status_led_enabled,
-    };
-    esp_zb_attribute_list_t *status_led_on_off_cluster = esp_zb_on_off_cluster_create(&status_led_on_off_cfg);
-    ESP_ERROR_CHECK(esp_zb_cluster_list_add_on_off_cluster(status_led_clusters, status_led_on_off_cluster, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
-    ESP_ERROR_CHECK(esp_zb_cluster_list_add_identify_cluster(status_led_clusters, esp_zb_identify_cluster_create(NULL), ESP_ZB_ZCL_CLUSTER_SERVER_ROLE));
-    
-    esp_zb_endpoint_config_t endpoint7_config = {
-        .endpoint = HA_ESP_STATUS_LED_ENDPOINT,
-        .app_profile_id = ESP_ZB_AF_HA_PROFILE_ID,
-        .app_device_id = ESP_ZB_HA_ON_OFF_LIGHT_DEVICE_ID,
-        .app_device_version = 0
-    };
-    esp_zb_ep_list_add_ep(ep_list, status_led_clusters, endpoint7_config);
+    /* Endpoints, clusters and attributes from the layout tables (zb_endpoints.c) */
+    int64_t build_start_us = esp_timer_get_time();
+    esp_zb_ep_list_t *ep_list = zb_endpoints_create();
+    int64_t build_us = esp_timer_get_time() - build_start_us;
     
     /* Add manufacturer info to primary endpoint */
     zcl_basic_manufacturer_info_t info = {
@@ -1035,14 +880,22 @@ static void esp_zb_task(void *pvParameters)
     /* Register the device */
     esp_zb_device_register(ep_list);
     esp_zb_core_action_handler_register(zb_action_handler);
+    esp_zb_identify_notify_handler_register(HA_ESP_TEMP_HUM_ENDPOINT, status_led_identify_cb);
+    esp_zb_identify_notify_handler_register(HA_ESP_STATUS_LED_ENDPOINT, status_led_identify_cb);
     esp_zb_set_primary_network_channel_set(ESP_ZB_PRIMARY_CHANNEL_MASK);
     
+    ESP_LOGI(TAG, "Startup: %lld ms from app_main to esp_zb_start (endpoints built in %lld us)",
+             (esp_timer_get_time() - s_app_main_us) / 1000, build_us);
+    boot_profile_mark(BOOT_MS_ZB_START);
     ESP_ERROR_CHECK(esp_zb_start(false));
     esp_zb_stack_main_loop();
 }
 
 void app_main(void)
 {
+    s_app_main_us = esp_timer_get_time();
+    boot_profile_init();
+    
     esp_zb_platform_config_t config = {
         .radio_config = ESP_ZB_DEFAULT_RADIO_CONFIG(),
         .host_config = ESP_ZB_DEFAULT_HOST_CONFIG(),
@@ -1050,11 +903,35 @@ void app_main(void)
     
     ESP_ERROR_CHECK(nvs_flash_init());
     
+#if CONFIG_PM_ENABLE
+    /* Dynamic frequency scaling: drivers raise the clock only while they hold a PM lock */
+    esp_pm_config_t pm_config = {
+        .max_freq_mhz = AERIS_PM_MAX_CPU_FREQ_MHZ,
+        .min_freq_mhz = AERIS_PM_MIN_CPU_FREQ_MHZ,
+        .light_sleep_enable = false,
+    };
+    esp_err_t pm_ret = esp_pm_configure(&pm_config);
+    if (pm_ret != ESP_OK) {
+        ESP_LOGW(TAG, "Power management not configured: %s", esp_err_to_name(pm_ret));
+    } else {
+        ESP_LOGI(TAG, "Power management: DFS %d-%d MHz, tickless idle",
+                 AERIS_PM_MIN_CPU_FREQ_MHZ, AERIS_PM_MAX_CPU_FREQ_MHZ);
+    }
+#endif
+    
+    /* Binary log drain task (hot-path logs, decode with tools/binlog_decode.py) */
+    binlog_init();
+    
+    /* Event tracer (AERIS_ENABLE_TRACE builds, convert dumps with tools/trace_to_perfetto.py) */
+    event_trace_init();
+    
     /* Initialize settings from NVS early so they're available for cluster creation */
     ESP_LOGI(TAG, "Loading settings from NVS...");
     settings_init();
+    boot_profile_mark(BOOT_MS_SETTINGS_INIT);
     
     ESP_ERROR_CHECK(esp_zb_platform_config(&config));
+    boot_profile_mark(BOOT_MS_PLATFORM_CONFIG);
     
     /* OTA validation */
     ota_validation_start();
@@ -1062,4 +939,7 @@ void app_main(void)
     ota_validation_zigbee_init_ok();
     
     xTaskCreate(esp_zb_task, "Zigbee_main", 4096, NULL, 5, NULL);
+    
+    /* Benchmark/diagnostics REPL on the serial console */
+    aeris_console_start();
 }
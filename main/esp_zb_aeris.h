@@ -22,6 +22,7 @@
 #define HA_ESP_CO2_ENDPOINT             5                                    /* CO2 sensor endpoint */
 #define HA_ESP_LED_CONFIG_ENDPOINT      6                                    /* LED configuration endpoint */
 #define HA_ESP_STATUS_LED_ENDPOINT      7                                    /* Zigbee status LED endpoint */
+#define HA_ESP_FAN_ENDPOINT             8                                    /* Fan mode and auto curve endpoint */
 
 /* Custom attribute IDs for LED thresholds (manufacturer-specific range 0xF000-0xFFFF) */
 #define ZCL_LED_ATTR_VOC_ORANGE         0xF000
@@ -42,9 +43,41 @@
 #define ZCL_ATTR_TEMP_OFFSET            0xF00F  // Temperature offset in 0.1°C (signed int16, e.g., 30 = 3.0°C)
 #define ZCL_ATTR_HUMIDITY_OFFSET        0xF010  // Humidity offset in 0.1% (signed int16, e.g., 10 = 1.0%)
 #define ZCL_ATTR_REFRESH_INTERVAL       0xF011  // Sensor refresh interval in seconds (10-3600)
+#define ZCL_ATTR_LOG_LEVEL              0xF012  // Runtime log verbosity (esp_log_level_t: 0=none .. 5=verbose)
+#define ZCL_ATTR_PERF_SUMMARY           0xF013  // Latency percentiles (octet string, see perf_stats.h)
+#define ZCL_LED_ATTR_DISPLAY_MODE       0xF014  // Sensor LED display mode (0=thresholds, 1=gradient)
+#define ZCL_ATTR_CONFIG                 0xF020  // Whole configuration as one TLV record (octet string, see config_tlv.h)
+
+/* Fan auto mode curve (Fan Control cluster 0x0202 on endpoint 8, see fan_curve_t) */
+#define ZCL_FAN_ATTR_IDLE_PERCENT       0xF000  // Speed in clean air, % (uint8, 0 = off)
+#define ZCL_FAN_ATTR_HYSTERESIS         0xF001  // Demand drop before slowing down, % (uint8)
+#define ZCL_FAN_ATTR_RAMP_DOWN          0xF002  // Slow-down rate, % per minute (uint8)
+#define ZCL_FAN_ATTR_TEMP_START         0xF003  // Temperature where the fan starts ramping, °C (uint16)
+#define ZCL_FAN_ATTR_TEMP_FULL          0xF004  // Temperature for full speed, °C (uint16)
+#define ZCL_FAN_ATTR_VOC_START          0xF005  // VOC index (uint16)
+#define ZCL_FAN_ATTR_VOC_FULL           0xF006
+#define ZCL_FAN_ATTR_CO2_START          0xF007  // CO2, ppm (uint16)
+#define ZCL_FAN_ATTR_CO2_FULL           0xF008
+#define ZCL_FAN_ATTR_HUM_START          0xF009  // Relative humidity, % (uint16)
+#define ZCL_FAN_ATTR_HUM_FULL           0xF00A
+#define ZCL_FAN_ATTR_RPM                0xF00B  // Measured fan speed, RPM (uint16, read-only)
+#define ZCL_FAN_ATTR_FAULT              0xF00F  // Fan commanded on but not turning (bool, read-only, reported)
+
+/* Purge-then-measure sequencing (same cluster, see fan_purge_t) */
+#define ZCL_FAN_ATTR_PURGE_TIME         0xF00C  // Purge before each sample, seconds (uint16, 0 = off)
+#define ZCL_FAN_ATTR_PURGE_SPEED        0xF00D  // Speed during the purge, % (uint8)
+#define ZCL_FAN_ATTR_MEASURE_SPEED      0xF00E  // Speed while the sensors settle and are read, % (uint8)
+
+/* Closed-loop airflow (same cluster) */
+#define ZCL_FAN_ATTR_FULL_RPM           0xF010  // RPM at 100% speed (uint16, 0 = open-loop duty)
 
 #define ESP_ZB_PRIMARY_CHANNEL_MASK     ESP_ZB_TRANSCEIVER_ALL_CHANNELS_MASK /* Zigbee primary channel mask use in the example */
 
+/* Power management (DFS + tickless idle). Light sleep stays disabled because a
+ * router must keep its receiver on; the 802.15.4 driver holds its own locks. */
+#define AERIS_PM_MAX_CPU_FREQ_MHZ       160                                  /* Full speed while any PM lock is held */
+#define AERIS_PM_MIN_CPU_FREQ_MHZ       40                                   /* XTAL clock when idle */
+
 /* Button configuration */
 #define ESP_INTR_FLAG_DEFAULT 0
 
@@ -85,4 +118,12 @@
         .host_connection_mode = ZB_HOST_CONNECTION_MODE_NONE,   \
     }
 
+/**
+ * @brief Run one acquisition cycle now (sensor reads, attributes, LEDs)
+ *
+ * Does not move the periodic schedule. Call from the Zigbee task or with the
+ * Zigbee lock held (esp_zb_lock_acquire()).
+ */
+void aeris_zb_update_now(void);
+
 #endif
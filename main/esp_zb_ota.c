@@ -12,6 +12,12 @@
 #include "nvs_flash.h"
 #include "esp_zigbee_core.h"
 #include "zcl/esp_zigbee_zcl_ota.h"
+#include "esp_pm.h"
+#include "freertos/FreeRTOS.h"
+#include "binlog.h"
+#include "settings.h"
+#include "perf_stats.h"
+#include "event_trace.h"
 
 static const char *TAG = "ESP_ZB_OTA";
 
@@ -24,6 +30,41 @@ static esp_ota_handle_t update_handle = 0;
 static uint32_t binary_file_len = 0;
 static uint32_t total_received = 0;
 
+/* Inactive slot lent to a diagnostic (bench flash); no download starts meanwhile */
+static portMUX_TYPE ota_slot_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool ota_slot_borrowed = false;
+
+#if CONFIG_PM_ENABLE
+/* Keeps the CPU at full speed for the duration of an OTA transfer */
+static esp_pm_lock_handle_t ota_pm_lock = NULL;
+static bool ota_pm_lock_held = false;
+#endif
+
+/**
+ * @brief Hold or release the OTA power management lock
+ */
+static void ota_pm_lock_set(bool hold)
+{
+#if CONFIG_PM_ENABLE
+    if (!ota_pm_lock) {
+        esp_err_t ret = esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "zb_ota", &ota_pm_lock);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to create OTA PM lock: %s", esp_err_to_name(ret));
+            return;
+        }
+    }
+    if (hold == ota_pm_lock_held) {
+        return;
+    }
+    if (hold) {
+        esp_pm_lock_acquire(ota_pm_lock);
+    } else {
+        esp_pm_lock_release(ota_pm_lock);
+    }
+    ota_pm_lock_held = hold;
+#endif
+}
+
 /**
  * @brief Initialize OTA functionality
  */
@@ -62,21 +103,32 @@ esp_err_t zb_ota_upgrade_value_handler(esp_zb_zcl_ota_upgrade_value_message_t me
     esp_err_t ret = ESP_OK;
 
     switch (message.upgrade_status) {
-        case ESP_ZB_ZCL_OTA_UPGRADE_STATUS_START:
+        case ESP_ZB_ZCL_OTA_UPGRADE_STATUS_START: {
+            portENTER_CRITICAL(&ota_slot_lock);
+            bool borrowed = ota_slot_borrowed;
+            ota_upgrade_status = borrowed ? ESP_ZB_ZCL_OTA_UPGRADE_STATUS_ERROR
+                                          : ESP_ZB_ZCL_OTA_UPGRADE_STATUS_START;
+            portEXIT_CRITICAL(&ota_slot_lock);
+            if (borrowed) {
+                ESP_LOGW(TAG, "OTA refused: update partition in use by a benchmark");
+                return ESP_ERR_INVALID_STATE;
+            }
             ESP_LOGI(TAG, "OTA upgrade started");
-            ota_upgrade_status = ESP_ZB_ZCL_OTA_UPGRADE_STATUS_START;
             total_received = 0;
             binary_file_len = 0;
+            ota_pm_lock_set(true);
 
             // Begin OTA update
             ret = esp_ota_begin(update_partition, OTA_SIZE_UNKNOWN, &update_handle);
             if (ret != ESP_OK) {
                 ESP_LOGE(TAG, "esp_ota_begin failed: %s", esp_err_to_name(ret));
                 ota_upgrade_status = ESP_ZB_ZCL_OTA_UPGRADE_STATUS_ERROR;
+                ota_pm_lock_set(false);
                 return ret;
             }
             ESP_LOGI(TAG, "OTA write session started");
             break;
+        }
 
         case ESP_ZB_ZCL_OTA_UPGRADE_STATUS_RECEIVE:
             // Handle the first chunk specially to detect and skip OTA header
@@ -103,35 +155,45 @@ esp_err_t zb_ota_upgrade_value_handler(esp_zb_zcl_ota_upgrade_value_message_t me
                     ESP_LOGI(TAG, "Writing %d bytes from first chunk", 
                              message.payload_size - magic_offset);
                     
+                    PERF_BEGIN(t0);
+                    TRACE_BEGIN(TRACE_OTA_WRITE, message.payload_size - magic_offset);
                     ret = esp_ota_write(update_handle, message.payload + magic_offset, 
                                       message.payload_size - magic_offset);
+                    TRACE_END(TRACE_OTA_WRITE, ret);
+                    PERF_END(PERF_OTA_WRITE, t0);
                     total_received += message.payload_size - magic_offset;
                 } else {
                     ESP_LOGE(TAG, "No ESP32 magic byte (0xE9) found in first %d bytes", 
                              message.payload_size);
                     ESP_LOGE(TAG, "Cannot proceed with OTA update");
                     ota_upgrade_status = ESP_ZB_ZCL_OTA_UPGRADE_STATUS_ERROR;
+                    ota_pm_lock_set(false);
                     return ESP_ERR_INVALID_ARG;
                 }
             } else {
                 // Subsequent chunks - write directly
-                ESP_LOGD(TAG, "OTA receiving chunk: %d bytes (total: %ld bytes)",
-                         message.payload_size, total_received);
+                BINLOGD(TAG, "OTA receiving chunk: %d bytes (total: %ld bytes)",
+                        message.payload_size, total_received);
                 
+                PERF_BEGIN(t0);
+                TRACE_BEGIN(TRACE_OTA_WRITE, message.payload_size);
                 ret = esp_ota_write(update_handle, message.payload, message.payload_size);
+                TRACE_END(TRACE_OTA_WRITE, ret);
+                PERF_END(PERF_OTA_WRITE, t0);
                 total_received += message.payload_size;
             }
             
             if (ret != ESP_OK) {
                 ESP_LOGE(TAG, "esp_ota_write failed: %s", esp_err_to_name(ret));
                 ota_upgrade_status = ESP_ZB_ZCL_OTA_UPGRADE_STATUS_ERROR;
+                ota_pm_lock_set(false);
                 return ret;
             }
             
             // Log progress every ~50KB
             static uint32_t last_log = 0;
             if (total_received - last_log > 50000) {
-                ESP_LOGI(TAG, "OTA progress: %ld bytes written", total_received);
+                BINLOGI(TAG, "OTA progress: %ld bytes written", total_received);
                 last_log = total_received;
             }
             break;
@@ -144,6 +206,7 @@ esp_err_t zb_ota_upgrade_value_handler(esp_zb_zcl_ota_upgrade_value_message_t me
             if (ret != ESP_OK) {
                 ESP_LOGE(TAG, "esp_ota_end failed: %s", esp_err_to_name(ret));
                 ota_upgrade_status = ESP_ZB_ZCL_OTA_UPGRADE_STATUS_ERROR;
+                ota_pm_lock_set(false);
                 return ret;
             }
 
@@ -154,6 +217,7 @@ esp_err_t zb_ota_upgrade_value_handler(esp_zb_zcl_ota_upgrade_value_message_t me
             if (ret != ESP_OK) {
                 ESP_LOGE(TAG, "Failed to get new app description: %s", esp_err_to_name(ret));
                 ota_upgrade_status = ESP_ZB_ZCL_OTA_UPGRADE_STATUS_ERROR;
+                ota_pm_lock_set(false);
                 return ret;
             }
             
@@ -165,6 +229,7 @@ esp_err_t zb_ota_upgrade_value_handler(esp_zb_zcl_ota_upgrade_value_message_t me
             if (ret != ESP_OK) {
                 ESP_LOGE(TAG, "esp_ota_set_boot_partition failed: %s", esp_err_to_name(ret));
                 ota_upgrade_status = ESP_ZB_ZCL_OTA_UPGRADE_STATUS_ERROR;
+                ota_pm_lock_set(false);
                 return ret;
             }
 
@@ -181,6 +246,7 @@ esp_err_t zb_ota_upgrade_value_handler(esp_zb_zcl_ota_upgrade_value_message_t me
             // Reboot to apply the update
             // After reboot, the new firmware will be in ESP_OTA_IMG_PENDING_VERIFY state
             // and must call esp_ota_mark_app_valid_cancel_rollback() to confirm it works
+            settings_flush();
             esp_restart();
             break;
 
@@ -192,11 +258,13 @@ esp_err_t zb_ota_upgrade_value_handler(esp_zb_zcl_ota_upgrade_value_message_t me
         case ESP_ZB_ZCL_OTA_UPGRADE_STATUS_FINISH:
             ESP_LOGI(TAG, "OTA upgrade finished successfully");
             ota_upgrade_status = ESP_ZB_ZCL_OTA_UPGRADE_STATUS_FINISH;
+            ota_pm_lock_set(false);
             break;
 
         case ESP_ZB_ZCL_OTA_UPGRADE_STATUS_ERROR:
             ESP_LOGE(TAG, "OTA upgrade error");
             ota_upgrade_status = ESP_ZB_ZCL_OTA_UPGRADE_STATUS_ERROR;
+            ota_pm_lock_set(false);
 
             // Abort OTA if it was started
             if (update_handle) {
@@ -253,6 +321,34 @@ esp_zb_zcl_ota_upgrade_status_t esp_zb_ota_get_status(void)
     return ota_upgrade_status;
 }
 
+const esp_partition_t *esp_zb_ota_slot_borrow(void)
+{
+    /* The inactive slot is the rollback image until the running one is validated */
+    esp_ota_img_states_t state;
+    if (esp_ota_get_state_partition(esp_ota_get_running_partition(), &state) == ESP_OK &&
+        state == ESP_OTA_IMG_PENDING_VERIFY) {
+        return NULL;
+    }
+
+    const esp_partition_t *part = esp_ota_get_next_update_partition(NULL);
+    portENTER_CRITICAL(&ota_slot_lock);
+    if (ota_slot_borrowed || ota_upgrade_status == ESP_ZB_ZCL_OTA_UPGRADE_STATUS_START ||
+        ota_upgrade_status == ESP_ZB_ZCL_OTA_UPGRADE_STATUS_RECEIVE) {
+        part = NULL;
+    } else if (part) {
+        ota_slot_borrowed = true;
+    }
+    portEXIT_CRITICAL(&ota_slot_lock);
+    return part;
+}
+
+void esp_zb_ota_slot_return(void)
+{
+    portENTER_CRITICAL(&ota_slot_lock);
+    ota_slot_borrowed = false;
+    portEXIT_CRITICAL(&ota_slot_lock);
+}
+
 /**
  * @brief Get current firmware version
  */
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "esp_err.h"
+#include "esp_partition.h"
 #include "esp_zigbee_core.h"
 
 // OTA manufacturer and image type definitions
@@ -38,6 +39,22 @@ esp_err_t esp_zb_ota_register_callbacks(void);
  */
 esp_zb_zcl_ota_upgrade_status_t esp_zb_ota_get_status(void);
 
+/**
+ * @brief Borrow the inactive OTA partition for a diagnostic that overwrites it
+ *
+ * Refused while an OTA download runs and while the running image is still
+ * pending verification (the inactive slot then holds the rollback image).
+ * OTA downloads are refused until esp_zb_ota_slot_return().
+ *
+ * @return The partition, or NULL if it cannot be lent now
+ */
+const esp_partition_t *esp_zb_ota_slot_borrow(void);
+
+/**
+ * @brief Give back the partition from esp_zb_ota_slot_borrow()
+ */
+void esp_zb_ota_slot_return(void);
+
 /**
  * @brief Get current firmware version
  * 
@@ -0,0 +1,211 @@
+/*
+ * RAM event tracer implementation for Aeris_Lite
+ *
+ * Producers (tasks, ISRs and the FreeRTOS task-switch hook) append to an
+ * overwrite-oldest ring under a spinlock; the ring always holds the last
+ * EVENT_TRACE_RING_EVENTS events. Dumping pauses recording, prints the ring
+ * plus name tables for trace IDs and task handles, then clears it.
+ */
+
+#include "event_trace.h"
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+static const char *TAG = "TRACE";
+
+#if AERIS_TRACE_ENABLE
+
+static const char *TRACE_NAMES[TRACE_ID_MAX] = {
+    [TRACE_ID_NONE] = "task",
+    [TRACE_ISR_BUTTON] = "isr_button",
+    [TRACE_ISR_RMT_DONE] = "isr_rmt_done",
+    [TRACE_ISR_PCNT_WATCH] = "isr_pcnt_watch",
+    [TRACE_I2C_SHT45] = "i2c_sht45",
+    [TRACE_I2C_LPS22HB] = "i2c_lps22hb",
+    [TRACE_I2C_SGP41] = "i2c_sgp41",
+    [TRACE_I2C_SCD40] = "i2c_scd40",
+    [TRACE_ZB_SIGNAL] = "zb_signal",
+    [TRACE_ALARM_SENSOR_UPDATE] = "alarm_sensor_update",
+    [TRACE_ALARM_COMMISSIONING] = "alarm_commissioning",
+    [TRACE_ALARM_FACTORY_RESET] = "alarm_factory_reset",
+    [TRACE_NVS_COMMIT] = "nvs_commit",
+    [TRACE_ACQUISITION] = "acquisition",
+    [TRACE_LED_REFRESH] = "led_refresh",
+    [TRACE_OTA_WRITE] = "ota_write",
+};
+
+#define EVENT_TRACE_TASKS_MAX       24      /* Upper bound on tasks in the name table */
+
+/* Module state */
+static trace_event_t s_ring[EVENT_TRACE_RING_EVENTS];
+static uint32_t s_head = 0;                 /* Total events written (next slot = head % size) */
+static volatile bool s_running = false;
+static volatile bool s_dump_pending = false;
+static portMUX_TYPE s_trace_lock = portMUX_INITIALIZER_UNLOCKED;
+
+void IRAM_ATTR event_trace_record(trace_evt_t type, trace_id_t id, uint32_t arg)
+{
+    if (!s_running) {
+        return;
+    }
+
+    uint32_t now = (uint32_t)esp_timer_get_time();
+
+    portENTER_CRITICAL_SAFE(&s_trace_lock);
+    trace_event_t *ev = &s_ring[s_head % EVENT_TRACE_RING_EVENTS];
+    ev->timestamp_us = now;
+    ev->arg = arg;
+    ev->type = (uint8_t)type;
+    ev->id = (uint8_t)id;
+    s_head++;
+    portEXIT_CRITICAL_SAFE(&s_trace_lock);
+}
+
+void IRAM_ATTR event_trace_task_switched_in(void)
+{
+    event_trace_record(TRACE_EVT_TASK_SWITCH, TRACE_ID_NONE, (uint32_t)(uintptr_t)xTaskGetCurrentTaskHandle());
+}
+
+esp_err_t event_trace_init(void)
+{
+    memset(s_ring, 0, sizeof(s_ring));
+    s_head = 0;
+    s_running = EVENT_TRACE_START_ON_BOOT;
+    ESP_LOGI(TAG, "Event tracer ready (%d events, %s) - convert dumps with tools/trace_to_perfetto.py",
+             EVENT_TRACE_RING_EVENTS, s_running ? "recording" : "paused");
+    return ESP_OK;
+}
+
+void event_trace_start(void)
+{
+    s_running = true;
+}
+
+void event_trace_stop(void)
+{
+    s_running = false;
+}
+
+bool event_trace_is_running(void)
+{
+    return s_running;
+}
+
+/**
+ * @brief Print the task handle -> name table for the tasks alive now
+ */
+static void event_trace_print_tasks(void)
+{
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY
+    static TaskStatus_t status[EVENT_TRACE_TASKS_MAX];
+    UBaseType_t count = uxTaskGetSystemState(status, EVENT_TRACE_TASKS_MAX, NULL);
+    for (UBaseType_t i = 0; i < count; i++) {
+        printf("#TR-TASK %08lx %s\n", (unsigned long)(uintptr_t)status[i].xHandle, status[i].pcTaskName);
+    }
+#endif
+}
+
+esp_err_t event_trace_dump(void)
+{
+    bool was_running = s_running;
+    s_running = false;
+
+    /* Producers check s_running outside the lock: take it once so an
+     * in-flight record completes before the ring is read */
+    portENTER_CRITICAL(&s_trace_lock);
+    uint32_t head = s_head;
+    portEXIT_CRITICAL(&s_trace_lock);
+
+    uint32_t count = (head < EVENT_TRACE_RING_EVENTS) ? head : EVENT_TRACE_RING_EVENTS;
+
+    printf("#TR-BEGIN %lu %lu\n", (unsigned long)count, (unsigned long)(head - count));
+    for (int i = 0; i < TRACE_ID_MAX; i++) {
+        printf("#TR-ID %d %s\n", i, TRACE_NAMES[i]);
+    }
+    event_trace_print_tasks();
+
+    for (uint32_t n = head - count; n != head; n++) {
+        const trace_event_t *ev = &s_ring[n % EVENT_TRACE_RING_EVENTS];
+        printf("#TR %08lx %c %u %08lx\n", (unsigned long)ev->timestamp_us, ev->type, ev->id,
+               (unsigned long)ev->arg);
+        if ((n & 0x3F) == 0) {
+            vTaskDelay(1);          /* Let the UART drain and the Zigbee task run */
+        }
+    }
+    printf("#TR-END\n");
+    fflush(stdout);
+
+    portENTER_CRITICAL(&s_trace_lock);
+    s_head = 0;
+    portEXIT_CRITICAL(&s_trace_lock);
+    s_running = was_running;
+    return ESP_OK;
+}
+
+/**
+ * @brief One-shot task for event_trace_request_dump()
+ */
+static void event_trace_dump_task(void *arg)
+{
+    event_trace_dump();
+    s_dump_pending = false;
+    vTaskDelete(NULL);
+}
+
+esp_err_t event_trace_request_dump(void)
+{
+    if (s_dump_pending) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    s_dump_pending = true;
+    if (xTaskCreate(event_trace_dump_task, "trace_dump", EVENT_TRACE_DUMP_STACK, NULL,
+                    EVENT_TRACE_DUMP_PRIORITY, NULL) != pdPASS) {
+        s_dump_pending = false;
+        ESP_LOGE(TAG, "Failed to create dump task");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+#else /* !AERIS_TRACE_ENABLE */
+
+esp_err_t event_trace_init(void)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+void event_trace_record(trace_evt_t type, trace_id_t id, uint32_t arg)
+{
+}
+
+void event_trace_start(void)
+{
+}
+
+void event_trace_stop(void)
+{
+}
+
+bool event_trace_is_running(void)
+{
+    return false;
+}
+
+esp_err_t event_trace_dump(void)
+{
+    ESP_LOGW(TAG, "Tracer not built in (configure with -D AERIS_ENABLE_TRACE=ON)");
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t event_trace_request_dump(void)
+{
+    return event_trace_dump();
+}
+
+#endif /* AERIS_TRACE_ENABLE */
@@ -0,0 +1,132 @@
+/*
+ * RAM event tracer for Aeris_Lite
+ *
+ * Flight-recorder ring of timestamped events (esp_timer, 1 us): FreeRTOS task
+ * switches, ISR entry/exit, I2C transactions, Zigbee signals, scheduler
+ * alarms, NVS commits and the acquisition / LED refresh / OTA write spans.
+ * event_trace_dump() prints the ring as "#TR" lines which
+ * tools/trace_to_perfetto.py converts into a Chrome/Perfetto JSON trace.
+ *
+ * Opt-in: configure with -D AERIS_ENABLE_TRACE=ON. This force-includes
+ * trace_hooks.h into every component so FreeRTOS calls the task-switch hook;
+ * without it all TRACE_x() macros compile to nothing.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Set by trace_hooks.h when the build option is on */
+#ifndef AERIS_TRACE_ENABLE
+#define AERIS_TRACE_ENABLE          0
+#endif
+
+#define EVENT_TRACE_RING_EVENTS     512     /* Ring capacity (12 bytes per event) */
+#define EVENT_TRACE_DUMP_STACK      3072
+#define EVENT_TRACE_DUMP_PRIORITY   1       /* Just above idle */
+
+/* Start recording from boot (otherwise wait for event_trace_start()) */
+#ifndef EVENT_TRACE_START_ON_BOOT
+#define EVENT_TRACE_START_ON_BOOT   1
+#endif
+
+/* Event kinds - must match tools/trace_to_perfetto.py */
+typedef enum {
+    TRACE_EVT_TASK_SWITCH = 'S',    /* arg = handle of the task switched in */
+    TRACE_EVT_BEGIN = 'B',          /* Span start, arg = context value */
+    TRACE_EVT_END = 'E',            /* Span end, arg = result (esp_err_t etc.) */
+    TRACE_EVT_INSTANT = 'I',        /* Point event, arg = context value */
+} trace_evt_t;
+
+/* Traced sources (names are printed with every dump) */
+typedef enum {
+    TRACE_ID_NONE = 0,              /* Task switches */
+    TRACE_ISR_BUTTON,               /* button_isr_handler() */
+    TRACE_ISR_RMT_DONE,             /* LED strip RMT transfer-done callback */
+    TRACE_ISR_PCNT_WATCH,           /* Fan tach PCNT watch point callback */
+    TRACE_I2C_SHT45,                /* One I2C transaction per device */
+    TRACE_I2C_LPS22HB,
+    TRACE_I2C_SGP41,
+    TRACE_I2C_SCD40,
+    TRACE_ZB_SIGNAL,                /* esp_zb_app_signal_handler(), arg = signal type */
+    TRACE_ALARM_SENSOR_UPDATE,      /* Scheduler alarm callbacks */
+    TRACE_ALARM_COMMISSIONING,
+    TRACE_ALARM_FACTORY_RESET,
+    TRACE_NVS_COMMIT,               /* settings_commit() */
+    TRACE_ACQUISITION,              /* sensor_update_zigbee_attributes() */
+    TRACE_LED_REFRESH,              /* led_refresh_strip() */
+    TRACE_OTA_WRITE,                /* esp_ota_write() per OTA chunk */
+    TRACE_ID_MAX
+} trace_id_t;
+
+/* Ring entry */
+typedef struct {
+    uint32_t timestamp_us;          /* Low 32 bits of esp_timer_get_time() */
+    uint32_t arg;
+    uint8_t type;                   /* trace_evt_t */
+    uint8_t id;                     /* trace_id_t */
+    uint16_t reserved;
+} trace_event_t;
+
+/**
+ * @brief Initialize the tracer (starts recording if EVENT_TRACE_START_ON_BOOT)
+ * @return ESP_OK, ESP_ERR_NOT_SUPPORTED when built without AERIS_ENABLE_TRACE
+ */
+esp_err_t event_trace_init(void);
+
+/**
+ * @brief Record one event (task, ISR or scheduler-hook context)
+ */
+void event_trace_record(trace_evt_t type, trace_id_t id, uint32_t arg);
+
+/**
+ * @brief Resume recording (the ring keeps its contents)
+ */
+void event_trace_start(void);
+
+/**
+ * @brief Pause recording
+ */
+void event_trace_stop(void);
+
+/**
+ * @brief Whether events are currently being recorded
+ */
+bool event_trace_is_running(void);
+
+/**
+ * @brief Print the ring to the console and clear it
+ *
+ * Recording is paused while the ring is printed and resumed afterwards if it
+ * was running. Blocks for the duration of the UART output.
+ */
+esp_err_t event_trace_dump(void);
+
+/**
+ * @brief Run event_trace_dump() from a low-priority one-shot task
+ *
+ * For callers that must not block (Zigbee task, attribute handlers).
+ *
+ * @return ESP_ERR_INVALID_STATE if a dump is already in progress
+ */
+esp_err_t event_trace_request_dump(void);
+
+#if AERIS_TRACE_ENABLE
+#define TRACE_BEGIN(id, arg)        event_trace_record(TRACE_EVT_BEGIN, (id), (uint32_t)(arg))
+#define TRACE_END(id, arg)          event_trace_record(TRACE_EVT_END, (id), (uint32_t)(arg))
+#define TRACE_INSTANT(id, arg)      event_trace_record(TRACE_EVT_INSTANT, (id), (uint32_t)(arg))
+#else
+#define TRACE_BEGIN(id, arg)        do { } while (0)
+#define TRACE_END(id, arg)          do { } while (0)
+#define TRACE_INSTANT(id, arg)      do { } while (0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -2,6 +2,10 @@
  * Fan Control Driver Implementation for Aeris_Lite
  * 
  * PWM speed control and RPM monitoring using ESP32-C6 LEDC and Pulse Counter
+ * 
+ * While the fan is powered, a periodic esp_timer reads and clears the pulse
+ * counter every FAN_TACH_SAMPLE_MS, keeps a smoothed RPM and advances the
+ * stall state machine, so RPM and status queries never wait for pulses.
  */
 
 #include "fan_control.h"
@@ -10,8 +14,12 @@
 #include "driver/gpio.h"
 #include "driver/pulse_cnt.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "event_trace.h"
+#include <math.h>
 
 static const char *TAG = "FAN";
 
@@ -25,13 +33,90 @@ static const char *TAG = "FAN";
 #define FAN_MIN_SPEED_PERCENT   20   /* Minimum speed to reliably start fan */
 #define FAN_RPM_RUNNING_THRESH  100  /* RPM threshold to consider fan "running" */
 #define FAN_PULSES_PER_REV      2    /* Standard for 4-wire fans */
+#define FAN_TRACE_WATCH_PULSES  50   /* Tach edges per PCNT trace marker (AERIS_ENABLE_TRACE builds) */
 
 /* Module state */
 static pcnt_unit_handle_t pcnt_unit = NULL;
+static esp_timer_handle_t fan_tach_timer = NULL;
 static bool fan_initialized = false;
 static bool fan_power_enabled = false;
 static uint8_t fan_current_speed = 0;
-static uint32_t fan_last_rpm = 0;
+static bool fan_fade_ready = false;             /* LEDC fade engine installed */
+
+/* Serialises every duty change: API calls (Zigbee task, console) and RPM controller steps
+ * (esp_timer task). Recursive: fan_set_target_rpm() falls back on fan_set_speed() */
+static SemaphoreHandle_t fan_duty_mutex = NULL;
+
+/* MOSFET gate (under fan_lock, switched off by the fade-end ISR at the bottom of a ramp) */
+static bool fan_gate_on = false;
+static bool fan_gate_off_pending = false;
+
+/* Tach sampler state (shared with the esp_timer task, under fan_lock) */
+static portMUX_TYPE fan_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t fan_rpm_x16 = 0;                /* Smoothed RPM, 4 fractional bits */
+static fan_state_t fan_state = FAN_STATE_OFF;
+static int64_t fan_state_since_us = 0;          /* Spin-up start / last sample above threshold */
+static int64_t fan_last_sample_us = 0;
+static fan_fault_cb_t fan_fault_cb = NULL;
+static void *fan_fault_ctx = NULL;
+static bool fan_fault_clear_pending = false;    /* Switched off while stalled, reported on unlock */
+
+/* Closed-loop control (run by the tach sampler, under fan_lock) */
+#define FAN_PID_UPDATE_SAMPLES  ((FAN_PID_UPDATE_MS + FAN_TACH_SAMPLE_MS - 1) / FAN_TACH_SAMPLE_MS)
+#define FAN_PID_DT_S            (FAN_PID_UPDATE_SAMPLES * FAN_TACH_SAMPLE_MS / 1000.0f)
+
+static uint32_t fan_target_rpm = 0;             /* 0 = open loop */
+static float fan_pid_integral = 0.0f;           /* Integral term, in percent duty */
+static uint32_t fan_pid_samples = 0;            /* Tach samples since the last controller step */
+static int64_t fan_kick_until_us = 0;
+
+/* Auto mode (Zigbee task) */
+static fan_mode_t fan_mode = FAN_MODE_OFF;
+static fan_curve_t fan_curve = FAN_CURVE_DEFAULT;
+static fan_curve_input_t fan_last_input;
+static bool fan_last_input_valid = false;
+static float fan_curve_output = -1.0f;          /* Rate-limited curve output in %, < 0 before the first evaluation */
+static int64_t fan_curve_last_us = 0;
+static bool fan_curve_falling = false;          /* Ramping down towards the demand */
+static uint8_t fan_curve_applied = 0xFF;        /* Last speed applied by the curve */
+static uint32_t fan_full_rpm = FAN_CURVE_FULL_RPM;  /* RPM at 100%, 0 = open-loop duty */
+
+/* Purge override (Zigbee task): mode and curve are tracked but not applied while active */
+static bool fan_override_active = false;
+static uint8_t fan_override_saved_speed = 0;    /* Restored on release outside auto mode */
+static uint32_t fan_override_saved_rpm = 0;
+
+static esp_err_t fan_curve_apply(const fan_curve_input_t *input);
+static esp_err_t fan_drive_percent(uint8_t percent);
+
+static const char *FAN_STATE_NAMES[] = {"OFF", "SPINUP", "RUNNING", "STALLED"};
+
+static void fan_duty_lock(void)
+{
+    xSemaphoreTakeRecursive(fan_duty_mutex, portMAX_DELAY);
+}
+
+static void fan_duty_unlock(void)
+{
+    xSemaphoreGiveRecursive(fan_duty_mutex);
+    if (xSemaphoreGetMutexHolder(fan_duty_mutex) == xTaskGetCurrentTaskHandle()) {
+        return;     /* Nested */
+    }
+    
+    /* Fault cleared by a switch-off: the callback may take other locks, so never under this one */
+    fan_fault_cb_t cb = NULL;
+    void *cb_ctx = NULL;
+    portENTER_CRITICAL(&fan_lock);
+    if (fan_fault_clear_pending) {
+        fan_fault_clear_pending = false;
+        cb = fan_fault_cb;
+        cb_ctx = fan_fault_ctx;
+    }
+    portEXIT_CRITICAL(&fan_lock);
+    if (cb) {
+        cb(false, 0, cb_ctx);
+    }
+}
 
 /**
  * @brief Initialize fan power control GPIO (MOSFET driver)
@@ -58,6 +143,40 @@ static esp_err_t fan_power_init(void)
     return ESP_OK;
 }
 
+/**
+ * @brief LEDC fade-end callback (ISR context): gate the MOSFET off once a ramp-down reached 0
+ */
+static bool fan_fade_end_cb(const ledc_cb_param_t *param, void *user_arg)
+{
+    if (param->event != LEDC_FADE_END_EVT || param->duty != 0) {
+        return false;
+    }
+    
+    portENTER_CRITICAL_ISR(&fan_lock);
+    if (fan_gate_off_pending) {
+        gpio_set_level(FAN_POWER_GPIO, 0);
+        fan_gate_on = false;
+        fan_gate_off_pending = false;
+    }
+    portEXIT_CRITICAL_ISR(&fan_lock);
+    
+    return false;
+}
+
+/**
+ * @brief Switch the MOSFET now (cancels a pending gate-off)
+ */
+static void fan_gate_set(bool on)
+{
+    portENTER_CRITICAL(&fan_lock);
+    fan_gate_off_pending = false;
+    if (fan_gate_on != on) {
+        gpio_set_level(FAN_POWER_GPIO, on ? 1 : 0);
+        fan_gate_on = on;
+    }
+    portEXIT_CRITICAL(&fan_lock);
+}
+
 /**
  * @brief Initialize PWM for fan speed control
  */
@@ -69,7 +188,7 @@ static esp_err_t fan_pwm_init(void)
         .duty_resolution = FAN_PWM_RESOLUTION,
         .timer_num = FAN_PWM_TIMER,
         .freq_hz = FAN_PWM_FREQ_HZ,
-        .clk_cfg = LEDC_AUTO_CLK,
+        .clk_cfg = LEDC_USE_XTAL_CLK,  /* XTAL is unaffected by DFS, so no PM lock is needed */
     };
     esp_err_t ret = ledc_timer_config(&timer_conf);
     if (ret != ESP_OK) {
@@ -92,11 +211,244 @@ static esp_err_t fan_pwm_init(void)
         return ret;
     }
     
+    /* Hardware fades: speed changes ramp without CPU involvement */
+    ledc_cbs_t fade_cbs = {
+        .fade_cb = fan_fade_end_cb,
+    };
+    if (ledc_fade_func_install(0) == ESP_OK &&
+        ledc_cb_register(FAN_PWM_MODE, FAN_PWM_CHANNEL, &fade_cbs, NULL) == ESP_OK) {
+        fan_fade_ready = true;
+    } else {
+        ESP_LOGW(TAG, "LEDC fade unavailable, speed changes will be immediate");
+    }
+    
     ESP_LOGI(TAG, "Fan PWM initialized on GPIO%d at %d Hz", FAN_PWM_GPIO, FAN_PWM_FREQ_HZ);
     
     return ESP_OK;
 }
 
+#if AERIS_TRACE_ENABLE
+/**
+ * @brief PCNT watch point callback (ISR context) - trace marker only
+ */
+static bool IRAM_ATTR fan_tach_watch_cb(pcnt_unit_handle_t unit, const pcnt_watch_event_data_t *edata,
+                                        void *user_ctx)
+{
+    TRACE_INSTANT(TRACE_ISR_PCNT_WATCH, edata->watch_point_value);
+    return false;
+}
+#endif
+
+/**
+ * @brief Set an 8-bit PWM duty, ramped by the LEDC fade engine
+ * 
+ * A fade in progress is stopped and the new one starts from the duty it
+ * reached. The ramp takes FAN_RAMP_MS per full range.
+ * @param duty Target duty
+ * @param ramp false for an immediate change (RPM controller steps)
+ * @param fade_ms Set to the fade time, 0 if the duty was written immediately (may be NULL)
+ */
+static esp_err_t fan_pwm_set(uint32_t duty, bool ramp, uint32_t *fade_ms)
+{
+    uint32_t time_ms = 0;
+    esp_err_t ret;
+    
+    if (fan_fade_ready) {
+        ledc_fade_stop(FAN_PWM_MODE, FAN_PWM_CHANNEL);
+        uint32_t from = ledc_get_duty(FAN_PWM_MODE, FAN_PWM_CHANNEL);
+        uint32_t delta = (duty > from) ? duty - from : from - duty;
+        time_ms = ramp ? delta * FAN_RAMP_MS / 255 : 0;
+    }
+    
+    if (time_ms > 0) {
+        ret = ledc_set_fade_time_and_start(FAN_PWM_MODE, FAN_PWM_CHANNEL, duty, time_ms,
+                                           LEDC_FADE_NO_WAIT);
+    } else if (fan_fade_ready) {
+        ret = ledc_set_duty_and_update(FAN_PWM_MODE, FAN_PWM_CHANNEL, duty, 0);
+    } else {
+        ret = ledc_set_duty(FAN_PWM_MODE, FAN_PWM_CHANNEL, duty);
+        if (ret == ESP_OK) {
+            ret = ledc_update_duty(FAN_PWM_MODE, FAN_PWM_CHANNEL);
+        }
+    }
+    
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set PWM duty: %s", esp_err_to_name(ret));
+        time_ms = 0;
+    }
+    if (fade_ms) {
+        *fade_ms = time_ms;
+    }
+    return ret;
+}
+
+/**
+ * @brief One PI controller step (tach sampler, under fan_lock)
+ * 
+ * Anti-windup: the integral only moves when the output is not saturated in
+ * the direction of the error, and is clamped to the output range.
+ * @return New 8-bit duty, or -1 to leave the PWM unchanged
+ */
+static int32_t fan_pid_step(uint32_t rpm, int64_t now)
+{
+    if (fan_target_rpm == 0 || ++fan_pid_samples < FAN_PID_UPDATE_SAMPLES) {
+        return -1;
+    }
+    fan_pid_samples = 0;
+    
+    /* Keep kicking until the fan turns (stall detection covers one that never does) */
+    if (fan_kick_until_us != 0) {
+        if (fan_state != FAN_STATE_RUNNING && now < fan_kick_until_us) {
+            return -1;
+        }
+        fan_kick_until_us = 0;
+    }
+    
+    float error = (float)fan_target_rpm - (float)rpm;
+    float integral = fan_pid_integral + FAN_PID_KI * error * FAN_PID_DT_S;
+    float output = FAN_PID_KP * error + integral;
+    
+    if (output > 100.0f) {
+        output = 100.0f;
+        if (error > 0.0f) {
+            integral = fan_pid_integral;
+        }
+    } else if (output < FAN_MIN_SPEED_PERCENT) {
+        output = FAN_MIN_SPEED_PERCENT;
+        if (error < 0.0f) {
+            integral = fan_pid_integral;
+        }
+    }
+    fan_pid_integral = (integral < 0.0f) ? 0.0f : (integral > 100.0f) ? 100.0f : integral;
+    
+    return (int32_t)(output * 255.0f / 100.0f + 0.5f);
+}
+
+/**
+ * @brief Tach sampler (esp_timer task): smooth the RPM, advance the stall state machine
+ *        and run the RPM controller
+ */
+static void fan_tach_sample_cb(void *arg)
+{
+    int pulse_count = 0;
+    int64_t now = esp_timer_get_time();
+    
+    if (pcnt_unit_get_count(pcnt_unit, &pulse_count) != ESP_OK ||
+        pcnt_unit_clear_count(pcnt_unit) != ESP_OK) {
+        return;
+    }
+    
+    int64_t window_us = now - fan_last_sample_us;
+    fan_last_sample_us = now;
+    if (window_us <= 0) {
+        return;
+    }
+    
+    /* Raw RPM of this window drives stall detection, the smoothed one is reported */
+    uint32_t rpm = (uint32_t)((int64_t)pulse_count * 60 * 1000000 / (FAN_PULSES_PER_REV * window_us));
+    bool turning = (rpm > FAN_RPM_RUNNING_THRESH);
+    fan_state_t old_state, new_state;
+    fan_fault_cb_t cb;
+    void *cb_ctx;
+    
+    portENTER_CRITICAL(&fan_lock);
+    if (!fan_power_enabled) {
+        /* Powered off while this sample was pending */
+        portEXIT_CRITICAL(&fan_lock);
+        return;
+    }
+    
+    int32_t ema = (int32_t)fan_rpm_x16;
+    ema += ((int32_t)(rpm << 4) - ema) / (1 << FAN_RPM_EMA_SHIFT);
+    if (rpm == 0 && ema < (FAN_RPM_RUNNING_THRESH << 4)) {
+        ema = 0;    /* Below one pulse per window, don't let the tail linger */
+    }
+    fan_rpm_x16 = (uint32_t)ema;
+    
+    old_state = fan_state;
+    switch (fan_state) {
+        case FAN_STATE_SPINUP:
+            if (turning) {
+                fan_state = FAN_STATE_RUNNING;
+                fan_state_since_us = now;
+            } else if (now - fan_state_since_us >= FAN_SPINUP_MS * 1000LL) {
+                fan_state = FAN_STATE_STALLED;
+            }
+            break;
+        case FAN_STATE_RUNNING:
+            if (turning) {
+                fan_state_since_us = now;
+            } else if (now - fan_state_since_us >= FAN_STALL_MS * 1000LL) {
+                fan_state = FAN_STATE_STALLED;
+            }
+            break;
+        case FAN_STATE_STALLED:
+            if (turning) {
+                fan_state = FAN_STATE_RUNNING;
+                fan_state_since_us = now;
+            }
+            break;
+        default:
+            break;
+    }
+    new_state = fan_state;
+    cb = fan_fault_cb;
+    cb_ctx = fan_fault_ctx;
+    int32_t duty = fan_pid_step(fan_rpm_x16 >> 4, now);
+    uint32_t step_target = fan_target_rpm;
+    portEXIT_CRITICAL(&fan_lock);
+    
+    if (duty >= 0) {
+        fan_duty_lock();
+        /* Switched off or retargeted since the step was computed: drop it */
+        portENTER_CRITICAL(&fan_lock);
+        bool current = (fan_power_enabled && fan_target_rpm == step_target);
+        portEXIT_CRITICAL(&fan_lock);
+        if (current && fan_pwm_set((uint32_t)duty, false, NULL) == ESP_OK) {
+            fan_current_speed = (uint8_t)((duty * 100 + 127) / 255);
+            ESP_LOGD(TAG, "RPM control: %lu/%lu RPM -> duty %ld/255", rpm, step_target, duty);
+        }
+        fan_duty_unlock();
+    }
+    
+    if (new_state == old_state) {
+        return;
+    }
+    
+    ESP_LOGD(TAG, "Fan state: %s -> %s (%lu RPM)", FAN_STATE_NAMES[old_state],
+             FAN_STATE_NAMES[new_state], rpm);
+    
+    if (new_state == FAN_STATE_STALLED) {
+        ESP_LOGE(TAG, "Fan failure detected! Set to %d%% but RPM is %lu (%s)",
+                 fan_current_speed, rpm, (old_state == FAN_STATE_SPINUP) ? "did not start" : "stalled");
+        if (cb) {
+            cb(true, rpm, cb_ctx);
+        }
+    } else if (old_state == FAN_STATE_STALLED) {
+        ESP_LOGI(TAG, "Fan recovered at %lu RPM", rpm);
+        if (cb) {
+            cb(false, rpm, cb_ctx);
+        }
+    }
+}
+
+/**
+ * @brief Start sampling the tachometer (fan powered on)
+ */
+static void fan_tach_start(void)
+{
+    if (fan_tach_timer == NULL || esp_timer_is_active(fan_tach_timer)) {
+        return;
+    }
+    
+    pcnt_unit_clear_count(pcnt_unit);
+    fan_last_sample_us = esp_timer_get_time();
+    esp_err_t ret = esp_timer_start_periodic(fan_tach_timer, FAN_TACH_SAMPLE_MS * 1000);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to start TACH sampling: %s", esp_err_to_name(ret));
+    }
+}
+
 /**
  * @brief Initialize tachometer pulse counter
  */
@@ -116,7 +468,7 @@ static esp_err_t fan_tach_init(void)
         return ret;
     }
     
-    /* Configure pulse counter unit */
+    /* Configure pulse counter unit (no glitch filter, so the PCNT driver takes no PM lock) */
     pcnt_unit_config_t unit_config = {
         .high_limit = 20000,  /* High enough for fast fans */
         .low_limit = 0,
@@ -152,6 +504,17 @@ static esp_err_t fan_tach_init(void)
         return ret;
     }
     
+#if AERIS_TRACE_ENABLE
+    /* Trace marker every FAN_TRACE_WATCH_PULSES tach edges (must be set before enable) */
+    pcnt_event_callbacks_t pcnt_cbs = {
+        .on_reach = fan_tach_watch_cb,
+    };
+    if (pcnt_unit_add_watch_point(pcnt_unit, FAN_TRACE_WATCH_PULSES) != ESP_OK ||
+        pcnt_unit_register_event_callbacks(pcnt_unit, &pcnt_cbs, NULL) != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to register PCNT trace callback");
+    }
+#endif
+    
     /* Enable and start counter */
     ret = pcnt_unit_enable(pcnt_unit);
     if (ret != ESP_OK) {
@@ -174,7 +537,25 @@ static esp_err_t fan_tach_init(void)
         return ret;
     }
     
-    ESP_LOGI(TAG, "Fan TACH monitoring initialized on GPIO%d", FAN_TACH_GPIO);
+    /* Periodic sampler, only running while the fan is powered */
+    const esp_timer_create_args_t timer_args = {
+        .callback = fan_tach_sample_cb,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "fan_tach",
+        .skip_unhandled_events = true,
+    };
+    ret = esp_timer_create(&timer_args, &fan_tach_timer);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create TACH sampling timer: %s", esp_err_to_name(ret));
+        pcnt_unit_stop(pcnt_unit);
+        pcnt_unit_disable(pcnt_unit);
+        pcnt_del_unit(pcnt_unit);
+        pcnt_unit = NULL;
+        return ret;
+    }
+    
+    ESP_LOGI(TAG, "Fan TACH monitoring initialized on GPIO%d (sampled every %d ms)",
+             FAN_TACH_GPIO, FAN_TACH_SAMPLE_MS);
     
     return ESP_OK;
 }
@@ -188,6 +569,13 @@ esp_err_t fan_init(void)
     
     ESP_LOGI(TAG, "Initializing fan control system...");
     
+    if (fan_duty_mutex == NULL) {
+        fan_duty_mutex = xSemaphoreCreateRecursiveMutex();
+        if (fan_duty_mutex == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    
     /* Initialize power control */
     esp_err_t ret = fan_power_init();
     if (ret != ESP_OK) {
@@ -210,42 +598,70 @@ esp_err_t fan_init(void)
     fan_initialized = true;
     fan_power_enabled = false;
     fan_current_speed = 0;
-    fan_last_rpm = 0;
+    fan_rpm_x16 = 0;
+    fan_state = FAN_STATE_OFF;
     
     ESP_LOGI(TAG, "Fan control system initialized successfully");
     
     return ESP_OK;
 }
 
-esp_err_t fan_set_power(bool enable)
+/**
+ * @brief Track the power state: tach sampler, health state and RPM control
+ */
+static void fan_power_track(bool enable)
 {
-    if (!fan_initialized) {
-        ESP_LOGE(TAG, "Fan control not initialized");
-        return ESP_ERR_INVALID_STATE;
-    }
-    
-    gpio_set_level(FAN_POWER_GPIO, enable ? 1 : 0);
+    portENTER_CRITICAL(&fan_lock);
     fan_power_enabled = enable;
-    
     if (!enable) {
-        /* If powering off, also set PWM to 0 */
+        if (fan_state == FAN_STATE_STALLED) {
+            fan_fault_clear_pending = true;     /* Switching off clears the fault (fan_duty_unlock) */
+        }
+        fan_state = FAN_STATE_OFF;
+        fan_rpm_x16 = 0;
+        fan_target_rpm = 0;     /* Powering off also ends RPM control */
+    }
+    portEXIT_CRITICAL(&fan_lock);
+    
+    if (enable) {
+        fan_tach_start();
+    } else {
         fan_current_speed = 0;
-        ledc_set_duty(FAN_PWM_MODE, FAN_PWM_CHANNEL, 0);
-        ledc_update_duty(FAN_PWM_MODE, FAN_PWM_CHANNEL);
+        if (fan_tach_timer) {
+            esp_timer_stop(fan_tach_timer);
+        }
     }
     
     ESP_LOGI(TAG, "Fan power: %s", enable ? "ON" : "OFF");
-    
-    return ESP_OK;
 }
 
-esp_err_t fan_set_speed(uint8_t speed_percent)
+esp_err_t fan_set_power(bool enable)
 {
     if (!fan_initialized) {
         ESP_LOGE(TAG, "Fan control not initialized");
         return ESP_ERR_INVALID_STATE;
     }
     
+    fan_duty_lock();
+    if (!enable) {
+        /* Immediate: PWM to 0 without a ramp, then the MOSFET */
+        fan_pwm_set(0, false, NULL);
+    }
+    fan_gate_set(enable);
+    fan_power_track(enable);
+    fan_duty_unlock();
+    
+    return ESP_OK;
+}
+
+/**
+ * @brief Apply an open-loop speed (power, PWM ramp and spin-up check)
+ * 
+ * The MOSFET is only switched at the ends of a ramp: on before ramping up
+ * from 0, off by the fade-end callback once a ramp-down reached 0.
+ */
+static esp_err_t fan_apply_speed(uint8_t speed_percent)
+{
     /* Clamp to valid range */
     if (speed_percent > 100) {
         speed_percent = 100;
@@ -260,68 +676,143 @@ esp_err_t fan_set_speed(uint8_t speed_percent)
     
     /* Convert percentage to 8-bit duty cycle */
     uint32_t duty = (speed_percent * 255) / 100;
+    uint32_t fade_ms = 0;
+    esp_err_t ret;
     
-    /* Set PWM duty cycle */
-    esp_err_t ret = ledc_set_duty(FAN_PWM_MODE, FAN_PWM_CHANNEL, duty);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to set PWM duty: %s", esp_err_to_name(ret));
-        return ret;
-    }
-    
-    ret = ledc_update_duty(FAN_PWM_MODE, FAN_PWM_CHANNEL);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to update PWM duty: %s", esp_err_to_name(ret));
-        return ret;
+    if (speed_percent > 0) {
+        /* Ramp up from 0 with the MOSFET on (keeps it on if a ramp-down is being reversed) */
+        portENTER_CRITICAL(&fan_lock);
+        bool gate_on = fan_gate_on;
+        portEXIT_CRITICAL(&fan_lock);
+        if (!gate_on) {
+            fan_pwm_set(0, false, NULL);
+        }
+        fan_gate_set(true);
+        
+        ret = fan_pwm_set(duty, true, &fade_ms);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        if (!fan_power_enabled) {
+            fan_power_track(true);
+        }
+    } else {
+        if (fan_power_enabled) {
+            fan_power_track(false);
+        }
+        
+        /* Ramp down, the fade-end callback gates the MOSFET off at 0 */
+        portENTER_CRITICAL(&fan_lock);
+        fan_gate_off_pending = fan_gate_on;
+        portEXIT_CRITICAL(&fan_lock);
+        
+        ret = fan_pwm_set(0, true, &fade_ms);
+        if (ret != ESP_OK || fade_ms == 0) {
+            fan_gate_set(false);
+        }
+        if (ret != ESP_OK) {
+            return ret;
+        }
     }
     
     fan_current_speed = speed_percent;
     
-    /* Enable power if speed > 0 */
-    if (speed_percent > 0 && !fan_power_enabled) {
-        fan_set_power(true);
-    } else if (speed_percent == 0 && fan_power_enabled) {
-        fan_set_power(false);
+    /* Arm the spin-up check when the fan is started */
+    if (speed_percent > 0) {
+        portENTER_CRITICAL(&fan_lock);
+        if (fan_state == FAN_STATE_OFF) {
+            fan_state = FAN_STATE_SPINUP;
+            fan_state_since_us = esp_timer_get_time();
+        }
+        portEXIT_CRITICAL(&fan_lock);
     }
     
-    ESP_LOGI(TAG, "Fan speed set to %d%% (duty: %lu/255)", speed_percent, duty);
+    ESP_LOGI(TAG, "Fan speed set to %d%% (duty: %lu/255, ramp %lu ms)", speed_percent, duty, fade_ms);
     
     return ESP_OK;
 }
 
-uint32_t fan_get_rpm(void)
+esp_err_t fan_set_speed(uint8_t speed_percent)
 {
-    if (!fan_initialized || pcnt_unit == NULL) {
-        return 0;
+    if (!fan_initialized) {
+        ESP_LOGE(TAG, "Fan control not initialized");
+        return ESP_ERR_INVALID_STATE;
     }
     
-    if (!fan_power_enabled || fan_current_speed == 0) {
-        fan_last_rpm = 0;
-        return 0;
+    /* Open loop from here on */
+    fan_duty_lock();
+    portENTER_CRITICAL(&fan_lock);
+    fan_target_rpm = 0;
+    portEXIT_CRITICAL(&fan_lock);
+    
+    esp_err_t ret = fan_apply_speed(speed_percent);
+    fan_duty_unlock();
+    return ret;
+}
+
+/**
+ * @brief Start or retarget closed-loop control (duty mutex held)
+ */
+static esp_err_t fan_target_rpm_apply(uint32_t rpm)
+{
+    if (rpm == 0) {
+        return fan_set_speed(0);
     }
     
-    /* Clear counter */
-    esp_err_t ret = pcnt_unit_clear_count(pcnt_unit);
-    if (ret != ESP_OK) {
-        ESP_LOGW(TAG, "Failed to clear pulse count: %s", esp_err_to_name(ret));
-        return fan_last_rpm;
+    bool stopped = (!fan_power_enabled || fan_current_speed == 0);
+    if (stopped) {
+        esp_err_t ret = fan_apply_speed(FAN_KICK_PERCENT);
+        if (ret != ESP_OK) {
+            return ret;
+        }
     }
     
-    /* Wait 1 second to count pulses */
-    vTaskDelay(pdMS_TO_TICKS(1000));
+    portENTER_CRITICAL(&fan_lock);
+    if (stopped) {
+        /* Controller takes over from the minimum speed once the fan turns */
+        fan_kick_until_us = esp_timer_get_time() + FAN_KICK_MS * 1000LL;
+        fan_pid_integral = FAN_MIN_SPEED_PERCENT;
+    } else if (fan_target_rpm == 0) {
+        /* Bumpless switch from open loop */
+        fan_kick_until_us = 0;
+        fan_pid_integral = fan_current_speed;
+    }
+    fan_target_rpm = rpm;
+    fan_pid_samples = 0;
+    portEXIT_CRITICAL(&fan_lock);
     
-    /* Read pulse count */
-    int pulse_count = 0;
-    ret = pcnt_unit_get_count(pcnt_unit, &pulse_count);
-    if (ret != ESP_OK) {
-        ESP_LOGW(TAG, "Failed to read pulse count: %s", esp_err_to_name(ret));
-        return fan_last_rpm;
+    ESP_LOGI(TAG, "Fan target: %lu RPM%s", rpm, stopped ? " (start kick)" : "");
+    
+    return ESP_OK;
+}
+
+esp_err_t fan_set_target_rpm(uint32_t rpm)
+{
+    if (!fan_initialized) {
+        ESP_LOGE(TAG, "Fan control not initialized");
+        return ESP_ERR_INVALID_STATE;
     }
     
-    /* Convert to RPM (standard: 2 pulses per revolution) */
-    uint32_t rpm = (pulse_count * 60) / FAN_PULSES_PER_REV;
-    fan_last_rpm = rpm;
+    if (fan_tach_timer == NULL) {
+        ESP_LOGW(TAG, "RPM control needs the tachometer");
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    
+    fan_duty_lock();
+    esp_err_t ret = fan_target_rpm_apply(rpm);
+    fan_duty_unlock();
+    return ret;
+}
+
+uint32_t fan_get_rpm(void)
+{
+    if (!fan_initialized || pcnt_unit == NULL) {
+        return 0;
+    }
     
-    ESP_LOGD(TAG, "Fan RPM: %lu (pulses: %d)", rpm, pulse_count);
+    portENTER_CRITICAL(&fan_lock);
+    uint32_t rpm = fan_rpm_x16 >> 4;
+    portEXIT_CRITICAL(&fan_lock);
     
     return rpm;
 }
@@ -332,19 +823,40 @@ esp_err_t fan_get_status(fan_status_t *status)
         return ESP_ERR_INVALID_ARG;
     }
     
+    portENTER_CRITICAL(&fan_lock);
+    uint32_t rpm = fan_rpm_x16 >> 4;
+    fan_state_t state = fan_state;
+    uint32_t target_rpm = fan_target_rpm;
+    portEXIT_CRITICAL(&fan_lock);
+    
     status->enabled = fan_power_enabled;
     status->speed_percent = fan_current_speed;
-    status->rpm = fan_last_rpm;
-    status->running = (fan_last_rpm > FAN_RPM_RUNNING_THRESH);
-    status->fault = (fan_power_enabled && fan_current_speed > 0 && 
-                     fan_last_rpm < FAN_RPM_RUNNING_THRESH);
+    status->rpm = rpm;
+    status->running = (state == FAN_STATE_RUNNING);
+    status->fault = (state == FAN_STATE_STALLED);
+    status->state = state;
+    status->target_rpm = target_rpm;
     
     return ESP_OK;
 }
 
 bool fan_is_running(void)
 {
-    return (fan_power_enabled && fan_last_rpm > FAN_RPM_RUNNING_THRESH);
+    portENTER_CRITICAL(&fan_lock);
+    bool running = (fan_state == FAN_STATE_RUNNING);
+    portEXIT_CRITICAL(&fan_lock);
+    
+    return running;
+}
+
+esp_err_t fan_register_fault_cb(fan_fault_cb_t cb, void *user_ctx)
+{
+    portENTER_CRITICAL(&fan_lock);
+    fan_fault_cb = cb;
+    fan_fault_ctx = user_ctx;
+    portEXIT_CRITICAL(&fan_lock);
+    
+    return ESP_OK;
 }
 
 esp_err_t fan_set_mode(fan_mode_t mode)
@@ -355,92 +867,234 @@ esp_err_t fan_set_mode(fan_mode_t mode)
     
     switch (mode) {
         case FAN_MODE_OFF:
-            return fan_set_speed(0);
         case FAN_MODE_LOW:
         case FAN_MODE_MEDIUM:
         case FAN_MODE_HIGH:
-            return fan_set_speed((uint8_t)mode);
+            fan_mode = mode;
+            if (fan_override_active) {
+                /* Takes effect when the purge ends */
+                fan_override_saved_speed = (uint8_t)mode;
+                fan_override_saved_rpm = (uint32_t)mode * fan_full_rpm / 100;
+                return ESP_OK;
+            }
+            return fan_drive_percent((uint8_t)mode);
         case FAN_MODE_AUTO:
-            /* Auto mode handled by fan_adaptive_control() */
-            ESP_LOGI(TAG, "Auto mode set - call fan_adaptive_control() periodically");
-            return ESP_OK;
+            /* Start the curve from scratch, then fan_adaptive_control() on every sample */
+            fan_mode = mode;
+            fan_curve_output = -1.0f;
+            fan_curve_falling = false;
+            fan_curve_applied = 0xFF;
+            ESP_LOGI(TAG, "Auto mode set");
+            return fan_curve_apply(fan_last_input_valid ? &fan_last_input : NULL);
         default:
             ESP_LOGW(TAG, "Unknown fan mode: %d", mode);
             return ESP_ERR_INVALID_ARG;
     }
 }
 
-esp_err_t fan_control_with_check(uint8_t speed_percent)
+esp_err_t fan_override(uint8_t speed_percent)
 {
     if (!fan_initialized) {
         return ESP_ERR_INVALID_STATE;
     }
+    if (speed_percent > 100) {
+        return ESP_ERR_INVALID_ARG;
+    }
     
-    /* Set fan speed */
-    esp_err_t ret = fan_set_speed(speed_percent);
-    if (ret != ESP_OK) {
-        return ret;
+    if (!fan_override_active) {
+        portENTER_CRITICAL(&fan_lock);
+        fan_override_saved_rpm = fan_target_rpm;
+        portEXIT_CRITICAL(&fan_lock);
+        fan_override_saved_speed = fan_power_enabled ? fan_current_speed : 0;
+        fan_override_active = true;
+    }
+    
+    ESP_LOGD(TAG, "Override: %d%%", speed_percent);
+    return fan_drive_percent(speed_percent);
+}
+
+esp_err_t fan_override_release(void)
+{
+    if (!fan_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!fan_override_active) {
+        return ESP_OK;
     }
     
-    /* If speed is 0, no need to check */
-    if (speed_percent == 0) {
+    fan_override_active = false;
+    ESP_LOGD(TAG, "Override released");
+    
+    if (fan_mode == FAN_MODE_AUTO) {
+        /* Continue the curve (and its ramp) from where it is now */
+        fan_curve_applied = 0xFF;
+        return fan_curve_apply(fan_last_input_valid ? &fan_last_input : NULL);
+    }
+    if (fan_override_saved_rpm > 0) {
+        return fan_set_target_rpm(fan_override_saved_rpm);
+    }
+    return fan_set_speed(fan_override_saved_speed);
+}
+
+bool fan_is_overridden(void)
+{
+    return fan_override_active;
+}
+
+/**
+ * @brief Drive a mode, curve or purge percentage (RPM target with a full-scale RPM)
+ */
+static esp_err_t fan_drive_percent(uint8_t percent)
+{
+    if (fan_full_rpm > 0 && percent > 0 && fan_tach_timer != NULL) {
+        return fan_set_target_rpm((uint32_t)percent * fan_full_rpm / 100);
+    }
+    return fan_set_speed(percent);
+}
+
+/**
+ * @brief Demand of one curve input: 0 below start, lower..100 from start to full
+ */
+static float fan_curve_demand(float value, float start, float full, float lower)
+{
+    if (value < start) {
+        return 0.0f;
+    }
+    if (full <= start || value >= full) {
+        return 100.0f;
+    }
+    return lower + (100.0f - lower) * (value - start) / (full - start);
+}
+
+/**
+ * @brief Evaluate the curve, apply hysteresis and rate limit, and drive the fan (auto mode)
+ */
+static esp_err_t fan_curve_apply(const fan_curve_input_t *input)
+{
+    const fan_curve_t *c = &fan_curve;
+    int64_t now = esp_timer_get_time();
+    float demand = c->idle_percent;
+    
+    if (input != NULL) {
+        float lower = (c->idle_percent > FAN_MIN_SPEED_PERCENT) ? c->idle_percent : FAN_MIN_SPEED_PERCENT;
+        demand = fmaxf(demand, fan_curve_demand(input->temperature_c, c->temp_start_c, c->temp_full_c, lower));
+        demand = fmaxf(demand, fan_curve_demand(input->voc_index, c->voc_start, c->voc_full, lower));
+        demand = fmaxf(demand, fan_curve_demand(input->co2_ppm, c->co2_start_ppm, c->co2_full_ppm, lower));
+        demand = fmaxf(demand, fan_curve_demand(input->humidity_percent, c->humidity_start, c->humidity_full, lower));
+    }
+    
+    if (fan_curve_output < 0.0f || demand >= fan_curve_output) {
+        /* First evaluation or worse air: follow at once */
+        fan_curve_output = demand;
+        fan_curve_falling = false;
+    } else {
+        /* Slow down only once the demand dropped past the hysteresis, then ramp all the way */
+        if (demand <= fan_curve_output - c->hysteresis_percent || demand == 0.0f) {
+            fan_curve_falling = true;
+        }
+        if (fan_curve_falling) {
+            if (c->ramp_down_percent_min == 0) {
+                fan_curve_output = demand;      /* No rate limit */
+            } else {
+                float max_drop = c->ramp_down_percent_min * (float)(now - fan_curve_last_us) / 60e6f;
+                fan_curve_output = fmaxf(demand, fan_curve_output - max_drop);
+            }
+            fan_curve_falling = (fan_curve_output > demand);
+        }
+    }
+    fan_curve_last_us = now;
+    
+    if (fan_override_active) {
+        return ESP_OK;      /* Applied by fan_override_release() */
+    }
+    
+    uint8_t percent = (uint8_t)(fan_curve_output + 0.5f);
+    if (percent == fan_curve_applied) {
         return ESP_OK;
     }
     
-    /* Wait for fan to stabilize */
-    vTaskDelay(pdMS_TO_TICKS(2000));
+    ESP_LOGI(TAG, "Fan curve: %d%% (demand %d%%)", percent, (int)(demand + 0.5f));
+    fan_curve_applied = percent;
+    
+    return fan_drive_percent(percent);
+}
+
+fan_mode_t fan_get_mode(void)
+{
+    return fan_mode;
+}
+
+esp_err_t fan_set_curve(const fan_curve_t *curve)
+{
+    if (curve == NULL || curve->idle_percent > 100 || curve->hysteresis_percent > 100) {
+        return ESP_ERR_INVALID_ARG;
+    }
     
-    /* Check if fan is actually running */
-    uint32_t rpm = fan_get_rpm();
+    fan_curve = *curve;
     
-    if (rpm < FAN_RPM_RUNNING_THRESH) {
-        ESP_LOGE(TAG, "Fan failure detected! Set to %d%% but RPM is %lu", 
-                 speed_percent, rpm);
-        return ESP_FAIL;
+    if (fan_initialized && fan_mode == FAN_MODE_AUTO) {
+        return fan_curve_apply(fan_last_input_valid ? &fan_last_input : NULL);
+    }
+    return ESP_OK;
+}
+
+esp_err_t fan_set_full_rpm(uint32_t rpm)
+{
+    if (rpm > 0 && (rpm < FAN_FULL_RPM_MIN || rpm > FAN_FULL_RPM_MAX)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (rpm > 0 && fan_initialized && fan_tach_timer == NULL) {
+        ESP_LOGW(TAG, "RPM control needs the tachometer");
+        return ESP_ERR_NOT_SUPPORTED;
     }
     
-    ESP_LOGI(TAG, "Fan running at %lu RPM (target %d%%)", rpm, speed_percent);
+    fan_full_rpm = rpm;
+    ESP_LOGI(TAG, "Full speed: %s%lu RPM", rpm ? "" : "open loop, ", rpm);
     
+    if (!fan_initialized || fan_override_active) {
+        return ESP_OK;      /* Used from the next mode change or override release */
+    }
+    switch (fan_mode) {
+        case FAN_MODE_AUTO:
+            fan_curve_applied = 0xFF;
+            return fan_curve_apply(fan_last_input_valid ? &fan_last_input : NULL);
+        case FAN_MODE_LOW:
+        case FAN_MODE_MEDIUM:
+        case FAN_MODE_HIGH:
+            return fan_drive_percent((uint8_t)fan_mode);
+        default:
+            return ESP_OK;
+    }
+}
+
+esp_err_t fan_get_curve(fan_curve_t *curve)
+{
+    if (curve == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    *curve = fan_curve;
     return ESP_OK;
 }
 
-esp_err_t fan_adaptive_control(float temperature_c, uint16_t voc_index)
+esp_err_t fan_adaptive_control(const fan_curve_input_t *input)
 {
     if (!fan_initialized) {
         return ESP_ERR_INVALID_STATE;
     }
-    
-    uint8_t target_speed = 0;
-    
-    /* Determine fan speed based on temperature and air quality */
-    if (temperature_c > 35.0 || voc_index > 300) {
-        /* High temperature or poor air quality - high speed */
-        target_speed = FAN_MODE_HIGH;
-        ESP_LOGD(TAG, "Adaptive: HIGH speed (temp=%.1f°C, VOC=%d)", 
-                 temperature_c, voc_index);
-    } else if (temperature_c > 30.0 || voc_index > 200) {
-        /* Medium conditions - medium speed */
-        target_speed = FAN_MODE_MEDIUM;
-        ESP_LOGD(TAG, "Adaptive: MEDIUM speed (temp=%.1f°C, VOC=%d)", 
-                 temperature_c, voc_index);
-    } else if (temperature_c > 25.0 || voc_index > 150) {
-        /* Normal conditions - low speed */
-        target_speed = FAN_MODE_LOW;
-        ESP_LOGD(TAG, "Adaptive: LOW speed (temp=%.1f°C, VOC=%d)", 
-                 temperature_c, voc_index);
-    } else {
-        /* Cool and clean - fan off or minimal */
-        target_speed = 0;
-        ESP_LOGD(TAG, "Adaptive: OFF (temp=%.1f°C, VOC=%d)", 
-                 temperature_c, voc_index);
+    if (input == NULL) {
+        return ESP_ERR_INVALID_ARG;
     }
     
-    /* Only change speed if different from current */
-    if (target_speed != fan_current_speed) {
-        ESP_LOGI(TAG, "Adaptive fan control: %d%% -> %d%% (T=%.1f°C, VOC=%d)",
-                 fan_current_speed, target_speed, temperature_c, voc_index);
-        return fan_set_speed(target_speed);
+    fan_last_input = *input;
+    fan_last_input_valid = true;
+    
+    if (fan_mode != FAN_MODE_AUTO) {
+        return ESP_OK;
     }
     
-    return ESP_OK;
+    ESP_LOGD(TAG, "Adaptive: T=%.1f°C, RH=%.1f%%, VOC=%d, CO2=%d ppm",
+             input->temperature_c, input->humidity_percent, input->voc_index, input->co2_ppm);
+    
+    return fan_curve_apply(input);
 }
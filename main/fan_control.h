@@ -25,15 +25,154 @@ typedef enum {
     FAN_MODE_AUTO = 255,        /* Automatic speed based on sensors */
 } fan_mode_t;
 
+/* Tachometer sampling: a periodic esp_timer reads and clears the pulse counter */
+#define FAN_TACH_SAMPLE_MS      250     /* Sample window (one pulse = 120 RPM at 2 pulses/rev) */
+#define FAN_RPM_EMA_SHIFT       2       /* Smoothing: each sample moves the RPM by 1/4 of the difference */
+
+/* Stall detection */
+#ifndef FAN_SPINUP_MS
+#define FAN_SPINUP_MS           2000    /* Time allowed to reach the running threshold after start */
+#endif
+#ifndef FAN_STALL_MS
+#define FAN_STALL_MS            1000    /* Time below the running threshold before a running fan is stalled */
+#endif
+
+/*
+ * Closed-loop RPM control (fan_set_target_rpm): a PI controller run by the
+ * tach sampler every FAN_PID_UPDATE_MS adjusts the PWM duty to hold the
+ * target RPM. Gains are in percent duty per RPM of error.
+ */
+#ifndef FAN_PID_UPDATE_MS
+#define FAN_PID_UPDATE_MS       500     /* Controller period (rounded up to whole tach samples) */
+#endif
+#ifndef FAN_PID_KP
+#define FAN_PID_KP              0.005f  /* % per RPM (1000 RPM error -> 5%) */
+#endif
+#ifndef FAN_PID_KI
+#define FAN_PID_KI              0.01f   /* % per RPM per second (1000 RPM error -> 10%/s) */
+#endif
+#define FAN_KICK_PERCENT        60      /* Start kick, held until the fan turns or FAN_KICK_MS */
+#define FAN_KICK_MS             1000
+
+/*
+ * Open-loop speed changes ramp in the LEDC fade engine (no CPU while in
+ * progress): a full 0-100% change takes FAN_RAMP_MS, smaller ones
+ * proportionally less. The MOSFET is switched only at the ends of a ramp.
+ */
+#ifndef FAN_RAMP_MS
+#define FAN_RAMP_MS             3000
+#endif
+
+
+/*
+ * Auto mode control curve: each input maps linearly from its start value
+ * (minimum running speed, or idle_percent if higher) to its full value
+ * (100%); the fan follows the highest demand. Speeding up is immediate,
+ * slowing down waits for the demand to drop hysteresis_percent below the
+ * current speed and is then limited to ramp_down_percent_min.
+ */
+typedef struct {
+    uint8_t idle_percent;           /* Speed while every input is below its start value (0 = off) */
+    uint8_t hysteresis_percent;     /* Drop in demand needed before slowing down */
+    uint8_t ramp_down_percent_min;  /* Maximum slow-down rate, % per minute */
+    uint16_t temp_start_c;          /* Temperature (°C) */
+    uint16_t temp_full_c;
+    uint16_t voc_start;             /* VOC index */
+    uint16_t voc_full;
+    uint16_t co2_start_ppm;         /* CO2 (ppm) */
+    uint16_t co2_full_ppm;
+    uint16_t humidity_start;        /* Relative humidity (%) */
+    uint16_t humidity_full;
+} fan_curve_t;
+
+#define FAN_CURVE_DEFAULT {                                         \
+    .idle_percent = FAN_MODE_LOW, .hysteresis_percent = 5,          \
+    .ramp_down_percent_min = 10,                                    \
+    .temp_start_c = 25, .temp_full_c = 35,                          \
+    .voc_start = 150, .voc_full = 300,                              \
+    .co2_start_ppm = 1000, .co2_full_ppm = 2000,                    \
+    .humidity_start = 70, .humidity_full = 85,                      \
+}
+
+/* Readings fed to the control curve */
+typedef struct {
+    float temperature_c;
+    float humidity_percent;
+    uint16_t voc_index;
+    uint16_t co2_ppm;
+} fan_curve_input_t;
+
+/*
+ * Default of the fan_full_rpm setting (fan_set_full_rpm): when > 0 the modes,
+ * the auto curve and the purge drive fan_set_target_rpm(percent * full / 100)
+ * instead of the duty. 0 keeps open-loop duty, the RPM depends on the fan model.
+ */
+#ifndef FAN_CURVE_FULL_RPM
+#define FAN_CURVE_FULL_RPM      0
+#endif
+#define FAN_FULL_RPM_MIN        500     /* Lowest accepted full-scale RPM (0 = off) */
+#define FAN_FULL_RPM_MAX        10000
+
+/*
+ * Purge-then-measure sequencing: before each scheduled sample the fan is
+ * boosted to purge_percent for purge_s seconds to pull room air through
+ * the chamber, then held at measure_percent for FAN_PURGE_SETTLE_MS so the
+ * SCD4x completes a measurement on the fresh air before the sample is read.
+ * Afterwards the fan returns to its mode (or auto curve).
+ */
+typedef struct {
+    uint16_t purge_s;               /* Purge window in seconds (0 = disabled) */
+    uint8_t purge_percent;          /* Speed during the purge */
+    uint8_t measure_percent;        /* Speed while the sensors settle and are read */
+} fan_purge_t;
+
+/* Off by default: enable with fan_purge_time once the refresh interval allows it */
+#define FAN_PURGE_DEFAULT {                                         \
+    .purge_s = 0, .purge_percent = FAN_MODE_HIGH,                   \
+    .measure_percent = FAN_MODE_LOW,                                \
+}
+
+/* Measurement window between purge and sample: one SCD4x periodic measurement (5 s) */
+#ifndef FAN_PURGE_SETTLE_MS
+#define FAN_PURGE_SETTLE_MS     5000
+#endif
+
+/* Purge only if the refresh interval is at least this many purge + settle windows */
+#ifndef FAN_PURGE_MIN_INTERVAL_RATIO
+#define FAN_PURGE_MIN_INTERVAL_RATIO    4
+#endif
+
+/* Fan health state (advanced by the tach sampler) */
+typedef enum {
+    FAN_STATE_OFF = 0,          /* Not powered or 0% */
+    FAN_STATE_SPINUP,           /* Started, waiting for RPM */
+    FAN_STATE_RUNNING,          /* RPM above the running threshold */
+    FAN_STATE_STALLED,          /* Commanded on but not turning (fault) */
+} fan_state_t;
+
 /* Fan status structure */
 typedef struct {
     bool enabled;               /* Fan power state (ON/OFF) */
     uint8_t speed_percent;      /* Current PWM duty cycle (0-100%) */
-    uint32_t rpm;               /* Current RPM (from TACH) */
-    bool running;               /* True if fan is spinning (RPM > threshold) */
+    uint32_t rpm;               /* Current RPM (from TACH, smoothed) */
+    bool running;               /* True if fan is spinning (last sample above the RPM threshold) */
     bool fault;                 /* True if fan failure detected */
+    fan_state_t state;          /* Health state machine */
+    uint32_t target_rpm;        /* Closed-loop target, 0 in open-loop mode */
 } fan_status_t;
 
+/**
+ * @brief Fault event callback
+ *
+ * Runs in the esp_timer task (stall, recovery) or in the task switching the
+ * fan off (fault cleared), never with the fan's own locks held, so it may
+ * take other locks. Keep it short: the tach sampler waits for it.
+ * @param fault True when the fan stalled or failed to start, false when it recovered or was switched off
+ * @param rpm Smoothed RPM at the transition
+ * @param user_ctx Pointer given to fan_register_fault_cb()
+ */
+typedef void (*fan_fault_cb_t)(bool fault, uint32_t rpm, void *user_ctx);
+
 /**
  * @brief Initialize fan control system
  * 
@@ -46,6 +185,9 @@ esp_err_t fan_init(void);
 /**
  * @brief Set fan power state
  * 
+ * Immediate, unlike fan_set_speed(): powering off drops the PWM to 0
+ * without a ramp and switches the MOSFET off at once.
+ * 
  * @param enable True to power on fan, false to power off
  * @return ESP_OK on success
  */
@@ -54,6 +196,9 @@ esp_err_t fan_set_power(bool enable);
 /**
  * @brief Set fan speed
  * 
+ * Open-loop: leaves closed-loop RPM control if it was active. Returns
+ * immediately, the duty ramps to the new speed over up to FAN_RAMP_MS.
+ * 
  * @param speed_percent Speed as percentage (0-100)
  *                      0 = off, 100 = full speed
  *                      Values below 20% may not start fan
@@ -61,19 +206,33 @@ esp_err_t fan_set_power(bool enable);
  */
 esp_err_t fan_set_speed(uint8_t speed_percent);
 
+/**
+ * @brief Hold the fan at a target RPM (closed loop)
+ * 
+ * A stopped fan is kicked at FAN_KICK_PERCENT first, then the PI controller
+ * takes over (never below the minimum start speed). Switching from open loop
+ * starts from the current duty. Returns immediately.
+ * 
+ * @param rpm Target RPM, 0 to stop the fan
+ * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED without tachometer
+ */
+esp_err_t fan_set_target_rpm(uint32_t rpm);
+
 /**
  * @brief Get current fan RPM
  * 
- * Reads tachometer pulses and calculates RPM
- * Blocks for approximately 1 second to count pulses
+ * Returns the smoothed RPM kept by the tach sampler, updated every
+ * FAN_TACH_SAMPLE_MS. Never blocks.
  * 
- * @return Current RPM (0 if fan is off or failed)
+ * @return Current RPM (0 once the fan has stopped or if TACH is unavailable)
  */
 uint32_t fan_get_rpm(void);
 
 /**
  * @brief Get fan status
  * 
+ * Never blocks (uses the sampler's RPM and health state)
+ * 
  * @param status Pointer to fan_status_t structure to fill
  * @return ESP_OK on success
  */
@@ -82,42 +241,100 @@ esp_err_t fan_get_status(fan_status_t *status);
 /**
  * @brief Check if fan is running
  * 
- * Quick check without blocking (uses last known RPM)
+ * Quick check without blocking (uses the tach sampler's state)
  * 
- * @return True if fan RPM > 100, false otherwise
+ * @return True if the last tach sample was above 100 RPM, false otherwise
  */
 bool fan_is_running(void);
 
 /**
  * @brief Set fan to predefined mode
  * 
+ * FAN_MODE_AUTO applies the control curve right away (to the last readings,
+ * or idle_percent before the first sample) and on every fan_adaptive_control().
+ * 
  * @param mode Fan operating mode (FAN_MODE_OFF, LOW, MEDIUM, HIGH, AUTO)
  * @return ESP_OK on success
  */
 esp_err_t fan_set_mode(fan_mode_t mode);
 
 /**
- * @brief Run fan control with health check
+ * @brief Get the mode last set with fan_set_mode()
+ */
+fan_mode_t fan_get_mode(void);
+
+/**
+ * @brief Replace the auto mode control curve (re-applied in auto mode)
+ * 
+ * A full value at or below its start value makes that input a step at the start value.
+ * 
+ * @param curve New curve
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for percentages above 100
+ */
+esp_err_t fan_set_curve(const fan_curve_t *curve);
+
+/**
+ * @brief Set the RPM that 100% stands for in the modes, auto curve and purge
  * 
- * Sets fan speed and verifies it actually starts
- * Logs warning if fan fails to start
+ * With a full-scale RPM the percentages become closed-loop RPM targets, so
+ * every unit moves the same air whatever its fan's duty-to-RPM curve. The
+ * current mode is re-applied.
  * 
- * @param speed_percent Desired speed (0-100%)
- * @return ESP_OK if fan started successfully, ESP_FAIL if fan stalled
+ * @param rpm Full-scale RPM, 0 for open-loop duty
+ * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED without a tachometer
+ */
+esp_err_t fan_set_full_rpm(uint32_t rpm);
+
+/**
+ * @brief Get the auto mode control curve
+ * 
+ * @param curve Pointer to store the curve
+ * @return ESP_OK on success
+ */
+esp_err_t fan_get_curve(fan_curve_t *curve);
+
+/**
+ * @brief Hold the fan at a fixed speed regardless of mode (purge sequencing)
+ * 
+ * Mode changes and auto curve evaluations are recorded while the override
+ * is active and take effect on fan_override_release().
+ * 
+ * @param speed_percent Speed (0-100%), may be called again to change it
+ * @return ESP_OK on success
+ */
+esp_err_t fan_override(uint8_t speed_percent);
+
+/**
+ * @brief End the override and return to the mode, auto curve or previous speed
+ * 
+ * @return ESP_OK on success (also when no override was active)
+ */
+esp_err_t fan_override_release(void);
+
+/**
+ * @brief Check if fan_override() is holding the fan
+ */
+bool fan_is_overridden(void);
+
+/**
+ * @brief Register the fault event callback (one callback, NULL to remove)
+ * 
+ * @param cb Called on every transition into and out of FAN_STATE_STALLED
+ * @param user_ctx Passed to the callback
+ * @return ESP_OK on success
  */
-esp_err_t fan_control_with_check(uint8_t speed_percent);
+esp_err_t fan_register_fault_cb(fan_fault_cb_t cb, void *user_ctx);
 
 /**
  * @brief Adaptive fan control based on sensor readings
  * 
- * Automatically adjusts fan speed based on temperature and air quality
- * Call this periodically from your measurement loop
+ * Evaluates the control curve on a new sample; only changes the speed in
+ * FAN_MODE_AUTO. Called by the acquisition cycle after every sample.
  * 
- * @param temperature_c Current temperature in Celsius
- * @param voc_index Current VOC index (1-500)
+ * @param input Current readings
  * @return ESP_OK on success
  */
-esp_err_t fan_adaptive_control(float temperature_c, uint16_t voc_index);
+esp_err_t fan_adaptive_control(const fan_curve_input_t *input);
 
 #ifdef __cplusplus
 }
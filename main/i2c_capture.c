@@ -0,0 +1,230 @@
+/*
+ * I2C transaction recorder implementation for Aeris_Lite
+ *
+ * Records are packed back to back: a linear boot section filled until
+ * i2c_capture_end_boot(), then a byte ring that drops its oldest records to
+ * make room. All buffer access happens under a spinlock; printing is done
+ * outside of it.
+ */
+
+#include "i2c_capture.h"
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+static const char *TAG = "I2C_CAPTURE";
+
+#define I2C_CAPTURE_RECORD_MAX      (I2C_CAPTURE_HEADER_SIZE + 2 * I2C_CAPTURE_MAX_DATA)
+#define I2C_CAPTURE_DUMP_STACK      3072
+#define I2C_CAPTURE_DUMP_PRIORITY   1
+
+/* Module state */
+static uint8_t s_boot[I2C_CAPTURE_BOOT_BYTES];
+static size_t s_boot_len = 0;
+static bool s_boot_done = false;
+static uint8_t s_ring[I2C_CAPTURE_RING_BYTES];
+static uint32_t s_head = 0;                 /* Byte positions, wrap with % I2C_CAPTURE_RING_BYTES */
+static uint32_t s_tail = 0;
+static uint32_t s_dropped = 0;              /* Records pushed out of the ring */
+static bool s_paused = false;
+static volatile bool s_dump_pending = false;
+static volatile i2c_capture_mode_t s_mode = I2C_CAPTURE_BOOT_MODE;
+static portMUX_TYPE s_capture_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static inline uint8_t ring_byte(uint32_t pos)
+{
+    return s_ring[pos % I2C_CAPTURE_RING_BYTES];
+}
+
+static void ring_copy_in(const uint8_t *src, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        s_ring[(s_head + i) % I2C_CAPTURE_RING_BYTES] = src[i];
+    }
+    s_head += len;
+}
+
+/**
+ * @brief Total size of the record starting at ring position @p pos
+ */
+static inline size_t ring_record_size(uint32_t pos)
+{
+    return I2C_CAPTURE_HEADER_SIZE + ring_byte(pos + 10) + ring_byte(pos + 11);
+}
+
+/**
+ * @brief Print one record as "#I2C <kind> <hex>"
+ */
+static void i2c_capture_print(char kind, const uint8_t *rec, size_t len)
+{
+    static const char hex[] = "0123456789abcdef";
+    char line[8 + 2 * I2C_CAPTURE_RECORD_MAX + 1];
+    char *p = line;
+
+    p += sprintf(p, "#I2C %c ", kind);
+    for (size_t i = 0; i < len; i++) {
+        *p++ = hex[rec[i] >> 4];
+        *p++ = hex[rec[i] & 0x0F];
+    }
+    *p = '\0';
+    puts(line);
+}
+
+void i2c_capture_record(uint8_t bus, uint8_t addr, i2c_capture_op_t op,
+                        const uint8_t *tx, size_t tx_len, const uint8_t *rx, size_t rx_len,
+                        esp_err_t result, uint32_t start_us)
+{
+    if (s_mode == I2C_CAPTURE_OFF) {
+        return;
+    }
+
+    uint32_t now = (uint32_t)esp_timer_get_time();
+    uint32_t duration = now - start_us;
+    int16_t res = (int16_t)result;
+    uint8_t rec[I2C_CAPTURE_RECORD_MAX];
+
+    if (tx_len > I2C_CAPTURE_MAX_DATA) {
+        tx_len = I2C_CAPTURE_MAX_DATA;
+    }
+    if (rx_len > I2C_CAPTURE_MAX_DATA) {
+        rx_len = I2C_CAPTURE_MAX_DATA;
+    }
+    if (duration > UINT16_MAX) {
+        duration = UINT16_MAX;
+    }
+
+    rec[0] = start_us & 0xFF;
+    rec[1] = (start_us >> 8) & 0xFF;
+    rec[2] = (start_us >> 16) & 0xFF;
+    rec[3] = (start_us >> 24) & 0xFF;
+    rec[4] = duration & 0xFF;
+    rec[5] = duration >> 8;
+    rec[6] = (uint16_t)res & 0xFF;
+    rec[7] = (uint16_t)res >> 8;
+    rec[8] = (uint8_t)((bus ? 0x80 : 0x00) | (addr & 0x7F));
+    rec[9] = (uint8_t)op;
+    rec[10] = (uint8_t)tx_len;
+    rec[11] = (uint8_t)rx_len;
+    size_t len = I2C_CAPTURE_HEADER_SIZE;
+    if (tx_len) {
+        memcpy(&rec[len], tx, tx_len);
+        len += tx_len;
+    }
+    if (rx_len) {
+        memcpy(&rec[len], rx, rx_len);
+        len += rx_len;
+    }
+
+    portENTER_CRITICAL(&s_capture_lock);
+    if (s_paused) {
+        portEXIT_CRITICAL(&s_capture_lock);
+        return;
+    }
+    if (!s_boot_done && s_boot_len + len <= sizeof(s_boot)) {
+        memcpy(&s_boot[s_boot_len], rec, len);
+        s_boot_len += len;
+    } else {
+        while (s_head - s_tail + len > I2C_CAPTURE_RING_BYTES) {
+            s_tail += ring_record_size(s_tail);
+            s_dropped++;
+        }
+        ring_copy_in(rec, len);
+    }
+    portEXIT_CRITICAL(&s_capture_lock);
+
+    if (s_mode == I2C_CAPTURE_STREAM) {
+        i2c_capture_print('S', rec, len);
+    }
+}
+
+void i2c_capture_end_boot(void)
+{
+    portENTER_CRITICAL(&s_capture_lock);
+    s_boot_done = true;
+    portEXIT_CRITICAL(&s_capture_lock);
+    ESP_LOGI(TAG, "Boot section: %u bytes pinned", (unsigned)s_boot_len);
+}
+
+esp_err_t i2c_capture_set_mode(i2c_capture_mode_t mode)
+{
+    if (mode > I2C_CAPTURE_STREAM) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_mode = mode;
+    ESP_LOGI(TAG, "Capture mode %d", mode);
+    return ESP_OK;
+}
+
+i2c_capture_mode_t i2c_capture_get_mode(void)
+{
+    return s_mode;
+}
+
+esp_err_t i2c_capture_dump(void)
+{
+    uint8_t rec[I2C_CAPTURE_RECORD_MAX];
+    uint32_t printed = 0;
+
+    portENTER_CRITICAL(&s_capture_lock);
+    s_paused = true;
+    uint32_t tail = s_tail;
+    uint32_t head = s_head;
+    uint32_t dropped = s_dropped;
+    portEXIT_CRITICAL(&s_capture_lock);
+
+    /* Producers are paused: the buffers can be read without the lock */
+    printf("#I2C-BEGIN %lu\n", (unsigned long)dropped);
+    for (size_t off = 0; off + I2C_CAPTURE_HEADER_SIZE <= s_boot_len; printed++) {
+        size_t len = I2C_CAPTURE_HEADER_SIZE + s_boot[off + 10] + s_boot[off + 11];
+        i2c_capture_print('B', &s_boot[off], len);
+        off += len;
+    }
+    for (uint32_t pos = tail; pos != head; printed++) {
+        size_t len = ring_record_size(pos);
+        for (size_t i = 0; i < len; i++) {
+            rec[i] = ring_byte(pos + i);
+        }
+        i2c_capture_print('R', rec, len);
+        pos += len;
+        if ((printed & 0x1F) == 0) {
+            vTaskDelay(1);          /* Let the UART drain and the Zigbee task run */
+        }
+    }
+    printf("#I2C-END %lu\n", (unsigned long)printed);
+    fflush(stdout);
+
+    portENTER_CRITICAL(&s_capture_lock);
+    s_paused = false;
+    portEXIT_CRITICAL(&s_capture_lock);
+    return ESP_OK;
+}
+
+/**
+ * @brief One-shot task for i2c_capture_request_dump()
+ */
+static void i2c_capture_dump_task(void *arg)
+{
+    i2c_capture_dump();
+    s_dump_pending = false;
+    vTaskDelete(NULL);
+}
+
+esp_err_t i2c_capture_request_dump(void)
+{
+    if (s_dump_pending) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    s_dump_pending = true;
+    if (xTaskCreate(i2c_capture_dump_task, "i2c_dump", I2C_CAPTURE_DUMP_STACK, NULL,
+                    I2C_CAPTURE_DUMP_PRIORITY, NULL) != pdPASS) {
+        s_dump_pending = false;
+        ESP_LOGE(TAG, "Failed to create dump task");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
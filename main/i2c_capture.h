@@ -0,0 +1,114 @@
+/*
+ * I2C transaction recorder for Aeris_Lite
+ *
+ * Records every sensor I2C transaction (bus, address, bytes written, bytes
+ * read, result, timing) as a variable-length record in a RAM ring. The
+ * sensor initialization transactions (both buses) are pinned in a separate
+ * boot section so every dump can be replayed from sensor initialization
+ * onwards.
+ *
+ * Dumps and streamed records are printed as "#I2C" console lines;
+ * tools/i2c_replay.py feeds them back through the unmodified aeris_driver.c
+ * on the host (see tools/replay/).
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Set to 0 to compile the recorder out of the driver */
+#ifndef AERIS_I2C_CAPTURE_ENABLE
+#define AERIS_I2C_CAPTURE_ENABLE    1
+#endif
+
+#define I2C_CAPTURE_RING_BYTES      8192    /* Ring for records after init (~40 acquisition cycles) */
+#define I2C_CAPTURE_BOOT_BYTES      512     /* Pinned records from aeris_driver_init() */
+#define I2C_CAPTURE_MAX_DATA        32      /* Bytes kept per direction (longer transfers are truncated) */
+
+/* Recording mode */
+typedef enum {
+    I2C_CAPTURE_OFF = 0,
+    I2C_CAPTURE_RING,                       /* Flight recorder, print with i2c_capture_dump() */
+    I2C_CAPTURE_STREAM,                     /* Ring + print every record as it happens */
+} i2c_capture_mode_t;
+
+/* Mode at boot */
+#ifndef I2C_CAPTURE_BOOT_MODE
+#define I2C_CAPTURE_BOOT_MODE       I2C_CAPTURE_RING
+#endif
+
+/* Transaction kind */
+typedef enum {
+    I2C_CAPTURE_OP_WRITE = 0,               /* i2c_master_transmit() */
+    I2C_CAPTURE_OP_READ,                    /* i2c_master_receive() */
+    I2C_CAPTURE_OP_WRITE_READ,              /* i2c_master_transmit_receive() */
+} i2c_capture_op_t;
+
+/*
+ * Record layout (little-endian, must match tools/replay/replay_main.c):
+ *   timestamp_us(4) duration_us(2) result(2, int16) bus_addr(1: bit7 = bus)
+ *   op(1) tx_len(1) rx_len(1) tx[tx_len] rx[rx_len]
+ */
+#define I2C_CAPTURE_HEADER_SIZE     12
+
+/**
+ * @brief Record one transaction (called by the driver's I2C wrappers)
+ *
+ * @param bus      I2C bus number (0 or 1)
+ * @param addr     7-bit device address
+ * @param op       Transaction kind
+ * @param tx       Bytes written (may be NULL when tx_len is 0)
+ * @param rx       Bytes read (may be NULL when rx_len is 0)
+ * @param result   Return value of the I2C driver call
+ * @param start_us perf_now() taken before the transaction
+ */
+void i2c_capture_record(uint8_t bus, uint8_t addr, i2c_capture_op_t op,
+                        const uint8_t *tx, size_t tx_len, const uint8_t *rx, size_t rx_len,
+                        esp_err_t result, uint32_t start_us);
+
+/**
+ * @brief Close the boot section (end of aeris_driver_init())
+ */
+void i2c_capture_end_boot(void);
+
+/**
+ * @brief Set the recording mode
+ */
+esp_err_t i2c_capture_set_mode(i2c_capture_mode_t mode);
+
+/**
+ * @brief Get the recording mode
+ */
+i2c_capture_mode_t i2c_capture_get_mode(void);
+
+/**
+ * @brief Print boot section and ring as "#I2C" lines
+ *
+ * Recording is paused while printing. The ring is kept so repeated dumps
+ * show overlapping history.
+ */
+esp_err_t i2c_capture_dump(void);
+
+/**
+ * @brief Run i2c_capture_dump() from a low-priority one-shot task
+ *
+ * @return ESP_ERR_INVALID_STATE if a dump is already in progress
+ */
+esp_err_t i2c_capture_request_dump(void);
+
+#if AERIS_I2C_CAPTURE_ENABLE
+#define I2C_CAPTURE_RECORD(bus, addr, op, tx, tx_len, rx, rx_len, result, start_us) \
+    i2c_capture_record(bus, addr, op, tx, tx_len, rx, rx_len, result, start_us)
+#else
+#define I2C_CAPTURE_RECORD(bus, addr, op, tx, tx_len, rx, rx_len, result, start_us) do { } while (0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,15 +1,23 @@
 /*
  * RGB LED Indicator Driver Implementation (SK6812)
  * Controls 4 separate LEDs for CO2, VOC, NOx, and Humidity monitoring
+ * The strip is driven by a dedicated render task; the API only queues commands
  */
 
 #include "led_indicator.h"
 #include "board.h"
 #include "driver/rmt_tx.h"
 #include "esp_log.h"
-#include "esp_check.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "binlog.h"
+#include "perf_stats.h"
+#include "event_trace.h"
 #include <string.h>
+#include <stdlib.h>
+#include <math.h>
 
 static const char *TAG = "LED_INDICATOR";
 
@@ -41,43 +49,150 @@ static const char* LED_NAMES[LED_ID_MAX] = {
     [LED_ID_STATUS] = "Status",
 };
 
-/* Default thresholds */
-static led_thresholds_t s_thresholds = {
-    .enabled = true,
-    .led_mask = LED_ENABLE_ALL,  // All 4 LEDs enabled by default (0x0F)
-    .voc_orange = 150,
-    .voc_red = 250,
-    .nox_orange = 150,
-    .nox_red = 250,
-    .co2_orange = 1000,
-    .co2_red = 1500,
-    .humidity_orange_low = 30,
-    .humidity_orange_high = 70,
-    .humidity_red_low = 20,
-    .humidity_red_high = 80,
+/* Color names for logging (indexed by led_color_t) */
+static const char* COLOR_NAMES[] = {
+    [LED_COLOR_OFF] = "OFF",
+    [LED_COLOR_GREEN] = "GREEN",
+    [LED_COLOR_ORANGE] = "ORANGE",
+    [LED_COLOR_RED] = "RED",
 };
 
-/* RMT channel handle - Single channel controlling entire LED strip */
+/* Default thresholds */
+static led_thresholds_t s_thresholds = LED_THRESHOLDS_DEFAULT;
+
+/* RMT channel handle - Single channel controlling entire LED strip, owned by the render task */
 static rmt_channel_handle_t s_rmt_channel = NULL;
-static rmt_encoder_handle_t s_led_encoder = NULL;
+static rmt_encoder_handle_t s_led_encoder = NULL;   // Copy encoder for the pre-encoded frame
+
+/*
+ * Threading model: the public setters only update the configuration below
+ * (under s_led_lock) and post a command to s_led_queue; they never touch the
+ * RMT channel or wait for the strip. The render task owns the frame and the
+ * channel, applies queued commands, then commits the frame with at most one
+ * non-blocking transfer. Transfer completion comes back as LED_CMD_TX_DONE
+ * from the RMT ISR.
+ */
+static portMUX_TYPE s_led_lock = portMUX_INITIALIZER_UNLOCKED;
+static QueueHandle_t s_led_queue = NULL;
 
-/* LED strip buffer - stores GRB values for all LEDs in the chain */
-static uint8_t s_led_strip_buffer[LED_STRIP_NUM_LEDS * 3];  // 3 bytes per LED (GRB)
+/* Render task commands */
+typedef enum {
+    LED_CMD_SENSORS,            // New readings: re-evaluate the sensor LEDs
+    LED_CMD_SENSOR_CONFIG,      // Thresholds or enable changed: re-evaluate the last readings
+    LED_CMD_STATUS,             // Status color, animation or status enable changed
+    LED_CMD_SET_COLOR,          // Direct color for one LED
+    LED_CMD_RENDER,             // Brightness changed: re-render the frame
+    LED_CMD_REFRESH,            // Re-send the strip even if unchanged
+    LED_CMD_TX_DONE,            // RMT transfer finished (posted from ISR)
+} led_cmd_type_t;
 
-/* LED state tracking */
-static led_color_t s_current_colors[LED_ID_MAX] = {
+typedef struct {
+    led_cmd_type_t type;
+    union {
+        led_sensor_data_t sensors;
+        struct {
+            led_id_t id;
+            led_color_t color;
+        } set;
+    };
+} led_cmd_t;
+
+/*
+ * Frame model: commands write colors into the shadow frame (s_frame), then
+ * led_commit() renders it to GRB bytes and transmits once, only if the
+ * bytes differ from what the strip already shows. The RMT symbols for the
+ * whole chain are kept pre-encoded (24 per LED, MSB first, plus the reset
+ * code) and only the bytes that changed are re-encoded.
+ */
+#define LED_FRAME_BYTES     (LED_STRIP_NUM_LEDS * 3)
+#define LED_FRAME_SYMBOLS   (LED_FRAME_BYTES * 8)
+
+/* Colors to display, per LED (after enable/mask rules) - render task only */
+static led_color_t s_frame[LED_ID_MAX] = {
     LED_COLOR_OFF, LED_COLOR_OFF, LED_COLOR_OFF, 
     LED_COLOR_OFF, LED_COLOR_OFF
 };
 
-/* Status LED control */
+/* GRB bytes matching s_frame_symbols, i.e. the last rendered frame */
+static uint8_t s_led_strip_buffer[LED_FRAME_BYTES];
+
+/* Pre-encoded frame: one RMT symbol per bit, then the reset code.
+ * Read by the RMT driver while a transfer is in flight, so only
+ * re-encoded when s_tx_busy is false. */
+static rmt_symbol_word_t s_frame_symbols[LED_FRAME_SYMBOLS + 1];
+
+/*
+ * Animations (status blink/breathe, brightness fades) are sent as batched
+ * sequences: each frame is followed by idle-low symbols holding it for its
+ * duration, so one transfer plays up to LED_ANIM_SEGMENT_MAX_MS of animation
+ * and the render task wakes once per sequence instead of once per frame.
+ * (RMT loop mode would need the frames to fit in channel RAM, which 5 LEDs
+ * don't.)
+ */
+#define LED_SYMBOL_MAX_TICKS    (2 * 32767)     // Both halves of an idle symbol
+#define LED_HOLD_SYMBOLS(ms)    ((((uint32_t)(ms) * (RMT_LED_STRIP_RESOLUTION_HZ / 1000)) + LED_SYMBOL_MAX_TICKS - 1) / LED_SYMBOL_MAX_TICKS)
+
+_Static_assert(LED_SEQ_MAX_SYMBOLS >= LED_FRAME_SYMBOLS + LED_HOLD_SYMBOLS(LED_ANIM_SEGMENT_MAX_MS),
+               "LED sequence buffer must hold at least one frame");
+
+static rmt_symbol_word_t s_seq_symbols[LED_SEQ_MAX_SYMBOLS];
+
+/* Gamma correction (~2.5): average of x^2 and x^3, evaluated by the compiler */
+#define LED_GAMMA(x)    ((uint8_t)((((x) * (x) * (x)) / 255 + (x) * (x) + 255) / 510))
+#define LED_GAMMA4(x)   LED_GAMMA(x), LED_GAMMA((x) + 1), LED_GAMMA((x) + 2), LED_GAMMA((x) + 3)
+#define LED_GAMMA16(x)  LED_GAMMA4(x), LED_GAMMA4((x) + 4), LED_GAMMA4((x) + 8), LED_GAMMA4((x) + 12)
+#define LED_GAMMA64(x)  LED_GAMMA16(x), LED_GAMMA16((x) + 16), LED_GAMMA16((x) + 32), LED_GAMMA16((x) + 48)
+
+/* Perceptual level (0-255) to PWM value */
+static const uint8_t GAMMA_LUT[256] = {
+    LED_GAMMA64(0), LED_GAMMA64(64), LED_GAMMA64(128), LED_GAMMA64(192)
+};
+
+/* Status LED animation (config shared under s_led_lock, s_anim is the render task copy) */
+typedef struct {
+    led_anim_t type;
+    led_color_t color_a;
+    led_color_t color_b;
+    uint16_t period_ms;
+} led_anim_config_t;
+
+static led_anim_config_t s_anim_config = { .type = LED_ANIM_NONE };
+static uint32_t s_anim_generation = 0;          // Bumped on every config change
+
+static struct {
+    led_anim_config_t config;
+    uint32_t generation;
+    uint32_t time_ms;                           // Position within the period
+} s_anim;
+
+/* Brightness fade, in perceptual levels (render task) */
+static struct {
+    bool active;
+    uint8_t from;
+    uint8_t to;
+    uint8_t target;                             // PWM brightness at the end of the fade
+    uint32_t elapsed_ms;
+} s_fade;
+
+static uint8_t s_brightness_now = 0;            // PWM brightness currently rendered (when not fading)
+
+/* Render task transfer state */
+static bool s_frame_sent = false;       // False until the rendered frame has been transmitted
+static bool s_refresh_pending = false;  // Send the next commit even if unchanged
+static bool s_tx_busy = false;
+static bool s_tx_sequence = false;      // Transfer in flight is an animation sequence
+static int64_t s_tx_deadline_us = 0;
+static uint32_t s_tx_start = 0;
+static volatile uint32_t s_frames_sent = 0;
+
+/* Status LED control (shared, under s_led_lock) */
 static bool s_status_led_enabled = true;  // Status LED enabled by default
 static led_color_t s_status_color = LED_COLOR_ORANGE;  // Default: not joined
 
-/* LED brightness level (0-255, default 32 = ~12% brightness) */
+/* LED brightness level (0-255, default 32 = ~12% brightness) (shared, under s_led_lock) */
 static uint8_t s_led_brightness = 32;
 
-/* Last sensor data for immediate LED refresh when enabled */
+/* Last sensor data for immediate LED refresh when enabled - render task only */
 static led_sensor_data_t s_last_sensor_data = {0};
 static bool s_sensor_data_valid = false;
 
@@ -88,8 +203,8 @@ typedef struct {
     uint8_t b;
 } rgb_t;
 
-/* Get RGB values for a color, scaled by current brightness */
-static rgb_t get_color_rgb(led_color_t color)
+/* Get RGB values for a color, scaled by the given brightness */
+static rgb_t get_color_rgb(led_color_t color, uint8_t brightness)
 {
     rgb_t rgb = {0, 0, 0};
     switch (color) {
@@ -97,177 +212,871 @@ static rgb_t get_color_rgb(led_color_t color)
             rgb.g = 0; rgb.r = 0; rgb.b = 0;
             break;
         case LED_COLOR_GREEN:
-            rgb.g = s_led_brightness; rgb.r = 0; rgb.b = 0;
+            rgb.g = brightness; rgb.r = 0; rgb.b = 0;
             break;
         case LED_COLOR_ORANGE:
-            rgb.g = s_led_brightness / 2; rgb.r = s_led_brightness; rgb.b = 0;
+            rgb.g = brightness / 2; rgb.r = brightness; rgb.b = 0;
             break;
         case LED_COLOR_RED:
-            rgb.g = 0; rgb.r = s_led_brightness; rgb.b = 0;
+            rgb.g = 0; rgb.r = brightness; rgb.b = 0;
             break;
     }
     return rgb;
 }
 
-/* RMT encoder for SK6812 */
+/*
+ * Gradient mode (thresholds.gradient): per sensor LED, a 256-entry LUT maps
+ * the reading, quantised over the metric's green-to-red range, to one of
+ * LED_GRADIENT_STEPS colour steps, and a palette turns steps into GRB at the
+ * current brightness. LUTs are rebuilt only when thresholds change and the
+ * palette only when brightness changes, so an update is one lookup per LED.
+ * Render task only.
+ */
 typedef struct {
-    rmt_encoder_t base;
-    rmt_encoder_t *bytes_encoder;
-    rmt_encoder_t *copy_encoder;
-    int state;
-    rmt_symbol_word_t reset_code;
-} rmt_led_strip_encoder_t;
-
-static size_t rmt_encode_led_strip(rmt_encoder_t *encoder, rmt_channel_handle_t channel,
-                                    const void *primary_data, size_t data_size,
-                                    rmt_encode_state_t *ret_state)
-{
-    rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
-    rmt_encoder_handle_t bytes_encoder = led_encoder->bytes_encoder;
-    rmt_encoder_handle_t copy_encoder = led_encoder->copy_encoder;
-    rmt_encode_state_t session_state = RMT_ENCODING_RESET;
-    rmt_encode_state_t state = RMT_ENCODING_RESET;
-    size_t encoded_symbols = 0;
-    
-    switch (led_encoder->state) {
-    case 0: // send RGB data
-        encoded_symbols += bytes_encoder->encode(bytes_encoder, channel, primary_data, data_size, &session_state);
-        if (session_state & RMT_ENCODING_COMPLETE) {
-            led_encoder->state = 1; // switch to next state when current encoding session finished
-        }
-        if (session_state & RMT_ENCODING_MEM_FULL) {
-            state |= RMT_ENCODING_MEM_FULL;
-            goto out;
-        }
-    // fall-through
-    case 1: // send reset code
-        encoded_symbols += copy_encoder->encode(copy_encoder, channel, &led_encoder->reset_code,
-                                                sizeof(led_encoder->reset_code), &session_state);
-        if (session_state & RMT_ENCODING_COMPLETE) {
-            led_encoder->state = RMT_ENCODING_RESET; // back to the initial encoding session
-            state |= RMT_ENCODING_COMPLETE;
+    float lo;                           // Reading at index 0
+    float scale;                        // LUT entries per unit of reading
+    uint8_t step[256];
+} led_gradient_lut_t;
+
+static led_gradient_lut_t s_gradient_lut[LED_ID_STATUS];   // CO2, VOC, NOx, Humidity
+static led_thresholds_t s_gradient_thresholds;              // Thresholds the LUTs were built from
+static bool s_gradient_valid = false;
+static rgb_t s_gradient_palette[LED_GRADIENT_STEPS];
+static int s_palette_brightness = -1;                       // Brightness the palette was built for
+static bool s_frame_gradient[LED_ID_MAX];                   // LED shows s_frame_step instead of s_frame
+static uint8_t s_frame_step[LED_ID_MAX];
+static int16_t s_gradient_index[LED_ID_MAX];                // Last LUT index (hysteresis), -1 = none
+
+/**
+ * @brief GRB of a gradient step at the given brightness, green -> orange -> red
+ *
+ * The palette is rebuilt only when the brightness differs from the last call.
+ */
+static rgb_t led_gradient_rgb(uint8_t step, uint8_t brightness)
+{
+    if (brightness != s_palette_brightness) {
+        const uint32_t top = LED_GRADIENT_STEPS - 1;
+        for (uint32_t i = 0; i <= top; i++) {
+            // Red ramps up over the first half, green down over the whole range,
+            // so the midpoint matches LED_COLOR_ORANGE
+            uint32_t red = (2 * i < top) ? 2 * i : top;
+            s_gradient_palette[i].g = (uint8_t)(brightness * (top - i) / top);
+            s_gradient_palette[i].r = (uint8_t)(brightness * red / top);
+            s_gradient_palette[i].b = 0;
         }
-        if (session_state & RMT_ENCODING_MEM_FULL) {
-            state |= RMT_ENCODING_MEM_FULL;
-            goto out;
+        s_palette_brightness = brightness;
+    }
+    return s_gradient_palette[step];
+}
+
+/* SK6812 bit symbols: duration = time_ns * resolution / 1e9 (10MHz: 1 tick = 100ns) */
+#define SK6812_TICKS(ns)    ((uint32_t)(((uint64_t)(ns) * RMT_LED_STRIP_RESOLUTION_HZ) / 1000000000ULL))
+
+static const rmt_symbol_word_t SK6812_BIT0 = {
+    .level0 = 1, .duration0 = SK6812_TICKS(SK6812_T0H_NS),
+    .level1 = 0, .duration1 = SK6812_TICKS(SK6812_T0L_NS),
+};
+static const rmt_symbol_word_t SK6812_BIT1 = {
+    .level0 = 1, .duration0 = SK6812_TICKS(SK6812_T1H_NS),
+    .level1 = 0, .duration1 = SK6812_TICKS(SK6812_T1L_NS),
+};
+
+/**
+ * @brief Encode GRB bytes into RMT symbols, 8 per byte (MSB first)
+ */
+static void led_encode_bytes(rmt_symbol_word_t *sym, const uint8_t *bytes, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        for (int bit = 0; bit < 8; bit++) {
+            *sym++ = (bytes[i] & (0x80 >> bit)) ? SK6812_BIT1 : SK6812_BIT0;
         }
     }
-out:
-    *ret_state = state;
-    return encoded_symbols;
 }
 
-static esp_err_t rmt_del_led_strip_encoder(rmt_encoder_t *encoder)
+/**
+ * @brief Encode an idle-low hold of @p hold_ms (latches the preceding frame)
+ * @return Number of symbols written, LED_HOLD_SYMBOLS(hold_ms)
+ */
+static size_t led_encode_hold(rmt_symbol_word_t *sym, uint32_t hold_ms)
+{
+    uint32_t ticks = hold_ms * (RMT_LED_STRIP_RESOLUTION_HZ / 1000);
+    size_t count = 0;
+    
+    while (ticks > 0) {
+        uint32_t chunk = (ticks > LED_SYMBOL_MAX_TICKS) ? LED_SYMBOL_MAX_TICKS : ticks;
+        sym[count++] = (rmt_symbol_word_t) {
+            .level0 = 0,
+            .duration0 = chunk / 2 ? chunk / 2 : 1,
+            .level1 = 0,
+            .duration1 = chunk - chunk / 2,
+        };
+        ticks -= chunk;
+    }
+    return count;
+}
+
+/**
+ * @brief Encode the whole frame from s_led_strip_buffer and append the reset code
+ */
+static void led_encode_frame(void)
 {
-    rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
-    rmt_del_encoder(led_encoder->bytes_encoder);
-    rmt_del_encoder(led_encoder->copy_encoder);
-    free(led_encoder);
+    led_encode_bytes(s_frame_symbols, s_led_strip_buffer, LED_FRAME_BYTES);
+    uint32_t reset_ticks = RMT_LED_STRIP_RESOLUTION_HZ / 1000000 * SK6812_RESET_US;
+    s_frame_symbols[LED_FRAME_SYMBOLS] = (rmt_symbol_word_t) {
+        .level0 = 0,
+        .duration0 = reset_ticks,
+        .level1 = 0,
+        .duration1 = reset_ticks,
+    };
+}
+
+/**
+ * @brief RMT transfer-done callback (ISR context) - hands completion to the render task
+ */
+static bool IRAM_ATTR led_rmt_trans_done_cb(rmt_channel_handle_t channel,
+                                            const rmt_tx_done_event_data_t *edata, void *user_ctx)
+{
+    BaseType_t high_task_wakeup = pdFALSE;
+    led_cmd_t cmd = { .type = LED_CMD_TX_DONE };
+    
+    TRACE_INSTANT(TRACE_ISR_RMT_DONE, edata->num_symbols);
+    xQueueSendFromISR(s_led_queue, &cmd, &high_task_wakeup);
+    return high_task_wakeup == pdTRUE;
+}
+
+/**
+ * @brief Post a command to the render task without blocking
+ * @return ESP_OK if queued
+ */
+static esp_err_t led_post(const led_cmd_t *cmd)
+{
+    if (!s_led_queue) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (xQueueSend(s_led_queue, cmd, 0) != pdTRUE) {
+        BINLOGW(TAG, "LED command %d dropped (queue full)", cmd->type);
+        return ESP_ERR_TIMEOUT;
+    }
     return ESP_OK;
 }
 
-static esp_err_t rmt_led_strip_encoder_reset(rmt_encoder_t *encoder)
+static esp_err_t led_post_type(led_cmd_type_t type)
+{
+    led_cmd_t cmd = { .type = type };
+    return led_post(&cmd);
+}
+
+/**
+ * @brief Start a non-blocking transfer of pre-encoded symbols (render task)
+ * @param symbols Single frame (s_frame_symbols) or animation sequence (s_seq_symbols)
+ * @param count Number of symbols
+ * @param duration_ms Playing time of a sequence, 0 for a single frame
+ * @return ESP_OK if the transfer was queued
+ */
+static esp_err_t led_tx_start(const rmt_symbol_word_t *symbols, size_t count, uint32_t duration_ms)
 {
-    rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
-    rmt_encoder_reset(led_encoder->bytes_encoder);
-    rmt_encoder_reset(led_encoder->copy_encoder);
-    led_encoder->state = RMT_ENCODING_RESET;
+    // Clocked from XTAL, so enabling the channel takes no CPU/APB frequency
+    // lock (the driver's no-light-sleep lock is moot on a router). It is still
+    // enabled per transfer so led_tx_finish() can reset a timed-out one with
+    // rmt_disable() and the channel is idle between frames
+    esp_err_t ret = rmt_enable(s_rmt_channel);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to enable RMT channel: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    
+    rmt_transmit_config_t tx_config = {
+        .loop_count = 0,
+    };
+    
+    s_tx_start = perf_now();
+    TRACE_BEGIN(TRACE_LED_REFRESH, 0);
+    ret = rmt_transmit(s_rmt_channel, s_led_encoder, symbols,
+                       count * sizeof(rmt_symbol_word_t), &tx_config);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "LED strip transmit failed: %s", esp_err_to_name(ret));
+        TRACE_END(TRACE_LED_REFRESH, ret);
+        rmt_disable(s_rmt_channel);
+        return ret;
+    }
+    
+    s_tx_busy = true;
+    s_tx_sequence = (duration_ms > 0);
+    s_tx_deadline_us = esp_timer_get_time() + (duration_ms + LED_TX_TIMEOUT_MS) * 1000LL;
     return ESP_OK;
 }
 
-static esp_err_t rmt_new_led_strip_encoder(rmt_encoder_handle_t *ret_encoder)
+/**
+ * @brief Finish the transfer in flight (render task)
+ * @param result ESP_OK on transfer done, ESP_ERR_TIMEOUT if it never completed
+ */
+static void led_tx_finish(esp_err_t result)
+{
+    rmt_disable(s_rmt_channel);
+    s_tx_busy = false;
+    TRACE_END(TRACE_LED_REFRESH, result);
+    
+    if (result == ESP_OK) {
+        if (!s_tx_sequence) {
+            PERF_END(PERF_LED_REFRESH, s_tx_start);
+        }
+        s_frames_sent++;
+    } else {
+        // Make sure the frame is sent again with the next commit
+        s_frame_sent = false;
+    }
+}
+
+/**
+ * @brief Render frame bytes (render task)
+ * @param grb Output, LED_FRAME_BYTES in chain order
+ * @param brightness PWM brightness of the sensor LEDs
+ * @param status_color Color of the status LED
+ * @param status_brightness PWM brightness of the status LED
+ */
+static void led_render(uint8_t *grb, uint8_t brightness,
+                       led_color_t status_color, uint8_t status_brightness)
+{
+    for (int i = 0; i < LED_ID_MAX; i++) {
+        rgb_t rgb;
+        if (i == LED_ID_STATUS) {
+            rgb = get_color_rgb(status_color, status_brightness);
+        } else if (s_frame_gradient[i]) {
+            rgb = led_gradient_rgb(s_frame_step[i], brightness);
+        } else {
+            rgb = get_color_rgb(s_frame[i], brightness);
+        }
+        uint32_t offset = LED_CHAIN_MAP[i] * 3;
+        grb[offset + 0] = rgb.g;
+        grb[offset + 1] = rgb.r;
+        grb[offset + 2] = rgb.b;
+    }
+}
+
+/**
+ * @brief Perceptual level of a PWM brightness (inverse of GAMMA_LUT)
+ */
+static uint8_t gamma_inverse(uint8_t pwm)
+{
+    int lo = 0, hi = 255;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (GAMMA_LUT[mid] < pwm) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return (uint8_t)lo;
+}
+
+/**
+ * @brief Current perceptual level of a brightness fade
+ */
+static uint8_t led_fade_level(void)
+{
+    int32_t span = (int32_t)s_fade.to - (int32_t)s_fade.from;
+    return (uint8_t)(s_fade.from + span * (int32_t)s_fade.elapsed_ms / LED_FADE_MS);
+}
+
+/**
+ * @brief PWM brightness at the current point of the fade
+ */
+static uint8_t led_brightness_now(void)
+{
+    return s_fade.active ? GAMMA_LUT[led_fade_level()] : s_brightness_now;
+}
+
+static bool led_status_animating(void)
+{
+    return s_anim.config.type != LED_ANIM_NONE && s_frame[LED_ID_STATUS] != LED_COLOR_OFF;
+}
+
+static bool led_animating(void)
+{
+    return led_status_animating() || s_fade.active;
+}
+
+/**
+ * @brief Pick up animation and brightness changes before a commit (render task)
+ */
+static void led_sync_animation(void)
 {
-    esp_err_t ret = ESP_OK;
-    rmt_led_strip_encoder_t *led_encoder = NULL;
+    led_anim_config_t config;
+    uint32_t generation;
+    uint8_t target;
     
-    led_encoder = calloc(1, sizeof(rmt_led_strip_encoder_t));
-    ESP_GOTO_ON_FALSE(led_encoder, ESP_ERR_NO_MEM, err, TAG, "no mem for led strip encoder");
+    portENTER_CRITICAL(&s_led_lock);
+    config = s_anim_config;
+    generation = s_anim_generation;
+    target = s_led_brightness;
+    portEXIT_CRITICAL(&s_led_lock);
     
-    led_encoder->base.encode = rmt_encode_led_strip;
-    led_encoder->base.del = rmt_del_led_strip_encoder;
-    led_encoder->base.reset = rmt_led_strip_encoder_reset;
+    if (generation != s_anim.generation) {
+        s_anim.config = config;
+        s_anim.generation = generation;
+        s_anim.time_ms = 0;
+    }
     
-    // SK6812 uses MSB first encoding
-    // Calculate timing: duration = (time_ns * resolution_hz) / 1,000,000,000
-    // At 10MHz: 1 tick = 100ns, so T0H=300ns=3 ticks, T0L=900ns=9 ticks, etc.
-    rmt_bytes_encoder_config_t bytes_encoder_config = {
-        .bit0 = {
-            .level0 = 1,
-            .duration0 = (SK6812_T0H_NS * (uint64_t)RMT_LED_STRIP_RESOLUTION_HZ) / 1000000000ULL,
-            .level1 = 0,
-            .duration1 = (SK6812_T0L_NS * (uint64_t)RMT_LED_STRIP_RESOLUTION_HZ) / 1000000000ULL,
-        },
-        .bit1 = {
-            .level0 = 1,
-            .duration0 = (SK6812_T1H_NS * (uint64_t)RMT_LED_STRIP_RESOLUTION_HZ) / 1000000000ULL,
-            .level1 = 0,
-            .duration1 = (SK6812_T1L_NS * (uint64_t)RMT_LED_STRIP_RESOLUTION_HZ) / 1000000000ULL,
-        },
-        .flags.msb_first = 1,
-    };
-    ESP_GOTO_ON_ERROR(rmt_new_bytes_encoder(&bytes_encoder_config, &led_encoder->bytes_encoder), err, TAG, "create bytes encoder failed");
+    uint8_t goal = s_fade.active ? s_fade.target : s_brightness_now;
+    if (target == goal) {
+        return;
+    }
     
-    rmt_copy_encoder_config_t copy_encoder_config = {};
-    ESP_GOTO_ON_ERROR(rmt_new_copy_encoder(&copy_encoder_config, &led_encoder->copy_encoder), err, TAG, "create copy encoder failed");
+    bool lit = led_status_animating();
+    for (int i = 0; i < LED_ID_MAX; i++) {
+        lit |= (s_frame[i] != LED_COLOR_OFF);
+    }
     
-    uint32_t reset_ticks = RMT_LED_STRIP_RESOLUTION_HZ / 1000000 * SK6812_RESET_US;
-    led_encoder->reset_code = (rmt_symbol_word_t) {
-        .level0 = 0,
-        .duration0 = reset_ticks,
-        .level1 = 0,
-        .duration1 = reset_ticks,
-    };
+    if (LED_FADE_MS == 0 || !lit) {
+        // Nothing visible to fade
+        s_fade.active = false;
+        s_brightness_now = target;
+        return;
+    }
     
-    *ret_encoder = &led_encoder->base;
-    return ESP_OK;
+    // Start (or redirect) a fade from wherever the current one is
+    uint8_t from = s_fade.active ? led_fade_level() : gamma_inverse(s_brightness_now);
+    s_fade.active = true;
+    s_fade.from = from;
+    s_fade.to = gamma_inverse(target);
+    s_fade.target = target;
+    s_fade.elapsed_ms = 0;
+}
+
+/**
+ * @brief Time until the next animation frame differs from the current one
+ */
+static uint32_t led_anim_hold_ms(void)
+{
+    uint32_t hold = LED_ANIM_SEGMENT_MAX_MS;
     
-err:
-    if (led_encoder) {
-        if (led_encoder->bytes_encoder) {
-            rmt_del_encoder(led_encoder->bytes_encoder);
+    if (led_status_animating()) {
+        if (s_anim.config.type == LED_ANIM_BLINK) {
+            uint32_t half = s_anim.config.period_ms / 2;
+            hold = half - (s_anim.time_ms % half);
+        } else {
+            hold = LED_ANIM_STEP_MS;
         }
-        if (led_encoder->copy_encoder) {
-            rmt_del_encoder(led_encoder->copy_encoder);
+    }
+    if (s_fade.active && hold > LED_ANIM_STEP_MS) {
+        hold = LED_ANIM_STEP_MS;
+    }
+    return hold;
+}
+
+/**
+ * @brief Render the animation frame at the current animation time
+ */
+static void led_anim_render(uint8_t *grb)
+{
+    uint8_t brightness = led_brightness_now();
+    led_color_t status_color = s_frame[LED_ID_STATUS];
+    uint8_t status_brightness = brightness;
+    
+    if (led_status_animating()) {
+        const led_anim_config_t *cfg = &s_anim.config;
+        if (cfg->type == LED_ANIM_BLINK) {
+            status_color = (s_anim.time_ms < cfg->period_ms / 2) ? cfg->color_a : cfg->color_b;
+        } else {
+            // Triangle wave in perceptual space, mapped through the gamma table
+            uint32_t phase = s_anim.time_ms * 510 / cfg->period_ms;
+            uint8_t level = (phase <= 255) ? phase : 510 - phase;
+            status_color = cfg->color_a;
+            status_brightness = (uint8_t)((brightness * GAMMA_LUT[level]) / 255);
+        }
+    }
+    led_render(grb, brightness, status_color, status_brightness);
+}
+
+static void led_anim_advance(uint32_t ms)
+{
+    if (s_anim.config.type != LED_ANIM_NONE) {
+        s_anim.time_ms = (s_anim.time_ms + ms) % s_anim.config.period_ms;
+    }
+    if (s_fade.active) {
+        s_fade.elapsed_ms += ms;
+        if (s_fade.elapsed_ms >= LED_FADE_MS) {
+            s_fade.active = false;
+            s_brightness_now = s_fade.target;
         }
-        free(led_encoder);
     }
-    return ret;
 }
 
 /**
- * @brief Refresh entire LED strip by sending buffer to all LEDs
- * @return ESP_OK on success
+ * @brief Encode and start the next animation sequence (render task)
+ *
+ * Frames are batched until LED_ANIM_SEGMENT_MAX_MS, the symbol buffer is
+ * full or the animation ends (fade complete).
  */
-static esp_err_t led_refresh_strip(void)
+static void led_start_sequence(void)
 {
-    if (!s_rmt_channel || !s_led_encoder) {
-        return ESP_ERR_INVALID_STATE;
+    uint8_t grb[LED_FRAME_BYTES];
+    size_t count = 0;
+    uint32_t total_ms = 0;
+    
+    while (led_animating() && total_ms < LED_ANIM_SEGMENT_MAX_MS) {
+        uint32_t hold = led_anim_hold_ms();
+        if (count + LED_FRAME_SYMBOLS + LED_HOLD_SYMBOLS(hold) > LED_SEQ_MAX_SYMBOLS) {
+            break;
+        }
+        led_anim_render(grb);
+        led_encode_bytes(&s_seq_symbols[count], grb, LED_FRAME_BYTES);
+        count += LED_FRAME_SYMBOLS;
+        count += led_encode_hold(&s_seq_symbols[count], hold);
+        led_anim_advance(hold);
+        total_ms += hold;
     }
     
-    rmt_transmit_config_t tx_config = {
-        .loop_count = 0,
+    // The strip keeps showing the last frame of the sequence
+    memcpy(s_led_strip_buffer, grb, LED_FRAME_BYTES);
+    led_encode_frame();
+    s_refresh_pending = false;
+    s_frame_sent = (led_tx_start(s_seq_symbols, count, total_ms) == ESP_OK);
+}
+
+/**
+ * @brief Render the shadow frame and transmit it if it changed (render task)
+ *
+ * At most one RMT transfer per call; nothing is sent when the strip already
+ * shows the rendered bytes. While an animation runs, sends its next
+ * sequence instead. Must not be called while a transfer is in flight.
+ */
+static void led_commit(void)
+{
+    uint8_t grb[LED_FRAME_BYTES];
+    
+    led_sync_animation();
+    if (led_animating()) {
+        led_start_sequence();
+        return;
+    }
+    
+    led_render(grb, s_brightness_now, s_frame[LED_ID_STATUS], s_brightness_now);
+    
+    bool changed = false;
+    for (size_t i = 0; i < LED_FRAME_BYTES; i++) {
+        if (grb[i] != s_led_strip_buffer[i]) {
+            s_led_strip_buffer[i] = grb[i];
+            led_encode_bytes(&s_frame_symbols[i * 8], &grb[i], 1);
+            changed = true;
+        }
+    }
+    
+    if (!changed && s_frame_sent && !s_refresh_pending) {
+        return;
+    }
+    
+    s_refresh_pending = false;
+    s_frame_sent = (led_tx_start(s_frame_symbols, LED_FRAME_SYMBOLS + 1, 0) == ESP_OK);
+}
+
+/**
+ * @brief Write a color into the shadow frame, applying the enable flags (render task)
+ */
+static void led_frame_set(led_id_t led_id, led_color_t color)
+{
+    bool enabled;
+    
+    portENTER_CRITICAL(&s_led_lock);
+    enabled = (led_id == LED_ID_STATUS) ? s_status_led_enabled : s_thresholds.enabled;
+    portEXIT_CRITICAL(&s_led_lock);
+    
+    // Status LED uses its own enable flag, sensor indicator LEDs use thresholds.enabled
+    if (!enabled && color != LED_COLOR_OFF) {
+        BINLOGD(TAG, "%s LED: blocked (disabled), was %s", LED_NAMES[led_id], COLOR_NAMES[color]);
+        color = LED_COLOR_OFF;
+    }
+    
+    s_frame_gradient[led_id] = false;
+    
+    if (s_frame[led_id] != color) {
+        BINLOGD(TAG, "%s LED (chain position %d): %s -> %s", LED_NAMES[led_id],
+                LED_CHAIN_MAP[led_id], COLOR_NAMES[s_frame[led_id]], COLOR_NAMES[color]);
+        s_frame[led_id] = color;
+    }
+}
+
+/**
+ * @brief Lower a threshold by the hysteresis margin without wrapping
+ */
+static inline uint16_t threshold_minus(uint16_t threshold, uint16_t hysteresis)
+{
+    return (threshold > hysteresis) ? threshold - hysteresis : 0;
+}
+
+/**
+ * @brief Evaluate a "higher is worse" reading against orange/red thresholds
+ *
+ * A level already shown is kept until the reading drops @p hysteresis below
+ * its threshold, so values hovering at a threshold don't flicker.
+ */
+static led_color_t evaluate_level(uint16_t value, uint16_t orange, uint16_t red,
+                                  uint16_t hysteresis, led_color_t current)
+{
+    if (current == LED_COLOR_RED) {
+        red = threshold_minus(red, hysteresis);
+    }
+    if (current == LED_COLOR_ORANGE || current == LED_COLOR_RED) {
+        orange = threshold_minus(orange, hysteresis);
+    }
+    
+    if (value >= red) {
+        return LED_COLOR_RED;
+    } else if (value >= orange) {
+        return LED_COLOR_ORANGE;
+    } else {
+        return LED_COLOR_GREEN;
+    }
+}
+
+static led_color_t evaluate_humidity(const led_thresholds_t *t, float humidity_percent)
+{
+    led_color_t current = s_frame[LED_ID_HUMIDITY];
+    float red_low = t->humidity_red_low;
+    float red_high = t->humidity_red_high;
+    float orange_low = t->humidity_orange_low;
+    float orange_high = t->humidity_orange_high;
+    
+    // Same hysteresis as evaluate_level(), applied towards the comfort band on both sides
+    if (current == LED_COLOR_RED) {
+        red_low += LED_HYSTERESIS_HUMIDITY_PCT;
+        red_high -= LED_HYSTERESIS_HUMIDITY_PCT;
+    }
+    if (current == LED_COLOR_ORANGE || current == LED_COLOR_RED) {
+        orange_low += LED_HYSTERESIS_HUMIDITY_PCT;
+        orange_high -= LED_HYSTERESIS_HUMIDITY_PCT;
+    }
+    
+    if (humidity_percent <= red_low || humidity_percent >= red_high) {
+        return LED_COLOR_RED;
+    } else if (humidity_percent <= orange_low || humidity_percent >= orange_high) {
+        return LED_COLOR_ORANGE;
+    } else {
+        return LED_COLOR_GREEN;
+    }
+}
+
+/**
+ * @brief Gradient badness of a "higher is worse" reading
+ * @return 0 at or below @p green, 1 at @p orange, 2 at or above @p red, linear in between
+ */
+static float gradient_badness(float value, float green, float orange, float red)
+{
+    if (value <= green) {
+        return 0.0f;
+    } else if (value < orange) {
+        return (value - green) / (orange - green);
+    } else if (value < red) {
+        return 1.0f + (value - orange) / (red - orange);
+    }
+    return 2.0f;
+}
+
+static float gradient_badness_humidity(const led_thresholds_t *t, float humidity_percent)
+{
+    float orange_low = t->humidity_orange_low;
+    float orange_high = t->humidity_orange_high;
+    float red_low = fminf(t->humidity_red_low, orange_low - 1.0f);
+    float red_high = fmaxf(t->humidity_red_high, orange_high + 1.0f);
+    
+    // Dry side mirrored onto a rising scale, green as far inside orange as red is outside
+    float dry = gradient_badness(-humidity_percent, -(2.0f * orange_low - red_low),
+                                 -orange_low, -red_low);
+    float humid = gradient_badness(humidity_percent, 2.0f * orange_high - red_high,
+                                   orange_high, red_high);
+    return fmaxf(dry, humid);
+}
+
+/**
+ * @brief True if any threshold differs from the ones the gradient LUTs were built from
+ */
+static bool gradient_thresholds_changed(const led_thresholds_t *t)
+{
+    const led_thresholds_t *b = &s_gradient_thresholds;
+    
+    return !s_gradient_valid ||
+           t->co2_orange != b->co2_orange || t->co2_red != b->co2_red ||
+           t->voc_orange != b->voc_orange || t->voc_red != b->voc_red ||
+           t->nox_orange != b->nox_orange || t->nox_red != b->nox_red ||
+           t->humidity_orange_low != b->humidity_orange_low ||
+           t->humidity_orange_high != b->humidity_orange_high ||
+           t->humidity_red_low != b->humidity_red_low ||
+           t->humidity_red_high != b->humidity_red_high;
+}
+
+/**
+ * @brief Rebuild the per-metric gradient LUTs from the thresholds (render task)
+ *
+ * Rising metrics span green (as far below orange as red is above it) to red,
+ * humidity spans red-low to red-high. Float math stays here, off the update path.
+ */
+static void led_gradient_build(const led_thresholds_t *t)
+{
+    for (int i = 0; i < LED_ID_STATUS; i++) {
+        led_gradient_lut_t *lut = &s_gradient_lut[i];
+        float orange = 0.0f, red = 0.0f, lo, hi;
+        
+        switch (i) {
+        case LED_ID_CO2: orange = t->co2_orange; red = t->co2_red; break;
+        case LED_ID_VOC: orange = t->voc_orange; red = t->voc_red; break;
+        case LED_ID_NOX: orange = t->nox_orange; red = t->nox_red; break;
+        default: break;
+        }
+        
+        if (i == LED_ID_HUMIDITY) {
+            lo = fminf(t->humidity_red_low, t->humidity_orange_low - 1.0f);
+            hi = fmaxf(t->humidity_red_high, t->humidity_orange_high + 1.0f);
+        } else {
+            red = fmaxf(red, orange + 1.0f);
+            lo = fmaxf(0.0f, 2.0f * orange - red);
+            hi = red;
+        }
+        
+        lut->lo = lo;
+        lut->scale = 255.0f / (hi - lo);
+        for (int k = 0; k < 256; k++) {
+            float value = lo + k / lut->scale;
+            float badness = (i == LED_ID_HUMIDITY) ? gradient_badness_humidity(t, value)
+                                                   : gradient_badness(value, lo, orange, red);
+            lut->step[k] = (uint8_t)(badness * (LED_GRADIENT_STEPS - 1) / 2.0f + 0.5f);
+        }
+        s_gradient_index[i] = -1;   // Index scale changed, drop the hysteresis anchor
+    }
+    
+    s_gradient_thresholds = *t;
+    s_gradient_valid = true;
+    BINLOGI(TAG, "Gradient LUTs rebuilt");
+}
+
+/**
+ * @brief Write a gradient reading into the shadow frame (render task)
+ *
+ * The reading is quantised to a LUT index; moves smaller than
+ * LED_GRADIENT_HYSTERESIS entries keep the current step, so the strip is
+ * only re-sent when the reading crosses into another colour step.
+ */
+static void led_frame_set_gradient(led_id_t led_id, float value)
+{
+    const led_gradient_lut_t *lut = &s_gradient_lut[led_id];
+    float position = (value - lut->lo) * lut->scale + 0.5f;
+    int index = (position <= 0.0f) ? 0 : (position >= 255.0f) ? 255 : (int)position;
+    
+    if (s_frame_gradient[led_id] && s_gradient_index[led_id] >= 0 &&
+        abs(index - s_gradient_index[led_id]) < LED_GRADIENT_HYSTERESIS) {
+        return;
+    }
+    
+    uint8_t step = lut->step[index];
+    // Discrete equivalent (by thirds) keeps s_frame meaningful for lit checks and logs
+    led_color_t color = (3 * step < LED_GRADIENT_STEPS - 1) ? LED_COLOR_GREEN :
+                        (3 * step < 2 * (LED_GRADIENT_STEPS - 1)) ? LED_COLOR_ORANGE : LED_COLOR_RED;
+    bool was_gradient = s_frame_gradient[led_id];
+    
+    led_frame_set(led_id, color);
+    if (s_frame[led_id] == LED_COLOR_OFF) {
+        return;     // Blocked by the enable flag
+    }
+    
+    if (!was_gradient || s_frame_step[led_id] != step) {
+        BINLOGD(TAG, "%s LED: gradient step %d/%d", LED_NAMES[led_id], step, LED_GRADIENT_STEPS - 1);
+    }
+    s_frame_gradient[led_id] = true;
+    s_frame_step[led_id] = step;
+    s_gradient_index[led_id] = (int16_t)index;
+}
+
+/**
+ * @brief Evaluate the last readings into the sensor LEDs in gradient mode (render task)
+ */
+static void led_render_gradient(const led_thresholds_t *t)
+{
+    static const uint8_t MASK_BITS[LED_ID_STATUS] = {
+        LED_ENABLE_CO2_BIT, LED_ENABLE_VOC_BIT, LED_ENABLE_NOX_BIT, LED_ENABLE_HUM_BIT
+    };
+    const led_sensor_data_t *data = &s_last_sensor_data;
+    const float values[LED_ID_STATUS] = {
+        [LED_ID_CO2] = data->co2_ppm,
+        [LED_ID_VOC] = data->voc_index,
+        [LED_ID_NOX] = data->nox_index,
+        [LED_ID_HUMIDITY] = data->humidity_percent,
     };
     
-    esp_err_t ret = rmt_transmit(s_rmt_channel, s_led_encoder, s_led_strip_buffer, 
-                                 sizeof(s_led_strip_buffer), &tx_config);
-    if (ret == ESP_OK) {
-        ret = rmt_tx_wait_all_done(s_rmt_channel, pdMS_TO_TICKS(100));
-        if (ret != ESP_OK) {
-            ESP_LOGW(TAG, "LED strip transmit timeout");
+    if (gradient_thresholds_changed(t)) {
+        led_gradient_build(t);
+    }
+    
+    for (int i = 0; i < LED_ID_STATUS; i++) {
+        if (t->led_mask & MASK_BITS[i]) {
+            led_frame_set_gradient(i, values[i]);
+        } else {
+            led_frame_set(i, LED_COLOR_OFF);
         }
+    }
+}
+
+/**
+ * @brief Evaluate the last readings into the sensor LEDs of the frame (render task)
+ */
+static void led_render_sensors(void)
+{
+    led_thresholds_t t;
+    const led_sensor_data_t *data = &s_last_sensor_data;
+    
+    portENTER_CRITICAL(&s_led_lock);
+    t = s_thresholds;
+    portEXIT_CRITICAL(&s_led_lock);
+    
+    if (!t.enabled) {
+        // Master switch OFF - turn off all sensor LEDs
+        for (int i = 0; i < LED_ID_MAX; i++) {
+            if (i != LED_ID_STATUS) {
+                led_frame_set(i, LED_COLOR_OFF);
+            }
+        }
+        return;
+    }
+    
+    if (!s_sensor_data_valid) {
+        return;
+    }
+    
+    if (t.gradient) {
+        led_render_gradient(&t);
+        return;
+    }
+    
+    // Evaluate each sensor independently (if enabled in bitmask)
+    
+    // Update CO2 LED (bit 0)
+    if (t.led_mask & LED_ENABLE_CO2_BIT) {
+        led_color_t co2_color = evaluate_level(data->co2_ppm, t.co2_orange, t.co2_red,
+                                               LED_HYSTERESIS_CO2_PPM, s_frame[LED_ID_CO2]);
+        if (co2_color != s_frame[LED_ID_CO2]) {
+            BINLOGI(TAG, "CO2 LED: %s (CO2: %d ppm)", COLOR_NAMES[co2_color], data->co2_ppm);
+        }
+        led_frame_set(LED_ID_CO2, co2_color);
     } else {
-        ESP_LOGW(TAG, "LED strip transmit failed: %s", esp_err_to_name(ret));
+        // LED disabled in mask - turn it off
+        led_frame_set(LED_ID_CO2, LED_COLOR_OFF);
+    }
+    
+    // Update VOC LED (bit 1)
+    if (t.led_mask & LED_ENABLE_VOC_BIT) {
+        led_color_t voc_color = evaluate_level(data->voc_index, t.voc_orange, t.voc_red,
+                                               LED_HYSTERESIS_VOC_INDEX, s_frame[LED_ID_VOC]);
+        if (voc_color != s_frame[LED_ID_VOC]) {
+            BINLOGI(TAG, "VOC LED: %s (index: %d)", COLOR_NAMES[voc_color], data->voc_index);
+        }
+        led_frame_set(LED_ID_VOC, voc_color);
+    } else {
+        led_frame_set(LED_ID_VOC, LED_COLOR_OFF);
+    }
+    
+    // Update NOx LED (bit 2)
+    if (t.led_mask & LED_ENABLE_NOX_BIT) {
+        led_color_t nox_color = evaluate_level(data->nox_index, t.nox_orange, t.nox_red,
+                                               LED_HYSTERESIS_NOX_INDEX, s_frame[LED_ID_NOX]);
+        if (nox_color != s_frame[LED_ID_NOX]) {
+            BINLOGI(TAG, "NOx LED: %s (index: %d)", COLOR_NAMES[nox_color], data->nox_index);
+        }
+        led_frame_set(LED_ID_NOX, nox_color);
+    } else {
+        led_frame_set(LED_ID_NOX, LED_COLOR_OFF);
+    }
+    
+    // Update Humidity LED (bit 3)
+    if (t.led_mask & LED_ENABLE_HUM_BIT) {
+        led_color_t humidity_color = evaluate_humidity(&t, data->humidity_percent);
+        if (humidity_color != s_frame[LED_ID_HUMIDITY]) {
+            BINLOGI(TAG, "Humidity LED: %s (%d x0.1%%)", COLOR_NAMES[humidity_color],
+                    (int)(data->humidity_percent * 10.0f));
+        }
+        led_frame_set(LED_ID_HUMIDITY, humidity_color);
+    } else {
+        led_frame_set(LED_ID_HUMIDITY, LED_COLOR_OFF);
     }
+}
+
+/**
+ * @brief Apply one command to the frame (render task)
+ */
+static void led_handle_command(const led_cmd_t *cmd)
+{
+    switch (cmd->type) {
+    case LED_CMD_SENSORS:
+        s_last_sensor_data = cmd->sensors;
+        s_sensor_data_valid = true;
+        led_render_sensors();
+        break;
+    case LED_CMD_SENSOR_CONFIG:
+        led_render_sensors();
+        break;
+    case LED_CMD_STATUS: {
+        led_color_t color;
+        portENTER_CRITICAL(&s_led_lock);
+        color = s_status_color;
+        portEXIT_CRITICAL(&s_led_lock);
+        led_frame_set(LED_ID_STATUS, color);
+        break;
+    }
+    case LED_CMD_SET_COLOR:
+        led_frame_set(cmd->set.id, cmd->set.color);
+        break;
+    case LED_CMD_RENDER:
+        // Nothing to change in the frame, led_commit() re-renders the bytes
+        break;
+    case LED_CMD_REFRESH:
+        s_refresh_pending = true;
+        break;
+    case LED_CMD_TX_DONE:
+        if (s_tx_busy) {
+            led_tx_finish(ESP_OK);
+        }
+        break;
+    }
+}
+
+/**
+ * @brief LED render task: sole owner of the RMT channel and the frame
+ */
+static void led_render_task(void *arg)
+{
+    led_cmd_t cmd;
     
-    return ret;
+    for (;;) {
+        TickType_t wait = portMAX_DELAY;
+        if (s_tx_busy) {
+            int64_t remaining_us = s_tx_deadline_us - esp_timer_get_time();
+            wait = (remaining_us > 0) ? pdMS_TO_TICKS(remaining_us / 1000) + 1 : 0;
+        }
+        
+        if (xQueueReceive(s_led_queue, &cmd, wait) == pdTRUE) {
+            // Apply everything already queued so one commit covers the whole batch
+            do {
+                led_handle_command(&cmd);
+            } while (xQueueReceive(s_led_queue, &cmd, 0) == pdTRUE);
+        } else if (s_tx_busy) {
+            // Queue is empty: the frame is re-sent with the next command, not retried in a loop
+            ESP_LOGW(TAG, "LED strip transmit timeout");
+            led_tx_finish(ESP_ERR_TIMEOUT);
+            continue;
+        }
+        
+        // Changes made while a transfer is in flight are committed after its TX_DONE
+        if (!s_tx_busy) {
+            led_commit();
+        }
+    }
 }
 
 esp_err_t led_indicator_init(void)
 {
-    ESP_LOGI(TAG, "Initializing RGB LED strip driver (6 LEDs on GPIO%d)", LED_STRIP_GPIO);
+    ESP_LOGI(TAG, "Initializing RGB LED strip driver (%d LEDs on GPIO%d)", LED_STRIP_NUM_LEDS, LED_STRIP_GPIO);
     
-    // Create LED strip encoder
-    esp_err_t ret = rmt_new_led_strip_encoder(&s_led_encoder);
+    // The frame is pre-encoded into RMT symbols, so a plain copy encoder is enough
+    rmt_copy_encoder_config_t copy_encoder_config = {};
+    esp_err_t ret = rmt_new_copy_encoder(&copy_encoder_config, &s_led_encoder);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to create LED strip encoder: %s", esp_err_to_name(ret));
         return ret;
@@ -291,7 +1100,7 @@ esp_err_t led_indicator_init(void)
     
     // Create RMT TX channel on LED strip GPIO
     rmt_tx_channel_config_t tx_chan_config = {
-        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .clk_src = RMT_CLK_SRC_XTAL,     // 40MHz / 4, needs no CPU/APB frequency lock under DFS
         .gpio_num = LED_STRIP_GPIO,
         .mem_block_symbols = 64,
         .resolution_hz = RMT_LED_STRIP_RESOLUTION_HZ,
@@ -304,26 +1113,42 @@ esp_err_t led_indicator_init(void)
         return ret;
     }
     
-    ret = rmt_enable(s_rmt_channel);
+    s_led_queue = xQueueCreate(LED_QUEUE_LENGTH, sizeof(led_cmd_t));
+    if (!s_led_queue) {
+        ESP_LOGE(TAG, "Failed to create LED command queue");
+        return ESP_ERR_NO_MEM;
+    }
+    
+    // Callbacks can only be registered while the channel is disabled
+    rmt_tx_event_callbacks_t rmt_cbs = {
+        .on_trans_done = led_rmt_trans_done_cb,
+    };
+    ret = rmt_tx_register_event_callbacks(s_rmt_channel, &rmt_cbs, NULL);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to enable RMT channel: %s", esp_err_to_name(ret));
+        ESP_LOGE(TAG, "Failed to register RMT callback: %s", esp_err_to_name(ret));
         return ret;
     }
     
-    // Initialize LED strip buffer (all LEDs OFF)
-    memset(s_led_strip_buffer, 0, sizeof(s_led_strip_buffer));
+    // Channel stays disabled between transfers (see led_tx_start)
     
-    // Initialize color tracking
+    // Initialize frame (all LEDs OFF) and its RMT symbols
+    memset(s_led_strip_buffer, 0, sizeof(s_led_strip_buffer));
     for (int i = 0; i < LED_ID_MAX; i++) {
-        s_current_colors[i] = LED_COLOR_OFF;
+        s_frame[i] = LED_COLOR_OFF;
     }
+    led_encode_frame();
+    s_frame_sent = false;
+    s_brightness_now = s_led_brightness;
     
-    // Send initial state to LED strip (all OFF)
-    ret = led_refresh_strip();
-    if (ret != ESP_OK) {
-        ESP_LOGW(TAG, "Initial LED strip refresh failed: %s", esp_err_to_name(ret));
+    if (xTaskCreate(led_render_task, "led_render", LED_TASK_STACK, NULL,
+                    LED_TASK_PRIORITY, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create LED render task");
+        return ESP_ERR_NO_MEM;
     }
     
+    // Send initial state to LED strip (all OFF)
+    led_post_type(LED_CMD_REFRESH);
+    
     ESP_LOGI(TAG, "RGB LED strip initialized successfully (%d LEDs in chain)", LED_STRIP_NUM_LEDS);
     
     return ESP_OK;
@@ -335,8 +1160,13 @@ esp_err_t led_set_thresholds(const led_thresholds_t *thresholds)
         return ESP_ERR_INVALID_ARG;
     }
     
-    memcpy(&s_thresholds, thresholds, sizeof(led_thresholds_t));
+    portENTER_CRITICAL(&s_led_lock);
+    s_thresholds = *thresholds;
+    portEXIT_CRITICAL(&s_led_lock);
     ESP_LOGI(TAG, "LED thresholds updated");
+    
+    // Re-evaluate the last readings against the new thresholds
+    led_post_type(LED_CMD_SENSOR_CONFIG);
     return ESP_OK;
 }
 
@@ -346,7 +1176,9 @@ esp_err_t led_get_thresholds(led_thresholds_t *thresholds)
         return ESP_ERR_INVALID_ARG;
     }
     
-    memcpy(thresholds, &s_thresholds, sizeof(led_thresholds_t));
+    portENTER_CRITICAL(&s_led_lock);
+    *thresholds = s_thresholds;
+    portEXIT_CRITICAL(&s_led_lock);
     return ESP_OK;
 }
 
@@ -360,92 +1192,32 @@ esp_err_t led_set_color(led_id_t led_id, led_color_t color)
         return ESP_ERR_INVALID_ARG;
     }
     
-    if (!s_rmt_channel) {
+    if (!s_led_queue) {
         ESP_LOGW(TAG, "LED driver not initialized");
         return ESP_ERR_INVALID_STATE;
     }
     
-    // Check enable flags based on LED type
-    if (led_id == LED_ID_STATUS) {
-        // Status LED uses its own enable flag
-        if (!s_status_led_enabled && color != LED_COLOR_OFF) {
-            ESP_LOGD(TAG, "Status LED: blocked (disabled)");
-            color = LED_COLOR_OFF;
-        }
-    } else {
-        // Sensor indicator LEDs use thresholds.enabled flag
-        if (!s_thresholds.enabled && color != LED_COLOR_OFF) {
-            ESP_LOGD(TAG, "%s LED: blocked (LEDs disabled), was %s", LED_NAMES[led_id], 
-                     color == LED_COLOR_GREEN ? "GREEN" : (color == LED_COLOR_ORANGE ? "ORANGE" : "RED"));
-            color = LED_COLOR_OFF;
-        }
-    }
-    
-    // Check if color actually changed
-    if (s_current_colors[led_id] == color) {
-        ESP_LOGD(TAG, "%s LED already %s, skipping update", LED_NAMES[led_id],
-                 color == LED_COLOR_OFF ? "OFF" : (color == LED_COLOR_GREEN ? "GREEN" : 
-                 (color == LED_COLOR_ORANGE ? "ORANGE" : "RED")));
-        return ESP_OK;
-    }
-    
-    // Get LED position in chain
-    uint8_t chain_index = LED_CHAIN_MAP[led_id];
-    
-    // Debug: Log the LED set request
-    ESP_LOGI(TAG, "Setting %s LED (chain position %d) to %s (brightness=%d)", 
-             LED_NAMES[led_id], chain_index,
-             color == LED_COLOR_OFF ? "OFF" : (color == LED_COLOR_GREEN ? "GREEN" : 
-             (color == LED_COLOR_ORANGE ? "ORANGE" : "RED")),
-             s_led_brightness);
-    
-    // Get RGB values for this color
-    rgb_t rgb = get_color_rgb(color);
-    
-    // Update LED strip buffer (GRB order for SK6812)
-    uint32_t buffer_offset = chain_index * 3;
-    s_led_strip_buffer[buffer_offset + 0] = rgb.g;
-    s_led_strip_buffer[buffer_offset + 1] = rgb.r;
-    s_led_strip_buffer[buffer_offset + 2] = rgb.b;
-    
-    ESP_LOGD(TAG, "Buffer[%d]: G=%d R=%d B=%d", chain_index, rgb.g, rgb.r, rgb.b);
-    
-    // Refresh entire LED strip with new data
-    esp_err_t ret = led_refresh_strip();
-    if (ret == ESP_OK) {
-        s_current_colors[led_id] = color;
-    } else {
-        ESP_LOGW(TAG, "%s LED update failed", LED_NAMES[led_id]);
-    }
+    BINLOGI(TAG, "Setting %s LED to %s", LED_NAMES[led_id], COLOR_NAMES[color]);
     
-    return ret;
+    led_cmd_t cmd = {
+        .type = LED_CMD_SET_COLOR,
+        .set = { .id = led_id, .color = color },
+    };
+    return led_post(&cmd);
 }
 
 esp_err_t led_set_enable(bool enable)
 {
-    bool was_enabled = s_thresholds.enabled;
+    bool was_enabled;
+    
+    portENTER_CRITICAL(&s_led_lock);
+    was_enabled = s_thresholds.enabled;
     s_thresholds.enabled = enable;
+    portEXIT_CRITICAL(&s_led_lock);
     
-    if (!enable) {
-        // Turn off all sensor LEDs when disabled (not status LED)
-        for (int i = 0; i < LED_ID_MAX; i++) {
-            if (i != LED_ID_STATUS) {
-                led_set_color(i, LED_COLOR_OFF);
-            }
-        }
-    } else if (!was_enabled) {
-        // Just enabled - force refresh all sensor LEDs by resetting tracked colors
-        // This ensures led_update_from_sensors will actually update them
-        for (int i = 0; i < LED_ID_MAX; i++) {
-            if (i != LED_ID_STATUS) {
-                s_current_colors[i] = LED_COLOR_OFF;  // Reset tracking so update is forced
-            }
-        }
-        
-        // Immediately refresh LEDs with last known sensor data
-        if (s_sensor_data_valid) {
-            led_update_from_sensors(&s_last_sensor_data);
-        }
+    // Disabled: sensor LEDs go off. Just enabled: refresh from the last readings
+    if (enable != was_enabled) {
+        led_post_type(LED_CMD_SENSOR_CONFIG);
     }
     
     ESP_LOGI(TAG, "Sensor LEDs %s", enable ? "enabled" : "disabled");
@@ -457,132 +1229,17 @@ bool led_is_enabled(void)
     return s_thresholds.enabled;
 }
 
-static led_color_t evaluate_voc(uint16_t voc_index)
-{
-    if (voc_index >= s_thresholds.voc_red) {
-        return LED_COLOR_RED;
-    } else if (voc_index >= s_thresholds.voc_orange) {
-        return LED_COLOR_ORANGE;
-    } else {
-        return LED_COLOR_GREEN;
-    }
-}
-
-static led_color_t evaluate_nox(uint16_t nox_index)
-{
-    if (nox_index >= s_thresholds.nox_red) {
-        return LED_COLOR_RED;
-    } else if (nox_index >= s_thresholds.nox_orange) {
-        return LED_COLOR_ORANGE;
-    } else {
-        return LED_COLOR_GREEN;
-    }
-}
-
-static led_color_t evaluate_co2(uint16_t co2_ppm)
-{
-    if (co2_ppm >= s_thresholds.co2_red) {
-        return LED_COLOR_RED;
-    } else if (co2_ppm >= s_thresholds.co2_orange) {
-        return LED_COLOR_ORANGE;
-    } else {
-        return LED_COLOR_GREEN;
-    }
-}
-
-static led_color_t evaluate_humidity(float humidity_percent)
-{
-    if (humidity_percent <= s_thresholds.humidity_red_low || 
-        humidity_percent >= s_thresholds.humidity_red_high) {
-        return LED_COLOR_RED;
-    } else if (humidity_percent <= s_thresholds.humidity_orange_low || 
-               humidity_percent >= s_thresholds.humidity_orange_high) {
-        return LED_COLOR_ORANGE;
-    } else {
-        return LED_COLOR_GREEN;
-    }
-}
-
 esp_err_t led_update_from_sensors(const led_sensor_data_t *sensor_data)
 {
     if (!sensor_data) {
         return ESP_ERR_INVALID_ARG;
     }
     
-    // Store for later use when LEDs are re-enabled
-    memcpy(&s_last_sensor_data, sensor_data, sizeof(led_sensor_data_t));
-    s_sensor_data_valid = true;
-    
-    if (!s_thresholds.enabled) {
-        // Master switch OFF - turn off all LEDs
-        for (int i = 0; i < LED_ID_MAX; i++) {
-            if (s_current_colors[i] != LED_COLOR_OFF) {
-                led_set_color(i, LED_COLOR_OFF);
-            }
-        }
-        return ESP_OK;
-    }
-    
-    // Evaluate each sensor independently and update its LED (if enabled in bitmask)
-    
-    // Update CO2 LED (bit 0)
-    if (s_thresholds.led_mask & LED_ENABLE_CO2_BIT) {
-        led_color_t co2_color = evaluate_co2(sensor_data->co2_ppm);
-        if (co2_color != s_current_colors[LED_ID_CO2]) {
-            ESP_LOGI(TAG, "CO2 LED: %s (CO2: %d ppm)", 
-                     co2_color == LED_COLOR_GREEN ? "GREEN" : 
-                     co2_color == LED_COLOR_ORANGE ? "ORANGE" : "RED",
-                     sensor_data->co2_ppm);
-            led_set_color(LED_ID_CO2, co2_color);
-        }
-    } else if (s_current_colors[LED_ID_CO2] != LED_COLOR_OFF) {
-        // LED disabled in mask - turn it off
-        led_set_color(LED_ID_CO2, LED_COLOR_OFF);
-    }
-    
-    // Update VOC LED (bit 1)
-    if (s_thresholds.led_mask & LED_ENABLE_VOC_BIT) {
-        led_color_t voc_color = evaluate_voc(sensor_data->voc_index);
-        if (voc_color != s_current_colors[LED_ID_VOC]) {
-            ESP_LOGI(TAG, "VOC LED: %s (index: %d)", 
-                     voc_color == LED_COLOR_GREEN ? "GREEN" : 
-                     voc_color == LED_COLOR_ORANGE ? "ORANGE" : "RED",
-                     sensor_data->voc_index);
-            led_set_color(LED_ID_VOC, voc_color);
-        }
-    } else if (s_current_colors[LED_ID_VOC] != LED_COLOR_OFF) {
-        led_set_color(LED_ID_VOC, LED_COLOR_OFF);
-    }
-    
-    // Update NOx LED (bit 2)
-    if (s_thresholds.led_mask & LED_ENABLE_NOX_BIT) {
-        led_color_t nox_color = evaluate_nox(sensor_data->nox_index);
-        if (nox_color != s_current_colors[LED_ID_NOX]) {
-            ESP_LOGI(TAG, "NOx LED: %s (index: %d)", 
-                     nox_color == LED_COLOR_GREEN ? "GREEN" : 
-                     nox_color == LED_COLOR_ORANGE ? "ORANGE" : "RED",
-                     sensor_data->nox_index);
-            led_set_color(LED_ID_NOX, nox_color);
-        }
-    } else if (s_current_colors[LED_ID_NOX] != LED_COLOR_OFF) {
-        led_set_color(LED_ID_NOX, LED_COLOR_OFF);
-    }
-    
-    // Update Humidity LED (bit 3)
-    if (s_thresholds.led_mask & LED_ENABLE_HUM_BIT) {
-        led_color_t humidity_color = evaluate_humidity(sensor_data->humidity_percent);
-        if (humidity_color != s_current_colors[LED_ID_HUMIDITY]) {
-            ESP_LOGI(TAG, "Humidity LED: %s (%.1f%%)", 
-                     humidity_color == LED_COLOR_GREEN ? "GREEN" : 
-                     humidity_color == LED_COLOR_ORANGE ? "ORANGE" : "RED",
-                     sensor_data->humidity_percent);
-            led_set_color(LED_ID_HUMIDITY, humidity_color);
-        }
-    } else if (s_current_colors[LED_ID_HUMIDITY] != LED_COLOR_OFF) {
-        led_set_color(LED_ID_HUMIDITY, LED_COLOR_OFF);
-    }
-    
-    return ESP_OK;
+    led_cmd_t cmd = {
+        .type = LED_CMD_SENSORS,
+        .sensors = *sensor_data,
+    };
+    return led_post(&cmd);
 }
 
 /**
@@ -591,16 +1248,18 @@ esp_err_t led_update_from_sensors(const led_sensor_data_t *sensor_data)
 esp_err_t led_set_status(led_color_t color)
 {
     if (color >= LED_COLOR_OFF && color <= LED_COLOR_RED) {
+        portENTER_CRITICAL(&s_led_lock);
         s_status_color = color;
-        
-        // Only update if status LED is enabled
-        if (s_status_led_enabled) {
-            led_set_color(LED_ID_STATUS, color);
-            ESP_LOGI(TAG, "Status LED: %s", 
-                     color == LED_COLOR_GREEN ? "GREEN (Connected)" :
-                     color == LED_COLOR_ORANGE ? "ORANGE (Not joined)" :
-                     color == LED_COLOR_RED ? "RED (Error)" : "OFF");
+        if (s_anim_config.type != LED_ANIM_NONE) {
+            // A steady color replaces any running animation
+            s_anim_config.type = LED_ANIM_NONE;
+            s_anim_generation++;
         }
+        portEXIT_CRITICAL(&s_led_lock);
+        
+        // Render task applies the status enable flag
+        led_post_type(LED_CMD_STATUS);
+        BINLOGD(TAG, "Status LED: %s", COLOR_NAMES[color]);
         return ESP_OK;
     }
     return ESP_ERR_INVALID_ARG;
@@ -611,20 +1270,47 @@ esp_err_t led_set_status(led_color_t color)
  */
 esp_err_t led_set_status_enable(bool enable)
 {
+    portENTER_CRITICAL(&s_led_lock);
     s_status_led_enabled = enable;
+    portEXIT_CRITICAL(&s_led_lock);
     
-    if (enable) {
-        // Force update by resetting tracked color first
-        s_current_colors[LED_ID_STATUS] = LED_COLOR_OFF;
-        // Restore status color
-        led_set_color(LED_ID_STATUS, s_status_color);
-        ESP_LOGI(TAG, "Status LED enabled");
-    } else {
-        // Turn off
-        led_set_color(LED_ID_STATUS, LED_COLOR_OFF);
-        ESP_LOGI(TAG, "Status LED disabled");
+    // Restore status color, or turn off
+    led_post_type(LED_CMD_STATUS);
+    ESP_LOGI(TAG, "Status LED %s", enable ? "enabled" : "disabled");
+    
+    return ESP_OK;
+}
+
+/**
+ * @brief Start or stop a status LED animation
+ */
+esp_err_t led_set_status_animation(led_anim_t anim, led_color_t color_a, led_color_t color_b,
+                                   uint16_t period_ms)
+{
+    if (anim > LED_ANIM_BREATHE || color_a > LED_COLOR_RED || color_b > LED_COLOR_RED) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (anim != LED_ANIM_NONE && period_ms < 2 * LED_ANIM_STEP_MS) {
+        return ESP_ERR_INVALID_ARG;
     }
     
+    portENTER_CRITICAL(&s_led_lock);
+    s_anim_config = (led_anim_config_t) {
+        .type = anim,
+        .color_a = color_a,
+        .color_b = color_b,
+        .period_ms = period_ms,
+    };
+    s_anim_generation++;
+    if (anim != LED_ANIM_NONE) {
+        // Keeps the status LED lit (subject to its enable flag) while animating
+        s_status_color = color_a;
+    }
+    portEXIT_CRITICAL(&s_led_lock);
+    
+    led_post_type(LED_CMD_STATUS);
+    ESP_LOGI(TAG, "Status LED animation %d (%s/%s, %u ms)", anim, COLOR_NAMES[color_a],
+             COLOR_NAMES[color_b], period_ms);
     return ESP_OK;
 }
 
@@ -642,15 +1328,13 @@ bool led_is_status_enabled(void)
  */
 void led_set_brightness(uint8_t brightness)
 {
+    portENTER_CRITICAL(&s_led_lock);
     s_led_brightness = brightness;
+    portEXIT_CRITICAL(&s_led_lock);
     ESP_LOGI(TAG, "LED brightness set to %d", brightness);
     
-    // Refresh all currently lit LEDs with new brightness
-    for (int i = 0; i < LED_ID_MAX; i++) {
-        if (s_current_colors[i] != LED_COLOR_OFF) {
-            led_set_color(i, s_current_colors[i]);
-        }
-    }
+    // Colors are unchanged but their bytes are not: the render task fades to the new level
+    led_post_type(LED_CMD_RENDER);
 }
 
 /**
@@ -661,3 +1345,20 @@ uint8_t led_get_brightness(void)
 {
     return s_led_brightness;
 }
+
+/**
+ * @brief Queue a re-send of the current strip contents (console benchmark)
+ * @return ESP_OK if queued
+ */
+esp_err_t led_indicator_refresh(void)
+{
+    return led_post_type(LED_CMD_REFRESH);
+}
+
+/**
+ * @brief Number of strip transfers completed since boot
+ */
+uint32_t led_indicator_frames_sent(void)
+{
+    return s_frames_sent;
+}
@@ -3,6 +3,10 @@
  * Provides visual feedback for air quality sensor readings
  * 4 separate LEDs: CO2, VOC, NOx, Humidity
  * 1 status LED: Zigbee network status
+ *
+ * All setters are non-blocking and safe from any task or timer callback:
+ * they update the configuration and queue a command for the LED render
+ * task, which is the only code touching the RMT channel.
  */
 
 #ifndef LED_INDICATOR_H
@@ -29,6 +33,41 @@ typedef enum {
 #define LED_ENABLE_HUM_BIT      (1 << 3)  // Bit 3: Humidity LED
 #define LED_ENABLE_ALL          0x0F      // All 4 LEDs enabled (bits 0-3)
 
+/* LED render task: owns the RMT channel, the API only queues commands */
+#define LED_TASK_STACK          2560
+#define LED_TASK_PRIORITY       4       /* Below the Zigbee task (5) */
+#define LED_QUEUE_LENGTH        16      /* Pending commands; setters never block on a full queue */
+#define LED_TX_TIMEOUT_MS       100     /* Give up on a transfer without a done callback */
+
+/*
+ * Threshold hysteresis: once an LED shows orange or red it keeps that color
+ * until the reading is back this far on the good side of the threshold, so a
+ * value hovering at a threshold doesn't make the LED flicker.
+ */
+#ifndef LED_HYSTERESIS_CO2_PPM
+#define LED_HYSTERESIS_CO2_PPM      50
+#endif
+#ifndef LED_HYSTERESIS_VOC_INDEX
+#define LED_HYSTERESIS_VOC_INDEX    10
+#endif
+#ifndef LED_HYSTERESIS_NOX_INDEX
+#define LED_HYSTERESIS_NOX_INDEX    10
+#endif
+#ifndef LED_HYSTERESIS_HUMIDITY_PCT
+#define LED_HYSTERESIS_HUMIDITY_PCT 2
+#endif
+
+/*
+ * Gradient mode: sensor LEDs blend green -> orange -> red continuously between
+ * the thresholds, in LED_GRADIENT_STEPS colour steps. Readings are quantised
+ * to 256 LUT entries per metric; a reading has to move LED_GRADIENT_HYSTERESIS
+ * entries before its LED changes step.
+ */
+#define LED_GRADIENT_STEPS          32
+#ifndef LED_GRADIENT_HYSTERESIS
+#define LED_GRADIENT_HYSTERESIS     2
+#endif
+
 /* LED Color definitions */
 typedef enum {
     LED_COLOR_OFF = 0,
@@ -37,10 +76,26 @@ typedef enum {
     LED_COLOR_RED         // Poor air quality
 } led_color_t;
 
+/* Status LED animations */
+typedef enum {
+    LED_ANIM_NONE = 0,      // Steady status color
+    LED_ANIM_BLINK,         // color_a for the first half of the period, color_b for the second
+    LED_ANIM_BREATHE,       // color_a fading in and out once per period (gamma corrected)
+} led_anim_t;
+
+/* Animation engine: frames are batched into one RMT transfer per segment */
+#define LED_ANIM_STEP_MS        50      /* Frame interval of breathe and fade animations */
+#define LED_ANIM_SEGMENT_MAX_MS 1000    /* Longest sequence, i.e. worst-case latency of other LED changes while animating */
+#define LED_SEQ_MAX_SYMBOLS     1024    /* RMT symbols per sequence (4 bytes each) */
+#ifndef LED_FADE_MS
+#define LED_FADE_MS             400     /* Brightness change fade time, 0 for immediate */
+#endif
+
 /* Air quality thresholds structure */
 typedef struct {
     bool enabled;           // Master LED enable/disable (all LEDs)
     uint8_t led_mask;       // Bitmask for individual LED control (bits 0-4)
+    bool gradient;          // Continuous colour gradient instead of three threshold colours
     
     // VOC Index thresholds (1-500 scale)
     uint16_t voc_orange;    // Warning threshold (default: 150)
@@ -61,6 +116,17 @@ typedef struct {
     uint16_t humidity_red_high;     // Very humid (default: 80%)
 } led_thresholds_t;
 
+#define LED_THRESHOLDS_DEFAULT { \
+    .enabled = true, \
+    .led_mask = LED_ENABLE_ALL, \
+    .gradient = false, \
+    .voc_orange = 150, .voc_red = 250, \
+    .nox_orange = 150, .nox_red = 250, \
+    .co2_orange = 1000, .co2_red = 1500, \
+    .humidity_orange_low = 30, .humidity_orange_high = 70, \
+    .humidity_red_low = 20, .humidity_red_high = 80, \
+}
+
 /* Sensor data for LED evaluation */
 typedef struct {
     uint16_t voc_index;
@@ -91,6 +157,9 @@ esp_err_t led_get_thresholds(led_thresholds_t *thresholds);
 
 /**
  * @brief Update LED based on sensor readings
+ *
+ * Queued to the render task, which evaluates all four sensor LEDs into the
+ * frame and sends the strip once, only if the frame changed. Never blocks.
  * @param sensor_data Current sensor readings
  * @return ESP_OK on success
  */
@@ -118,7 +187,7 @@ esp_err_t led_set_enable(bool enable);
 bool led_is_enabled(void);
 
 /**
- * @brief Set Zigbee status LED color
+ * @brief Set Zigbee status LED color (stops any status animation)
  * @param color Color to set (GREEN=connected, ORANGE=not joined, RED=error)
  * @return ESP_OK on success
  */
@@ -131,6 +200,20 @@ esp_err_t led_set_status(led_color_t color);
  */
 esp_err_t led_set_status_enable(bool enable);
 
+/**
+ * @brief Start or stop a status LED animation
+ *
+ * Played by the render task as batched RMT sequences, so the CPU wakes at
+ * most once per LED_ANIM_SEGMENT_MAX_MS. led_set_status() stops it.
+ * @param anim Animation, LED_ANIM_NONE to return to the steady status color
+ * @param color_a Blink first color / breathe color (also becomes the status color)
+ * @param color_b Blink second color (ignored for breathe)
+ * @param period_ms Full blink or breathe cycle (at least 2 * LED_ANIM_STEP_MS)
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG on bad parameters
+ */
+esp_err_t led_set_status_animation(led_anim_t anim, led_color_t color_a, led_color_t color_b,
+                                   uint16_t period_ms);
+
 /**
  * @brief Check if status LED is enabled
  * @return true if enabled, false otherwise
@@ -139,6 +222,8 @@ bool led_is_status_enabled(void);
 
 /**
  * @brief Set LED brightness level
+ *
+ * Lit LEDs fade to the new level over LED_FADE_MS.
  * @param brightness Brightness level 0-255 (0=off, 255=max)
  *                   Recommended: 8-64 for indoor use
  */
@@ -150,4 +235,17 @@ void led_set_brightness(uint8_t brightness);
  */
 uint8_t led_get_brightness(void);
 
+/**
+ * @brief Queue a re-send of the current strip contents even if unchanged (console benchmark)
+ * @return ESP_OK if queued
+ */
+esp_err_t led_indicator_refresh(void);
+
+/**
+ * @brief Number of strip transfers completed since boot
+ *
+ * Lets the console benchmark time led_indicator_refresh() up to completion.
+ */
+uint32_t led_indicator_frames_sent(void);
+
 #endif // LED_INDICATOR_H
@@ -0,0 +1,161 @@
+/*
+ * Latency instrumentation implementation for Aeris_Lite
+ *
+ * Timestamps come from esp_timer (systimer, 1 us resolution) rather than the
+ * CPU cycle counter: with DFS enabled the CPU clock moves between 40 and
+ * 160 MHz, so cycle counts cannot be converted back to time.
+ */
+
+#include "perf_stats.h"
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+
+static const char *TAG = "PERF";
+
+typedef struct {
+    uint32_t count;
+    uint32_t max_us;
+    uint32_t buckets[PERF_NUM_BUCKETS];
+} perf_hist_t;
+
+static const char *PERF_NAMES[PERF_ID_MAX] = {
+    [PERF_READ_TEMP_HUM] = "read_temp_hum",
+    [PERF_READ_PRESSURE] = "read_pressure",
+    [PERF_READ_VOC] = "read_voc",
+    [PERF_READ_NOX] = "read_nox",
+    [PERF_READ_CO2] = "read_co2",
+    [PERF_I2C_SHT45] = "i2c_sht45",
+    [PERF_I2C_LPS22HB] = "i2c_lps22hb",
+    [PERF_I2C_SGP41] = "i2c_sgp41",
+    [PERF_I2C_SCD40] = "i2c_scd40",
+    [PERF_LED_REFRESH] = "led_refresh",
+    [PERF_ZB_ATTR_BATCH] = "zb_attr_batch",
+    [PERF_NVS_COMMIT] = "nvs_commit",
+    [PERF_OTA_WRITE] = "ota_write",
+};
+
+static perf_hist_t s_hist[PERF_ID_MAX];
+static portMUX_TYPE s_perf_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief log2 bucket index for a duration (floor(log2(us)), 0 for 0/1 us)
+ */
+static inline uint8_t perf_bucket(uint32_t us)
+{
+    uint8_t b = (us == 0) ? 0 : (uint8_t)(31 - __builtin_clz(us));
+    return (b >= PERF_NUM_BUCKETS) ? (PERF_NUM_BUCKETS - 1) : b;
+}
+
+void perf_record(perf_id_t id, uint32_t start_us)
+{
+    if (id >= PERF_ID_MAX) {
+        return;
+    }
+
+    uint32_t elapsed = perf_now() - start_us;   /* Wraps correctly (~71 min period) */
+    uint8_t b = perf_bucket(elapsed);
+
+    portENTER_CRITICAL_SAFE(&s_perf_lock);
+    perf_hist_t *h = &s_hist[id];
+    h->count++;
+    h->buckets[b]++;
+    if (elapsed > h->max_us) {
+        h->max_us = elapsed;
+    }
+    portEXIT_CRITICAL_SAFE(&s_perf_lock);
+}
+
+/**
+ * @brief Bucket containing the given percentile (0-100) of a histogram copy
+ */
+static uint8_t perf_percentile(const perf_hist_t *h, uint32_t pct)
+{
+    /* Rank of the sample at this percentile (1-based, rounded up) */
+    uint64_t rank = ((uint64_t)h->count * pct + 99) / 100;
+    uint32_t cumulative = 0;
+
+    if (rank == 0) {
+        rank = 1;
+    }
+    for (uint8_t b = 0; b < PERF_NUM_BUCKETS; b++) {
+        cumulative += h->buckets[b];
+        if (cumulative >= rank) {
+            return b;
+        }
+    }
+    return PERF_NUM_BUCKETS - 1;
+}
+
+esp_err_t perf_get_summary(perf_id_t id, perf_summary_t *summary)
+{
+    if (id >= PERF_ID_MAX || !summary) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    perf_hist_t h;
+    portENTER_CRITICAL(&s_perf_lock);
+    h = s_hist[id];
+    portEXIT_CRITICAL(&s_perf_lock);
+
+    memset(summary, 0, sizeof(*summary));
+    summary->count = h.count;
+    summary->max_us = h.max_us;
+    if (h.count > 0) {
+        summary->p50_bucket = perf_percentile(&h, 50);
+        summary->p90_bucket = perf_percentile(&h, 90);
+        summary->p99_bucket = perf_percentile(&h, 99);
+    }
+    return ESP_OK;
+}
+
+const char *perf_get_name(perf_id_t id)
+{
+    return (id < PERF_ID_MAX) ? PERF_NAMES[id] : "?";
+}
+
+void perf_dump(void)
+{
+    ESP_LOGI(TAG, "%-14s %8s %10s %10s %10s %10s", "operation", "count", "p50<us", "p90<us", "p99<us", "max_us");
+    for (int i = 0; i < PERF_ID_MAX; i++) {
+        perf_summary_t s;
+        perf_get_summary((perf_id_t)i, &s);
+        if (s.count == 0) {
+            continue;
+        }
+        ESP_LOGI(TAG, "%-14s %8lu %10lu %10lu %10lu %10lu", PERF_NAMES[i], s.count,
+                 perf_bucket_upper_us(s.p50_bucket), perf_bucket_upper_us(s.p90_bucket),
+                 perf_bucket_upper_us(s.p99_bucket), s.max_us);
+    }
+}
+
+void perf_reset(void)
+{
+    portENTER_CRITICAL(&s_perf_lock);
+    memset(s_hist, 0, sizeof(s_hist));
+    portEXIT_CRITICAL(&s_perf_lock);
+}
+
+size_t perf_encode_summary(uint8_t *buf, size_t buf_size)
+{
+    size_t len = 1;
+
+    if (!buf || buf_size < 1) {
+        return 0;
+    }
+
+    for (int i = 0; i < PERF_ID_MAX && len + PERF_ENCODED_ENTRY_SIZE <= buf_size; i++) {
+        perf_summary_t s;
+        perf_get_summary((perf_id_t)i, &s);
+        if (s.count == 0) {
+            continue;
+        }
+        buf[len++] = (uint8_t)i;
+        buf[len++] = s.p50_bucket;
+        buf[len++] = s.p90_bucket;
+        buf[len++] = s.p99_bucket;
+    }
+
+    buf[0] = (uint8_t)(len - 1);
+    return len;
+}
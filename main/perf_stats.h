@@ -0,0 +1,126 @@
+/*
+ * Latency instrumentation for Aeris_Lite
+ *
+ * Fixed-bucket log2 histograms of operation durations in microseconds.
+ * Bucket b counts samples in [2^b, 2^(b+1)) us (bucket 0 also holds 0 us),
+ * so percentiles are reported as the upper edge of the bucket they fall in.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "esp_timer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Set to 0 to compile all instrumentation out */
+#ifndef AERIS_PERF_ENABLE
+#define AERIS_PERF_ENABLE       1
+#endif
+
+#define PERF_NUM_BUCKETS        24      /* 1 us .. 16.7 s (last bucket is open-ended) */
+
+/* Dump the histogram table to the log every N sensor updates (0 = never) */
+#ifndef PERF_DUMP_EVERY_N_UPDATES
+#define PERF_DUMP_EVERY_N_UPDATES   20
+#endif
+
+/* Instrumented operations */
+typedef enum {
+    PERF_READ_TEMP_HUM = 0,     /* aeris_read_temp_humidity() */
+    PERF_READ_PRESSURE,         /* aeris_read_pressure() */
+    PERF_READ_VOC,              /* aeris_read_voc() */
+    PERF_READ_NOX,              /* aeris_read_nox() */
+    PERF_READ_CO2,              /* aeris_read_co2() */
+    PERF_I2C_SHT45,             /* Single I2C transaction per device */
+    PERF_I2C_LPS22HB,
+    PERF_I2C_SGP41,
+    PERF_I2C_SCD40,
+    PERF_LED_REFRESH,           /* led_refresh_strip() */
+    PERF_ZB_ATTR_BATCH,         /* esp_zb_zcl_set_attribute_val() batch per sensor update */
+    PERF_NVS_COMMIT,            /* nvs_commit() in settings.c */
+    PERF_OTA_WRITE,             /* esp_ota_write() per OTA chunk */
+    PERF_ID_MAX
+} perf_id_t;
+
+/* Percentile summary for one operation */
+typedef struct {
+    uint32_t count;
+    uint32_t max_us;
+    uint8_t p50_bucket;
+    uint8_t p90_bucket;
+    uint8_t p99_bucket;
+} perf_summary_t;
+
+/* Per-entry size of perf_encode_summary() output: id, p50, p90, p99 bucket */
+#define PERF_ENCODED_ENTRY_SIZE 4
+
+/**
+ * @brief Timestamp for perf_record()
+ */
+static inline uint32_t perf_now(void)
+{
+    return (uint32_t)esp_timer_get_time();
+}
+
+/**
+ * @brief Record one sample for @p id, measured from @p start_us (from perf_now())
+ *
+ * Safe from task and ISR context.
+ */
+void perf_record(perf_id_t id, uint32_t start_us);
+
+/**
+ * @brief Get the percentile summary for one operation
+ */
+esp_err_t perf_get_summary(perf_id_t id, perf_summary_t *summary);
+
+/**
+ * @brief Upper edge of a histogram bucket in microseconds
+ */
+static inline uint32_t perf_bucket_upper_us(uint8_t bucket)
+{
+    return (bucket >= 31) ? UINT32_MAX : (1UL << (bucket + 1));
+}
+
+/**
+ * @brief Get the name of an operation for display
+ */
+const char *perf_get_name(perf_id_t id);
+
+/**
+ * @brief Print count, p50/p90/p99 and max of every operation to the log
+ */
+void perf_dump(void);
+
+/**
+ * @brief Clear all histograms
+ */
+void perf_reset(void);
+
+/**
+ * @brief Encode percentiles of all operations with samples as a ZCL octet string
+ *
+ * Layout: [len] then per operation {id, p50 bucket, p90 bucket, p99 bucket}.
+ *
+ * @param buf Output buffer (first byte receives the length)
+ * @param buf_size Size of @p buf
+ * @return Total bytes written including the length byte
+ */
+size_t perf_encode_summary(uint8_t *buf, size_t buf_size);
+
+#if AERIS_PERF_ENABLE
+#define PERF_BEGIN(var)         uint32_t var = perf_now()
+#define PERF_END(id, var)       perf_record(id, var)
+#else
+#define PERF_BEGIN(var)         do { } while (0)
+#define PERF_END(id, var)       do { } while (0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,116 +1,516 @@
 /*
  * Settings persistence module for Aeris Air Quality Sensor
- * 
- * Stores user-configurable settings in NVS flash memory
+ *
+ * Stores user-configurable settings in NVS flash memory as one versioned,
+ * CRC-protected blob. Setters only update the RAM copy; a debounce timer
+ * wakes the commit task once the writes stop (see SETTINGS_COMMIT_DELAY_MS).
  */
 #include "settings.h"
 #include "nvs_flash.h"
 #include "nvs.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_rom_crc.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "perf_stats.h"
+#include "event_trace.h"
+#include <stddef.h>
+#include <stdlib.h>
 #include <string.h>
 
 static const char *TAG = "SETTINGS";
 
 /* NVS namespace and keys */
 #define NVS_NAMESPACE           "aeris_cfg"
+#define NVS_KEY_SETTINGS        "settings"      // settings_blob_t
+
+/* Keys of the per-setting layout before the blob (migrated once, then erased) */
 #define NVS_KEY_SENSOR_LEDS     "sensor_leds"
 #define NVS_KEY_STATUS_LED      "status_led"
 #define NVS_KEY_BRIGHTNESS      "brightness"
 #define NVS_KEY_LED_MASK        "led_mask"
+#define NVS_KEY_LED_GRADIENT    "led_gradient"
 #define NVS_KEY_TEMP_OFFSET     "temp_offset"
 #define NVS_KEY_HUM_OFFSET      "hum_offset"
 #define NVS_KEY_REFRESH_INTERVAL "refresh_int"
 #define NVS_KEY_PM_POLL_INTERVAL "pm_poll_int"
+#define NVS_KEY_FAN_MODE        "fan_mode"
+#define NVS_KEY_FAN_CURVE       "fan_curve"     // fan_curve_t blob
+#define NVS_KEY_FAN_PURGE       "fan_purge"     // fan_purge_t blob
+
+static const char *const LEGACY_KEYS[] = {
+    NVS_KEY_SENSOR_LEDS, NVS_KEY_STATUS_LED, NVS_KEY_BRIGHTNESS, NVS_KEY_LED_MASK,
+    NVS_KEY_LED_GRADIENT, NVS_KEY_TEMP_OFFSET, NVS_KEY_HUM_OFFSET, NVS_KEY_REFRESH_INTERVAL,
+    NVS_KEY_PM_POLL_INTERVAL, NVS_KEY_FAN_MODE, NVS_KEY_FAN_CURVE, NVS_KEY_FAN_PURGE,
+};
+
+/*
+ * Blob layout. Fields are only ever appended to aeris_settings_t: a blob of
+ * another size with the same version is loaded over the defaults (shorter)
+ * or truncated (longer, written by newer firmware). Bump the version only
+ * for changes that need an explicit conversion in settings_blob_load().
+ */
+#define SETTINGS_BLOB_VERSION   1
+
+typedef struct {
+    uint16_t version;           // SETTINGS_BLOB_VERSION
+    uint16_t size;              // Bytes of settings data following the header
+    uint32_t crc;               // CRC-32 of the settings data
+} settings_blob_header_t;
+
+typedef struct {
+    settings_blob_header_t header;
+    aeris_settings_t data;
+} settings_blob_t;
+
+/*
+ * Version 1 layout. The nested structs are defined by the fan and LED
+ * modules, so a field added there would shift everything after it under
+ * the same version and CRC: these fail the build instead. When a check
+ * fails, append the new field at the end of aeris_settings_t (or bump the
+ * version with a conversion) and add its offset here.
+ */
+#define SETTINGS_LAYOUT(member, offset) \
+    _Static_assert(offsetof(aeris_settings_t, member) == (offset), "settings blob layout changed: " #member)
+SETTINGS_LAYOUT(sensor_leds_enabled, 0);
+SETTINGS_LAYOUT(status_led_enabled, 1);
+SETTINGS_LAYOUT(led_brightness, 2);
+SETTINGS_LAYOUT(led_mask, 3);
+SETTINGS_LAYOUT(led_gradient, 4);
+SETTINGS_LAYOUT(temperature_offset, 6);
+SETTINGS_LAYOUT(humidity_offset, 8);
+SETTINGS_LAYOUT(sensor_refresh_interval, 10);
+SETTINGS_LAYOUT(pm_poll_interval, 12);
+SETTINGS_LAYOUT(fan_mode, 14);
+SETTINGS_LAYOUT(fan_curve, 16);
+SETTINGS_LAYOUT(fan_curve.temp_start_c, 20);
+SETTINGS_LAYOUT(fan_curve.humidity_full, 34);
+SETTINGS_LAYOUT(fan_purge, 36);
+SETTINGS_LAYOUT(fan_purge.measure_percent, 39);
+SETTINGS_LAYOUT(led_thresholds, 40);
+SETTINGS_LAYOUT(led_thresholds.voc_orange, 44);
+SETTINGS_LAYOUT(led_thresholds.humidity_red_high, 62);
+SETTINGS_LAYOUT(fan_full_rpm, 64);
+_Static_assert(sizeof(fan_curve_t) == 20 && sizeof(fan_purge_t) == 4 && sizeof(led_thresholds_t) == 24,
+               "settings blob layout changed: nested struct size");
+_Static_assert(sizeof(aeris_settings_t) == 66, "settings blob layout changed: append the field and update the checks");
 
 /* Default values */
 #define DEFAULT_SENSOR_LEDS_ENABLED     true
 #define DEFAULT_STATUS_LED_ENABLED      true
 #define DEFAULT_LED_BRIGHTNESS          32      // ~12% brightness
 #define DEFAULT_LED_MASK                0x1F    // All 5 LEDs enabled
+#define DEFAULT_LED_GRADIENT            false   // Threshold colors
 #define DEFAULT_TEMP_OFFSET             0       // No offset
 #define DEFAULT_HUM_OFFSET              0       // No offset
 #define DEFAULT_REFRESH_INTERVAL        30      // 30 seconds
 #define DEFAULT_PM_POLL_INTERVAL        300     // 5 minutes (0=continuous)
+#define DEFAULT_FAN_MODE                FAN_MODE_AUTO
+
+static const aeris_settings_t s_defaults = {
+    .sensor_leds_enabled = DEFAULT_SENSOR_LEDS_ENABLED,
+    .status_led_enabled = DEFAULT_STATUS_LED_ENABLED,
+    .led_brightness = DEFAULT_LED_BRIGHTNESS,
+    .led_mask = DEFAULT_LED_MASK,
+    .led_gradient = DEFAULT_LED_GRADIENT,
+    .temperature_offset = DEFAULT_TEMP_OFFSET,
+    .humidity_offset = DEFAULT_HUM_OFFSET,
+    .sensor_refresh_interval = DEFAULT_REFRESH_INTERVAL,
+    .pm_poll_interval = DEFAULT_PM_POLL_INTERVAL,
+    .fan_mode = DEFAULT_FAN_MODE,
+    .fan_curve = FAN_CURVE_DEFAULT,
+    .fan_purge = FAN_PURGE_DEFAULT,
+    .led_thresholds = LED_THRESHOLDS_DEFAULT,
+    .fan_full_rpm = FAN_CURVE_FULL_RPM,
+};
 
-/* Current settings in RAM */
+/* Current settings in RAM (written by the setters, snapshotted by the commit timer under s_lock) */
 static aeris_settings_t s_settings = {
     .sensor_leds_enabled = DEFAULT_SENSOR_LEDS_ENABLED,
     .status_led_enabled = DEFAULT_STATUS_LED_ENABLED,
     .led_brightness = DEFAULT_LED_BRIGHTNESS,
     .led_mask = DEFAULT_LED_MASK,
+    .led_gradient = DEFAULT_LED_GRADIENT,
     .temperature_offset = DEFAULT_TEMP_OFFSET,
     .humidity_offset = DEFAULT_HUM_OFFSET,
     .sensor_refresh_interval = DEFAULT_REFRESH_INTERVAL,
     .pm_poll_interval = DEFAULT_PM_POLL_INTERVAL,
+    .fan_mode = DEFAULT_FAN_MODE,
+    .fan_curve = FAN_CURVE_DEFAULT,
+    .fan_purge = FAN_PURGE_DEFAULT,
+    .led_thresholds = LED_THRESHOLDS_DEFAULT,
+    .fan_full_rpm = FAN_CURVE_FULL_RPM,
 };
 
 static bool s_initialized = false;
 
-esp_err_t settings_init(void)
+/* Write coalescing */
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t s_commit_timer = NULL;
+static TaskHandle_t s_commit_task = NULL;
+static SemaphoreHandle_t s_write_mutex = NULL;  // One snapshot-to-commit sequence at a time
+static bool s_dirty = false;                    // RAM copy differs from flash
+static int64_t s_dirty_since_us = 0;            // First change since the last commit
+static settings_stats_t s_stats = {0};
+
+/* nvs_commit() with latency and trace instrumentation */
+static esp_err_t settings_commit(nvs_handle_t handle)
 {
-    if (s_initialized) {
-        return ESP_OK;
+    PERF_BEGIN(t0);
+    TRACE_BEGIN(TRACE_NVS_COMMIT, 0);
+    esp_err_t ret = nvs_commit(handle);
+    TRACE_END(TRACE_NVS_COMMIT, ret);
+    PERF_END(PERF_NVS_COMMIT, t0);
+    return ret;
+}
+
+/**
+ * @brief Write the RAM copy as one blob and commit it
+ *
+ * Changes made while the flash write runs keep the store dirty and are
+ * committed by the next timer expiry. Writers are serialized so an older
+ * snapshot can never be committed after a newer one.
+ */
+static esp_err_t settings_write_blob(void)
+{
+    if (s_write_mutex) {
+        xSemaphoreTake(s_write_mutex, portMAX_DELAY);
     }
-    
+
+    settings_blob_t blob = {
+        .header = {
+            .version = SETTINGS_BLOB_VERSION,
+            .size = sizeof(aeris_settings_t),
+        },
+    };
+
+    portENTER_CRITICAL(&s_lock);
+    blob.data = s_settings;
+    s_dirty = false;
+    portEXIT_CRITICAL(&s_lock);
+
+    blob.header.crc = esp_rom_crc32_le(0, (const uint8_t *)&blob.data, sizeof(blob.data));
+
     nvs_handle_t handle;
-    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle);
-    
-    if (ret == ESP_ERR_NVS_NOT_FOUND) {
-        // First boot - use defaults
-        ESP_LOGI(TAG, "No saved settings found, using defaults");
-        s_initialized = true;
-        return ESP_OK;
-    } else if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open NVS: %s", esp_err_to_name(ret));
-        return ret;
+    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret == ESP_OK) {
+        ret = nvs_set_blob(handle, NVS_KEY_SETTINGS, &blob, sizeof(blob));
+        if (ret == ESP_OK) {
+            ret = settings_commit(handle);
+        }
+        nvs_close(handle);
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    if (ret == ESP_OK) {
+        s_stats.commits++;
+        s_stats.bytes_written += sizeof(blob);
+    } else {
+        s_stats.commit_errors++;
+        if (!s_dirty) {
+            s_dirty = true;     // Retried with the next change or flush
+            s_dirty_since_us = esp_timer_get_time();
+        }
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (s_write_mutex) {
+        xSemaphoreGive(s_write_mutex);
+    }
+
+    if (ret == ESP_OK) {
+        ESP_LOGD(TAG, "Settings committed (%u bytes)", (unsigned)sizeof(blob));
+    } else {
+        ESP_LOGE(TAG, "Failed to save settings: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+/*
+ * Debounce timer expiry (esp_timer task). The flash write can stall for
+ * tens of milliseconds, so it runs in the commit task rather than here,
+ * where it would hold up every other esp_timer client (fan tach sampler).
+ */
+static void settings_commit_timer_cb(void *arg)
+{
+    xTaskNotifyGive(s_commit_task);
+}
+
+static void settings_commit_task(void *arg)
+{
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        settings_flush();   // No-op if a flush already wrote the changes
+    }
+}
+
+/**
+ * @brief Mark the RAM copy dirty and (re)start the debounce window
+ *
+ * Every change pushes the commit back by SETTINGS_COMMIT_DELAY_MS, but never
+ * past SETTINGS_COMMIT_MAX_DELAY_MS after the first uncommitted change.
+ */
+static void settings_schedule_commit(void)
+{
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&s_lock);
+    s_stats.changes++;
+    if (!s_dirty) {
+        s_dirty = true;
+        s_dirty_since_us = now;
+    }
+    int64_t deadline = s_dirty_since_us + SETTINGS_COMMIT_MAX_DELAY_MS * 1000LL;
+    portEXIT_CRITICAL(&s_lock);
+
+    if (s_commit_timer == NULL) {
+        settings_write_blob();      // Not initialized: write through
+        return;
+    }
+
+    int64_t delay_us = SETTINGS_COMMIT_DELAY_MS * 1000LL;
+    if (now + delay_us > deadline) {
+        delay_us = (deadline > now) ? deadline - now : 1;
+    }
+    esp_timer_stop(s_commit_timer);
+    esp_timer_start_once(s_commit_timer, (uint64_t)delay_us);
+}
+
+/**
+ * @brief Update one field of the RAM copy
+ * @return true if the value changed (a commit is scheduled)
+ */
+static bool settings_update(void *field, const void *value, size_t size)
+{
+    portENTER_CRITICAL(&s_lock);
+    bool changed = (memcmp(field, value, size) != 0);
+    if (changed) {
+        memcpy(field, value, size);
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (changed) {
+        settings_schedule_commit();
+    }
+    return changed;
+}
+
+/*
+ * Field-wise equality for the structs with padding, whose padding bytes are
+ * indeterminate after a struct copy and would make memcmp() report changes.
+ */
+static bool led_thresholds_equal(const led_thresholds_t *a, const led_thresholds_t *b)
+{
+    return a->voc_orange == b->voc_orange && a->voc_red == b->voc_red &&
+           a->nox_orange == b->nox_orange && a->nox_red == b->nox_red &&
+           a->co2_orange == b->co2_orange && a->co2_red == b->co2_red &&
+           a->humidity_orange_low == b->humidity_orange_low &&
+           a->humidity_orange_high == b->humidity_orange_high &&
+           a->humidity_red_low == b->humidity_red_low &&
+           a->humidity_red_high == b->humidity_red_high;
+}
+
+static bool fan_curve_equal(const fan_curve_t *a, const fan_curve_t *b)
+{
+    return a->idle_percent == b->idle_percent &&
+           a->hysteresis_percent == b->hysteresis_percent &&
+           a->ramp_down_percent_min == b->ramp_down_percent_min &&
+           a->temp_start_c == b->temp_start_c && a->temp_full_c == b->temp_full_c &&
+           a->voc_start == b->voc_start && a->voc_full == b->voc_full &&
+           a->co2_start_ppm == b->co2_start_ppm && a->co2_full_ppm == b->co2_full_ppm &&
+           a->humidity_start == b->humidity_start && a->humidity_full == b->humidity_full;
+}
+
+/**
+ * @brief Load a blob read from NVS into the RAM copy
+ * @return true if the blob was valid
+ */
+static bool settings_blob_load(const uint8_t *raw, size_t len)
+{
+    settings_blob_header_t header;
+    if (len < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, raw, sizeof(header));
+
+    const uint8_t *data = raw + sizeof(header);
+    if (header.version != SETTINGS_BLOB_VERSION || header.size != len - sizeof(header) ||
+        esp_rom_crc32_le(0, data, header.size) != header.crc) {
+        return false;
+    }
+
+    s_settings = s_defaults;
+    memcpy(&s_settings, data, (header.size < sizeof(s_settings)) ? header.size : sizeof(s_settings));
+    if (header.size != sizeof(s_settings)) {
+        ESP_LOGI(TAG, "Settings blob resized (%u -> %u bytes)",
+                 header.size, (unsigned)sizeof(s_settings));
+        s_dirty = true;
+        s_dirty_since_us = esp_timer_get_time();
     }
-    
-    // Load each setting (use default if not found)
+    return true;
+}
+
+/**
+ * @brief Read the per-setting keys written by earlier firmware
+ * @return Number of keys found
+ */
+static int settings_load_legacy(nvs_handle_t handle)
+{
+    int found = 0;
     uint8_t u8_val;
     int16_t i16_val;
-    
+    uint16_t u16_val;
+
     if (nvs_get_u8(handle, NVS_KEY_SENSOR_LEDS, &u8_val) == ESP_OK) {
         s_settings.sensor_leds_enabled = (u8_val != 0);
+        found++;
     }
-    
     if (nvs_get_u8(handle, NVS_KEY_STATUS_LED, &u8_val) == ESP_OK) {
         s_settings.status_led_enabled = (u8_val != 0);
+        found++;
     }
-    
     if (nvs_get_u8(handle, NVS_KEY_BRIGHTNESS, &u8_val) == ESP_OK) {
         s_settings.led_brightness = u8_val;
+        found++;
     }
-    
     if (nvs_get_u8(handle, NVS_KEY_LED_MASK, &u8_val) == ESP_OK) {
         s_settings.led_mask = u8_val;
+        found++;
+    }
+    if (nvs_get_u8(handle, NVS_KEY_LED_GRADIENT, &u8_val) == ESP_OK) {
+        s_settings.led_gradient = (u8_val != 0);
+        found++;
     }
-    
     if (nvs_get_i16(handle, NVS_KEY_TEMP_OFFSET, &i16_val) == ESP_OK) {
         s_settings.temperature_offset = i16_val;
+        found++;
     }
-    
     if (nvs_get_i16(handle, NVS_KEY_HUM_OFFSET, &i16_val) == ESP_OK) {
         s_settings.humidity_offset = i16_val;
+        found++;
     }
-    
-    uint16_t u16_val;
     if (nvs_get_u16(handle, NVS_KEY_REFRESH_INTERVAL, &u16_val) == ESP_OK) {
         s_settings.sensor_refresh_interval = u16_val;
+        found++;
     }
-    
     if (nvs_get_u16(handle, NVS_KEY_PM_POLL_INTERVAL, &u16_val) == ESP_OK) {
         s_settings.pm_poll_interval = u16_val;
+        found++;
+    }
+    if (nvs_get_u8(handle, NVS_KEY_FAN_MODE, &u8_val) == ESP_OK) {
+        s_settings.fan_mode = u8_val;
+        found++;
+    }
+
+    fan_curve_t curve;
+    size_t curve_size = sizeof(curve);
+    if (nvs_get_blob(handle, NVS_KEY_FAN_CURVE, &curve, &curve_size) == ESP_OK &&
+        curve_size == sizeof(curve)) {
+        s_settings.fan_curve = curve;
+        found++;
+    }
+
+    fan_purge_t purge;
+    size_t purge_size = sizeof(purge);
+    if (nvs_get_blob(handle, NVS_KEY_FAN_PURGE, &purge, &purge_size) == ESP_OK &&
+        purge_size == sizeof(purge)) {
+        s_settings.fan_purge = purge;
+        found++;
+    }
+
+    return found;
+}
+
+/**
+ * @brief Erase the per-setting keys once they live in the blob
+ */
+static void settings_erase_legacy(void)
+{
+    nvs_handle_t handle;
+    if (nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK) {
+        return;
+    }
+    for (size_t i = 0; i < sizeof(LEGACY_KEYS) / sizeof(LEGACY_KEYS[0]); i++) {
+        nvs_erase_key(handle, LEGACY_KEYS[i]);     // ESP_ERR_NVS_NOT_FOUND is fine
+    }
+    settings_commit(handle);
+    nvs_close(handle);
+}
+
+esp_err_t settings_init(void)
+{
+    if (s_initialized) {
+        return ESP_OK;
+    }
+
+    s_write_mutex = xSemaphoreCreateMutex();
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = settings_commit_timer_cb,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "settings",
+    };
+    if (xTaskCreate(settings_commit_task, "settings", SETTINGS_TASK_STACK, NULL,
+                    SETTINGS_TASK_PRIORITY, &s_commit_task) != pdPASS ||
+        esp_timer_create(&timer_args, &s_commit_timer) != ESP_OK) {
+        ESP_LOGW(TAG, "No commit timer, settings will be written through");
+        s_commit_timer = NULL;
+    }
+
+    nvs_handle_t handle;
+    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle);
+
+    if (ret == ESP_ERR_NVS_NOT_FOUND) {
+        // First boot - use defaults
+        ESP_LOGI(TAG, "No saved settings found, using defaults");
+        s_initialized = true;
+        return ESP_OK;
+    } else if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS: %s", esp_err_to_name(ret));
+        return ret;
     }
-    
+
+    /* One lookup for everything; the per-setting keys only on the first boot after an update */
+    bool migrate = false;
+    size_t len = 0;
+    ret = nvs_get_blob(handle, NVS_KEY_SETTINGS, NULL, &len);
+    if (ret == ESP_OK) {
+        uint8_t *raw = malloc(len);
+        if (raw && nvs_get_blob(handle, NVS_KEY_SETTINGS, raw, &len) == ESP_OK &&
+            settings_blob_load(raw, len)) {
+            ESP_LOGI(TAG, "Settings blob v%d loaded (%u bytes)", SETTINGS_BLOB_VERSION, (unsigned)len);
+        } else {
+            ESP_LOGW(TAG, "Settings blob invalid (version, size or CRC), using defaults");
+            s_settings = s_defaults;
+        }
+        free(raw);
+    } else if (settings_load_legacy(handle) > 0) {
+        migrate = true;
+    }
+
     nvs_close(handle);
-    
-    ESP_LOGI(TAG, "Settings loaded: sensor_leds=%d, status_led=%d, brightness=%d, mask=0x%02X, temp_off=%d, hum_off=%d, refresh=%ds, pm_poll=%ds",
+
+    if (migrate) {
+        ESP_LOGI(TAG, "Migrating settings to blob v%d", SETTINGS_BLOB_VERSION);
+        if (settings_write_blob() == ESP_OK) {
+            settings_erase_legacy();
+        }
+    }
+
+    ESP_LOGI(TAG, "Settings loaded: sensor_leds=%d, status_led=%d, brightness=%d, mask=0x%02X, gradient=%d, temp_off=%d, hum_off=%d, refresh=%ds, pm_poll=%ds, fan_mode=%d",
              s_settings.sensor_leds_enabled, s_settings.status_led_enabled,
-             s_settings.led_brightness, s_settings.led_mask,
+             s_settings.led_brightness, s_settings.led_mask, s_settings.led_gradient,
              s_settings.temperature_offset, s_settings.humidity_offset,
-             s_settings.sensor_refresh_interval, s_settings.pm_poll_interval);
-    
+             s_settings.sensor_refresh_interval, s_settings.pm_poll_interval,
+             s_settings.fan_mode);
+
     s_initialized = true;
+
+    if (s_dirty) {
+        settings_flush();   // Resized blob
+    }
     return ESP_OK;
 }
 
@@ -119,7 +519,9 @@ esp_err_t settings_get(aeris_settings_t *settings)
     if (!settings) {
         return ESP_ERR_INVALID_ARG;
     }
+    portENTER_CRITICAL(&s_lock);
     memcpy(settings, &s_settings, sizeof(aeris_settings_t));
+    portEXIT_CRITICAL(&s_lock);
     return ESP_OK;
 }
 
@@ -128,123 +530,125 @@ esp_err_t settings_save(const aeris_settings_t *settings)
     if (!settings) {
         return ESP_ERR_INVALID_ARG;
     }
-    
-    nvs_handle_t handle;
-    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open NVS for writing: %s", esp_err_to_name(ret));
-        return ret;
-    }
-    
-    nvs_set_u8(handle, NVS_KEY_SENSOR_LEDS, settings->sensor_leds_enabled ? 1 : 0);
-    nvs_set_u8(handle, NVS_KEY_STATUS_LED, settings->status_led_enabled ? 1 : 0);
-    nvs_set_u8(handle, NVS_KEY_BRIGHTNESS, settings->led_brightness);
-    nvs_set_u8(handle, NVS_KEY_LED_MASK, settings->led_mask);
-    nvs_set_i16(handle, NVS_KEY_TEMP_OFFSET, settings->temperature_offset);
-    nvs_set_i16(handle, NVS_KEY_HUM_OFFSET, settings->humidity_offset);
-    nvs_set_u16(handle, NVS_KEY_REFRESH_INTERVAL, settings->sensor_refresh_interval);
-    nvs_set_u16(handle, NVS_KEY_PM_POLL_INTERVAL, settings->pm_poll_interval);
-    
-    ret = nvs_commit(handle);
-    nvs_close(handle);
-    
+
+    portENTER_CRITICAL(&s_lock);
+    memcpy(&s_settings, settings, sizeof(aeris_settings_t));
+    s_dirty = true;
+    portEXIT_CRITICAL(&s_lock);
+
+    esp_err_t ret = settings_flush();
     if (ret == ESP_OK) {
-        memcpy(&s_settings, settings, sizeof(aeris_settings_t));
         ESP_LOGI(TAG, "Settings saved to NVS");
-    } else {
-        ESP_LOGE(TAG, "Failed to commit NVS: %s", esp_err_to_name(ret));
     }
-    
     return ret;
 }
 
-/* Helper to save a single value */
-static esp_err_t save_u8(const char *key, uint8_t value)
+esp_err_t settings_flush(void)
 {
-    nvs_handle_t handle;
-    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
-    if (ret != ESP_OK) return ret;
-    
-    ret = nvs_set_u8(handle, key, value);
-    if (ret == ESP_OK) {
-        ret = nvs_commit(handle);
+    if (s_commit_timer) {
+        esp_timer_stop(s_commit_timer);
     }
-    nvs_close(handle);
-    return ret;
+
+    portENTER_CRITICAL(&s_lock);
+    bool dirty = s_dirty;
+    portEXIT_CRITICAL(&s_lock);
+
+    return dirty ? settings_write_blob() : ESP_OK;
 }
 
-static esp_err_t save_i16(const char *key, int16_t value)
+void settings_get_stats(settings_stats_t *stats)
 {
-    nvs_handle_t handle;
-    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
-    if (ret != ESP_OK) return ret;
-    
-    ret = nvs_set_i16(handle, key, value);
-    if (ret == ESP_OK) {
-        ret = nvs_commit(handle);
+    portENTER_CRITICAL(&s_lock);
+    *stats = s_stats;
+    stats->pending = s_dirty;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+esp_err_t settings_set_field(size_t offset, const void *value, size_t size)
+{
+    if (value == NULL || size == 0 || offset > sizeof(s_settings) - size) {
+        return ESP_ERR_INVALID_ARG;
     }
-    nvs_close(handle);
-    return ret;
+    settings_update((uint8_t *)&s_settings + offset, value, size);
+    return ESP_OK;
 }
 
 esp_err_t settings_set_sensor_leds_enabled(bool enabled)
 {
-    esp_err_t ret = save_u8(NVS_KEY_SENSOR_LEDS, enabled ? 1 : 0);
-    if (ret == ESP_OK) {
-        s_settings.sensor_leds_enabled = enabled;
-        ESP_LOGI(TAG, "Sensor LEDs %s (saved)", enabled ? "enabled" : "disabled");
+    if (settings_update(&s_settings.sensor_leds_enabled, &enabled, sizeof(enabled))) {
+        ESP_LOGI(TAG, "Sensor LEDs %s", enabled ? "enabled" : "disabled");
     }
-    return ret;
+    return ESP_OK;
 }
 
 esp_err_t settings_set_status_led_enabled(bool enabled)
 {
-    esp_err_t ret = save_u8(NVS_KEY_STATUS_LED, enabled ? 1 : 0);
-    if (ret == ESP_OK) {
-        s_settings.status_led_enabled = enabled;
-        ESP_LOGI(TAG, "Status LED %s (saved)", enabled ? "enabled" : "disabled");
+    if (settings_update(&s_settings.status_led_enabled, &enabled, sizeof(enabled))) {
+        ESP_LOGI(TAG, "Status LED %s", enabled ? "enabled" : "disabled");
     }
-    return ret;
+    return ESP_OK;
 }
 
 esp_err_t settings_set_led_brightness(uint8_t brightness)
 {
-    esp_err_t ret = save_u8(NVS_KEY_BRIGHTNESS, brightness);
-    if (ret == ESP_OK) {
-        s_settings.led_brightness = brightness;
-        ESP_LOGI(TAG, "LED brightness set to %d (saved)", brightness);
+    if (settings_update(&s_settings.led_brightness, &brightness, sizeof(brightness))) {
+        ESP_LOGI(TAG, "LED brightness set to %d", brightness);
     }
-    return ret;
+    return ESP_OK;
 }
 
 esp_err_t settings_set_led_mask(uint8_t mask)
 {
-    esp_err_t ret = save_u8(NVS_KEY_LED_MASK, mask);
-    if (ret == ESP_OK) {
-        s_settings.led_mask = mask;
-        ESP_LOGI(TAG, "LED mask set to 0x%02X (saved)", mask);
+    if (settings_update(&s_settings.led_mask, &mask, sizeof(mask))) {
+        ESP_LOGI(TAG, "LED mask set to 0x%02X", mask);
     }
-    return ret;
+    return ESP_OK;
+}
+
+esp_err_t settings_set_led_gradient(bool gradient)
+{
+    if (settings_update(&s_settings.led_gradient, &gradient, sizeof(gradient))) {
+        ESP_LOGI(TAG, "LED gradient mode %s", gradient ? "on" : "off");
+    }
+    return ESP_OK;
+}
+
+esp_err_t settings_set_led_thresholds(const led_thresholds_t *thresholds)
+{
+    /* enabled, led_mask and gradient have their own settings */
+    led_thresholds_t t = *thresholds;
+    t.enabled = s_defaults.led_thresholds.enabled;
+    t.led_mask = s_defaults.led_thresholds.led_mask;
+    t.gradient = s_defaults.led_thresholds.gradient;
+
+    portENTER_CRITICAL(&s_lock);
+    bool changed = !led_thresholds_equal(&s_settings.led_thresholds, &t);
+    if (changed) {
+        s_settings.led_thresholds = t;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (changed) {
+        settings_schedule_commit();
+        ESP_LOGI(TAG, "LED thresholds updated");
+    }
+    return ESP_OK;
 }
 
 esp_err_t settings_set_temperature_offset(int16_t offset)
 {
-    esp_err_t ret = save_i16(NVS_KEY_TEMP_OFFSET, offset);
-    if (ret == ESP_OK) {
-        s_settings.temperature_offset = offset;
-        ESP_LOGI(TAG, "Temperature offset set to %d (saved)", offset);
+    if (settings_update(&s_settings.temperature_offset, &offset, sizeof(offset))) {
+        ESP_LOGI(TAG, "Temperature offset set to %d", offset);
     }
-    return ret;
+    return ESP_OK;
 }
 
 esp_err_t settings_set_humidity_offset(int16_t offset)
 {
-    esp_err_t ret = save_i16(NVS_KEY_HUM_OFFSET, offset);
-    if (ret == ESP_OK) {
-        s_settings.humidity_offset = offset;
-        ESP_LOGI(TAG, "Humidity offset set to %d (saved)", offset);
+    if (settings_update(&s_settings.humidity_offset, &offset, sizeof(offset))) {
+        ESP_LOGI(TAG, "Humidity offset set to %d", offset);
     }
-    return ret;
+    return ESP_OK;
 }
 
 bool settings_get_sensor_leds_enabled(void)
@@ -267,6 +671,19 @@ uint8_t settings_get_led_mask(void)
     return s_settings.led_mask;
 }
 
+bool settings_get_led_gradient(void)
+{
+    return s_settings.led_gradient;
+}
+
+void settings_get_led_thresholds(led_thresholds_t *thresholds)
+{
+    *thresholds = s_settings.led_thresholds;
+    thresholds->enabled = s_settings.sensor_leds_enabled;
+    thresholds->led_mask = s_settings.led_mask;
+    thresholds->gradient = s_settings.led_gradient;
+}
+
 int16_t settings_get_temperature_offset(void)
 {
     return s_settings.temperature_offset;
@@ -287,32 +704,16 @@ uint16_t settings_get_pm_poll_interval(void)
     return s_settings.pm_poll_interval;
 }
 
-static esp_err_t save_u16(const char *key, uint16_t value)
-{
-    nvs_handle_t handle;
-    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
-    if (ret != ESP_OK) return ret;
-    
-    ret = nvs_set_u16(handle, key, value);
-    if (ret == ESP_OK) {
-        ret = nvs_commit(handle);
-    }
-    nvs_close(handle);
-    return ret;
-}
-
 esp_err_t settings_set_sensor_refresh_interval(uint16_t interval_sec)
 {
     // Clamp to valid range (10-3600 seconds)
     if (interval_sec < 10) interval_sec = 10;
     if (interval_sec > 3600) interval_sec = 3600;
-    
-    esp_err_t ret = save_u16(NVS_KEY_REFRESH_INTERVAL, interval_sec);
-    if (ret == ESP_OK) {
-        s_settings.sensor_refresh_interval = interval_sec;
-        ESP_LOGI(TAG, "Sensor refresh interval set to %d seconds (saved)", interval_sec);
+
+    if (settings_update(&s_settings.sensor_refresh_interval, &interval_sec, sizeof(interval_sec))) {
+        ESP_LOGI(TAG, "Sensor refresh interval set to %d seconds", interval_sec);
     }
-    return ret;
+    return ESP_OK;
 }
 
 esp_err_t settings_set_pm_poll_interval(uint16_t interval_sec)
@@ -320,39 +721,98 @@ esp_err_t settings_set_pm_poll_interval(uint16_t interval_sec)
     // Clamp to valid range (0=continuous, or 60-3600 seconds)
     if (interval_sec != 0 && interval_sec < 60) interval_sec = 60;
     if (interval_sec > 3600) interval_sec = 3600;
-    
-    esp_err_t ret = save_u16(NVS_KEY_PM_POLL_INTERVAL, interval_sec);
-    if (ret == ESP_OK) {
-        s_settings.pm_poll_interval = interval_sec;
-        ESP_LOGI(TAG, "PM poll interval set to %d seconds (saved)", interval_sec);
+
+    if (settings_update(&s_settings.pm_poll_interval, &interval_sec, sizeof(interval_sec))) {
+        ESP_LOGI(TAG, "PM poll interval set to %d seconds", interval_sec);
     }
-    return ret;
+    return ESP_OK;
+}
+
+esp_err_t settings_set_fan_mode(fan_mode_t mode)
+{
+    uint8_t value = (uint8_t)mode;
+    if (settings_update(&s_settings.fan_mode, &value, sizeof(value))) {
+        ESP_LOGI(TAG, "Fan mode set to %d", mode);
+    }
+    return ESP_OK;
+}
+
+esp_err_t settings_set_fan_curve(const fan_curve_t *curve)
+{
+    portENTER_CRITICAL(&s_lock);
+    bool changed = !fan_curve_equal(&s_settings.fan_curve, curve);
+    if (changed) {
+        s_settings.fan_curve = *curve;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (changed) {
+        settings_schedule_commit();
+        ESP_LOGI(TAG, "Fan curve updated");
+    }
+    return ESP_OK;
+}
+
+esp_err_t settings_set_fan_purge(const fan_purge_t *purge)
+{
+    if (settings_update(&s_settings.fan_purge, purge, sizeof(*purge))) {
+        ESP_LOGI(TAG, "Fan purge: %ds at %d%%, measure at %d%%",
+                 purge->purge_s, purge->purge_percent, purge->measure_percent);
+    }
+    return ESP_OK;
+}
+
+fan_mode_t settings_get_fan_mode(void)
+{
+    return (fan_mode_t)s_settings.fan_mode;
+}
+
+void settings_get_fan_curve(fan_curve_t *curve)
+{
+    *curve = s_settings.fan_curve;
+}
+
+void settings_get_fan_purge(fan_purge_t *purge)
+{
+    *purge = s_settings.fan_purge;
+}
+
+uint16_t settings_get_fan_full_rpm(void)
+{
+    return s_settings.fan_full_rpm;
 }
 
 esp_err_t settings_reset_to_defaults(void)
 {
+    if (s_commit_timer) {
+        esp_timer_stop(s_commit_timer);
+    }
+
     nvs_handle_t handle;
     esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle);
     if (ret != ESP_OK) return ret;
-    
+
+    // No commit of the old settings may land after the erase
+    if (s_write_mutex) {
+        xSemaphoreTake(s_write_mutex, portMAX_DELAY);
+    }
     ret = nvs_erase_all(handle);
     if (ret == ESP_OK) {
-        ret = nvs_commit(handle);
+        ret = settings_commit(handle);
     }
     nvs_close(handle);
-    
+
     if (ret == ESP_OK) {
         // Reset RAM copy to defaults
-        s_settings.sensor_leds_enabled = DEFAULT_SENSOR_LEDS_ENABLED;
-        s_settings.status_led_enabled = DEFAULT_STATUS_LED_ENABLED;
-        s_settings.led_brightness = DEFAULT_LED_BRIGHTNESS;
-        s_settings.led_mask = DEFAULT_LED_MASK;
-        s_settings.temperature_offset = DEFAULT_TEMP_OFFSET;
-        s_settings.humidity_offset = DEFAULT_HUM_OFFSET;
-        s_settings.sensor_refresh_interval = DEFAULT_REFRESH_INTERVAL;
-        s_settings.pm_poll_interval = DEFAULT_PM_POLL_INTERVAL;
+        portENTER_CRITICAL(&s_lock);
+        s_settings = s_defaults;
+        s_dirty = false;
+        portEXIT_CRITICAL(&s_lock);
         ESP_LOGI(TAG, "Settings reset to defaults");
     }
-    
+    if (s_write_mutex) {
+        xSemaphoreGive(s_write_mutex);
+    }
+
     return ret;
 }
@@ -1,18 +1,39 @@
 /*
  * Settings persistence module for Aeris Air Quality Sensor
  * 
- * Stores user-configurable settings in NVS flash memory
+ * Stores user-configurable settings in NVS flash memory. Setters update a RAM
+ * copy; changes are committed together as one versioned, CRC-protected blob
+ * once they have settled for SETTINGS_COMMIT_DELAY_MS.
  */
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include "esp_err.h"
+#include "fan_control.h"
+#include "led_indicator.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* Commit debounce: quiet time after the last change, and the longest a change may stay unsaved */
+#ifndef SETTINGS_COMMIT_DELAY_MS
+#define SETTINGS_COMMIT_DELAY_MS        3000
+#endif
+#ifndef SETTINGS_COMMIT_MAX_DELAY_MS
+#define SETTINGS_COMMIT_MAX_DELAY_MS    15000
+#endif
+
+/* Task that runs the debounced flash commit, off the shared esp_timer task */
+#ifndef SETTINGS_TASK_STACK
+#define SETTINGS_TASK_STACK             3072
+#endif
+#ifndef SETTINGS_TASK_PRIORITY
+#define SETTINGS_TASK_PRIORITY          2
+#endif
+
 /**
  * @brief Settings structure containing all persistent settings
  */
@@ -22,6 +43,7 @@ typedef struct {
     bool status_led_enabled;       // Status LED enabled (endpoint 10)
     uint8_t led_brightness;        // LED brightness 0-255
     uint8_t led_mask;              // LED enable bitmask (5 bits)
+    bool led_gradient;             // Sensor LEDs in continuous gradient mode
     
     // Calibration offsets (in 0.1 units)
     int16_t temperature_offset;    // Temperature offset in 0.1°C
@@ -30,8 +52,29 @@ typedef struct {
     // Sensor settings
     uint16_t sensor_refresh_interval;  // Sensor refresh interval in seconds (10-3600)
     uint16_t pm_poll_interval;         // PM sensor polling interval in seconds (0=continuous, 60-3600)
+    
+    // Fan settings
+    uint8_t fan_mode;              // fan_mode_t (AUTO follows fan_curve)
+    fan_curve_t fan_curve;         // Auto mode control curve
+    fan_purge_t fan_purge;         // Purge-then-measure sequencing
+
+    // LED thresholds (new fields are only ever appended, see the blob layout in settings.c)
+    led_thresholds_t led_thresholds;   // Sensor LED thresholds (enabled/mask/gradient come from the fields above)
+
+    uint16_t fan_full_rpm;         // Fan RPM at 100% in the modes and auto curve (0 = open-loop duty)
 } aeris_settings_t;
 
+/**
+ * @brief Settings store counters since boot
+ */
+typedef struct {
+    uint32_t changes;              // Setter calls that changed a value
+    uint32_t commits;              // Blob commits to flash
+    uint32_t bytes_written;        // Blob bytes written by those commits
+    uint32_t commit_errors;        // Failed commits (retried)
+    bool pending;                  // Changes not yet committed
+} settings_stats_t;
+
 /**
  * @brief Initialize settings module and load from NVS
  * @return ESP_OK on success
@@ -46,23 +89,52 @@ esp_err_t settings_init(void);
 esp_err_t settings_get(aeris_settings_t *settings);
 
 /**
- * @brief Save all settings to NVS
+ * @brief Save all settings to NVS immediately
  * @param settings Pointer to settings structure to save
  * @return ESP_OK on success
  */
 esp_err_t settings_save(const aeris_settings_t *settings);
 
 /**
- * @brief Update and save a single setting
+ * @brief Commit pending changes now instead of waiting for the debounce timer
+ *
+ * Call before a restart so the last changes are not lost.
+ * @return ESP_OK on success or when nothing is pending
+ */
+esp_err_t settings_flush(void);
+
+/**
+ * @brief Get settings store counters
+ */
+void settings_get_stats(settings_stats_t *stats);
+
+/**
+ * @brief Update a single setting (committed after SETTINGS_COMMIT_DELAY_MS)
  */
 esp_err_t settings_set_sensor_leds_enabled(bool enabled);
 esp_err_t settings_set_status_led_enabled(bool enabled);
 esp_err_t settings_set_led_brightness(uint8_t brightness);
 esp_err_t settings_set_led_mask(uint8_t mask);
+esp_err_t settings_set_led_gradient(bool gradient);
+esp_err_t settings_set_led_thresholds(const led_thresholds_t *thresholds);
 esp_err_t settings_set_temperature_offset(int16_t offset);
 esp_err_t settings_set_humidity_offset(int16_t offset);
 esp_err_t settings_set_sensor_refresh_interval(uint16_t interval_sec);
 esp_err_t settings_set_pm_poll_interval(uint16_t interval_sec);
+esp_err_t settings_set_fan_mode(fan_mode_t mode);
+esp_err_t settings_set_fan_curve(const fan_curve_t *curve);
+esp_err_t settings_set_fan_purge(const fan_purge_t *purge);
+
+/**
+ * @brief Update one field by position (attribute table writes)
+ *
+ * No validation beyond the bounds; the caller has range checked the value.
+ * @param offset offsetof(aeris_settings_t, field)
+ * @param value New value, size bytes
+ * @param size Field size
+ * @return ESP_OK, ESP_ERR_INVALID_ARG if the field is outside aeris_settings_t
+ */
+esp_err_t settings_set_field(size_t offset, const void *value, size_t size);
 
 /**
  * @brief Get individual settings
@@ -71,10 +143,16 @@ bool settings_get_sensor_leds_enabled(void);
 bool settings_get_status_led_enabled(void);
 uint8_t settings_get_led_brightness(void);
 uint8_t settings_get_led_mask(void);
+bool settings_get_led_gradient(void);
+void settings_get_led_thresholds(led_thresholds_t *thresholds);
 int16_t settings_get_temperature_offset(void);
 int16_t settings_get_humidity_offset(void);
 uint16_t settings_get_sensor_refresh_interval(void);
 uint16_t settings_get_pm_poll_interval(void);
+fan_mode_t settings_get_fan_mode(void);
+void settings_get_fan_curve(fan_curve_t *curve);
+void settings_get_fan_purge(fan_purge_t *purge);
+uint16_t settings_get_fan_full_rpm(void);
 
 /**
  * @brief Reset all settings to defaults
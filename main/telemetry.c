@@ -0,0 +1,177 @@
+/*
+ * Task CPU-load, stack and heap telemetry implementation for Aeris_Lite
+ */
+
+#include "telemetry.h"
+#include <string.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+static const char *TAG = "TELEMETRY";
+
+#define TELEMETRY_STATUS_MAX        24      /* Upper bound on tasks in the system */
+
+/* Run-time counter per task at the previous sample */
+typedef struct {
+    TaskHandle_t handle;
+    uint32_t runtime;
+} telemetry_prev_t;
+
+static TaskStatus_t s_status[TELEMETRY_STATUS_MAX];
+static telemetry_prev_t s_prev[TELEMETRY_STATUS_MAX];
+static size_t s_prev_count = 0;
+static uint32_t s_prev_total = 0;
+static telemetry_record_t s_record;
+static portMUX_TYPE s_record_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Previous run-time counter of a task (0 if it is new)
+ */
+static uint32_t telemetry_prev_runtime(TaskHandle_t handle)
+{
+    for (size_t i = 0; i < s_prev_count; i++) {
+        if (s_prev[i].handle == handle) {
+            return s_prev[i].runtime;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Sort order for tasks: lowest stack high-water mark first
+ */
+static int telemetry_cmp_stack(const void *a, const void *b)
+{
+    const telemetry_task_t *ta = a;
+    const telemetry_task_t *tb = b;
+    return (int)ta->stack_hwm - (int)tb->stack_hwm;
+}
+
+esp_err_t telemetry_sample(void)
+{
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY && CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    telemetry_record_t rec = {0};
+    configRUN_TIME_COUNTER_TYPE total = 0;
+    UBaseType_t count = uxTaskGetSystemState(s_status, TELEMETRY_STATUS_MAX, &total);
+    if (count == 0) {
+        ESP_LOGW(TAG, "More than %d tasks, sample skipped", TELEMETRY_STATUS_MAX);
+        return ESP_ERR_NO_MEM;
+    }
+
+    /* Counter is 32-bit esp_timer microseconds: unsigned deltas survive wrap-around */
+    uint32_t total_delta = (uint32_t)total - s_prev_total;
+    TaskHandle_t idle = xTaskGetIdleTaskHandle();
+    uint32_t idle_delta = 0;
+
+    for (UBaseType_t i = 0; i < count; i++) {
+        uint32_t delta = (uint32_t)s_status[i].ulRunTimeCounter - telemetry_prev_runtime(s_status[i].xHandle);
+        uint8_t pct = total_delta ? (uint8_t)(((uint64_t)delta * 100) / total_delta) : 0;
+
+        if (s_status[i].xHandle == idle) {
+            idle_delta = delta;
+        }
+        if (rec.num_tasks < TELEMETRY_MAX_TASKS) {
+            telemetry_task_t *t = &rec.tasks[rec.num_tasks++];
+            strlcpy(t->name, s_status[i].pcTaskName, sizeof(t->name));
+            t->stack_hwm = (uint16_t)s_status[i].usStackHighWaterMark;  /* Bytes on ESP-IDF */
+            t->cpu_pct = pct;
+            t->priority = (uint8_t)s_status[i].uxCurrentPriority;
+        }
+    }
+
+    /* Remember counters for the next interval */
+    for (UBaseType_t i = 0; i < count; i++) {
+        s_prev[i].handle = s_status[i].xHandle;
+        s_prev[i].runtime = (uint32_t)s_status[i].ulRunTimeCounter;
+    }
+    s_prev_count = count;
+    s_prev_total = (uint32_t)total;
+
+    qsort(rec.tasks, rec.num_tasks, sizeof(rec.tasks[0]), telemetry_cmp_stack);
+
+    rec.uptime_s = (uint32_t)(esp_timer_get_time() / 1000000);
+    rec.heap_free = esp_get_free_heap_size();
+    rec.heap_min_free = esp_get_minimum_free_heap_size();
+    rec.heap_largest_block = heap_caps_get_largest_free_block(MALLOC_CAP_DEFAULT);
+    rec.cpu_load_pct = total_delta ? (uint8_t)(100 - ((uint64_t)idle_delta * 100) / total_delta) : 0;
+
+    portENTER_CRITICAL(&s_record_lock);
+    s_record = rec;
+    portEXIT_CRITICAL(&s_record_lock);
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t telemetry_get(telemetry_record_t *record)
+{
+    if (!record) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&s_record_lock);
+    *record = s_record;
+    portEXIT_CRITICAL(&s_record_lock);
+    return ESP_OK;
+}
+
+void telemetry_dump(void)
+{
+    telemetry_record_t rec;
+    telemetry_get(&rec);
+
+    ESP_LOGI(TAG, "uptime %lus, CPU load %u%%, heap free %lu, min %lu, largest block %lu",
+             rec.uptime_s, rec.cpu_load_pct, rec.heap_free, rec.heap_min_free, rec.heap_largest_block);
+    ESP_LOGI(TAG, "%-16s %4s %10s %5s", "task", "prio", "stack_free", "cpu%");
+    for (int i = 0; i < rec.num_tasks; i++) {
+        ESP_LOGI(TAG, "%-16s %4u %10u %5u", rec.tasks[i].name, rec.tasks[i].priority,
+                 rec.tasks[i].stack_hwm, rec.tasks[i].cpu_pct);
+    }
+}
+
+/**
+ * @brief Append a little-endian uint32 to a buffer
+ */
+static size_t put_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+    return 4;
+}
+
+size_t telemetry_encode(uint8_t *buf, size_t buf_size)
+{
+    const size_t header = 1 + 4 * 4 + 1;
+    const size_t per_task = TELEMETRY_ENCODED_NAME_LEN + 2 + 1;
+    telemetry_record_t rec;
+
+    if (!buf || buf_size < header) {
+        return 0;
+    }
+    telemetry_get(&rec);
+
+    size_t len = 1;
+    len += put_u32(&buf[len], rec.uptime_s);
+    len += put_u32(&buf[len], rec.heap_free);
+    len += put_u32(&buf[len], rec.heap_min_free);
+    len += put_u32(&buf[len], rec.heap_largest_block);
+    buf[len++] = rec.cpu_load_pct;
+
+    for (int i = 0; i < rec.num_tasks && i < TELEMETRY_ENCODED_TASKS && len + per_task <= buf_size; i++) {
+        strncpy((char *)&buf[len], rec.tasks[i].name, TELEMETRY_ENCODED_NAME_LEN);  /* Zero-padded, not terminated */
+        len += TELEMETRY_ENCODED_NAME_LEN;
+        buf[len++] = rec.tasks[i].stack_hwm & 0xFF;
+        buf[len++] = rec.tasks[i].stack_hwm >> 8;
+        buf[len++] = rec.tasks[i].cpu_pct;
+    }
+
+    buf[0] = (uint8_t)(len - 1);
+    return len;
+}
@@ -0,0 +1,87 @@
+/*
+ * Task CPU-load, stack and heap telemetry for Aeris_Lite
+ *
+ * Periodically samples FreeRTOS run-time stats (CPU share per task since the
+ * previous sample), per-task stack high-water marks and heap figures into a
+ * compact record exposed over Zigbee (Diagnostics cluster 0xF107) and the log.
+ *
+ * Requires CONFIG_FREERTOS_USE_TRACE_FACILITY and
+ * CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS (see sdkconfig.defaults).
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TELEMETRY_MAX_TASKS         16      /* Tasks captured per sample */
+#define TELEMETRY_ENCODED_TASKS     8       /* Tasks in the Zigbee record (fits one ZCL frame) */
+#define TELEMETRY_ENCODED_NAME_LEN  4       /* Task name prefix length in the Zigbee record */
+#define TELEMETRY_ENCODED_MAX_LEN   (1 + 17 + TELEMETRY_ENCODED_TASKS * (TELEMETRY_ENCODED_NAME_LEN + 3))
+
+/* Log the telemetry table every N sensor updates (0 = never) */
+#ifndef TELEMETRY_LOG_EVERY_N_UPDATES
+#define TELEMETRY_LOG_EVERY_N_UPDATES   20
+#endif
+
+/* Per-task figures */
+typedef struct {
+    char name[16];                  /* Task name (truncated to configMAX_TASK_NAME_LEN) */
+    uint16_t stack_hwm;             /* Minimum free stack since task start (bytes) */
+    uint8_t cpu_pct;                /* CPU share since previous sample (0-100) */
+    uint8_t priority;
+} telemetry_task_t;
+
+/* Telemetry record */
+typedef struct {
+    uint32_t uptime_s;
+    uint32_t heap_free;             /* Current free heap (bytes) */
+    uint32_t heap_min_free;         /* Heap low-water mark since boot (bytes) */
+    uint32_t heap_largest_block;    /* Largest allocatable block (fragmentation indicator) */
+    uint8_t cpu_load_pct;           /* 100 - idle share since previous sample */
+    uint8_t num_tasks;              /* Valid entries in tasks[] */
+    telemetry_task_t tasks[TELEMETRY_MAX_TASKS];
+} telemetry_record_t;
+
+/**
+ * @brief Take a new telemetry sample
+ *
+ * CPU percentages cover the interval since the previous call. Not
+ * reentrant: only the acquisition cycle (Zigbee task) samples, other tasks
+ * read the result with telemetry_get() / telemetry_dump().
+ *
+ * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED without trace facility
+ */
+esp_err_t telemetry_sample(void);
+
+/**
+ * @brief Get a copy of the most recent sample
+ */
+esp_err_t telemetry_get(telemetry_record_t *record);
+
+/**
+ * @brief Print the most recent sample to the log
+ */
+void telemetry_dump(void);
+
+/**
+ * @brief Encode the most recent sample as a ZCL octet string
+ *
+ * Layout (little-endian): [len] uptime_s(4) heap_free(4) heap_min_free(4)
+ * heap_largest_block(4) cpu_load(1) then per task {name[4], stack_hwm(2), cpu(1)}
+ * for as many tasks as fit, lowest stack high-water mark first.
+ *
+ * @param buf Output buffer (first byte receives the length)
+ * @param buf_size Size of @p buf
+ * @return Total bytes written including the length byte
+ */
+size_t telemetry_encode(uint8_t *buf, size_t buf_size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,23 @@
+/*
+ * FreeRTOS trace hooks for the Aeris_Lite event tracer
+ *
+ * Force-included into every translation unit (including the FreeRTOS kernel)
+ * when the project is configured with -D AERIS_ENABLE_TRACE=ON, so it must
+ * stay free of includes and safe for assembler sources.
+ *
+ * Not compatible with SystemView (CONFIG_APPTRACE_SV_ENABLE), which defines
+ * the same hooks.
+ */
+
+#pragma once
+
+#define AERIS_TRACE_ENABLE  1
+
+#ifndef __ASSEMBLER__
+
+/* Implemented in event_trace.c (IRAM) */
+void event_trace_task_switched_in(void);
+
+#define traceTASK_SWITCHED_IN()     event_trace_task_switched_in()
+
+#endif /* __ASSEMBLER__ */
@@ -0,0 +1,249 @@
+/*
+ * Configurable Zigbee attribute registry for Aeris Air Quality Sensor
+ */
+#include "zb_attr_registry.h"
+#include "attr_table.h"
+#include "esp_zb_aeris.h"
+#include "led_indicator.h"
+#include "fan_control.h"
+#include "esp_log.h"
+#include <stddef.h>
+#include <string.h>
+
+static const char *TAG = "ZB_ATTR";
+
+_Static_assert(ATTR_TYPE_BOOL == ESP_ZB_ZCL_ATTR_TYPE_BOOL && ATTR_TYPE_U8 == ESP_ZB_ZCL_ATTR_TYPE_U8 &&
+               ATTR_TYPE_U16 == ESP_ZB_ZCL_ATTR_TYPE_U16 && ATTR_TYPE_S16 == ESP_ZB_ZCL_ATTR_TYPE_S16,
+               "ATTR_TYPE_* must be the ZCL type values");
+
+/********************* Apply hooks **************************/
+
+static esp_err_t zb_apply_none(const aeris_settings_t *s)
+{
+    return ESP_OK;  // Read from the settings when used (sampling, purge)
+}
+
+static esp_err_t zb_apply_offsets(const aeris_settings_t *s)
+{
+    aeris_set_temperature_offset(s->temperature_offset / 10.0f);  // 0.1°C -> °C
+    aeris_set_humidity_offset(s->humidity_offset / 10.0f);        // 0.1% -> %
+    return ESP_OK;
+}
+
+static esp_err_t zb_apply_leds(const aeris_settings_t *s)
+{
+    led_thresholds_t thresholds = s->led_thresholds;
+    thresholds.enabled = s->sensor_leds_enabled;
+    thresholds.led_mask = s->led_mask;
+    thresholds.gradient = s->led_gradient;
+    esp_err_t ret = led_set_thresholds(&thresholds);
+    if (ret == ESP_OK) {
+        ret = led_set_enable(s->sensor_leds_enabled);
+    }
+    return ret;
+}
+
+static esp_err_t zb_apply_brightness(const aeris_settings_t *s)
+{
+    led_set_brightness(s->led_brightness);
+    return ESP_OK;
+}
+
+static esp_err_t zb_apply_status_led(const aeris_settings_t *s)
+{
+    return led_set_status_enable(s->status_led_enabled);
+}
+
+static esp_err_t zb_apply_fan_curve(const aeris_settings_t *s)
+{
+    return fan_set_curve(&s->fan_curve);
+}
+
+static esp_err_t zb_apply_fan_full_rpm(const aeris_settings_t *s)
+{
+    return fan_set_full_rpm(s->fan_full_rpm);
+}
+
+static esp_err_t zb_apply_fan_mode(const aeris_settings_t *s)
+{
+    return fan_set_mode((fan_mode_t)s->fan_mode);
+}
+
+/********************* Descriptor table **************************/
+
+#define FIELD_SIZE(field)       sizeof(((aeris_settings_t *)0)->field)
+#define TYPE_SIZE(type)         (((type) == ATTR_TYPE_U16 || (type) == ATTR_TYPE_S16) ? 2 : 1)
+
+#define ZB_ATTR_DESC(key, field, type, min, max, check, endpoint, cluster, attr_id, tag, apply, unit, desc) \
+    { #key, endpoint, cluster, attr_id, type, FIELD_SIZE(field), offsetof(aeris_settings_t, field), \
+      min, max, check, apply },
+
+static const zb_attr_desc_t s_attrs[] = {
+    AERIS_ATTR_TABLE(ZB_ATTR_DESC)
+};
+
+#define ZB_ATTR_COUNT   (sizeof(s_attrs) / sizeof(s_attrs[0]))
+
+#define ZB_ATTR_SIZE_CHECK(key, field, type, min, max, check, endpoint, cluster, attr_id, tag, apply, unit, desc) \
+    _Static_assert(FIELD_SIZE(field) == TYPE_SIZE(type), #key ": field size does not match the attribute type");
+
+AERIS_ATTR_TABLE(ZB_ATTR_SIZE_CHECK)
+
+_Static_assert(ZB_ATTR_SLOTS >= 2 * ZB_ATTR_COUNT && (ZB_ATTR_SLOTS & (ZB_ATTR_SLOTS - 1)) == 0,
+               "ZB_ATTR_SLOTS must be a power of two, at least twice the table size");
+_Static_assert(ZB_ATTR_COUNT < UINT8_MAX, "Slot and alarm index is a uint8_t");
+
+/* Open addressing on (endpoint, cluster, attribute): table index + 1, 0 = empty */
+static uint8_t s_slots[ZB_ATTR_SLOTS];
+
+static uint32_t zb_attr_hash(uint8_t endpoint, uint16_t cluster_id, uint16_t attr_id)
+{
+    uint32_t key = ((uint32_t)cluster_id << 16) | attr_id;
+    key ^= (uint32_t)endpoint * 0x9E3779B1u;
+    key *= 0x85EBCA6Bu;
+    return (key ^ (key >> 15)) & (ZB_ATTR_SLOTS - 1);
+}
+
+void zb_attr_registry_init(void)
+{
+    int collisions = 0;
+
+    memset(s_slots, 0, sizeof(s_slots));
+    for (size_t i = 0; i < ZB_ATTR_COUNT; i++) {
+        const zb_attr_desc_t *d = &s_attrs[i];
+        if (d->endpoint == 0) {
+            continue;   // Stored and in the bulk record only
+        }
+        uint32_t slot = zb_attr_hash(d->endpoint, d->cluster, d->attr_id);
+        while (s_slots[slot] != 0) {
+            slot = (slot + 1) & (ZB_ATTR_SLOTS - 1);
+            collisions++;
+        }
+        s_slots[slot] = (uint8_t)(i + 1);
+    }
+    ESP_LOGI(TAG, "%d attributes indexed (%d collisions)", (int)ZB_ATTR_COUNT, collisions);
+}
+
+const zb_attr_desc_t *zb_attr_registry_find(uint8_t endpoint, uint16_t cluster_id, uint16_t attr_id)
+{
+    uint32_t slot = zb_attr_hash(endpoint, cluster_id, attr_id);
+
+    while (s_slots[slot] != 0) {
+        const zb_attr_desc_t *d = &s_attrs[s_slots[slot] - 1];
+        if (d->attr_id == attr_id && d->cluster == cluster_id && d->endpoint == endpoint) {
+            return d;
+        }
+        slot = (slot + 1) & (ZB_ATTR_SLOTS - 1);
+    }
+    return NULL;
+}
+
+/********************* Values **************************/
+
+/* ZCL attribute data, same layout as the field (may be unaligned), sign extended for S16 */
+static int32_t zb_attr_decode(const zb_attr_desc_t *d, const void *value)
+{
+    if (d->size == 1) {
+        return *(const uint8_t *)value;
+    }
+    uint16_t v;
+    memcpy(&v, value, sizeof(v));
+    return (d->type == ATTR_TYPE_S16) ? (int32_t)(int16_t)v : (int32_t)v;
+}
+
+static void zb_attr_set(const zb_attr_desc_t *d, const aeris_settings_t *s)
+{
+    uint8_t value[2];
+    memcpy(value, (const uint8_t *)s + d->offset, d->size);
+    esp_zb_zcl_set_attribute_val(d->endpoint, d->cluster, ESP_ZB_ZCL_CLUSTER_SERVER_ROLE,
+                                 d->attr_id, value, false);
+}
+
+/* Put back the saved value of a refused write (the stack stores the write after the callback) */
+static void zb_attr_restore(uint8_t index)
+{
+    aeris_settings_t s;
+    settings_get(&s);
+    zb_attr_set(&s_attrs[index], &s);
+}
+
+/********************* API **************************/
+
+void zb_attr_registry_add(esp_zb_attribute_list_t *attr_list, uint8_t endpoint, uint16_t cluster_id)
+{
+    aeris_settings_t s;
+    settings_get(&s);   // Use saved values
+
+    for (size_t i = 0; i < ZB_ATTR_COUNT; i++) {
+        const zb_attr_desc_t *d = &s_attrs[i];
+        if (d->endpoint != endpoint || d->cluster != cluster_id || d->attr_id < ATTR_ID_CUSTOM_MIN) {
+            continue;
+        }
+        uint8_t value[2];
+        memcpy(value, (const uint8_t *)&s + d->offset, d->size);
+        esp_err_t ret = esp_zb_cluster_add_attr(attr_list, cluster_id, d->attr_id, d->type,
+                                                ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE, value);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to add %s (0x%04x): %s", d->key, d->attr_id, esp_err_to_name(ret));
+        }
+    }
+}
+
+esp_err_t zb_attr_registry_write(const zb_attr_desc_t *desc, const void *value)
+{
+    uint8_t index = (uint8_t)(desc - s_attrs);
+    int32_t v = zb_attr_decode(desc, value);
+
+    if (v < desc->min || v > desc->max || !desc->check(v)) {
+        ESP_LOGW(TAG, "%s: %ld refused (range %ld..%ld)", desc->key, (long)v, (long)desc->min, (long)desc->max);
+        esp_zb_scheduler_alarm((esp_zb_callback_t)zb_attr_restore, index, 0);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    aeris_settings_t s;
+    settings_get(&s);
+    memcpy((uint8_t *)&s + desc->offset, value, desc->size);
+
+    esp_err_t ret = desc->apply(&s);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "%s: %ld not applied: %s", desc->key, (long)v, esp_err_to_name(ret));
+        esp_zb_scheduler_alarm((esp_zb_callback_t)zb_attr_restore, index, 0);
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "%s = %ld", desc->key, (long)v);
+    return settings_set_field(desc->offset, (const uint8_t *)&s + desc->offset, desc->size);
+}
+
+esp_err_t zb_attr_registry_apply_all(const aeris_settings_t *settings)
+{
+    esp_err_t result = ESP_OK;
+
+    for (size_t i = 0; i < ZB_ATTR_COUNT; i++) {
+        /* Each hook once, many rows share one */
+        size_t j = 0;
+        while (j < i && s_attrs[j].apply != s_attrs[i].apply) {
+            j++;
+        }
+        if (j < i) {
+            continue;
+        }
+        esp_err_t ret = s_attrs[i].apply(settings);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "%s: not applied: %s", s_attrs[i].key, esp_err_to_name(ret));
+            if (result == ESP_OK) {
+                result = ret;
+            }
+        }
+    }
+    return result;
+}
+
+void zb_attr_registry_sync(const aeris_settings_t *settings)
+{
+    for (size_t i = 0; i < ZB_ATTR_COUNT; i++) {
+        if (s_attrs[i].endpoint != 0) {
+            zb_attr_set(&s_attrs[i], settings);
+        }
+    }
+}
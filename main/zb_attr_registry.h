@@ -0,0 +1,83 @@
+/*
+ * Configurable Zigbee attribute registry for Aeris Air Quality Sensor
+ *
+ * Built from AERIS_ATTR_TABLE (attr_table.h): creates the custom
+ * attributes, dispatches writes through a hashed lookup with range
+ * validation, persists accepted values and applies them to the drivers.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_zigbee_core.h"
+#include "settings.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Lookup slots (power of two, at least twice the table size) */
+#define ZB_ATTR_SLOTS           128
+
+/* One configurable attribute (a row of AERIS_ATTR_TABLE) */
+typedef struct {
+    const char *key;
+    uint8_t endpoint;
+    uint16_t cluster;
+    uint16_t attr_id;
+    uint8_t type;               // ATTR_TYPE_*
+    uint8_t size;               // Field size in aeris_settings_t
+    uint16_t offset;            // Field offset in aeris_settings_t
+    int32_t min;
+    int32_t max;
+    bool (*check)(int32_t value);
+    esp_err_t (*apply)(const aeris_settings_t *settings);  // Push to the drivers, settings not saved on error
+} zb_attr_desc_t;
+
+/**
+ * @brief Build the lookup index, call once before the endpoints are created
+ */
+void zb_attr_registry_init(void);
+
+/**
+ * @brief Add the table's custom attributes of one cluster, with the saved values
+ * @param attr_list Cluster attribute list being created
+ * @param endpoint Endpoint the cluster belongs to
+ * @param cluster_id Cluster ID
+ */
+void zb_attr_registry_add(esp_zb_attribute_list_t *attr_list, uint8_t endpoint, uint16_t cluster_id);
+
+/**
+ * @brief Find a configurable attribute
+ * @return Descriptor, NULL if the attribute is not in the table
+ */
+const zb_attr_desc_t *zb_attr_registry_find(uint8_t endpoint, uint16_t cluster_id, uint16_t attr_id);
+
+/**
+ * @brief Validate, apply and persist a written value
+ *
+ * A rejected value is not saved and the attribute is set back to the saved
+ * value once the stack has stored the write.
+ * @param desc Attribute descriptor
+ * @param value Value in the attribute's ZCL type
+ * @return ESP_OK, ESP_ERR_INVALID_ARG if the value is out of range, or the driver error
+ */
+esp_err_t zb_attr_registry_write(const zb_attr_desc_t *desc, const void *value);
+
+/**
+ * @brief Apply all settings to the drivers (after a bulk change)
+ *
+ * Every hook runs even if an earlier one fails.
+ * @return ESP_OK, or the first driver error
+ */
+esp_err_t zb_attr_registry_apply_all(const aeris_settings_t *settings);
+
+/**
+ * @brief Set every table attribute to its saved value (after a bulk change)
+ */
+void zb_attr_registry_sync(const aeris_settings_t *settings);
+
+#ifdef __cplusplus
+}
+#endif
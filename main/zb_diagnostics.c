@@ -0,0 +1,161 @@
+/*
+ * Zigbee Diagnostics cluster implementation for Aeris_Lite
+ */
+
+#include "zb_diagnostics.h"
+#include "esp_zb_aeris.h"
+#include "aeris_driver.h"
+#include "telemetry.h"
+#include "boot_profile.h"
+#include "event_trace.h"
+#include "i2c_capture.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_system.h"
+
+static const char *TAG = "ZB_DIAG";
+
+/* Firmware counters */
+static uint32_t s_cycle_time_ms = 0;
+static uint32_t s_dropped_samples = 0;
+
+/* Manufacturer attribute per sensor, indexed by aeris_sensor_id_t */
+static const uint16_t I2C_ERR_ATTRS[AERIS_SENSOR_MAX] = {
+    [AERIS_SENSOR_SHT45] = ZCL_DIAG_ATTR_I2C_ERR_SHT45,
+    [AERIS_SENSOR_LPS22HB] = ZCL_DIAG_ATTR_I2C_ERR_LPS22HB,
+    [AERIS_SENSOR_SGP41] = ZCL_DIAG_ATTR_I2C_ERR_SGP41,
+    [AERIS_SENSOR_SCD40] = ZCL_DIAG_ATTR_I2C_ERR_SCD40,
+};
+
+esp_zb_attribute_list_t *zb_diag_cluster_create(void)
+{
+    esp_zb_attribute_list_t *diag_cluster = esp_zb_zcl_attr_list_create(ESP_ZB_ZCL_CLUSTER_ID_DIAGNOSTICS);
+    if (!diag_cluster) {
+        ESP_LOGE(TAG, "Failed to create Diagnostics cluster");
+        return NULL;
+    }
+
+    /* Standard counters - updated by the stack's diagnostics module */
+    static uint16_t zero_u16 = 0;
+    static uint32_t zero_u32 = 0;
+    static uint8_t zero_u8 = 0;
+    static int8_t zero_s8 = 0;
+    static const struct {
+        uint16_t id;
+        uint8_t type;
+        void *value;
+    } std_attrs[] = {
+        { ZCL_DIAG_ATTR_NUMBER_OF_RESETS,         ESP_ZB_ZCL_ATTR_TYPE_U16, &zero_u16 },
+        { ZCL_DIAG_ATTR_MAC_RX_BCAST,             ESP_ZB_ZCL_ATTR_TYPE_U32, &zero_u32 },
+        { ZCL_DIAG_ATTR_MAC_TX_BCAST,             ESP_ZB_ZCL_ATTR_TYPE_U32, &zero_u32 },
+        { ZCL_DIAG_ATTR_MAC_RX_UCAST,             ESP_ZB_ZCL_ATTR_TYPE_U32, &zero_u32 },
+        { ZCL_DIAG_ATTR_MAC_TX_UCAST,             ESP_ZB_ZCL_ATTR_TYPE_U32, &zero_u32 },
+        { ZCL_DIAG_ATTR_MAC_TX_UCAST_RETRY,       ESP_ZB_ZCL_ATTR_TYPE_U16, &zero_u16 },
+        { ZCL_DIAG_ATTR_MAC_TX_UCAST_FAIL,        ESP_ZB_ZCL_ATTR_TYPE_U16, &zero_u16 },
+        { ZCL_DIAG_ATTR_APS_TX_UCAST_SUCCESS,     ESP_ZB_ZCL_ATTR_TYPE_U16, &zero_u16 },
+        { ZCL_DIAG_ATTR_APS_TX_UCAST_RETRY,       ESP_ZB_ZCL_ATTR_TYPE_U16, &zero_u16 },
+        { ZCL_DIAG_ATTR_APS_TX_UCAST_FAIL,        ESP_ZB_ZCL_ATTR_TYPE_U16, &zero_u16 },
+        { ZCL_DIAG_ATTR_ROUTE_DISC_INITIATED,     ESP_ZB_ZCL_ATTR_TYPE_U16, &zero_u16 },
+        { ZCL_DIAG_ATTR_NEIGHBOR_ADDED,           ESP_ZB_ZCL_ATTR_TYPE_U16, &zero_u16 },
+        { ZCL_DIAG_ATTR_NEIGHBOR_REMOVED,         ESP_ZB_ZCL_ATTR_TYPE_U16, &zero_u16 },
+        { ZCL_DIAG_ATTR_NEIGHBOR_STALE,           ESP_ZB_ZCL_ATTR_TYPE_U16, &zero_u16 },
+        { ZCL_DIAG_ATTR_PACKET_BUFFER_ALLOC_FAIL, ESP_ZB_ZCL_ATTR_TYPE_U16, &zero_u16 },
+        { ZCL_DIAG_ATTR_AVG_MAC_RETRY_PER_APS,    ESP_ZB_ZCL_ATTR_TYPE_U16, &zero_u16 },
+        { ZCL_DIAG_ATTR_LAST_MESSAGE_LQI,         ESP_ZB_ZCL_ATTR_TYPE_U8,  &zero_u8 },
+        { ZCL_DIAG_ATTR_LAST_MESSAGE_RSSI,        ESP_ZB_ZCL_ATTR_TYPE_S8,  &zero_s8 },
+    };
+
+    for (size_t i = 0; i < sizeof(std_attrs) / sizeof(std_attrs[0]); i++) {
+        ESP_ERROR_CHECK(esp_zb_cluster_add_attr(diag_cluster, ESP_ZB_ZCL_CLUSTER_ID_DIAGNOSTICS,
+                                                std_attrs[i].id, std_attrs[i].type,
+                                                ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY, std_attrs[i].value));
+    }
+
+    /* Manufacturer-specific firmware counters */
+    ESP_ERROR_CHECK(esp_zb_cluster_add_attr(diag_cluster, ESP_ZB_ZCL_CLUSTER_ID_DIAGNOSTICS,
+                                            ZCL_DIAG_ATTR_CYCLE_TIME_MS, ESP_ZB_ZCL_ATTR_TYPE_U32,
+                                            ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY, &zero_u32));
+    for (int i = 0; i < AERIS_SENSOR_MAX; i++) {
+        ESP_ERROR_CHECK(esp_zb_cluster_add_attr(diag_cluster, ESP_ZB_ZCL_CLUSTER_ID_DIAGNOSTICS,
+                                                I2C_ERR_ATTRS[i], ESP_ZB_ZCL_ATTR_TYPE_U32,
+                                                ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY, &zero_u32));
+    }
+    ESP_ERROR_CHECK(esp_zb_cluster_add_attr(diag_cluster, ESP_ZB_ZCL_CLUSTER_ID_DIAGNOSTICS,
+                                            ZCL_DIAG_ATTR_DROPPED_SAMPLES, ESP_ZB_ZCL_ATTR_TYPE_U32,
+                                            ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY, &zero_u32));
+    ESP_ERROR_CHECK(esp_zb_cluster_add_attr(diag_cluster, ESP_ZB_ZCL_CLUSTER_ID_DIAGNOSTICS,
+                                            ZCL_DIAG_ATTR_HEAP_MIN_FREE, ESP_ZB_ZCL_ATTR_TYPE_U32,
+                                            ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY, &zero_u32));
+    static uint8_t telemetry_default[TELEMETRY_ENCODED_MAX_LEN] = {0};  // Octet string, empty
+    ESP_ERROR_CHECK(esp_zb_cluster_add_attr(diag_cluster, ESP_ZB_ZCL_CLUSTER_ID_DIAGNOSTICS,
+                                            ZCL_DIAG_ATTR_TELEMETRY, ESP_ZB_ZCL_ATTR_TYPE_OCTET_STRING,
+                                            ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY, telemetry_default));
+    static uint8_t trace_control = EVENT_TRACE_START_ON_BOOT ? ZCL_DIAG_TRACE_START : ZCL_DIAG_TRACE_STOP;
+    ESP_ERROR_CHECK(esp_zb_cluster_add_attr(diag_cluster, ESP_ZB_ZCL_CLUSTER_ID_DIAGNOSTICS,
+                                            ZCL_DIAG_ATTR_TRACE_CONTROL, ESP_ZB_ZCL_ATTR_TYPE_U8,
+                                            ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE, &trace_control));
+    static uint8_t i2c_capture = I2C_CAPTURE_BOOT_MODE;
+    ESP_ERROR_CHECK(esp_zb_cluster_add_attr(diag_cluster, ESP_ZB_ZCL_CLUSTER_ID_DIAGNOSTICS,
+                                            ZCL_DIAG_ATTR_I2C_CAPTURE, ESP_ZB_ZCL_ATTR_TYPE_U8,
+                                            ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE, &i2c_capture));
+    uint8_t boot_profile[BOOT_PROFILE_ENCODED_LEN];
+    boot_profile_encode(boot_profile, sizeof(boot_profile));
+    ESP_ERROR_CHECK(esp_zb_cluster_add_attr(diag_cluster, ESP_ZB_ZCL_CLUSTER_ID_DIAGNOSTICS,
+                                            ZCL_DIAG_ATTR_BOOT_PROFILE, ESP_ZB_ZCL_ATTR_TYPE_OCTET_STRING,
+                                            ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY, boot_profile));
+
+    return diag_cluster;
+}
+
+void zb_diag_record_cycle(uint32_t cycle_time_ms)
+{
+    s_cycle_time_ms = cycle_time_ms;
+}
+
+void zb_diag_sample_dropped(void)
+{
+    s_dropped_samples++;
+}
+
+/**
+ * @brief Set one manufacturer attribute on the endpoint 1 Diagnostics cluster
+ */
+static void zb_diag_set_u32(uint16_t attr_id, uint32_t value)
+{
+    esp_zb_zcl_set_attribute_val(HA_ESP_TEMP_HUM_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_DIAGNOSTICS,
+                                 ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, attr_id, &value, false);
+}
+
+void zb_diag_update_attributes(void)
+{
+    uint32_t heap_min = esp_get_minimum_free_heap_size();
+
+    zb_diag_set_u32(ZCL_DIAG_ATTR_CYCLE_TIME_MS, s_cycle_time_ms);
+    for (int i = 0; i < AERIS_SENSOR_MAX; i++) {
+        zb_diag_set_u32(I2C_ERR_ATTRS[i], aeris_get_i2c_error_count((aeris_sensor_id_t)i));
+    }
+    zb_diag_set_u32(ZCL_DIAG_ATTR_DROPPED_SAMPLES, s_dropped_samples);
+    zb_diag_set_u32(ZCL_DIAG_ATTR_HEAP_MIN_FREE, heap_min);
+    
+    uint8_t telemetry[TELEMETRY_ENCODED_MAX_LEN];
+    telemetry_encode(telemetry, sizeof(telemetry));
+    esp_zb_zcl_set_attribute_val(HA_ESP_TEMP_HUM_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_DIAGNOSTICS,
+                                 ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, ZCL_DIAG_ATTR_TELEMETRY, telemetry, false);
+
+    uint8_t boot_profile[BOOT_PROFILE_ENCODED_LEN];
+    boot_profile_encode(boot_profile, sizeof(boot_profile));
+    esp_zb_zcl_set_attribute_val(HA_ESP_TEMP_HUM_ENDPOINT, ESP_ZB_ZCL_CLUSTER_ID_DIAGNOSTICS,
+                                 ESP_ZB_ZCL_CLUSTER_SERVER_ROLE, ZCL_DIAG_ATTR_BOOT_PROFILE, boot_profile, false);
+
+    ESP_LOGD(TAG, "cycle=%lums dropped=%lu heap_min=%lu", s_cycle_time_ms, s_dropped_samples, heap_min);
+}
+
+void zb_diag_dump(void)
+{
+    ESP_LOGI(TAG, "Last cycle: %lu ms, dropped samples: %lu", s_cycle_time_ms, s_dropped_samples);
+    ESP_LOGI(TAG, "I2C errors: SHT45 %lu, LPS22HB %lu, SGP41 %lu, SCD40 %lu",
+             aeris_get_i2c_error_count(AERIS_SENSOR_SHT45), aeris_get_i2c_error_count(AERIS_SENSOR_LPS22HB),
+             aeris_get_i2c_error_count(AERIS_SENSOR_SGP41), aeris_get_i2c_error_count(AERIS_SENSOR_SCD40));
+    ESP_LOGI(TAG, "Heap: %lu free, %lu minimum", (uint32_t)esp_get_free_heap_size(),
+             (uint32_t)esp_get_minimum_free_heap_size());
+}
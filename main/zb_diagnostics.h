@@ -0,0 +1,96 @@
+/*
+ * Zigbee Diagnostics cluster (0x0B05) for Aeris_Lite
+ *
+ * Standard MAC/NWK/APS counters are maintained by the Zigbee stack; the
+ * manufacturer-specific attributes (0xF1xx) carry firmware counters used to
+ * spot overloaded routers in the mesh.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_zigbee_core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Standard Diagnostics attributes (ZCL 3.15.2.2) */
+#define ZCL_DIAG_ATTR_NUMBER_OF_RESETS          0x0000
+#define ZCL_DIAG_ATTR_MAC_RX_BCAST              0x0100
+#define ZCL_DIAG_ATTR_MAC_TX_BCAST              0x0101
+#define ZCL_DIAG_ATTR_MAC_RX_UCAST              0x0102
+#define ZCL_DIAG_ATTR_MAC_TX_UCAST              0x0103
+#define ZCL_DIAG_ATTR_MAC_TX_UCAST_RETRY        0x0104
+#define ZCL_DIAG_ATTR_MAC_TX_UCAST_FAIL         0x0105
+#define ZCL_DIAG_ATTR_APS_TX_UCAST_SUCCESS      0x0108
+#define ZCL_DIAG_ATTR_APS_TX_UCAST_RETRY        0x0109
+#define ZCL_DIAG_ATTR_APS_TX_UCAST_FAIL         0x010A
+#define ZCL_DIAG_ATTR_ROUTE_DISC_INITIATED      0x010B
+#define ZCL_DIAG_ATTR_NEIGHBOR_ADDED            0x010C
+#define ZCL_DIAG_ATTR_NEIGHBOR_REMOVED          0x010D
+#define ZCL_DIAG_ATTR_NEIGHBOR_STALE            0x010E
+#define ZCL_DIAG_ATTR_PACKET_BUFFER_ALLOC_FAIL  0x0113
+#define ZCL_DIAG_ATTR_AVG_MAC_RETRY_PER_APS     0x011C
+#define ZCL_DIAG_ATTR_LAST_MESSAGE_LQI          0x011D
+#define ZCL_DIAG_ATTR_LAST_MESSAGE_RSSI         0x011E
+
+/* Manufacturer-specific firmware counters */
+#define ZCL_DIAG_ATTR_CYCLE_TIME_MS             0xF100  // Last acquisition cycle duration in ms (uint32)
+#define ZCL_DIAG_ATTR_I2C_ERR_SHT45             0xF101  // Failed I2C transactions per sensor (uint32)
+#define ZCL_DIAG_ATTR_I2C_ERR_LPS22HB           0xF102
+#define ZCL_DIAG_ATTR_I2C_ERR_SGP41             0xF103
+#define ZCL_DIAG_ATTR_I2C_ERR_SCD40             0xF104
+#define ZCL_DIAG_ATTR_DROPPED_SAMPLES           0xF105  // Sensor reads that fell back to cached values (uint32)
+#define ZCL_DIAG_ATTR_HEAP_MIN_FREE             0xF106  // Heap low-water mark in bytes (uint32)
+#define ZCL_DIAG_ATTR_TELEMETRY                 0xF107  // Task/heap telemetry record (octet string, see telemetry.h)
+#define ZCL_DIAG_ATTR_TRACE_CONTROL             0xF108  // Event tracer command (uint8, RW, see event_trace.h)
+#define ZCL_DIAG_ATTR_I2C_CAPTURE               0xF109  // I2C transaction recorder command (uint8, RW, see i2c_capture.h)
+#define ZCL_DIAG_ATTR_BOOT_PROFILE              0xF10A  // Boot milestones (octet string, see boot_profile.h)
+
+/* ZCL_DIAG_ATTR_TRACE_CONTROL values */
+#define ZCL_DIAG_TRACE_STOP                     0
+#define ZCL_DIAG_TRACE_START                    1
+#define ZCL_DIAG_TRACE_DUMP                     2       // Print the ring on the console (tools/trace_to_perfetto.py)
+
+/* ZCL_DIAG_ATTR_I2C_CAPTURE values (0-2 match i2c_capture_mode_t) */
+#define ZCL_DIAG_I2C_CAPTURE_OFF                0
+#define ZCL_DIAG_I2C_CAPTURE_RING               1
+#define ZCL_DIAG_I2C_CAPTURE_STREAM             2       // Also print every transaction as it happens
+#define ZCL_DIAG_I2C_CAPTURE_DUMP               3       // Print boot section + ring (tools/i2c_replay.py)
+
+/**
+ * @brief Create the Diagnostics cluster attribute list
+ *
+ * @return Attribute list to add with esp_zb_cluster_list_add_diagnostics_cluster()
+ */
+esp_zb_attribute_list_t *zb_diag_cluster_create(void);
+
+/**
+ * @brief Record the duration of one acquisition cycle
+ *
+ * @param cycle_time_ms Time from first sensor read to last attribute update
+ */
+void zb_diag_record_cycle(uint32_t cycle_time_ms);
+
+/**
+ * @brief Count a sensor sample that could not be read (cached value reported)
+ */
+void zb_diag_sample_dropped(void);
+
+/**
+ * @brief Push the firmware counters to the Diagnostics cluster attributes
+ *
+ * Must be called from the Zigbee task context (e.g. a scheduler alarm).
+ */
+void zb_diag_update_attributes(void);
+
+/**
+ * @brief Log the firmware counters (console "counters" command)
+ */
+void zb_diag_dump(void);
+
+#ifdef __cplusplus
+}
+#endif
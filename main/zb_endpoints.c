@@ -0,0 +1,355 @@
+/*
+ * Zigbee endpoint layout for Aeris Air Quality Sensor
+ */
+#include <math.h>
+#include "zb_endpoints.h"
+#include "esp_zb_aeris.h"
+#include "ha/esp_zigbee_ha_standard.h"
+#include "zb_attr_registry.h"
+#include "zb_diagnostics.h"
+#include "settings.h"
+#include "config_tlv.h"
+#include "perf_stats.h"
+#include "binlog.h"
+#include "esp_check.h"
+#include "esp_log.h"
+
+static const char *TAG = "ZB_EP";
+
+#define ACCESS_RO           ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY
+#define ACCESS_RO_REPORT    (ESP_ZB_ZCL_ATTR_ACCESS_READ_ONLY | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING)
+#define ACCESS_RW           ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE
+#define ACCESS_RW_REPORT    (ESP_ZB_ZCL_ATTR_ACCESS_READ_WRITE | ESP_ZB_ZCL_ATTR_ACCESS_REPORTING)
+
+/* One attribute: initial value stored in the table, or a pointer for strings and boot-time values */
+typedef struct {
+    uint16_t id;
+    uint8_t type;
+    uint8_t access;
+    bool by_ref;
+    union {
+        bool b;
+        uint8_t u8;
+        int16_t s16;
+        uint16_t u16;
+        float f;
+        const void *ref;
+    } value;
+} zb_ep_attr_t;
+
+#define ATTR(id, type, access, member, v)   { id, ESP_ZB_ZCL_ATTR_TYPE_##type, access, false, { .member = (v) } }
+#define ATTR_REF(id, type, access, ptr)     { id, ESP_ZB_ZCL_ATTR_TYPE_##type, access, true, { .ref = (ptr) } }
+
+/* One cluster: standard constructor (NULL: empty list), then the table attributes, then the settings from attr_table.h */
+typedef struct {
+    uint16_t id;
+    esp_zb_attribute_list_t *(*create)(void);
+    const zb_ep_attr_t *attrs;
+    uint8_t attr_count;
+} zb_ep_cluster_t;
+
+#define CLUSTER(id, create, attrs)  { ESP_ZB_ZCL_CLUSTER_ID_##id, create, attrs, sizeof(attrs) / sizeof(attrs[0]) }
+#define CLUSTER_NO_ATTRS(id, create) { ESP_ZB_ZCL_CLUSTER_ID_##id, create, NULL, 0 }
+
+typedef struct {
+    uint8_t endpoint;
+    uint16_t device_id;
+    const zb_ep_cluster_t *clusters;
+    uint8_t cluster_count;
+} zb_ep_t;
+
+#define ENDPOINT(ep, device, clusters)  { ep, device, clusters, sizeof(clusters) / sizeof(clusters[0]) }
+
+/********************* Boot-time values **************************/
+
+static uint8_t s_log_level;                                                 // binlog_get_level()
+static uint8_t s_config_record[1 + CONFIG_TLV_MAX_SIZE];                    // Octet string, current configuration
+static const uint8_t s_perf_summary_empty[1 + PERF_ID_MAX * PERF_ENCODED_ENTRY_SIZE];  // Octet string, empty
+
+/********************* Standard cluster constructors **************************/
+
+fan_mode_t zb_fan_mode_from_zcl(uint8_t zcl_mode)
+{
+    switch (zcl_mode) {
+        case 0:  return FAN_MODE_OFF;
+        case 1:  return FAN_MODE_LOW;
+        case 2:  return FAN_MODE_MEDIUM;
+        case 5:  return FAN_MODE_AUTO;
+        default: return FAN_MODE_HIGH;  // high, on
+    }
+}
+
+uint8_t zb_fan_mode_to_zcl(fan_mode_t mode)
+{
+    switch (mode) {
+        case FAN_MODE_OFF:    return 0;
+        case FAN_MODE_LOW:    return 1;
+        case FAN_MODE_MEDIUM: return 2;
+        case FAN_MODE_HIGH:   return 3;
+        default:              return 5;
+    }
+}
+
+static esp_zb_attribute_list_t *basic_create(void)
+{
+    esp_zb_basic_cluster_cfg_t cfg = {
+        .zcl_version = ESP_ZB_ZCL_BASIC_ZCL_VERSION_DEFAULT_VALUE,
+        .power_source = ESP_ZB_ZCL_BASIC_POWER_SOURCE_DEFAULT_VALUE,
+    };
+    return esp_zb_basic_cluster_create(&cfg);
+}
+
+static esp_zb_attribute_list_t *identify_create(void)
+{
+    return esp_zb_identify_cluster_create(NULL);
+}
+
+static esp_zb_attribute_list_t *sensor_leds_on_off_create(void)
+{
+    esp_zb_on_off_cluster_cfg_t cfg = {
+        .on_off = settings_get_sensor_leds_enabled(),  // Use saved value
+    };
+    return esp_zb_on_off_cluster_create(&cfg);
+}
+
+static esp_zb_attribute_list_t *status_led_on_off_create(void)
+{
+    esp_zb_on_off_cluster_cfg_t cfg = {
+        .on_off = settings_get_status_led_enabled(),  // Use saved value
+    };
+    return esp_zb_on_off_cluster_create(&cfg);
+}
+
+/* Analog Output as the container of the LED settings. The constructor already adds
+ * present_value, out_of_service, status_flags, min/max_present_value and resolution */
+static esp_zb_attribute_list_t *led_config_create(void)
+{
+    static char desc[17] = "\x0D""LED Thresholds";
+    esp_zb_analog_output_cluster_cfg_t cfg = {
+        .present_value = 0.0f,  // Written by Zigbee2MQTT as the LED mask
+    };
+    esp_zb_attribute_list_t *cluster = esp_zb_analog_output_cluster_create(&cfg);
+    esp_zb_analog_output_cluster_add_attr(cluster, ESP_ZB_ZCL_ATTR_ANALOG_OUTPUT_DESCRIPTION_ID, desc);
+    return cluster;
+}
+
+/* currentLevel is a standard attribute, writable for the LED brightness */
+static esp_zb_attribute_list_t *level_create(void)
+{
+    uint8_t current_level = settings_get_led_brightness();  // Use saved value
+    esp_zb_attribute_list_t *cluster = esp_zb_zcl_attr_list_create(ESP_ZB_ZCL_CLUSTER_ID_LEVEL_CONTROL);
+    ESP_ERROR_CHECK(esp_zb_cluster_add_attr(cluster, ESP_ZB_ZCL_CLUSTER_ID_LEVEL_CONTROL,
+                                            ESP_ZB_ZCL_ATTR_LEVEL_CONTROL_CURRENT_LEVEL_ID, ESP_ZB_ZCL_ATTR_TYPE_U8,
+                                            ACCESS_RW_REPORT, &current_level));
+    return cluster;
+}
+
+static esp_zb_attribute_list_t *fan_create(void)
+{
+    esp_zb_fan_control_cluster_cfg_t cfg = {
+        .fan_mode = zb_fan_mode_to_zcl(settings_get_fan_mode()),  // Use saved value
+        .fan_mode_sequence = ESP_ZB_ZCL_FAN_CONTROL_FAN_MODE_SEQUENCE_LOW_MED_HIGH_AUTO,
+    };
+    return esp_zb_fan_control_cluster_create(&cfg);
+}
+
+/********************* Layout **************************/
+
+/* Endpoint 1: temperature and humidity, diagnostics, bulk configuration */
+static const zb_ep_attr_t basic_attrs[] = {
+    ATTR(ESP_ZB_ZCL_ATTR_BASIC_APPLICATION_VERSION_ID, U8, ACCESS_RO, u8, 1),
+    ATTR(ESP_ZB_ZCL_ATTR_BASIC_STACK_VERSION_ID, U8, ACCESS_RO, u8, 0x30),     // Zigbee 3.0
+    ATTR(ESP_ZB_ZCL_ATTR_BASIC_HW_VERSION_ID, U8, ACCESS_RO, u8, 1),
+    ATTR_REF(ESP_ZB_ZCL_ATTR_BASIC_DATE_CODE_ID, CHAR_STRING, ACCESS_RO, "\x0A""2025-11-15"),
+    ATTR_REF(ESP_ZB_ZCL_ATTR_BASIC_SW_BUILD_ID, CHAR_STRING, ACCESS_RO, "\x05""v1.0.0"),
+};
+
+static const zb_ep_attr_t temp_attrs[] = {
+    ATTR(ESP_ZB_ZCL_ATTR_TEMP_MEASUREMENT_VALUE_ID, S16, ACCESS_RO_REPORT, s16, (int16_t)0x8000),  // Unknown
+    ATTR(ESP_ZB_ZCL_ATTR_TEMP_MEASUREMENT_MIN_VALUE_ID, S16, ACCESS_RO, s16, (int16_t)0x954D),     // -40°C in 0.01°C
+    ATTR(ESP_ZB_ZCL_ATTR_TEMP_MEASUREMENT_MAX_VALUE_ID, S16, ACCESS_RO, s16, 0x7FFF),
+    ATTR_REF(ZCL_ATTR_LOG_LEVEL, U8, ACCESS_RW, &s_log_level),
+    ATTR_REF(ZCL_ATTR_PERF_SUMMARY, OCTET_STRING, ACCESS_RO, s_perf_summary_empty),
+    ATTR_REF(ZCL_ATTR_CONFIG, OCTET_STRING, ACCESS_RW, s_config_record),
+};
+
+static const zb_ep_attr_t humidity_attrs[] = {
+    ATTR(ESP_ZB_ZCL_ATTR_REL_HUMIDITY_MEASUREMENT_VALUE_ID, U16, ACCESS_RO_REPORT, u16, 0xFFFF),  // Unknown
+    ATTR(ESP_ZB_ZCL_ATTR_REL_HUMIDITY_MEASUREMENT_MIN_VALUE_ID, U16, ACCESS_RO, u16, 0),
+    ATTR(ESP_ZB_ZCL_ATTR_REL_HUMIDITY_MEASUREMENT_MAX_VALUE_ID, U16, ACCESS_RO, u16, 10000),     // 100% in 0.01%
+};
+
+static const zb_ep_cluster_t ep1_clusters[] = {
+    CLUSTER(BASIC, basic_create, basic_attrs),
+    CLUSTER(TEMP_MEASUREMENT, NULL, temp_attrs),
+    CLUSTER(REL_HUMIDITY_MEASUREMENT, NULL, humidity_attrs),
+    CLUSTER_NO_ATTRS(IDENTIFY, identify_create),
+    CLUSTER_NO_ATTRS(DIAGNOSTICS, zb_diag_cluster_create),  // Stack counters + firmware counters 0xF1xx
+};
+
+/* Endpoint 2: pressure (0.1 hPa, int16) */
+static const zb_ep_attr_t pressure_attrs[] = {
+    ATTR(ESP_ZB_ZCL_ATTR_PRESSURE_MEASUREMENT_VALUE_ID, S16, ACCESS_RO_REPORT, s16,
+         ESP_ZB_ZCL_ATTR_PRESSURE_MEASUREMENT_VALUE_UNKNOWN),
+    ATTR(ESP_ZB_ZCL_ATTR_PRESSURE_MEASUREMENT_MIN_VALUE_ID, S16, ACCESS_RO, s16, 3000),    // 300 hPa
+    ATTR(ESP_ZB_ZCL_ATTR_PRESSURE_MEASUREMENT_MAX_VALUE_ID, S16, ACCESS_RO, s16, 11000),   // 1100 hPa
+};
+
+static const zb_ep_cluster_t ep2_clusters[] = {
+    CLUSTER(PRESSURE_MEASUREMENT, NULL, pressure_attrs),
+    CLUSTER_NO_ATTRS(IDENTIFY, identify_create),
+};
+
+/* Endpoints 3 and 4: VOC and NOx index as Analog Input (mandatory attributes, presentValue
+ * reportable, NaN - the ZCL invalid single - until the first sample) */
+#define ANALOG_INPUT_ATTRS(name, description) \
+    static const zb_ep_attr_t name[] = { \
+        ATTR(ESP_ZB_ZCL_ATTR_ANALOG_INPUT_OUT_OF_SERVICE_ID, BOOL, ACCESS_RO, b, false), \
+        ATTR(ESP_ZB_ZCL_ATTR_ANALOG_INPUT_PRESENT_VALUE_ID, SINGLE, ACCESS_RO_REPORT, f, NAN), \
+        ATTR(ESP_ZB_ZCL_ATTR_ANALOG_INPUT_STATUS_FLAGS_ID, 8BITMAP, ACCESS_RO, u8, 0), \
+        ATTR_REF(ESP_ZB_ZCL_ATTR_ANALOG_INPUT_DESCRIPTION_ID, CHAR_STRING, ACCESS_RO, description), \
+    }
+
+ANALOG_INPUT_ATTRS(voc_attrs, "\x09""VOC Index");
+ANALOG_INPUT_ATTRS(nox_attrs, "\x09""NOx Index");
+
+static const zb_ep_cluster_t ep3_clusters[] = {
+    CLUSTER(ANALOG_INPUT, NULL, voc_attrs),
+    CLUSTER_NO_ATTRS(IDENTIFY, identify_create),
+};
+
+static const zb_ep_cluster_t ep4_clusters[] = {
+    CLUSTER(ANALOG_INPUT, NULL, nox_attrs),
+    CLUSTER_NO_ATTRS(IDENTIFY, identify_create),
+};
+
+/* Endpoint 5: CO2 (ppm as float) */
+static const zb_ep_attr_t co2_attrs[] = {
+    ATTR(ESP_ZB_ZCL_ATTR_CARBON_DIOXIDE_MEASUREMENT_MEASURED_VALUE_ID, SINGLE, ACCESS_RO_REPORT, f, NAN),  // Unknown
+    ATTR(ESP_ZB_ZCL_ATTR_CARBON_DIOXIDE_MEASUREMENT_MIN_MEASURED_VALUE_ID, SINGLE, ACCESS_RO, f, 400.0f),
+    ATTR(ESP_ZB_ZCL_ATTR_CARBON_DIOXIDE_MEASUREMENT_MAX_MEASURED_VALUE_ID, SINGLE, ACCESS_RO, f, 5000.0f),
+};
+
+static const zb_ep_cluster_t ep5_clusters[] = {
+    CLUSTER(CARBON_DIOXIDE_MEASUREMENT, NULL, co2_attrs),
+    CLUSTER_NO_ATTRS(IDENTIFY, identify_create),
+};
+
+/* Endpoint 6: sensor LEDs (switch, thresholds and mask from attr_table.h, brightness) */
+static const zb_ep_cluster_t ep6_clusters[] = {
+    CLUSTER_NO_ATTRS(ON_OFF, sensor_leds_on_off_create),
+    CLUSTER_NO_ATTRS(ANALOG_OUTPUT, led_config_create),
+    CLUSTER_NO_ATTRS(IDENTIFY, identify_create),
+    CLUSTER_NO_ATTRS(LEVEL_CONTROL, level_create),
+};
+
+/* Endpoint 7: status LED */
+static const zb_ep_cluster_t ep7_clusters[] = {
+    CLUSTER_NO_ATTRS(ON_OFF, status_led_on_off_create),
+    CLUSTER_NO_ATTRS(IDENTIFY, identify_create),
+};
+
+/* Endpoint 8: fan (ZCL fan mode, auto curve and purge settings, measured RPM, stall fault) */
+static const zb_ep_attr_t fan_attrs[] = {
+    ATTR(ZCL_FAN_ATTR_RPM, U16, ACCESS_RO_REPORT, u16, 0),
+    ATTR(ZCL_FAN_ATTR_FAULT, BOOL, ACCESS_RO_REPORT, b, false),
+};
+
+static const zb_ep_cluster_t ep8_clusters[] = {
+    CLUSTER(FAN_CONTROL, fan_create, fan_attrs),
+    CLUSTER_NO_ATTRS(IDENTIFY, identify_create),
+};
+
+static const zb_ep_t s_endpoints[] = {
+    ENDPOINT(HA_ESP_TEMP_HUM_ENDPOINT, ESP_ZB_HA_TEMPERATURE_SENSOR_DEVICE_ID, ep1_clusters),
+    ENDPOINT(HA_ESP_PRESSURE_ENDPOINT, ESP_ZB_HA_SIMPLE_SENSOR_DEVICE_ID, ep2_clusters),
+    ENDPOINT(HA_ESP_VOC_ENDPOINT, ESP_ZB_HA_SIMPLE_SENSOR_DEVICE_ID, ep3_clusters),
+    ENDPOINT(HA_ESP_NOX_ENDPOINT, ESP_ZB_HA_SIMPLE_SENSOR_DEVICE_ID, ep4_clusters),
+    ENDPOINT(HA_ESP_CO2_ENDPOINT, ESP_ZB_HA_SIMPLE_SENSOR_DEVICE_ID, ep5_clusters),
+    ENDPOINT(HA_ESP_LED_CONFIG_ENDPOINT, ESP_ZB_HA_ON_OFF_OUTPUT_DEVICE_ID, ep6_clusters),
+    ENDPOINT(HA_ESP_STATUS_LED_ENDPOINT, ESP_ZB_HA_ON_OFF_LIGHT_DEVICE_ID, ep7_clusters),
+    ENDPOINT(HA_ESP_FAN_ENDPOINT, ESP_ZB_HA_ON_OFF_OUTPUT_DEVICE_ID, ep8_clusters),
+};
+
+/********************* Builder **************************/
+
+/* The cluster list API has one add function per standard cluster */
+static esp_err_t zb_cluster_list_add(esp_zb_cluster_list_t *list, esp_zb_attribute_list_t *cluster, uint16_t cluster_id)
+{
+    const uint8_t role = ESP_ZB_ZCL_CLUSTER_SERVER_ROLE;
+
+    switch (cluster_id) {
+        case ESP_ZB_ZCL_CLUSTER_ID_BASIC:
+            return esp_zb_cluster_list_add_basic_cluster(list, cluster, role);
+        case ESP_ZB_ZCL_CLUSTER_ID_IDENTIFY:
+            return esp_zb_cluster_list_add_identify_cluster(list, cluster, role);
+        case ESP_ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT:
+            return esp_zb_cluster_list_add_temperature_meas_cluster(list, cluster, role);
+        case ESP_ZB_ZCL_CLUSTER_ID_REL_HUMIDITY_MEASUREMENT:
+            return esp_zb_cluster_list_add_humidity_meas_cluster(list, cluster, role);
+        case ESP_ZB_ZCL_CLUSTER_ID_DIAGNOSTICS:
+            return esp_zb_cluster_list_add_diagnostics_cluster(list, cluster, role);
+        case ESP_ZB_ZCL_CLUSTER_ID_PRESSURE_MEASUREMENT:
+            return esp_zb_cluster_list_add_pressure_meas_cluster(list, cluster, role);
+        case ESP_ZB_ZCL_CLUSTER_ID_ANALOG_INPUT:
+            return esp_zb_cluster_list_add_analog_input_cluster(list, cluster, role);
+        case ESP_ZB_ZCL_CLUSTER_ID_CARBON_DIOXIDE_MEASUREMENT:
+            return esp_zb_cluster_list_add_carbon_dioxide_measurement_cluster(list, cluster, role);
+        case ESP_ZB_ZCL_CLUSTER_ID_ON_OFF:
+            return esp_zb_cluster_list_add_on_off_cluster(list, cluster, role);
+        case ESP_ZB_ZCL_CLUSTER_ID_ANALOG_OUTPUT:
+            return esp_zb_cluster_list_add_analog_output_cluster(list, cluster, role);
+        case ESP_ZB_ZCL_CLUSTER_ID_LEVEL_CONTROL:
+            return esp_zb_cluster_list_add_level_cluster(list, cluster, role);
+        case ESP_ZB_ZCL_CLUSTER_ID_FAN_CONTROL:
+            return esp_zb_cluster_list_add_fan_control_cluster(list, cluster, role);
+        default:
+            return esp_zb_cluster_list_add_custom_cluster(list, cluster, role);
+    }
+}
+
+esp_zb_ep_list_t *zb_endpoints_create(void)
+{
+    int clusters = 0, attrs = 0;
+
+    /* Boot-time initial values */
+    aeris_settings_t saved;
+    settings_get(&saved);
+    config_tlv_encode(&saved, s_config_record, sizeof(s_config_record));
+    s_log_level = (uint8_t)binlog_get_level();
+
+    esp_zb_ep_list_t *ep_list = esp_zb_ep_list_create();
+
+    for (size_t e = 0; e < sizeof(s_endpoints) / sizeof(s_endpoints[0]); e++) {
+        const zb_ep_t *ep = &s_endpoints[e];
+        esp_zb_cluster_list_t *cluster_list = esp_zb_zcl_cluster_list_create();
+
+        for (size_t c = 0; c < ep->cluster_count; c++) {
+            const zb_ep_cluster_t *cl = &ep->clusters[c];
+            esp_zb_attribute_list_t *cluster = cl->create ? cl->create() : esp_zb_zcl_attr_list_create(cl->id);
+
+            for (size_t a = 0; a < cl->attr_count; a++) {
+                const zb_ep_attr_t *attr = &cl->attrs[a];
+                void *value = (void *)(attr->by_ref ? attr->value.ref : &attr->value);  // Copied by the stack
+                ESP_ERROR_CHECK(esp_zb_cluster_add_attr(cluster, cl->id, attr->id, attr->type, attr->access, value));
+            }
+            attrs += cl->attr_count;
+
+            zb_attr_registry_add(cluster, ep->endpoint, cl->id);
+            ESP_ERROR_CHECK(zb_cluster_list_add(cluster_list, cluster, cl->id));
+        }
+        clusters += ep->cluster_count;
+
+        esp_zb_endpoint_config_t config = {
+            .endpoint = ep->endpoint,
+            .app_profile_id = ESP_ZB_AF_HA_PROFILE_ID,
+            .app_device_id = ep->device_id,
+            .app_device_version = 0,
+        };
+        ESP_ERROR_CHECK(esp_zb_ep_list_add_ep(ep_list, cluster_list, config));
+    }
+
+    ESP_LOGD(TAG, "%d endpoints, %d clusters, %d table attributes",
+             (int)(sizeof(s_endpoints) / sizeof(s_endpoints[0])), clusters, attrs);
+    return ep_list;
+}
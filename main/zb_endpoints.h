@@ -0,0 +1,35 @@
+/*
+ * Zigbee endpoint layout for Aeris Air Quality Sensor
+ *
+ * Endpoints, clusters and attributes are described by const tables
+ * (zb_endpoints.c) and registered by one builder pass. Settings attributes
+ * come from the attribute registry (attr_table.h).
+ */
+#pragma once
+
+#include <stdint.h>
+#include "esp_zigbee_core.h"
+#include "fan_control.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Build every endpoint from the layout tables
+ *
+ * Call after zb_attr_registry_init() and settings_init(): initial values
+ * of the settings attributes are the saved ones.
+ * @return Endpoint list for esp_zb_device_register()
+ */
+esp_zb_ep_list_t *zb_endpoints_create(void);
+
+/**
+ * @brief ZCL fan mode (0=off 1=low 2=medium 3=high 4=on 5=auto) <-> fan_mode_t
+ */
+fan_mode_t zb_fan_mode_from_zcl(uint8_t zcl_mode);
+uint8_t zb_fan_mode_to_zcl(fan_mode_t mode);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,146 @@
+#!/usr/bin/env python3
+"""
+Decode Aeris_Lite binary log records ("#BL <hex>" console lines).
+
+The firmware stores only the address of the format string and tag plus raw
+32-bit arguments; this tool looks the strings up in the application ELF and
+re-creates the ESP_LOG style text. Other console lines pass through unchanged.
+
+Usage:
+    idf.py monitor | tools/binlog_decode.py build/aeris_lite.elf
+    tools/binlog_decode.py build/aeris_lite.elf capture.log
+
+Requires pyelftools (shipped with the ESP-IDF Python environment).
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+from elftools.elf.elffile import ELFFile
+
+# Must match binlog_record_t in main/binlog.h (little-endian RISC-V)
+RECORD_FORMAT = '<IIIBBH4I'
+RECORD_SIZE = struct.calcsize(RECORD_FORMAT)
+
+LEVEL_CHARS = {1: 'E', 2: 'W', 3: 'I', 4: 'D', 5: 'V'}
+LEVEL_COLORS = {1: '\033[0;31m', 2: '\033[0;33m', 3: '\033[0;32m'}
+
+# printf conversion: flags, width, precision, length modifier, conversion
+FMT_SPEC = re.compile(r'%([-+ #0]*)(\d*)(?:\.(\d+))?(hh|h|ll|l|z|j|t)?([diuxXcsp%])')
+
+
+class ElfStrings:
+    """Resolve NUL-terminated strings from the loadable sections of an ELF."""
+
+    def __init__(self, path):
+        self._sections = []
+        self._cache = {}
+        with open(path, 'rb') as f:
+            elf = ELFFile(f)
+            for sec in elf.iter_sections():
+                if not (sec['sh_flags'] & 0x2):     # SHF_ALLOC
+                    continue
+                if sec['sh_type'] != 'SHT_PROGBITS' or sec['sh_size'] == 0:
+                    continue
+                self._sections.append((sec['sh_addr'], sec.data()))
+
+    def get(self, addr):
+        if addr in self._cache:
+            return self._cache[addr]
+        for base, data in self._sections:
+            if base <= addr < base + len(data):
+                off = addr - base
+                end = data.find(b'\0', off)
+                text = data[off:end if end >= 0 else len(data)].decode('utf-8', 'replace')
+                self._cache[addr] = text
+                return text
+        return None
+
+
+def format_message(strings, fmt, args):
+    """Apply printf-style formatting with 32-bit raw arguments."""
+    out = []
+    pos = 0
+    argi = 0
+    for m in FMT_SPEC.finditer(fmt):
+        out.append(fmt[pos:m.start()])
+        pos = m.end()
+        flags, width, prec, _length, conv = m.groups()
+        if conv == '%':
+            out.append('%')
+            continue
+        if argi >= len(args):
+            out.append('<?>')
+            continue
+        raw = args[argi]
+        argi += 1
+        spec = '%' + flags + width + ('.' + prec if prec else '')
+        if conv == 's':
+            text = strings.get(raw) if raw else '(null)'
+            out.append((spec + 's') % (text if text is not None else '<0x%08x>' % raw))
+        elif conv in 'di':
+            value = raw - (1 << 32) if raw & 0x80000000 else raw
+            out.append((spec + 'd') % value)
+        elif conv == 'c':
+            out.append((spec + 'c') % chr(raw & 0xFF))
+        elif conv == 'p':
+            out.append('0x%08x' % raw)
+        else:
+            out.append((spec + conv) % raw)
+    out.append(fmt[pos:])
+    return ''.join(out)
+
+
+def decode_line(strings, hex_payload, color):
+    try:
+        raw = bytes.fromhex(hex_payload)
+    except ValueError:
+        return None
+    if len(raw) != RECORD_SIZE:
+        return None
+    fmt_addr, tag_addr, ts, level, nargs, seq, *args = struct.unpack(RECORD_FORMAT, raw)
+    fmt = strings.get(fmt_addr)
+    tag = strings.get(tag_addr) or '0x%08x' % tag_addr
+    if fmt is None:
+        msg = '<unknown fmt 0x%08x> %s' % (fmt_addr, ' '.join('0x%x' % a for a in args[:nargs]))
+    else:
+        msg = format_message(strings, fmt, args[:nargs])
+    text = '%s (%d) %s: %s' % (LEVEL_CHARS.get(level, '?'), ts, tag, msg)
+    if color and level in LEVEL_COLORS:
+        text = LEVEL_COLORS[level] + text + '\033[0m'
+    return text, seq
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode Aeris_Lite binary log lines')
+    parser.add_argument('elf', help='Application ELF matching the running firmware')
+    parser.add_argument('input', nargs='?', help='Captured log file (default: stdin)')
+    parser.add_argument('--color', action='store_true', help='Colorize output like idf.py monitor')
+    args = parser.parse_args()
+
+    strings = ElfStrings(args.elf)
+    src = open(args.input, 'r', errors='replace') if args.input else sys.stdin
+    expected_seq = None
+
+    for line in src:
+        line = line.rstrip('\r\n')
+        idx = line.find('#BL ')
+        if idx < 0:
+            print(line)
+            continue
+        result = decode_line(strings, line[idx + 4:].strip(), args.color)
+        if result is None:
+            print(line)
+            continue
+        text, seq = result
+        if expected_seq is not None and seq != expected_seq:
+            print('--- binlog: %d record(s) lost ---' % ((seq - expected_seq) & 0xFFFF))
+        expected_seq = (seq + 1) & 0xFFFF
+        print(text)
+        sys.stdout.flush()
+
+
+if __name__ == '__main__':
+    main()
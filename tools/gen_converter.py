@@ -0,0 +1,195 @@
+#!/usr/bin/env python3
+"""
+Generate the settings part of the Zigbee2MQTT converter from main/attr_table.h.
+
+Rewrites the block between the BEGIN GENERATED / END GENERATED markers in
+aeris_lite.js: the bulk configuration field list (CONFIG_FIELDS) and a
+numeric expose for every manufacturer-specific attribute of the table that
+has a description. Run it after changing the table.
+
+Usage:
+    tools/gen_converter.py            # update aeris_lite.js
+    tools/gen_converter.py --check    # exit 1 if aeris_lite.js is out of date
+"""
+
+import argparse
+import os
+import re
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+TABLE_H = os.path.join(ROOT, 'main', 'attr_table.h')
+AERIS_H = os.path.join(ROOT, 'main', 'esp_zb_aeris.h')
+CONVERTER = os.path.join(ROOT, 'aeris_lite.js')
+
+BEGIN = '// BEGIN GENERATED by tools/gen_converter.py from main/attr_table.h, do not edit'
+END = '// END GENERATED'
+
+# zigbee-herdsman names of the clusters used by the table
+CLUSTERS = {
+    'ESP_ZB_ZCL_CLUSTER_ID_TEMP_MEASUREMENT': 'msTemperatureMeasurement',
+    'ESP_ZB_ZCL_CLUSTER_ID_ON_OFF': 'genOnOff',
+    'ESP_ZB_ZCL_CLUSTER_ID_LEVEL_CONTROL': 'genLevelCtrl',
+    'ESP_ZB_ZCL_CLUSTER_ID_ANALOG_OUTPUT': 'genAnalogOutput',
+    'ESP_ZB_ZCL_CLUSTER_ID_FAN_CONTROL': 'hvacFanCtrl',
+}
+
+COLUMNS = ('key', 'field', 'type', 'min', 'max', 'check', 'endpoint', 'cluster',
+           'attr_id', 'tag', 'apply', 'unit', 'description')
+
+DEFINE = re.compile(r'^\s*#define\s+(\w+)\s+(0x[0-9A-Fa-f]+|\d+)\b', re.M)
+
+
+def read_defines(*paths):
+    values = {}
+    for path in paths:
+        with open(path, encoding='utf-8') as f:
+            for name, value in DEFINE.findall(f.read()):
+                values[name] = int(value, 0)
+    return values
+
+
+def split_args(text):
+    """Split a macro argument list at top-level commas, keeping strings intact."""
+    args, depth, current, in_string = [], 0, '', False
+    for i, c in enumerate(text):
+        if in_string:
+            current += c
+            if c == '"' and text[i - 1] != '\\':
+                in_string = False
+        elif c == '"':
+            in_string, current = True, current + c
+        elif c == '(':
+            depth, current = depth + 1, current + c
+        elif c == ')':
+            depth, current = depth - 1, current + c
+        elif c == ',' and depth == 0:
+            args.append(current.strip())
+            current = ''
+        else:
+            current += c
+    args.append(current.strip())
+    return args
+
+
+def read_table(path):
+    with open(path, encoding='utf-8') as f:
+        source = f.read()
+    start = source.index('#define AERIS_ATTR_TABLE(X)')
+    body = []
+    for line in source[start:].splitlines()[1:]:
+        body.append(line.rstrip().rstrip('\\'))
+        if not line.rstrip().endswith('\\'):
+            break
+    body = re.sub(r'/\*.*?\*/', '', ' '.join(body))
+
+    rows = []
+    pos = 0
+    while True:
+        pos = body.find('X(', pos)
+        if pos < 0:
+            return rows
+        depth, end = 0, pos + 1
+        in_string = False
+        for end in range(pos + 1, len(body)):
+            c = body[end]
+            if c == '"' and body[end - 1] != '\\':
+                in_string = not in_string
+            elif not in_string and c == '(':
+                depth += 1
+            elif not in_string and c == ')':
+                depth -= 1
+                if depth == 0:
+                    break
+        args = split_args(body[pos + 2:end])
+        if len(args) != len(COLUMNS):
+            sys.exit(f'attr_table.h: expected {len(COLUMNS)} columns, got {len(args)}: {args[0]}')
+        rows.append(dict(zip(COLUMNS, args)))
+        pos = end
+
+
+def resolve(value, defines):
+    """Integer value of a table cell, None for a symbol the headers don't define (standard IDs)."""
+    try:
+        return int(value, 0)
+    except ValueError:
+        return defines.get(value)
+
+
+def js_string(value):
+    return value if value.startswith('"') else f'"{value}"'
+
+
+def generate(rows, defines):
+    custom_min = defines['ATTR_ID_CUSTOM_MIN']
+    out = [BEGIN, 'const CONFIG_FIELDS = [', '    // [key, tag, size, signed]']
+    for row in rows:
+        tag = resolve(row['tag'], defines)
+        if not tag:
+            continue
+        type_id = resolve(row['type'], defines)
+        size = 2 if type_id in (defines['ATTR_TYPE_U16'], defines['ATTR_TYPE_S16']) else 1
+        signed = ', true' if type_id == defines['ATTR_TYPE_S16'] else ''
+        out.append(f'    ["{row["key"]}", 0x{tag:02X}, {size}{signed}],')
+    out += ['];', '', 'const configAttributes = [']
+
+    for row in rows:
+        attr_id = resolve(row['attr_id'], defines)
+        if row['description'] == '""' or attr_id is None or attr_id < custom_min:
+            continue
+        cluster = CLUSTERS.get(row['cluster'])
+        if cluster is None:
+            sys.exit(f'attr_table.h: {row["key"]}: no Zigbee2MQTT name for {row["cluster"]}')
+        endpoint = resolve(row['endpoint'], defines)
+        type_id = resolve(row['type'], defines)
+        out += [
+            '    m.numeric({',
+            f'        name: "{row["key"]}",',
+            f'        valueMin: {resolve(row["min"], defines)},',
+            f'        valueMax: {resolve(row["max"], defines)},',
+            '        valueStep: 1,',
+        ]
+        if row['unit'] != '""':
+            out.append(f'        unit: {js_string(row["unit"])},')
+        out += [
+            f'        cluster: "{cluster}",',
+            f'        attribute: {{ID: 0x{attr_id:04X}, type: 0x{type_id:02X}}},',
+            f'        description: {js_string(row["description"])},',
+            '        access: "ALL",',
+            '        entityCategory: "config",',
+            f'        endpointNames: ["{endpoint}"],',
+            '    }),',
+        ]
+    out += ['];', END]
+    return '\n'.join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Generate the aeris_lite.js settings block from main/attr_table.h')
+    parser.add_argument('--check', action='store_true', help='only check that aeris_lite.js is up to date')
+    args = parser.parse_args()
+
+    defines = read_defines(AERIS_H, TABLE_H)
+    block = generate(read_table(TABLE_H), defines)
+
+    with open(CONVERTER, encoding='utf-8') as f:
+        converter = f.read()
+    start, end = converter.find(BEGIN), converter.find(END)
+    if start < 0 or end < start:
+        sys.exit(f'{CONVERTER}: generated block markers not found')
+    updated = converter[:start] + block + converter[end + len(END):]
+
+    if args.check:
+        if updated != converter:
+            print('aeris_lite.js is out of date, run tools/gen_converter.py', file=sys.stderr)
+            return 1
+        return 0
+    if updated != converter:
+        with open(CONVERTER, 'w', encoding='utf-8') as f:
+            f.write(updated)
+        print('aeris_lite.js updated')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+"""
+Replay an Aeris_Lite I2C capture through the sensor driver on the host.
+
+The firmware records every sensor I2C transaction (see main/i2c_capture.h).
+Write 3 to 0xF109 on the Diagnostics cluster to dump the recording, or 2 to
+stream every transaction as it happens (needed for captures longer than the
+ring, e.g. a full SGP41 gas-index learning period). This tool compiles the
+unmodified main/aeris_driver.c against the host stubs in tools/replay/ and
+feeds the capture back through it, much faster than real time:
+
+    idf.py monitor | tee capture.log
+    tools/i2c_replay.py capture.log -o readings.csv
+
+One CSV row is written per acquisition cycle; the driver log, latency
+histograms and replay statistics go to stderr. Requires a host C compiler
+(cc/gcc/clang) and only the Python standard library.
+"""
+
+import argparse
+import os
+import shutil
+import subprocess
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+REPLAY_DIR = os.path.join(ROOT, 'tools', 'replay')
+SOURCES = [
+    os.path.join(REPLAY_DIR, 'replay_main.c'),
+    os.path.join(ROOT, 'main', 'aeris_driver.c'),
+    os.path.join(ROOT, 'main', 'perf_stats.c'),
+]
+
+
+def build(cc, output, extra_flags):
+    """Compile the replay binary if any source or header changed."""
+    deps = SOURCES + [os.path.join(d, f) for base in (REPLAY_DIR, os.path.join(ROOT, 'main'))
+                      for d, _, files in os.walk(base) for f in files if f.endswith('.h')]
+    if os.path.exists(output) and not extra_flags:
+        built = os.path.getmtime(output)
+        if all(os.path.getmtime(dep) <= built for dep in deps):
+            return
+    os.makedirs(os.path.dirname(output), exist_ok=True)
+    cmd = [cc, '-std=gnu17', '-O2', '-g', '-Wall', '-Wno-format', '-Wno-unused-function',
+           '-DAERIS_I2C_CAPTURE_ENABLE=0',
+           '-I' + os.path.join(REPLAY_DIR, 'stubs'), '-I' + os.path.join(ROOT, 'main')]
+    cmd += extra_flags + SOURCES + ['-o', output, '-lm']
+    subprocess.check_call(cmd)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Replay an Aeris_Lite "#I2C" capture through aeris_driver.c')
+    parser.add_argument('capture', help='Console log with "#I2C" lines (- for stdin)')
+    parser.add_argument('-o', '--output', help='CSV output file (default: stdout)')
+    parser.add_argument('-v', '--verbosity', default='W', choices='EWIDV',
+                        help='Driver log level (default: W)')
+    parser.add_argument('--cc', default=os.environ.get('CC') or shutil.which('cc') or 'gcc',
+                        help='Host C compiler')
+    parser.add_argument('--build-dir', default=os.path.join(ROOT, 'build', 'i2c_replay'),
+                        help='Where to put the replay binary')
+    parser.add_argument('--cflags', default='', help='Extra compiler flags (e.g. "-fsanitize=address")')
+    args = parser.parse_args()
+
+    binary = os.path.join(args.build_dir, 'aeris_i2c_replay')
+    try:
+        build(args.cc, binary, args.cflags.split())
+    except (OSError, subprocess.CalledProcessError) as exc:
+        sys.exit('Build failed: %s' % exc)
+
+    out = open(args.output, 'w') if args.output else None
+    stdin = sys.stdin if args.capture == '-' else None
+    ret = subprocess.call([binary, '-v', args.verbosity, args.capture], stdin=stdin, stdout=out)
+    if out:
+        out.close()
+    sys.exit(ret)
+
+
+if __name__ == '__main__':
+    main()
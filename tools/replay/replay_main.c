@@ -0,0 +1,520 @@
+/*
+ * Host replay engine for Aeris_Lite I2C captures
+ *
+ * Links the unmodified main/aeris_driver.c against host stubs of the IDF
+ * APIs it uses. Every i2c_master_* call is answered from the capture: the
+ * next matching record (same bus, address, kind, written bytes and read
+ * length) supplies the read bytes, the result and the duration. Time is
+ * virtual - vTaskDelay() and recorded transaction durations advance it, and
+ * each acquisition cycle starts at the timestamp of its first record - so
+ * hours of recording replay in well under a second.
+ *
+ * Output: one CSV row per acquisition cycle on stdout, driver logs, latency
+ * histograms and replay statistics on stderr. Built and run by
+ * tools/i2c_replay.py.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_system.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/i2c_master.h"
+#include "aeris_driver.h"
+#include "fan_control.h"
+#include "i2c_capture.h"
+#include "boot_profile.h"
+#include "perf_stats.h"
+
+#define REPLAY_LOOKAHEAD    64      /* Records searched for a match before giving up */
+#define REPLAY_LINE_MAX     512
+
+/* One decoded capture record */
+typedef struct {
+    uint64_t ts_us;                 /* Unwrapped timestamp */
+    uint16_t dur_us;
+    int16_t result;
+    uint8_t bus;
+    uint8_t addr;
+    uint8_t op;
+    uint8_t tx_len;
+    uint8_t rx_len;
+    bool boot;                      /* From the pinned boot section */
+    uint8_t tx[I2C_CAPTURE_MAX_DATA];
+    uint8_t rx[I2C_CAPTURE_MAX_DATA];
+} replay_rec_t;
+
+typedef struct {
+    replay_rec_t *recs;
+    size_t count;
+    size_t cap;
+    uint32_t last_raw;
+    uint64_t wrap;
+} replay_list_t;
+
+struct i2c_master_bus_t {
+    uint8_t port;
+};
+
+struct i2c_master_dev_t {
+    uint8_t bus;
+    uint8_t addr;
+};
+
+/* Replay state */
+static replay_rec_t *s_recs;
+static size_t s_count;
+static size_t s_cursor;
+static int64_t s_now_us;
+static esp_log_level_t s_log_level = ESP_LOG_WARN;
+static struct i2c_master_bus_t s_buses[2];
+static struct i2c_master_dev_t s_devs[8];
+static size_t s_dev_count;
+
+/* Statistics */
+static uint32_t s_matched;
+static uint32_t s_skipped;
+static uint32_t s_unmatched;
+static uint32_t s_param_diffs;
+static uint32_t s_cycles;
+
+/* --- IDF stubs -------------------------------------------------------------- */
+
+void replay_log(esp_log_level_t level, const char *tag, const char *fmt, ...)
+{
+    static const char letters[] = "NEWIDV";
+    if (level > s_log_level) {
+        return;
+    }
+    va_list ap;
+    va_start(ap, fmt);
+    fprintf(stderr, "%c (%lld) %s: ", letters[level], (long long)(s_now_us / 1000), tag);
+    vfprintf(stderr, fmt, ap);
+    fputc('\n', stderr);
+    va_end(ap);
+}
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+    case ESP_OK: return "ESP_OK";
+    case ESP_FAIL: return "ESP_FAIL";
+    case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+    case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+    case ESP_ERR_INVALID_RESPONSE: return "ESP_ERR_INVALID_RESPONSE";
+    case ESP_ERR_INVALID_CRC: return "ESP_ERR_INVALID_CRC";
+    default: return "UNKNOWN ERROR";
+    }
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return s_now_us;
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    s_now_us += (int64_t)ticks * (1000000 / configTICK_RATE_HZ);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(s_now_us / (1000000 / configTICK_RATE_HZ));
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+                       UBaseType_t priority, TaskHandle_t *handle)
+{
+    fn(arg);
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+}
+
+void boot_profile_mark(boot_milestone_t milestone)
+{
+}
+
+/* Power-on: captures replay through the full sensor discovery */
+esp_reset_reason_t esp_reset_reason(void)
+{
+    return ESP_RST_POWERON;
+}
+
+esp_err_t fan_init(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t fan_set_speed(uint8_t speed_percent)
+{
+    return ESP_OK;
+}
+
+/**
+ * @brief Driver calls this at the end of aeris_driver_init()
+ *
+ * Ring records of a dump may start long after boot: skip whatever is left of
+ * the boot section so the first acquisition lines up with the ring.
+ */
+void i2c_capture_end_boot(void)
+{
+    size_t next = s_cursor;
+    while (next < s_count && s_recs[next].boot) {
+        next++;
+    }
+    s_skipped += next - s_cursor;
+    s_cursor = next;
+}
+
+/* --- I2C master stubs --------------------------------------------------------- */
+
+esp_err_t i2c_new_master_bus(const i2c_master_bus_config_t *bus_config, i2c_master_bus_handle_t *ret_bus_handle)
+{
+    if (bus_config->i2c_port > I2C_NUM_1) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_buses[bus_config->i2c_port].port = (uint8_t)bus_config->i2c_port;
+    *ret_bus_handle = &s_buses[bus_config->i2c_port];
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_bus_add_device(i2c_master_bus_handle_t bus_handle, const i2c_device_config_t *dev_config,
+                                    i2c_master_dev_handle_t *ret_handle)
+{
+    if (s_dev_count >= sizeof(s_devs) / sizeof(s_devs[0])) {
+        return ESP_ERR_NO_MEM;
+    }
+    struct i2c_master_dev_t *dev = &s_devs[s_dev_count++];
+    dev->bus = bus_handle->port;
+    dev->addr = (uint8_t)dev_config->device_address;
+    *ret_handle = dev;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_probe(i2c_master_bus_handle_t bus_handle, uint16_t address, int xfer_timeout_ms)
+{
+    /* Probes are not recorded: a device is present if it appears in the capture */
+    for (size_t i = 0; i < s_count; i++) {
+        if (s_recs[i].bus == bus_handle->port && s_recs[i].addr == address) {
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+/**
+ * @brief Find the record answering a driver transaction, starting at the cursor
+ *
+ * @param cmp_len Leading written bytes that must match
+ */
+static const replay_rec_t *replay_find(const struct i2c_master_dev_t *dev, uint8_t op, const uint8_t *tx,
+                                       size_t tx_len, size_t rx_len, size_t cmp_len)
+{
+    size_t end = s_cursor + REPLAY_LOOKAHEAD;
+    if (end > s_count) {
+        end = s_count;
+    }
+
+    for (size_t i = s_cursor; i < end; i++) {
+        const replay_rec_t *r = &s_recs[i];
+        if (r->bus == dev->bus && r->addr == dev->addr && r->op == op && r->tx_len == tx_len &&
+            r->rx_len == rx_len && memcmp(r->tx, tx, cmp_len) == 0) {
+            return r;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Answer one driver transaction from the capture
+ */
+static esp_err_t replay_xfer(i2c_master_dev_handle_t dev, uint8_t op, const uint8_t *tx, size_t tx_len,
+                             uint8_t *rx, size_t rx_len)
+{
+    size_t tx_rec = (tx_len > I2C_CAPTURE_MAX_DATA) ? I2C_CAPTURE_MAX_DATA : tx_len;
+    size_t rx_rec = (rx_len > I2C_CAPTURE_MAX_DATA) ? I2C_CAPTURE_MAX_DATA : rx_len;
+
+    const replay_rec_t *r = replay_find(dev, op, tx, tx_rec, rx_rec, tx_rec);
+    if (!r && tx_rec > 2) {
+        /* Same command, different parameters: compensation words computed in
+         * floating point (SGP41 RH/T, SCD40 pressure) may differ by one LSB */
+        r = replay_find(dev, op, tx, tx_rec, rx_rec, 2);
+        if (r) {
+            s_param_diffs++;
+        }
+    }
+    if (!r) {
+        s_unmatched++;
+        ESP_LOGD("REPLAY", "No record for bus %u addr 0x%02X op %u tx %zu rx %zu",
+                 dev->bus, dev->addr, op, tx_len, rx_len);
+        if (rx_len) {
+            memset(rx, 0, rx_len);
+        }
+        return ESP_ERR_TIMEOUT;
+    }
+
+    size_t idx = (size_t)(r - s_recs);
+    s_skipped += idx - s_cursor;
+    s_cursor = idx + 1;
+    s_matched++;
+    if (rx_len) {
+        memset(rx, 0, rx_len);
+        memcpy(rx, r->rx, r->rx_len);
+    }
+    if ((int64_t)r->ts_us > s_now_us) {
+        s_now_us = (int64_t)r->ts_us;
+    }
+    s_now_us += r->dur_us;
+    return (esp_err_t)r->result;
+}
+
+esp_err_t i2c_master_transmit(i2c_master_dev_handle_t i2c_dev, const uint8_t *write_buffer, size_t write_size,
+                              int xfer_timeout_ms)
+{
+    return replay_xfer(i2c_dev, I2C_CAPTURE_OP_WRITE, write_buffer, write_size, NULL, 0);
+}
+
+esp_err_t i2c_master_receive(i2c_master_dev_handle_t i2c_dev, uint8_t *read_buffer, size_t read_size,
+                             int xfer_timeout_ms)
+{
+    return replay_xfer(i2c_dev, I2C_CAPTURE_OP_READ, NULL, 0, read_buffer, read_size);
+}
+
+esp_err_t i2c_master_transmit_receive(i2c_master_dev_handle_t i2c_dev, const uint8_t *write_buffer,
+                                      size_t write_size, uint8_t *read_buffer, size_t read_size,
+                                      int xfer_timeout_ms)
+{
+    return replay_xfer(i2c_dev, I2C_CAPTURE_OP_WRITE_READ, write_buffer, write_size, read_buffer, read_size);
+}
+
+/* --- Capture parsing ------------------------------------------------------------ */
+
+static int hex_nibble(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+/**
+ * @brief Decode one "#I2C <kind> <hex>" payload and append it to @p list
+ *
+ * @return false if the line is truncated or corrupted by other console output
+ */
+static bool replay_list_add(replay_list_t *list, const char *hex, bool boot)
+{
+    uint8_t raw[I2C_CAPTURE_HEADER_SIZE + 2 * I2C_CAPTURE_MAX_DATA];
+    size_t len = 0;
+
+    while (hex[0] && hex[1] && len < sizeof(raw)) {
+        int hi = hex_nibble(hex[0]);
+        int lo = hex_nibble(hex[1]);
+        if (hi < 0 || lo < 0) {
+            break;
+        }
+        raw[len++] = (uint8_t)((hi << 4) | lo);
+        hex += 2;
+    }
+    if (len < I2C_CAPTURE_HEADER_SIZE || raw[10] > I2C_CAPTURE_MAX_DATA || raw[11] > I2C_CAPTURE_MAX_DATA ||
+        len != (size_t)I2C_CAPTURE_HEADER_SIZE + raw[10] + raw[11]) {
+        return false;
+    }
+
+    if (list->count == list->cap) {
+        list->cap = list->cap ? list->cap * 2 : 1024;
+        list->recs = realloc(list->recs, list->cap * sizeof(replay_rec_t));
+        if (!list->recs) {
+            fprintf(stderr, "Out of memory\n");
+            exit(1);
+        }
+    }
+
+    replay_rec_t *r = &list->recs[list->count];
+    uint32_t ts = raw[0] | (raw[1] << 8) | (raw[2] << 16) | ((uint32_t)raw[3] << 24);
+    if (list->count && ts < list->last_raw && list->last_raw - ts > 0x80000000UL) {
+        list->wrap += 1ULL << 32;
+    }
+    list->last_raw = ts;
+    r->ts_us = list->wrap + ts;
+    r->dur_us = (uint16_t)(raw[4] | (raw[5] << 8));
+    r->result = (int16_t)(raw[6] | (raw[7] << 8));
+    r->bus = raw[8] >> 7;
+    r->addr = raw[8] & 0x7F;
+    r->op = raw[9];
+    r->tx_len = raw[10];
+    r->rx_len = raw[11];
+    r->boot = boot;
+    memcpy(r->tx, &raw[I2C_CAPTURE_HEADER_SIZE], r->tx_len);
+    memcpy(r->rx, &raw[I2C_CAPTURE_HEADER_SIZE + r->tx_len], r->rx_len);
+    list->count++;
+    return true;
+}
+
+/**
+ * @brief Load a console log: the last complete dump wins, else the streamed records
+ */
+static bool replay_load(FILE *f, uint32_t *bad_lines)
+{
+    replay_list_t stream = {0};
+    replay_list_t current = {0};
+    replay_list_t dump = {0};
+    bool in_dump = false;
+    char line[REPLAY_LINE_MAX];
+
+    while (fgets(line, sizeof(line), f)) {
+        const char *p = strstr(line, "#I2C");
+        if (!p) {
+            continue;
+        }
+        if (strncmp(p, "#I2C-BEGIN", 10) == 0) {
+            free(current.recs);
+            memset(&current, 0, sizeof(current));
+            in_dump = true;
+        } else if (strncmp(p, "#I2C-END", 8) == 0) {
+            if (in_dump) {
+                free(dump.recs);
+                dump = current;
+                memset(&current, 0, sizeof(current));
+            }
+            in_dump = false;
+        } else if (p[4] == ' ' && p[5] && p[6] == ' ') {
+            bool ok = false;
+            if (p[5] == 'S') {
+                ok = replay_list_add(&stream, p + 7, false);
+            } else if (in_dump && (p[5] == 'B' || p[5] == 'R')) {
+                ok = replay_list_add(&current, p + 7, p[5] == 'B');
+            }
+            if (!ok) {
+                (*bad_lines)++;
+            }
+        }
+    }
+    free(current.recs);
+
+    if (dump.count) {
+        free(stream.recs);
+        s_recs = dump.recs;
+        s_count = dump.count;
+    } else {
+        free(dump.recs);
+        s_recs = stream.recs;
+        s_count = stream.count;
+    }
+    return s_count > 0;
+}
+
+/* --- Main ------------------------------------------------------------------------- */
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-v E|W|I|D|V] capture.log\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-v") == 0 && i + 1 < argc) {
+            const char *levels = "NEWIDV";
+            const char *l = strchr(levels, argv[++i][0]);
+            s_log_level = l ? (esp_log_level_t)(l - levels) : ESP_LOG_INFO;
+        } else if ((argv[i][0] != '-' || argv[i][1] == '\0') && !path) {
+            path = argv[i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (!path) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    FILE *f = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return 1;
+    }
+    uint32_t bad_lines = 0;
+    bool loaded = replay_load(f, &bad_lines);
+    if (f != stdin) {
+        fclose(f);
+    }
+    if (!loaded) {
+        fprintf(stderr, "No \"#I2C\" records in %s\n", path);
+        return 1;
+    }
+
+    uint64_t origin = s_recs[0].ts_us;
+    s_now_us = (int64_t)origin;
+    aeris_driver_init();
+
+    printf("time_s,temperature_c,humidity_pct,pressure_hpa,voc_raw,nox_raw,voc_index,nox_index,co2_ppm,errors\n");
+    while (s_cursor < s_count) {
+        size_t start = s_cursor;
+        if ((int64_t)s_recs[s_cursor].ts_us > s_now_us) {
+            s_now_us = (int64_t)s_recs[s_cursor].ts_us;
+        }
+        int64_t cycle_us = s_now_us;
+
+        /* Same order as sensor_periodic_update() in esp_zb_aeris.c */
+        float temp_c, humidity, pressure_hpa;
+        uint16_t voc_index, nox_index, co2_ppm;
+        int errors = 0;
+        errors += aeris_read_temp_humidity(&temp_c, &humidity) != ESP_OK;
+        errors += aeris_read_pressure(&pressure_hpa) != ESP_OK;
+        errors += aeris_read_voc(&voc_index) != ESP_OK;
+        errors += aeris_read_nox(&nox_index) != ESP_OK;
+        esp_err_t co2_ret = aeris_read_co2(&co2_ppm);
+        errors += co2_ret != ESP_OK && co2_ret != ESP_ERR_NOT_FOUND;    /* Not ready is normal */
+
+        if (s_cursor == start) {
+            /* Nothing in this cycle matched the record under the cursor */
+            s_cursor++;
+            s_skipped++;
+            continue;
+        }
+
+        aeris_sensor_state_t state;
+        aeris_get_sensor_data(&state);
+        printf("%.3f,%.2f,%.2f,%.2f,%u,%u,%u,%u,%u,%d\n", (double)(cycle_us - (int64_t)origin) / 1e6,
+               state.temperature_c, state.humidity_percent, state.pressure_hpa, state.voc_raw, state.nox_raw,
+               state.voc_index, state.nox_index, state.co2_ppm, errors);
+        s_cycles++;
+    }
+
+    if (s_log_level < ESP_LOG_INFO) {
+        s_log_level = ESP_LOG_INFO;                 /* perf_dump() logs at info level */
+    }
+    perf_dump();
+    fprintf(stderr, "Replay: %zu records, %lu matched, %lu skipped, %lu unmatched driver calls, "
+            "%lu with different parameters, %lu cycles, %lu bad lines, %.1f s of capture\n",
+            s_count, (unsigned long)s_matched, (unsigned long)s_skipped, (unsigned long)s_unmatched,
+            (unsigned long)s_param_diffs,
+            (unsigned long)s_cycles, (unsigned long)bad_lines,
+            (double)(s_recs[s_count - 1].ts_us - origin) / 1e6);
+    free(s_recs);
+    return 0;
+}
@@ -0,0 +1,5 @@
+/*
+ * Host stub of driver/uart.h for the I2C replay harness
+ */
+
+#pragma once
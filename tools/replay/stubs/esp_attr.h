@@ -0,0 +1,7 @@
+/*
+ * Host stub of esp_attr.h for the I2C replay harness
+ */
+
+#pragma once
+
+#define RTC_NOINIT_ATTR
@@ -0,0 +1,9 @@
+/*
+ * Host stub of esp_timer.h for the I2C replay harness (virtual clock)
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+int64_t esp_timer_get_time(void);
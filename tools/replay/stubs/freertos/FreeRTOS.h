@@ -0,0 +1,35 @@
+/*
+ * Host stub of FreeRTOS.h for the I2C replay harness
+ *
+ * Single-threaded: critical sections are no-ops and time is the replay
+ * engine's virtual clock (100 Hz tick, as CONFIG_FREERTOS_HZ).
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define configTICK_RATE_HZ          100
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+typedef struct {
+    int unused;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED    { 0 }
+#define portENTER_CRITICAL(mux)         ((void)(mux))
+#define portEXIT_CRITICAL(mux)          ((void)(mux))
+#define portENTER_CRITICAL_SAFE(mux)    ((void)(mux))
+#define portEXIT_CRITICAL_SAFE(mux)     ((void)(mux))
+
+#define pdPASS                      1
+#define pdTRUE                      1
+#define pdFALSE                     0
+#define portMAX_DELAY               0xFFFFFFFFUL
+#define pdMS_TO_TICKS(ms)           ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+#define pdTICKS_TO_MS(ticks)        ((TickType_t)(((uint64_t)(ticks) * 1000) / configTICK_RATE_HZ))
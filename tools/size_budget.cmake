@@ -0,0 +1,28 @@
+# Print the application image size against the OTA slot budget.
+#
+# Usage: cmake -DBIN=<app.bin> -DSLOT_SIZE=<bytes> -DPROFILE=<name> -P size_budget.cmake
+
+if(NOT EXISTS "${BIN}")
+    message(FATAL_ERROR "size_budget: ${BIN} not found")
+endif()
+
+file(SIZE "${BIN}" _bin_size)
+math(EXPR _slot_size "${SLOT_SIZE}")
+math(EXPR _free "${_slot_size} - ${_bin_size}")
+math(EXPR _used_permille "(${_bin_size} * 1000) / ${_slot_size}")
+math(EXPR _used_pct "${_used_permille} / 10")
+math(EXPR _used_pct_frac "${_used_permille} % 10")
+
+message("================================================")
+message("Size budget (${PROFILE}):")
+message("  Image:     ${_bin_size} bytes")
+message("  OTA slot:  ${_slot_size} bytes")
+message("  Used:      ${_used_pct}.${_used_pct_frac}%")
+message("  Free:      ${_free} bytes")
+message("================================================")
+
+if(_bin_size GREATER _slot_size)
+    message(FATAL_ERROR "Application image does not fit in the OTA slot")
+elseif(_used_permille GREATER 900)
+    message(WARNING "Application image uses more than 90% of the OTA slot")
+endif()
@@ -0,0 +1,182 @@
+#!/usr/bin/env python3
+"""
+Convert Aeris_Lite event trace dumps ("#TR" console lines) to a Chrome trace.
+
+The firmware (built with -D AERIS_ENABLE_TRACE=ON) prints its trace ring when
+0xF108 on the Diagnostics cluster is written with 2 (see main/event_trace.h).
+The JSON written by this tool opens in https://ui.perfetto.dev or
+chrome://tracing:
+
+    CPU       which task is running (from FreeRTOS task switches)
+    ISR       button / RMT / PCNT interrupt markers
+    <task>    I2C, Zigbee signal, scheduler alarm, NVS, acquisition, LED and
+              OTA spans, on the task that executed them
+
+Usage:
+    idf.py monitor | tee capture.log
+    tools/trace_to_perfetto.py capture.log -o trace.json
+
+Only the standard library is required. Other console lines are ignored.
+"""
+
+import argparse
+import json
+import sys
+
+PID = 1
+TID_CPU = 0
+TID_ISR = 1
+TID_UNKNOWN = 2
+
+
+class TraceConverter:
+    """Turns the "#TR" lines of one or more dumps into Chrome trace events."""
+
+    def __init__(self):
+        self.events = []
+        self.id_names = {}
+        self.task_names = {}
+        self.tids = {}
+        self.open_spans = {}
+        self.current_task = None
+        self.switch_ts = None
+        self.last_raw = None
+        self.wrap_offset = 0
+        self.origin = None
+        self.last_ts = None
+        self.overwritten = 0
+
+    # --- helpers -------------------------------------------------------------
+
+    def timestamp(self, raw):
+        """Unwrap the 32-bit microsecond counter and make it relative to the first event."""
+        if self.last_raw is not None and raw < self.last_raw and self.last_raw - raw > 0x80000000:
+            self.wrap_offset += 1 << 32
+        self.last_raw = raw
+        ts = raw + self.wrap_offset
+        if self.origin is None:
+            self.origin = ts
+        return ts - self.origin
+
+    def task_name(self, handle):
+        return self.task_names.get(handle, 'task_%08x' % handle)
+
+    def task_tid(self, handle):
+        if handle is None:
+            return TID_UNKNOWN
+        if handle not in self.tids:
+            self.tids[handle] = 16 + len(self.tids)
+        return self.tids[handle]
+
+    def id_name(self, trace_id):
+        return self.id_names.get(trace_id, 'id_%d' % trace_id)
+
+    # --- line handlers -------------------------------------------------------
+
+    def begin_dump(self, fields):
+        if len(fields) >= 3:                # "#TR-BEGIN <events> <overwritten>"
+            self.overwritten += int(fields[2])
+        # Each dump clears the ring on the device: spans left open cannot be closed
+        self.open_spans = {}
+
+    def end_dump(self):
+        self.close_task_slice(self.last_ts)
+        self.current_task = None
+        self.switch_ts = None
+
+    def close_task_slice(self, ts):
+        if self.current_task is not None and self.switch_ts is not None and ts is not None:
+            self.events.append({
+                'name': self.task_name(self.current_task), 'ph': 'X', 'pid': PID, 'tid': TID_CPU,
+                'ts': self.switch_ts, 'dur': max(ts - self.switch_ts, 0),
+            })
+        self.switch_ts = ts
+
+    def event(self, raw_ts, kind, trace_id, arg):
+        ts = self.timestamp(raw_ts)
+        self.last_ts = ts
+
+        if kind == 'S':
+            self.close_task_slice(ts)
+            self.current_task = arg
+            return
+
+        name = self.id_name(trace_id)
+        tid = TID_ISR if name.startswith('isr_') else self.task_tid(self.current_task)
+        base = {'name': name, 'pid': PID, 'tid': tid, 'ts': ts}
+
+        if kind == 'B':
+            self.open_spans.setdefault((tid, trace_id), []).append(ts)
+            self.events.append(dict(base, ph='B', args={'arg': arg}))
+        elif kind == 'E':
+            stack = self.open_spans.get((tid, trace_id))
+            if not stack:
+                return          # Begin was overwritten in the ring
+            stack.pop()
+            result = arg - (1 << 32) if arg & 0x80000000 else arg
+            self.events.append(dict(base, ph='E', args={'result': result}))
+        elif kind == 'I':
+            self.events.append(dict(base, ph='i', s='t', args={'arg': arg}))
+
+    def feed(self, line):
+        idx = line.find('#TR')
+        if idx < 0:
+            return
+        fields = line[idx:].split()
+        tag = fields[0]
+        try:
+            if tag == '#TR' and len(fields) == 5:
+                self.event(int(fields[1], 16), fields[2], int(fields[3]), int(fields[4], 16))
+            elif tag == '#TR-ID' and len(fields) >= 3:
+                self.id_names[int(fields[1])] = fields[2]
+            elif tag == '#TR-TASK' and len(fields) >= 3:
+                self.task_names[int(fields[1], 16)] = ' '.join(fields[2:])
+            elif tag == '#TR-BEGIN':
+                self.begin_dump(fields)
+            elif tag == '#TR-END':
+                self.end_dump()
+        except ValueError:
+            pass                # Line corrupted by interleaved console output
+
+    # --- output --------------------------------------------------------------
+
+    def metadata(self):
+        meta = [
+            {'name': 'process_name', 'ph': 'M', 'pid': PID, 'args': {'name': 'Aeris_Lite'}},
+            {'name': 'thread_name', 'ph': 'M', 'pid': PID, 'tid': TID_CPU, 'args': {'name': 'CPU'}},
+            {'name': 'thread_name', 'ph': 'M', 'pid': PID, 'tid': TID_ISR, 'args': {'name': 'ISR'}},
+            {'name': 'thread_name', 'ph': 'M', 'pid': PID, 'tid': TID_UNKNOWN, 'args': {'name': '(before first switch)'}},
+        ]
+        for handle, tid in self.tids.items():
+            meta.append({'name': 'thread_name', 'ph': 'M', 'pid': PID, 'tid': tid,
+                         'args': {'name': self.task_name(handle)}})
+        return meta
+
+    def result(self):
+        return {'traceEvents': self.metadata() + self.events, 'displayTimeUnit': 'ms'}
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Convert Aeris_Lite "#TR" trace dumps to Chrome/Perfetto JSON')
+    parser.add_argument('input', nargs='?', help='Captured console log (default: stdin)')
+    parser.add_argument('-o', '--output', help='Output JSON file (default: stdout)')
+    args = parser.parse_args()
+
+    conv = TraceConverter()
+    src = open(args.input, 'r', errors='replace') if args.input else sys.stdin
+    for line in src:
+        conv.feed(line.rstrip('\r\n'))
+
+    if not conv.events:
+        sys.exit('No "#TR" events found (firmware built with -D AERIS_ENABLE_TRACE=ON?)')
+
+    out = open(args.output, 'w') if args.output else sys.stdout
+    json.dump(conv.result(), out)
+    if args.output:
+        out.close()
+        print('%d events -> %s (%d overwritten in the ring)' % (len(conv.events), args.output, conv.overwritten),
+              file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()